@@ -0,0 +1,67 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief benchmark driver.
+ */
+
+// c++17
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Local Project
+#include "benchUtil.hpp"
+
+/* Usage: RecognizeBench [--quick] [--json report.json] [--filter name]
+ * The report goes to stdout when --json is not given, the progress to
+ * stderr. Exits with 1 if a suite found a wrong result.
+ */
+int main(int argc, char *argv[]) {
+  bookfiler::bench::BenchOptions options;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--quick") == 0) {
+      options.quick = true;
+    } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+      options.jsonPath = argv[++i];
+    } else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+      options.filter = argv[++i];
+    } else {
+      std::fprintf(stderr,
+                   "usage: %s [--quick] [--json path] [--filter suite]\n",
+                   argv[0]);
+      return 2;
+    }
+  }
+  using SuiteRun = std::function<void(bookfiler::bench::BenchReport &,
+                                      const bookfiler::bench::BenchOptions &)>;
+  std::vector<std::pair<std::string, SuiteRun>>
+      suiteList = {{"title", bookfiler::bench::runTitleBench},
+                   {"parse", bookfiler::bench::runParseBench},
+                   {"statement", bookfiler::bench::runStatementBench},
+                   {"endToEnd", bookfiler::bench::runEndToEndBench},
+                   {"pixmap", bookfiler::bench::runPixmapBench},
+                   {"export", bookfiler::bench::runExportBench},
+                   {"index", bookfiler::bench::runIndexBench},
+                   {"payee", bookfiler::bench::runPayeeBench},
+                   {"extract", bookfiler::bench::runExtractBench}};
+  bookfiler::bench::BenchReport report;
+  for (auto &suite : suiteList) {
+    if (suite.first.find(options.filter) != std::string::npos) {
+      suite.second(report, options);
+    }
+  }
+  std::string json = report.toJson();
+  if (options.jsonPath.empty()) {
+    std::printf("%s\n", json.c_str());
+  } else {
+    std::ofstream file(options.jsonPath);
+    file << json << "\n";
+  }
+  return report.failed ? 1 : 0;
+}
@@ -0,0 +1,140 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief benchmark timing and JSON report.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_BENCH_UTIL_H
+#define BOOKFILER_MODULE_RECOGNIZE_BENCH_UTIL_H
+
+// c++17
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* rapidjson v1.1 (2016-8-25)
+ * Developed by Tencent
+ * License: MITs
+ */
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+
+namespace bookfiler {
+namespace bench {
+
+class BenchOptions {
+public:
+  // write the report here, stdout if empty
+  std::string jsonPath;
+  // smaller inputs, for a quick check that everything runs
+  bool quick = false;
+  // run only the suites whose name contains this
+  std::string filter;
+};
+
+class BenchTimer {
+public:
+  std::chrono::steady_clock::time_point start;
+  BenchTimer() : start(std::chrono::steady_clock::now()){};
+  double seconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+  }
+};
+
+class BenchResult {
+public:
+  std::string suite, name, unit;
+  double value = 0;
+  // input size and configuration of the run
+  std::vector<std::pair<std::string, double>> params;
+};
+
+/* Results of every suite, printed as they come and written as JSON at the
+ * end
+ * {"suite": "recognize", "version": 1,
+ *  "results": [{"suite", "name", "unit", "value", "params": {}}]}
+ */
+class BenchReport {
+public:
+  std::vector<BenchResult> resultList;
+  // set when a suite finds a wrong result, the process exits with 1
+  bool failed = false;
+
+  void add(const std::string &suite, const std::string &name,
+           const std::string &unit, double value,
+           std::vector<std::pair<std::string, double>> params = {}) {
+    BenchResult result;
+    result.suite = suite;
+    result.name = name;
+    result.unit = unit;
+    result.value = value;
+    result.params = std::move(params);
+    std::fprintf(stderr, "%-10s %-40s %16.3f %s\n", suite.c_str(),
+                 name.c_str(), value, unit.c_str());
+    resultList.push_back(std::move(result));
+  }
+  void fail(const std::string &suite, const std::string &message) {
+    std::fprintf(stderr, "%-10s FAILED: %s\n", suite.c_str(),
+                 message.c_str());
+    failed = true;
+  }
+  std::string toJson() {
+    rapidjson::StringBuffer buffer;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+    writer.StartObject();
+    writer.Key("suite");
+    writer.String("recognize");
+    writer.Key("version");
+    writer.Uint(1);
+    writer.Key("failed");
+    writer.Bool(failed);
+    writer.Key("results");
+    writer.StartArray();
+    for (const BenchResult &result : resultList) {
+      writer.StartObject();
+      writer.Key("suite");
+      writer.String(result.suite.c_str());
+      writer.Key("name");
+      writer.String(result.name.c_str());
+      writer.Key("unit");
+      writer.String(result.unit.c_str());
+      writer.Key("value");
+      writer.Double(result.value);
+      writer.Key("params");
+      writer.StartObject();
+      for (const auto &param : result.params) {
+        writer.Key(param.first.c_str());
+        writer.Double(param.second);
+      }
+      writer.EndObject();
+      writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+    return buffer.GetString();
+  }
+};
+
+/* Suites, one per file
+ */
+void runTitleBench(BenchReport &report, const BenchOptions &options);
+void runParseBench(BenchReport &report, const BenchOptions &options);
+void runStatementBench(BenchReport &report, const BenchOptions &options);
+void runEndToEndBench(BenchReport &report, const BenchOptions &options);
+void runPixmapBench(BenchReport &report, const BenchOptions &options);
+void runExportBench(BenchReport &report, const BenchOptions &options);
+void runIndexBench(BenchReport &report, const BenchOptions &options);
+void runPayeeBench(BenchReport &report, const BenchOptions &options);
+void runExtractBench(BenchReport &report, const BenchOptions &options);
+
+} // namespace bench
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_BENCH_UTIL_H
@@ -0,0 +1,705 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief end to end recognition throughput benchmark.
+ */
+
+// c++17
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* boost 1.72.0
+ * License: Boost Software License (similar to BSD and MIT)
+ */
+#include <boost/filesystem.hpp>
+
+// Local Project
+#include "benchUtil.hpp"
+#include "core/recognizeModel.hpp"
+#include "mockOcr.hpp"
+
+namespace bookfiler {
+namespace bench {
+
+namespace {
+
+class EndToEndRun {
+public:
+  std::string name;
+  unsigned int files = 0;
+  // 0 for image files, otherwise every file is a PDF with this many pages
+  int pdfPages = 0;
+  // pages of each image file, more than one is a multi-page TIFF
+  unsigned int imagePages = 1;
+  std::chrono::microseconds ocrLatency{0}, renderLatency{0},
+      ocrSetupLatency{0};
+  // keep idle engines between pages
+  bool enginePool = true;
+  bool cacheEnabled = false;
+  // run the batch twice, the second run is measured
+  bool warm = false;
+  // recognize only this region of the pages
+  std::shared_ptr<const RecognizeRegion> region;
+  // memory budget of the model, 0 for the default
+  unsigned long long modelMaxBytes = 0;
+  // every PDF is the same document, its pages skipped as duplicates
+  bool sameDocument = false;
+  // jobs the scheduler runs at once, 0 for one per worker
+  unsigned int maxJobs = 0;
+  // this page of every PDF fails to render, -1 for none
+  int failPage = -1;
+};
+
+/* @brief Wait for the batch of a model to finish
+ * @return the final batch status
+ */
+std::shared_ptr<rapidjson::Document>
+waitBatch(std::shared_ptr<RecognizeModelInternal> model,
+          unsigned long long pagesExpected) {
+  while (true) {
+    std::shared_ptr<rapidjson::Document> status = model->getBatchStatus();
+    unsigned long long pages = (*status)["pagesDone"].GetUint64() +
+                               (*status)["pagesFailed"].GetUint64();
+    if ((*status)["crawling"].GetUint64() == 0 &&
+        (*status)["pending"].GetUint64() == 0 &&
+        (*status)["queued"].GetUint64() == 0 &&
+        (*status)["running"].GetUint64() == 0 && pages >= pagesExpected) {
+      return status;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(500));
+  }
+}
+
+// @return pages per second
+double runEndToEnd(BenchReport &report, const EndToEndRun &run,
+                   const boost::filesystem::path &directory) {
+  boost::filesystem::path runDirectory = directory / run.name;
+  boost::filesystem::create_directories(runDirectory / "input");
+  std::shared_ptr<std::vector<std::string>> pathList =
+      std::make_shared<std::vector<std::string>>();
+  for (unsigned int i = 0; i < run.files; i++) {
+    boost::filesystem::path filePath =
+        runDirectory / "input" /
+        ("file" + std::to_string(i) +
+         (run.pdfPages ? ".pdf" : run.imagePages > 1 ? ".tif" : ".png"));
+    std::ofstream file(filePath.string(), std::ios::binary);
+    // distinct content so every file has its own cache key
+    file << (run.pdfPages          ? std::string("%PDF-1.4\n")
+             : run.imagePages > 1 ? std::string("II*\0", 4)
+                                  : std::string("\x89PNG\r\n\x1a\n", 8))
+         << i << "\n";
+    pathList->push_back(filePath.string());
+  }
+
+  HocrCorpusConfig corpus;
+  corpus.lines = 50;
+  corpus.words = 8;
+  corpus.noise = 2;
+  corpus.pages = run.pdfPages ? 1 : run.imagePages;
+  std::shared_ptr<MockOcrInterface> ocrModule =
+      std::make_shared<MockOcrInterface>(corpus, run.ocrLatency,
+                                         run.ocrSetupLatency);
+  std::shared_ptr<MockPdfInterface> pdfModule =
+      std::make_shared<MockPdfInterface>(run.pdfPages, run.renderLatency);
+  pdfModule->sameDocument = run.sameDocument;
+  pdfModule->failPage = run.failPage;
+  std::shared_ptr<RecognizeSettings> settings =
+      std::make_shared<RecognizeSettings>();
+  settings->cacheEnabled = run.cacheEnabled;
+  settings->pageSkip.skipDuplicate = run.sameDocument;
+  settings->cachePath = (runDirectory / "cache").string();
+  if (!run.enginePool) {
+    settings->ocrPoolMaxIdle = 0;
+  }
+  if (run.modelMaxBytes) {
+    settings->modelMaxBytes = run.modelMaxBytes;
+  }
+  settings->schedulerMaxJobs = run.maxJobs;
+  std::shared_ptr<RecognizeCache> recognizeCache =
+      std::make_shared<RecognizeCache>();
+  recognizeCache->configure(*settings);
+
+  unsigned long long pagesExpected =
+      static_cast<unsigned long long>(run.files) *
+      (run.pdfPages ? run.pdfPages : 1);
+  if (run.warm) {
+    std::shared_ptr<RecognizeModelInternal> coldModel =
+        std::make_shared<RecognizeModelInternal>(ocrModule, pdfModule,
+                                                 settings, recognizeCache);
+    coldModel->addPaths(pathList);
+    waitBatch(coldModel, pagesExpected);
+  }
+  std::shared_ptr<RecognizeModelInternal> model =
+      std::make_shared<RecognizeModelInternal>(ocrModule, pdfModule, settings,
+                                               recognizeCache);
+  model->setDocumentRegion("bankStatement", run.region);
+  unsigned long long ocrBefore = ocrModule->ocrCount;
+  BenchTimer timer;
+  model->addPaths(pathList);
+  std::shared_ptr<rapidjson::Document> status =
+      waitBatch(model, pagesExpected);
+  double seconds = timer.seconds();
+
+  unsigned long long pagesDone = (*status)["pagesDone"].GetUint64(),
+                     pagesFailed = (*status)["pagesFailed"].GetUint64();
+  unsigned long long failedExpected = run.failPage >= 0 ? run.files : 0;
+  std::vector<std::pair<std::string, double>> params = {
+      {"files", run.files},
+      {"pdfPages", run.pdfPages},
+      {"imagePages", run.imagePages},
+      {"ocrLatencyUs", static_cast<double>(run.ocrLatency.count())},
+      {"renderLatencyUs", static_cast<double>(run.renderLatency.count())},
+      {"ocrSetupLatencyUs", static_cast<double>(run.ocrSetupLatency.count())},
+      {"threads", (*status)["threads"].GetUint()},
+      {"maxJobs", run.maxJobs},
+      {"ocrCalls", static_cast<double>(ocrModule->ocrCount - ocrBefore)}};
+  // the batch counts a multi-page image as one page
+  double pagesPerSecond = static_cast<double>(pagesDone) *
+                          (run.pdfPages ? 1 : run.imagePages) / seconds;
+  report.add("endToEnd", run.name, "pages/s", pagesPerSecond, params);
+  if (pagesDone != pagesExpected - failedExpected) {
+    report.fail("endToEnd", run.name + " recognized " +
+                                std::to_string(pagesDone) + " of " +
+                                std::to_string(pagesExpected) + " pages");
+  }
+  if (pagesFailed != failedExpected) {
+    report.fail("endToEnd", run.name + " counted " +
+                                std::to_string(pagesFailed) + " failed pages, "
+                                "expected " + std::to_string(failedExpected));
+  }
+  // where the time went, from the runtime metrics of the model
+  std::shared_ptr<rapidjson::Document> metrics = model->getMetrics();
+  for (const char *stage : {"ocrSetup", "openImage", "ocr", "hocrParse",
+                            "wordExtraction", "cacheLoad", "cacheStore"}) {
+    const rapidjson::Value &stageValue = (*metrics)["stages"][stage];
+    if (stageValue["count"].GetUint64() > 0) {
+      report.add("endToEnd", run.name + "/" + stage + "/p50", "ns",
+                 static_cast<double>(stageValue["p50"].GetUint64()), params);
+    }
+  }
+  const rapidjson::Value &pageLatency =
+      (*metrics)["histograms"]["pageLatencyMicros"];
+  if (pageLatency["count"].GetUint64() > 0) {
+    report.add("endToEnd", run.name + "/pageLatency/p99", "us",
+               static_cast<double>(pageLatency["p99"].GetUint64()), params);
+  }
+  // only the file last stored may be over the budget
+  const rapidjson::Value &memory = (*metrics)["memory"];
+  if (run.modelMaxBytes) {
+    report.add("endToEnd", run.name + "/memory", "bytes",
+               static_cast<double>(model->getMemoryBytes()), params);
+    if (memory["bytes"].GetUint64() > run.modelMaxBytes &&
+        memory["files"].GetUint64() > 1) {
+      report.fail("endToEnd", run.name + " kept " +
+                                  std::to_string(memory["files"].GetUint64()) +
+                                  " files over the memory budget");
+    }
+    if (memory["filesEvicted"].GetUint64() == 0) {
+      report.fail("endToEnd", run.name + " evicted no file");
+    }
+  }
+  if (run.sameDocument) {
+    const rapidjson::Value &counters = (*metrics)["counters"];
+    report.add("endToEnd", run.name + "/pagesDuplicate", "pages",
+               static_cast<double>(counters["pagesDuplicate"].GetUint64()),
+               params);
+  }
+  // without the cache an evicted file is gone
+  bool kept = !run.modelMaxBytes || run.cacheEnabled;
+  if (kept && !pathList->empty() &&
+      !model->getWordTable(pathList->front(), 0)) {
+    report.fail("endToEnd", run.name + " stored no word table");
+  }
+  // every page of a multi-page image is stored on its own
+  if (!pathList->empty() && run.imagePages > 1) {
+    std::shared_ptr<HocrWordTable> lastPage =
+        model->getWordTable(pathList->front(), run.imagePages - 1);
+    if (!lastPage || lastPage->empty() || !lastPage->pageEnd.empty()) {
+      report.fail("endToEnd", run.name + " stored the pages of an image as "
+                                         "one table");
+    }
+  }
+  // the pages after one that did not render are stored all the same
+  if (!pathList->empty() && run.failPage >= 0) {
+    if (model->getWordTable(pathList->front(), run.failPage)) {
+      report.fail("endToEnd", run.name + " stored the page that failed");
+    }
+    for (int pageNum = run.failPage + 1; pageNum < run.pdfPages; pageNum++) {
+      if (!model->getWordTable(pathList->front(), pageNum)) {
+        report.fail("endToEnd", run.name + " dropped page " +
+                                    std::to_string(pageNum) +
+                                    " after the failed page");
+        break;
+      }
+    }
+  }
+  return pagesPerSecond;
+}
+
+/* @brief Latency of single requests while a batch keeps every worker busy
+ * The batch runs as background, the requests at the given priority.
+ */
+void runRequestLatency(BenchReport &report,
+                       const boost::filesystem::path &directory,
+                       RecognizePriority priority, const std::string &name,
+                       unsigned int files) {
+  boost::filesystem::path runDirectory = directory / name;
+  boost::filesystem::create_directories(runDirectory);
+  std::shared_ptr<std::vector<std::string>> pathList =
+      std::make_shared<std::vector<std::string>>();
+  std::vector<std::string> requestList;
+  for (unsigned int i = 0; i < files + 10; i++) {
+    std::string filePath =
+        (runDirectory / ("file" + std::to_string(i) + ".png")).string();
+    std::ofstream(filePath, std::ios::binary) << i << "\n";
+    if (i < files) {
+      pathList->push_back(filePath);
+    } else {
+      requestList.push_back(filePath);
+    }
+  }
+  HocrCorpusConfig corpus;
+  std::shared_ptr<MockOcrInterface> ocrModule =
+      std::make_shared<MockOcrInterface>(corpus, std::chrono::milliseconds(4));
+  std::shared_ptr<RecognizeSettings> settings =
+      std::make_shared<RecognizeSettings>();
+  settings->cacheEnabled = false;
+  std::shared_ptr<RecognizeModelInternal> model =
+      std::make_shared<RecognizeModelInternal>(ocrModule, nullptr, settings,
+                                               nullptr);
+  model->addPaths(pathList);
+  MetricHistogram latency;
+  for (const std::string &filePath : requestList) {
+    BenchTimer timer;
+    model->requestRecognizeAsync(filePath, priority)->future.wait();
+    latency.record(static_cast<std::uint64_t>(timer.seconds() * 1e6));
+  }
+  std::vector<std::pair<std::string, double>> params = {
+      {"batchFiles", files}, {"ocrLatencyUs", 4000}};
+  report.add("endToEnd", name + "/mean", "us",
+             static_cast<double>(latency.sum) / latency.count, params);
+  report.add("endToEnd", name + "/max", "us",
+             static_cast<double>(latency.max), params);
+}
+
+/* @brief A tree of scans through addPaths, then again as after a restart
+ * The second walk finds every file in the manifest and queues none, the
+ * third finds the one file rewritten in between.
+ */
+void runCrawl(BenchReport &report, const boost::filesystem::path &directory,
+              unsigned int files) {
+  boost::filesystem::path root = directory / "crawl";
+  const unsigned int directories = 20;
+  unsigned int images = 0, others = 0;
+  std::string changedPath;
+  for (unsigned int d = 0; d < directories; d++) {
+    boost::filesystem::path folder =
+        root / ("year" + std::to_string(d % 4)) / ("box" + std::to_string(d));
+    boost::filesystem::create_directories(folder);
+    for (unsigned int i = 0; i < files / directories; i++) {
+      std::string filePath =
+          (folder / ("scan" + std::to_string(i) + ".png")).string();
+      std::ofstream(filePath, std::ios::binary)
+          << std::string("\x89PNG\r\n\x1a\n", 8) << d << " " << i << "\n";
+      changedPath = filePath;
+      images++;
+    }
+    // notes and thumbnail indexes left by the scanner
+    std::ofstream((folder / "notes.txt").string()) << "box " << d << "\n";
+    others++;
+  }
+  HocrCorpusConfig corpus;
+  std::shared_ptr<MockOcrInterface> ocrModule =
+      std::make_shared<MockOcrInterface>(corpus, std::chrono::microseconds(0));
+  std::shared_ptr<RecognizeSettings> settings =
+      std::make_shared<RecognizeSettings>();
+  settings->cacheEnabled = true;
+  settings->crawlManifest = true;
+  settings->cachePath = (directory / "crawlCache").string();
+  std::shared_ptr<RecognizeCache> recognizeCache =
+      std::make_shared<RecognizeCache>();
+  recognizeCache->configure(*settings);
+  std::vector<std::pair<std::string, double>> params = {
+      {"files", images}, {"directories", directories}};
+  for (const char *name : {"cold", "unchanged", "oneChanged"}) {
+    std::string runName = std::string("crawl/") + name;
+    if (runName == "crawl/oneChanged") {
+      std::ofstream(changedPath, std::ios::binary)
+          << std::string("\x89PNG\r\n\x1a\n", 8) << "rescanned\n";
+    }
+    // a manifest loaded from disk as a new session would
+    std::shared_ptr<FileManifest> fileManifest =
+        std::make_shared<FileManifest>();
+    fileManifest->configure(*settings);
+    std::shared_ptr<RecognizeModelInternal> model =
+        std::make_shared<RecognizeModelInternal>(
+            ocrModule, nullptr, settings, recognizeCache, nullptr, nullptr,
+            fileManifest);
+    BenchTimer timer;
+    model->addPaths(std::make_shared<std::vector<std::string>>(
+        std::vector<std::string>{root.string()}));
+    std::shared_ptr<rapidjson::Document> status = waitBatch(model, images);
+    double seconds = timer.seconds();
+    report.add("endToEnd", runName, "files/s", images / seconds, params);
+    unsigned long long unchanged = (*status)["filesUnchanged"].GetUint64();
+    unsigned long long unchangedExpected = runName == "crawl/cold" ? 0
+                                           : runName == "crawl/unchanged"
+                                               ? images
+                                               : images - 1;
+    if (unchanged != unchangedExpected ||
+        (*status)["filesIgnored"].GetUint64() != others) {
+      report.fail("endToEnd",
+                  runName + " found " + std::to_string(unchanged) +
+                      " files unchanged and ignored " +
+                      std::to_string((*status)["filesIgnored"].GetUint64()));
+    }
+    // an unchanged file comes back from the cache
+    if (!model->getWordTable(root.string() + "/year0/box0/scan0.png", 0)) {
+      report.fail("endToEnd", runName + " has no words for an unchanged file");
+    }
+  }
+}
+
+/* @brief Requests whose signals have slow slots, as a UI or a database
+ * would connect. Inline the slots are part of every request.
+ */
+void runSignalDispatch(BenchReport &report,
+                       const boost::filesystem::path &directory,
+                       bool signalThread, const std::string &name,
+                       unsigned int files) {
+  boost::filesystem::path runDirectory = directory / name;
+  boost::filesystem::create_directories(runDirectory);
+  HocrCorpusConfig corpus;
+  std::shared_ptr<MockOcrInterface> ocrModule =
+      std::make_shared<MockOcrInterface>(corpus, std::chrono::milliseconds(1));
+  std::shared_ptr<RecognizeSettings> settings =
+      std::make_shared<RecognizeSettings>();
+  settings->cacheEnabled = false;
+  settings->signalThread = signalThread;
+  std::shared_ptr<RecognizeModelInternal> model =
+      std::make_shared<RecognizeModelInternal>(ocrModule, nullptr, settings,
+                                               nullptr);
+  std::atomic<unsigned long long> images(0), tables(0);
+  const std::chrono::microseconds slotLatency(2000);
+  model->imageUpdateSignal.connect([&](std::shared_ptr<Pixmap>) {
+    std::this_thread::sleep_for(slotLatency);
+    images++;
+  });
+  model->wordTableUpdateSignal.connect([&](std::shared_ptr<HocrWordTable>) {
+    std::this_thread::sleep_for(slotLatency);
+    tables++;
+  });
+  MetricHistogram latency;
+  BenchTimer totalTimer;
+  for (unsigned int i = 0; i < files; i++) {
+    std::string filePath =
+        (runDirectory / ("file" + std::to_string(i) + ".png")).string();
+    std::ofstream(filePath, std::ios::binary) << i << "\n";
+    BenchTimer timer;
+    model->requestRecognizeAsync(filePath, RecognizePriority::interactive)
+        ->future.wait();
+    latency.record(static_cast<std::uint64_t>(timer.seconds() * 1e6));
+  }
+  model->flushSignals();
+  double seconds = totalTimer.seconds();
+  std::vector<std::pair<std::string, double>> params = {
+      {"files", files},
+      {"ocrLatencyUs", 1000},
+      {"slotLatencyUs", static_cast<double>(slotLatency.count())},
+      {"imagesDelivered", static_cast<double>(images.load())}};
+  report.add("endToEnd", name + "/request/mean", "us",
+             static_cast<double>(latency.sum) / latency.count, params);
+  report.add("endToEnd", name + "/allDelivered", "files/s", files / seconds,
+             params);
+  std::shared_ptr<rapidjson::Document> metrics = model->getMetrics();
+  const rapidjson::Value &queueLatency =
+      (*metrics)["histograms"]["signalQueueMicros"];
+  if (queueLatency["count"].GetUint64() > 0) {
+    report.add("endToEnd", name + "/signalQueue/p99", "us",
+               static_cast<double>(queueLatency["p99"].GetUint64()), params);
+  }
+  // only a later image of the same page replaces one, each file has its own
+  if (tables != files || images != files) {
+    report.fail("endToEnd", name + " delivered " +
+                                std::to_string(tables.load()) +
+                                " word tables and " +
+                                std::to_string(images.load()) +
+                                " images for " + std::to_string(files) +
+                                " files");
+  }
+}
+
+/* @brief A batch where one engine in ten never calls back
+ * Each such page fails after the OCR timeout and its worker goes on, so
+ * the batch still ends with every file done or failed.
+ */
+void runSilentEngine(BenchReport &report,
+                     const boost::filesystem::path &directory,
+                     unsigned int files) {
+  const std::string name = "ocr/silentEngine";
+  boost::filesystem::path runDirectory = directory / name;
+  boost::filesystem::create_directories(runDirectory);
+  std::shared_ptr<std::vector<std::string>> pathList =
+      std::make_shared<std::vector<std::string>>();
+  for (unsigned int i = 0; i < files; i++) {
+    std::string filePath =
+        (runDirectory / ("file" + std::to_string(i) + ".png")).string();
+    std::ofstream(filePath, std::ios::binary)
+        << std::string("\x89PNG\r\n\x1a\n", 8) << i << "\n";
+    pathList->push_back(filePath);
+  }
+  HocrCorpusConfig corpus;
+  std::shared_ptr<MockOcrInterface> ocrModule =
+      std::make_shared<MockOcrInterface>(corpus, std::chrono::milliseconds(1));
+  ocrModule->silentEvery = 10;
+  std::shared_ptr<RecognizeSettings> settings =
+      std::make_shared<RecognizeSettings>();
+  settings->ocrTimeoutMs = 50;
+  std::shared_ptr<RecognizeModelInternal> model =
+      std::make_shared<RecognizeModelInternal>(ocrModule, nullptr, settings,
+                                               nullptr);
+  BenchTimer timer;
+  model->addPaths(pathList);
+  std::shared_ptr<rapidjson::Document> status = waitBatch(model, files);
+  double seconds = timer.seconds();
+  unsigned long long done = (*status)["pagesDone"].GetUint64(),
+                     failed = (*status)["pagesFailed"].GetUint64();
+  std::vector<std::pair<std::string, double>> params = {
+      {"files", files}, {"timeoutMs", 50}, {"silentEvery", 10}};
+  report.add("endToEnd", name + "/batch", "ms", seconds * 1e3, params);
+  report.add("endToEnd", name + "/pagesFailed", "pages",
+             static_cast<double>(failed), params);
+  if (done + failed != files || failed == 0) {
+    report.fail("endToEnd", name + " done " + std::to_string(done) +
+                                " and failed " + std::to_string(failed) +
+                                " of " + std::to_string(files) + " files");
+  }
+}
+
+/* @brief A request cancelled while its page is in a slow engine that
+ * calls back from its own thread
+ * The ticket stops waiting for the engine, the cancel takes effect within
+ * the poll of the wait and not when the page is done.
+ */
+void runCancelDuringOcr(BenchReport &report,
+                        const boost::filesystem::path &directory) {
+  const std::string name = "request/cancelDuringOcr";
+  boost::filesystem::path runDirectory = directory / name;
+  boost::filesystem::create_directories(runDirectory);
+  const std::chrono::milliseconds ocrLatency(500);
+  HocrCorpusConfig corpus;
+  std::shared_ptr<MockOcrInterface> ocrModule =
+      std::make_shared<MockOcrInterface>(corpus, ocrLatency);
+  ocrModule->async = true;
+  std::shared_ptr<RecognizeSettings> settings =
+      std::make_shared<RecognizeSettings>();
+  std::shared_ptr<RecognizeModelInternal> model =
+      std::make_shared<RecognizeModelInternal>(ocrModule, nullptr, settings,
+                                               nullptr);
+  std::string filePath = (runDirectory / "file.png").string();
+  std::ofstream(filePath, std::ios::binary)
+      << std::string("\x89PNG\r\n\x1a\n", 8) << "cancel\n";
+  std::shared_ptr<RecognizeTicket> ticket =
+      model->requestRecognizeAsync(filePath, RecognizePriority::interactive);
+  // well inside recognize
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  BenchTimer timer;
+  ticket->cancel();
+  std::shared_ptr<RecognizeResult> result = ticket->future.get();
+  double seconds = timer.seconds();
+  std::vector<std::pair<std::string, double>> params = {
+      {"ocrLatencyMs", static_cast<double>(ocrLatency.count())}};
+  report.add("endToEnd", name + "/cancelToResult", "ms", seconds * 1e3,
+             params);
+  if (!result->cancelled || seconds * 1e3 > ocrLatency.count() / 2) {
+    report.fail("endToEnd", name + " took " + std::to_string(seconds * 1e3) +
+                                " ms to return the cancelled request");
+  }
+}
+
+/* @brief Two models on one scheduler, a small batch added after a large one
+ * With a fair share the small batch is done long before the large one,
+ * with one queue it would wait for every file added before it.
+ */
+void runSharedScheduler(BenchReport &report,
+                        const boost::filesystem::path &directory,
+                        unsigned int files) {
+  const std::string name = "scheduler/twoModels";
+  boost::filesystem::path runDirectory = directory / "sharedScheduler";
+  boost::filesystem::create_directories(runDirectory);
+  unsigned int smallFiles = files / 10;
+  std::shared_ptr<std::vector<std::string>> largeList =
+      std::make_shared<std::vector<std::string>>();
+  std::shared_ptr<std::vector<std::string>> smallList =
+      std::make_shared<std::vector<std::string>>();
+  for (unsigned int i = 0; i < files + smallFiles; i++) {
+    std::string filePath =
+        (runDirectory / ("file" + std::to_string(i) + ".png")).string();
+    std::ofstream(filePath, std::ios::binary)
+        << std::string("\x89PNG\r\n\x1a\n", 8) << i << "\n";
+    (i < files ? largeList : smallList)->push_back(filePath);
+  }
+  HocrCorpusConfig corpus;
+  std::shared_ptr<MockOcrInterface> ocrModule =
+      std::make_shared<MockOcrInterface>(corpus, std::chrono::milliseconds(2));
+  std::shared_ptr<RecognizeSettings> settings =
+      std::make_shared<RecognizeSettings>();
+  settings->cacheEnabled = false;
+  settings->schedulerMaxOcrJobs = 2;
+  std::shared_ptr<RecognizeScheduler> scheduler =
+      std::make_shared<RecognizeScheduler>();
+  scheduler->configure(*settings);
+  std::shared_ptr<RecognizeModelInternal> largeModel =
+      std::make_shared<RecognizeModelInternal>(ocrModule, nullptr, settings,
+                                               nullptr, nullptr, nullptr,
+                                               nullptr, nullptr, scheduler);
+  std::shared_ptr<RecognizeModelInternal> smallModel =
+      std::make_shared<RecognizeModelInternal>(ocrModule, nullptr, settings,
+                                               nullptr, nullptr, nullptr,
+                                               nullptr, nullptr, scheduler);
+  BenchTimer timer;
+  largeModel->addPaths(largeList);
+  smallModel->addPaths(smallList);
+  waitBatch(smallModel, smallFiles);
+  double smallSeconds = timer.seconds();
+  waitBatch(largeModel, files);
+  double largeSeconds = timer.seconds();
+  rapidjson::Document status;
+  scheduler->toJson(status, status.GetAllocator());
+  std::vector<std::pair<std::string, double>> params = {
+      {"largeFiles", files},
+      {"smallFiles", smallFiles},
+      {"ocrLatencyUs", 2000},
+      {"threads", status["threads"].GetUint()},
+      {"maxOcrJobs", settings->schedulerMaxOcrJobs}};
+  report.add("endToEnd", name + "/small", "ms", smallSeconds * 1e3, params);
+  report.add("endToEnd", name + "/large", "ms", largeSeconds * 1e3, params);
+  report.add("endToEnd", name + "/total", "files/s",
+             (files + smallFiles) / largeSeconds, params);
+  std::uint64_t ocrPeak = status["ocrPeak"].GetUint64();
+  if (ocrPeak > settings->schedulerMaxOcrJobs) {
+    report.fail("endToEnd", name + " ran " + std::to_string(ocrPeak) +
+                                " pages in OCR at once");
+  }
+  if (smallSeconds > largeSeconds / 2) {
+    report.fail("endToEnd", name + " small batch done at " +
+                                std::to_string(smallSeconds) + "s of " +
+                                std::to_string(largeSeconds) + "s");
+  }
+}
+
+} // namespace
+
+/* Files through addPaths with the mock modules, cache off unless the run
+ * measures it
+ */
+void runEndToEndBench(BenchReport &report, const BenchOptions &options) {
+  unsigned int files = options.quick ? 40 : 400;
+  std::vector<EndToEndRun> runList(16);
+  runList[0].name = "images/parseOnly";
+  runList[0].files = files;
+  runList[1].name = "images/ocr2ms";
+  runList[1].files = files;
+  runList[1].ocrLatency = std::chrono::milliseconds(2);
+  runList[2].name = "pdf/parseOnly";
+  runList[2].files = files / 10;
+  runList[2].pdfPages = 10;
+  runList[3].name = "pdf/render1ms+ocr2ms";
+  runList[3].files = files / 10;
+  runList[3].pdfPages = 10;
+  runList[3].ocrLatency = std::chrono::milliseconds(2);
+  runList[3].renderLatency = std::chrono::milliseconds(1);
+  runList[4].name = "images/ocr2ms/cacheWarm";
+  runList[4].files = files;
+  runList[4].ocrLatency = std::chrono::milliseconds(2);
+  runList[4].cacheEnabled = true;
+  runList[4].warm = true;
+  // the middle third of the page, the transaction table band
+  std::shared_ptr<RecognizeRegion> band = std::make_shared<RecognizeRegion>();
+  band->y0 = 1.0 / 3;
+  band->y1 = 2.0 / 3;
+  runList[5] = runList[1];
+  runList[5].name = "images/ocr2ms/region";
+  runList[5].region = band;
+  runList[6] = runList[3];
+  runList[6].name = "pdf/render1ms+ocr2ms/region";
+  runList[6].region = band;
+  // engines that load 5ms of data when they are set up
+  runList[7] = runList[1];
+  runList[7].name = "images/ocr2ms+setup5ms";
+  runList[7].ocrSetupLatency = std::chrono::milliseconds(5);
+  runList[8] = runList[7];
+  runList[8].name = "images/ocr2ms+setup5ms/noEnginePool";
+  runList[8].enginePool = false;
+  // one hOCR of 10 pages per file, parsed a page per worker
+  runList[9].name = "tiff/parseOnly";
+  runList[9].files = files / 10;
+  runList[9].imagePages = 10;
+  runList[10] = runList[9];
+  runList[10].name = "tiff/ocr2ms/cacheWarm";
+  runList[10].ocrLatency = std::chrono::milliseconds(2);
+  runList[10].cacheEnabled = true;
+  runList[10].warm = true;
+  // evicted files come back from the cache when asked for
+  runList[11] = runList[2];
+  runList[11].name = "pdf/parseOnly/cache+maxBytes2MiB";
+  runList[11].cacheEnabled = true;
+  runList[11].modelMaxBytes = 2 * 1024 * 1024;
+  /* the same document over and over with files evicted without a cache, a
+   * duplicate of an evicted page is recognized as any other page
+   */
+  runList[12] = runList[2];
+  runList[12].name = "pdf/parseOnly/duplicates+evicted";
+  runList[12].sameDocument = true;
+  runList[12].modelMaxBytes = 256 * 1024;
+  /* a single long hOCR, its pages parsed on every worker, then with one job
+   * at a time so they are parsed in turn
+   */
+  runList[13].name = "tiff/parseOnly/oneFile";
+  runList[13].files = 1;
+  runList[13].imagePages = options.quick ? 200 : 1000;
+  runList[14] = runList[13];
+  runList[14].name = "tiff/parseOnly/oneFile/sequential";
+  runList[14].maxJobs = 1;
+  // one page in the middle of every PDF does not render
+  runList[15] = runList[2];
+  runList[15].name = "pdf/parseOnly/failedPage";
+  runList[15].failPage = runList[15].pdfPages / 2;
+
+  boost::filesystem::path directory =
+      boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path("bookfiler-recognize-bench-%%%%%%%%");
+  std::vector<double> pagesPerSecond;
+  for (const EndToEndRun &run : runList) {
+    pagesPerSecond.push_back(runEndToEnd(report, run, directory));
+  }
+  double splitSpeedup = pagesPerSecond[13] / pagesPerSecond[14];
+  report.add("endToEnd", "tiff/parseOnly/oneFile/splitSpeedup", "x",
+             splitSpeedup, {{"pages", runList[13].imagePages}});
+  if (std::thread::hardware_concurrency() > 1 && splitSpeedup < 1) {
+    report.fail("endToEnd", "pages split over the workers parsed slower "
+                            "than in turn");
+  }
+  runRequestLatency(report, directory, RecognizePriority::background,
+                    "request/underBatch/background", files);
+  runRequestLatency(report, directory, RecognizePriority::interactive,
+                    "request/underBatch/interactive", files);
+  runCrawl(report, directory, files * 25);
+  runSignalDispatch(report, directory, false, "signal/slow2ms/inline", files);
+  runSignalDispatch(report, directory, true, "signal/slow2ms/thread", files);
+  runSharedScheduler(report, directory, files);
+  runSilentEngine(report, directory, files);
+  runCancelDuringOcr(report, directory);
+  boost::system::error_code ec;
+  boost::filesystem::remove_all(directory, ec);
+}
+
+} // namespace bench
+} // namespace bookfiler
@@ -0,0 +1,281 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief document export benchmark.
+ */
+
+// c++17
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/* boost 1.72.0
+ * License: Boost Software License (similar to BSD and MIT)
+ */
+#include <boost/filesystem.hpp>
+
+/* rapidjson v1.1 (2016-8-25)
+ * Developed by Tencent
+ * License: MITs
+ */
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+// Local Project
+#include "benchUtil.hpp"
+#include "core/bankStatement.hpp"
+#include "core/documentFile.hpp"
+#include "core/documentJson.hpp"
+#include "core/hocrParser.hpp"
+#include "syntheticHocr.hpp"
+#include "syntheticStatement.hpp"
+
+namespace bookfiler {
+namespace bench {
+
+namespace {
+
+/* Same layout as writeDocumentJson built as a Document first, the way the
+ * results were turned into JSON before
+ */
+std::string writeDocumentJsonDom(const std::string &sourcePath,
+                                 const std::vector<DocumentPage> &pageList) {
+  rapidjson::Document document;
+  document.SetObject();
+  rapidjson::Document::AllocatorType &allocator = document.GetAllocator();
+  document.AddMember("file", rapidjson::Value(sourcePath.c_str(), allocator),
+                     allocator);
+  rapidjson::Value pages(rapidjson::kArrayType);
+  for (const DocumentPage &page : pageList) {
+    rapidjson::Value pageValue(rapidjson::kObjectType);
+    pageValue.AddMember("page", page.pageNum, allocator);
+    rapidjson::Value words(rapidjson::kArrayType);
+    const HocrWordTable &table = *page.wordTable;
+    for (std::size_t i = 0; i < table.size(); i++) {
+      std::string_view text = table.getString(table.valueIndex[i]);
+      rapidjson::Value word(rapidjson::kObjectType);
+      word.AddMember("text",
+                     rapidjson::Value(text.data(),
+                                      static_cast<rapidjson::SizeType>(
+                                          text.size()),
+                                      allocator),
+                     allocator);
+      word.AddMember("x0", table.x0[i], allocator);
+      word.AddMember("y0", table.y0[i], allocator);
+      word.AddMember("x1", table.x1[i], allocator);
+      word.AddMember("y1", table.y1[i], allocator);
+      word.AddMember("confidence", static_cast<double>(table.confidence[i]),
+                     allocator);
+      words.PushBack(word, allocator);
+    }
+    pageValue.AddMember("words", words, allocator);
+    rapidjson::Value lines(rapidjson::kArrayType);
+    for (unsigned int end : table.lineEnd) {
+      lines.PushBack(end, allocator);
+    }
+    pageValue.AddMember("lines", lines, allocator);
+    rapidjson::Value rows(rapidjson::kArrayType);
+    std::vector<unsigned int> rowNumList;
+    for (auto &rowPair : page.statement->rowMap) {
+      rowNumList.push_back(rowPair.first);
+    }
+    std::sort(rowNumList.begin(), rowNumList.end());
+    for (unsigned int rowNum : rowNumList) {
+      const FileTypeBankStatementRow &row = page.statement->rowMap.at(rowNum);
+      long long amount = static_cast<long long>(row.amount),
+                balance = static_cast<long long>(row.balance);
+      rapidjson::Value rowValue(rapidjson::kObjectType);
+      rowValue.AddMember("date", rapidjson::Value(row.date.c_str(), allocator),
+                         allocator);
+      rowValue.AddMember("description",
+                         rapidjson::Value(row.description.c_str(), allocator),
+                         allocator);
+      rowValue.AddMember("payee",
+                         rapidjson::Value(row.payee.c_str(), allocator),
+                         allocator);
+      rowValue.AddMember(
+          "amount", static_cast<int64_t>(row.amountSign ? -amount : amount),
+          allocator);
+      rowValue.AddMember(
+          "balance",
+          static_cast<int64_t>(row.balanceSign ? -balance : balance),
+          allocator);
+      rowValue.AddMember("x0", row.x0, allocator);
+      rowValue.AddMember("y0", row.y0, allocator);
+      rowValue.AddMember("x1", row.x1, allocator);
+      rowValue.AddMember("y1", row.y1, allocator);
+      rows.PushBack(rowValue, allocator);
+    }
+    pageValue.AddMember("rows", rows, allocator);
+    pages.PushBack(pageValue, allocator);
+  }
+  document.AddMember("pages", pages, allocator);
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+  document.Accept(writer);
+  return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+/* What an importer reads back, summed so nothing is optimized away
+ */
+class ExportChecksum {
+public:
+  unsigned long long words = 0, x0 = 0, textBytes = 0, rows = 0;
+  long long amount = 0;
+  bool operator==(const ExportChecksum &other) const {
+    return words == other.words && x0 == other.x0 &&
+           textBytes == other.textBytes && rows == other.rows &&
+           amount == other.amount;
+  }
+};
+
+ExportChecksum readJson(const std::string &json) {
+  ExportChecksum checksum;
+  rapidjson::Document document;
+  document.Parse(json.data(), json.size());
+  if (document.HasParseError()) {
+    return checksum;
+  }
+  for (const rapidjson::Value &page : document["pages"].GetArray()) {
+    for (const rapidjson::Value &word : page["words"].GetArray()) {
+      checksum.words++;
+      checksum.x0 += word["x0"].GetUint();
+      checksum.textBytes += word["text"].GetStringLength();
+    }
+    for (const rapidjson::Value &row : page["rows"].GetArray()) {
+      checksum.rows++;
+      checksum.amount += row["amount"].GetInt64();
+    }
+  }
+  return checksum;
+}
+
+ExportChecksum readBinary(const std::string &filePath) {
+  ExportChecksum checksum;
+  DocumentFileView view;
+  if (!view.open(filePath)) {
+    return checksum;
+  }
+  const uint32_t *x0 = view.column<uint32_t>(DocumentColumn::x0);
+  const uint32_t *valueIndex =
+      view.column<uint32_t>(DocumentColumn::valueIndex);
+  checksum.words = view.getWordCount();
+  for (std::size_t i = 0; i < view.getWordCount(); i++) {
+    checksum.x0 += x0[i];
+    checksum.textBytes += view.getString(valueIndex[i]).size();
+  }
+  const uint64_t *amount = view.column<uint64_t>(DocumentColumn::rowAmount);
+  const uint32_t *flags = view.column<uint32_t>(DocumentColumn::rowFlags);
+  checksum.rows = view.getRowCount();
+  for (std::size_t i = 0; i < view.getRowCount(); i++) {
+    long long value = static_cast<long long>(amount[i]);
+    checksum.amount += (flags[i] & 1) ? -value : value;
+  }
+  return checksum;
+}
+
+} // namespace
+
+/* Writing and reading back a recognized document
+ * write: DOM JSON, streaming JSON and the binary document file
+ * read: the hOCR the words came from, the JSON and the mapped binary file
+ */
+void runExportBench(BenchReport &report, const BenchOptions &options) {
+  unsigned int pageCount = options.quick ? 4 : 40;
+  unsigned int repeat = options.quick ? 3 : 10;
+  std::vector<DocumentPage> pageList;
+  std::vector<std::string> hocrList;
+  std::size_t wordCount = 0;
+  for (unsigned int i = 0; i < pageCount; i++) {
+    HocrCorpusConfig config;
+    config.seed = i + 1;
+    hocrList.push_back(generateHocr(config));
+    DocumentPage page;
+    page.pageNum = i;
+    page.wordTable = hocrWordTableFromString(hocrList.back());
+    page.statement = toBankStatement(makeStatementTable(50, i + 1));
+    wordCount += page.wordTable->size();
+    pageList.push_back(page);
+  }
+  boost::filesystem::path directory =
+      boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path("bookfiler-recognize-bench-%%%%%%%%");
+  boost::filesystem::create_directories(directory);
+  std::string binaryPath = (directory / "document.bfdc").string();
+  std::string sourcePath = "statement.pdf";
+  std::vector<std::pair<std::string, double>> params = {
+      {"pages", static_cast<double>(pageCount)},
+      {"words", static_cast<double>(wordCount)}};
+
+  std::string domJson, streamJson;
+  BenchTimer domTimer;
+  for (unsigned int i = 0; i < repeat; i++) {
+    domJson = writeDocumentJsonDom(sourcePath, pageList);
+  }
+  double domSeconds = domTimer.seconds() / repeat;
+  BenchTimer streamTimer;
+  for (unsigned int i = 0; i < repeat; i++) {
+    streamJson = writeDocumentJson(sourcePath, pageList);
+  }
+  double streamSeconds = streamTimer.seconds() / repeat;
+  BenchTimer binaryTimer;
+  bool written = true;
+  for (unsigned int i = 0; i < repeat; i++) {
+    written = writeDocumentFile(binaryPath, sourcePath, pageList) && written;
+  }
+  double binarySeconds = binaryTimer.seconds() / repeat;
+  if (!written) {
+    report.fail("export", "writeDocumentFile failed");
+  }
+  if (domJson != streamJson) {
+    report.fail("export", "streaming JSON differs from the DOM JSON");
+  }
+  double binaryBytes =
+      static_cast<double>(boost::filesystem::file_size(binaryPath));
+  report.add("export", "write/domJson", "ms", domSeconds * 1e3, params);
+  report.add("export", "write/streamJson", "ms", streamSeconds * 1e3, params);
+  report.add("export", "write/binary", "ms", binarySeconds * 1e3, params);
+  report.add("export", "size/json", "bytes",
+             static_cast<double>(streamJson.size()), params);
+  report.add("export", "size/binary", "bytes", binaryBytes, params);
+
+  std::size_t hocrWords = 0;
+  BenchTimer hocrTimer;
+  for (unsigned int i = 0; i < repeat; i++) {
+    for (const std::string &hocr : hocrList) {
+      hocrWords += hocrWordTableFromString(hocr)->size();
+    }
+  }
+  double hocrSeconds = hocrTimer.seconds() / repeat;
+  ExportChecksum jsonChecksum, binaryChecksum;
+  BenchTimer jsonTimer;
+  for (unsigned int i = 0; i < repeat; i++) {
+    jsonChecksum = readJson(streamJson);
+  }
+  double jsonSeconds = jsonTimer.seconds() / repeat;
+  BenchTimer mapTimer;
+  for (unsigned int i = 0; i < repeat; i++) {
+    binaryChecksum = readBinary(binaryPath);
+  }
+  double mapSeconds = mapTimer.seconds() / repeat;
+  if (!(jsonChecksum == binaryChecksum) || binaryChecksum.words != wordCount ||
+      hocrWords != wordCount * repeat) {
+    report.fail("export", "binary and JSON read back different documents");
+  }
+  report.add("export", "read/hocrParse", "ms", hocrSeconds * 1e3, params);
+  report.add("export", "read/jsonDom", "ms", jsonSeconds * 1e3, params);
+  report.add("export", "read/binaryMap", "ms", mapSeconds * 1e3, params);
+  report.add("export", "read/jsonDom/throughput", "MB/s",
+             streamJson.size() / jsonSeconds / 1e6, params);
+  report.add("export", "read/binaryMap/throughput", "MB/s",
+             binaryBytes / mapSeconds / 1e6, params);
+  report.add("export", "read/speedup", "x", jsonSeconds / mapSeconds, params);
+  boost::system::error_code ec;
+  boost::filesystem::remove_all(directory, ec);
+}
+
+} // namespace bench
+} // namespace bookfiler
@@ -0,0 +1,111 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief document extractor registry benchmark.
+ */
+
+// c++17
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Local Project
+#include "benchUtil.hpp"
+#include "core/documentExtractor.hpp"
+#include "syntheticInvoice.hpp"
+#include "syntheticStatement.hpp"
+
+namespace bookfiler {
+namespace bench {
+
+/* Every extractor of the registry through extractDocument, as the model
+ * calls it: pages and words per second and the share of the rows found.
+ * Fails on a missed row, a wrong total or a missing invoice number.
+ */
+void runExtractBench(BenchReport &report, const BenchOptions &options) {
+  unsigned int rowCount = options.quick ? 50 : 200;
+  unsigned int pageCount = options.quick ? 20 : 100;
+  unsigned int typeCount = static_cast<unsigned int>(DocumentType::count);
+  for (unsigned int typeIndex = 0; typeIndex < typeCount; typeIndex++) {
+    DocumentType type = static_cast<DocumentType>(typeIndex);
+    const DocumentExtractor &extractor = getDocumentExtractor(type);
+    if (!extractor.extract) {
+      continue;
+    }
+    std::vector<std::shared_ptr<HocrWordTable>> tableList;
+    std::vector<InvoiceTruth> truthList(pageCount);
+    std::size_t wordCount = 0;
+    for (unsigned int page = 0; page < pageCount; page++) {
+      if (type == DocumentType::bankStatement) {
+        tableList.push_back(makeStatementTable(rowCount, page + 1));
+      } else {
+        tableList.push_back(makeInvoiceTable(rowCount, page + 1,
+                                             type == DocumentType::receipt,
+                                             truthList[page]));
+      }
+      wordCount += tableList.back()->size();
+    }
+    std::vector<DocumentExtract> extractList(pageCount);
+    unsigned int repeat = options.quick ? 2 : 5;
+    BenchTimer timer;
+    for (unsigned int i = 0; i < repeat; i++) {
+      for (unsigned int page = 0; page < pageCount; page++) {
+        extractList[page] =
+            extractDocument(type, tableList[page], StatementFieldOptions());
+      }
+    }
+    double seconds = timer.seconds() / repeat;
+    std::size_t rowsFound = 0;
+    std::string error;
+    for (unsigned int page = 0; page < pageCount && error.empty(); page++) {
+      const DocumentExtract &extract = extractList[page];
+      if (type == DocumentType::bankStatement) {
+        rowsFound += extract.statement ? extract.statement->rowMap.size() : 0;
+        continue;
+      }
+      if (!extract.invoice) {
+        error = "no invoice";
+        break;
+      }
+      const FileTypeInvoice &invoice = *extract.invoice;
+      const InvoiceTruth &truth = truthList[page];
+      rowsFound += invoice.rowMap.size();
+      if (invoice.number != truth.number) {
+        error = "number \"" + invoice.number + "\" for " + truth.number;
+      } else if (invoice.subtotal != truth.subtotal ||
+                 invoice.tax != truth.tax || invoice.total != truth.total) {
+        error = "totals " + std::to_string(invoice.subtotal) + " " +
+                std::to_string(invoice.tax) + " " +
+                std::to_string(invoice.total) + " on page " +
+                std::to_string(page);
+      } else if (invoice.dateDay == 0) {
+        error = "no date";
+      }
+    }
+    std::vector<std::pair<std::string, double>> params = {
+        {"pages", static_cast<double>(pageCount)},
+        {"rows", static_cast<double>(rowCount)},
+        {"words", static_cast<double>(wordCount)}};
+    std::string name = std::string(extractor.name);
+    double rowRecall =
+        static_cast<double>(rowsFound) / (static_cast<double>(rowCount) *
+                                          pageCount);
+    report.add("extract", name + "/pages", "pages/s", pageCount / seconds,
+               params);
+    report.add("extract", name + "/words", "words/s", wordCount / seconds,
+               params);
+    report.add("extract", name + "/rowRecall", "ratio", rowRecall, params);
+    if (error.empty() && rowsFound != static_cast<std::size_t>(rowCount) *
+                                          pageCount) {
+      error = "found " + std::to_string(rowsFound) + " rows";
+    }
+    if (!error.empty()) {
+      report.fail("extract", name + " " + error);
+    }
+  }
+}
+
+} // namespace bench
+} // namespace bookfiler
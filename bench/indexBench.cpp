@@ -0,0 +1,229 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief word index benchmark.
+ */
+
+// c++17
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* boost 1.72.0
+ * License: Boost Software License (similar to BSD and MIT)
+ */
+#include <boost/filesystem.hpp>
+
+// Local Project
+#include "benchUtil.hpp"
+#include "core/recognizeMetrics.hpp"
+#include "core/recognizeSettings.hpp"
+#include "core/statementFields.hpp"
+#include "core/wordIndex.hpp"
+#include "syntheticStatement.hpp"
+
+namespace bookfiler {
+namespace bench {
+
+namespace {
+
+const unsigned int pagesPerDocument = 12;
+
+std::string getDocumentPath(unsigned int page) {
+  return "/statements/" + std::to_string(page / pagesPerDocument) + ".pdf";
+}
+
+/* Latency of a query run over a list of inputs, in nanoseconds
+ * @return hits of every query summed, so nothing is optimized away
+ */
+std::size_t runQueries(BenchReport &report, const std::string &name,
+                       std::size_t queryCount,
+                       const std::function<std::size_t(std::size_t)> &query) {
+  MetricHistogram latency;
+  std::size_t hits = 0;
+  for (std::size_t i = 0; i < queryCount; i++) {
+    BenchTimer timer;
+    hits += query(i);
+    latency.record(static_cast<std::uint64_t>(timer.seconds() * 1e9));
+  }
+  report.add("index", name + "/p50", "ns",
+             static_cast<double>(latency.getQuantile(0.5)));
+  report.add("index", name + "/p99", "ns",
+             static_cast<double>(latency.getQuantile(0.99)));
+  return hits;
+}
+
+/* Term, prefix and amount queries against an index, checked against a
+ * scan of the tables
+ */
+void runIndexQueries(
+    BenchReport &report, const std::string &prefix, WordIndex &index,
+    const std::vector<std::shared_ptr<HocrWordTable>> &tableList) {
+  // amounts are rare terms, a payee is on most pages
+  std::vector<std::string> rareList;
+  for (std::size_t i = 0; i < 1000; i++) {
+    const HocrWordTable &table = *tableList[(i * 7919) % tableList.size()];
+    std::size_t word = (i * 31) % table.size();
+    while (table.getString(table.valueIndex[word]).find('.') ==
+           std::string_view::npos) {
+      word = (word + 1) % table.size();
+    }
+    rareList.emplace_back(table.getString(table.valueIndex[word]));
+  }
+  std::vector<WordHit> hitList;
+  runQueries(report, prefix + "/term/rare", rareList.size(),
+             [&](std::size_t i) {
+               hitList.clear();
+               index.findTerm(rareList[i], 0, hitList);
+               return hitList.size();
+             });
+  runQueries(report, prefix + "/term/common100", 1000, [&](std::size_t) {
+    hitList.clear();
+    index.findTerm("Grocery", 100, hitList);
+    return hitList.size();
+  });
+  runQueries(report, prefix + "/prefix/pay100", 1000, [&](std::size_t) {
+    hitList.clear();
+    index.findPrefix("PAY", 100, hitList);
+    return hitList.size();
+  });
+  runQueries(report, prefix + "/amount/range", 1000, [&](std::size_t i) {
+    long long minimum = static_cast<long long>(i * 500) - 250000;
+    hitList.clear();
+    index.findAmounts(minimum, minimum + 100, 0, hitList);
+    return hitList.size();
+  });
+  // every hit of a term and a range, compared with a scan
+  std::size_t payrollCount = 0, amountCount = 0;
+  const long long minimum = -10000, maximum = 10000;
+  for (const std::shared_ptr<HocrWordTable> &table : tableList) {
+    for (std::size_t i = 0; i < table->size(); i++) {
+      std::string_view value = table->getString(table->valueIndex[i]);
+      payrollCount += value == "PAYROLL";
+      unsigned long long cents;
+      bool negative;
+      if (parseAmountToken(value, cents, negative) > 0) {
+        long long amount = negative ? -static_cast<long long>(cents)
+                                    : static_cast<long long>(cents);
+        amountCount += amount >= minimum && amount <= maximum;
+      }
+    }
+  }
+  hitList.clear();
+  index.findTerm("payroll,", 0, hitList);
+  if (hitList.size() != payrollCount) {
+    report.fail("index", prefix + " found " + std::to_string(hitList.size()) +
+                             " of " + std::to_string(payrollCount) +
+                             " PAYROLL");
+  }
+  hitList.clear();
+  index.findAmounts(minimum, maximum, 0, hitList);
+  bool sorted = true;
+  for (std::size_t i = 1; i < hitList.size(); i++) {
+    sorted = sorted && hitList[i - 1].amount <= hitList[i].amount;
+  }
+  if (hitList.size() != amountCount || !sorted) {
+    report.fail("index", prefix + " found " + std::to_string(hitList.size()) +
+                             " of " + std::to_string(amountCount) +
+                             " amounts in range");
+  }
+}
+
+} // namespace
+
+/* Word index of recognized statements
+ * add: pages indexed in memory, merge: written to a segment
+ * queries: rare and common terms, a prefix and amount ranges, in memory
+ * and on the mapped segment of the next session
+ */
+void runIndexBench(BenchReport &report, const BenchOptions &options) {
+  unsigned int pageCount = options.quick ? 300 : 3000;
+  std::vector<std::shared_ptr<HocrWordTable>> tableList;
+  std::size_t wordCount = 0;
+  for (unsigned int i = 0; i < pageCount; i++) {
+    tableList.push_back(makeStatementTable(50, i + 1));
+    wordCount += tableList.back()->size();
+  }
+  std::vector<std::pair<std::string, double>> params = {
+      {"pages", pageCount}, {"words", static_cast<double>(wordCount)}};
+  {
+    WordIndex index;
+    BenchTimer timer;
+    for (unsigned int i = 0; i < pageCount; i++) {
+      index.addPage(getDocumentPath(i), i % pagesPerDocument, *tableList[i]);
+    }
+    report.add("index", "memory/add", "words/s", wordCount / timer.seconds(),
+               params);
+    report.add("index", "memory/terms", "terms",
+               static_cast<double>(index.getTermCount()), params);
+    runIndexQueries(report, "memory", index, tableList);
+    // a page recognized again keeps only its new words
+    std::shared_ptr<HocrWordTable> oldTable = tableList[0];
+    tableList[0] = makeStatementTable(50, pageCount + 1);
+    index.addPage(getDocumentPath(0), 0, *tableList[0]);
+    std::vector<WordHit> hitList;
+    index.findTerm("statement", 0, hitList);
+    if (hitList.size() != pageCount) {
+      report.fail("index", "replaced page left " +
+                               std::to_string(hitList.size()) + " hits of " +
+                               std::to_string(pageCount) + " pages");
+    }
+    tableList[0] = oldTable;
+  }
+  boost::filesystem::path directory =
+      boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path("bookfiler-index-bench-%%%%%%%%");
+  boost::filesystem::create_directories(directory);
+  RecognizeSettings settings;
+  settings.cacheEnabled = true;
+  settings.indexEnabled = true;
+  settings.cachePath = directory.string();
+  // one merge at the end
+  settings.indexFlushWords = wordCount + 1;
+  {
+    WordIndex index;
+    index.configure(settings);
+    for (unsigned int i = 0; i < pageCount; i++) {
+      index.addPage(getDocumentPath(i), i % pagesPerDocument, *tableList[i]);
+    }
+    BenchTimer timer;
+    if (!index.flush()) {
+      report.fail("index", "segment not written");
+    }
+    report.add("index", "segment/merge", "words/s",
+               wordCount / timer.seconds(), params);
+  }
+  boost::system::error_code ec;
+  unsigned long long segmentBytes =
+      boost::filesystem::file_size(directory / "wordIndex", ec);
+  report.add("index", "segment/bytesPerWord", "bytes",
+             static_cast<double>(segmentBytes) / wordCount, params);
+  {
+    // the next session maps the segment
+    WordIndex index;
+    index.configure(settings);
+    BenchTimer timer;
+    unsigned long long indexedWords = index.getWordCount();
+    report.add("index", "segment/open", "us", timer.seconds() * 1e6, params);
+    if (indexedWords != wordCount) {
+      report.fail("index", "segment holds " + std::to_string(indexedWords) +
+                               " of " + std::to_string(wordCount) + " words");
+    }
+    runIndexQueries(report, "segment", index, tableList);
+    // pages found again the same are not indexed twice
+    for (unsigned int i = 0; i < pageCount; i++) {
+      index.addPage(getDocumentPath(i), i % pagesPerDocument, *tableList[i]);
+    }
+    if (index.getWordCount() != wordCount) {
+      report.fail("index", "unchanged pages were indexed again");
+    }
+  }
+  boost::filesystem::remove_all(directory, ec);
+}
+
+} // namespace bench
+} // namespace bookfiler
@@ -0,0 +1,265 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief deterministic OCR and PDF modules for the benchmarks.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_BENCH_MOCK_OCR_H
+#define BOOKFILER_MODULE_RECOGNIZE_BENCH_MOCK_OCR_H
+
+// c++17
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Local Project
+#include "Interface.hpp"
+#include "syntheticHocr.hpp"
+
+namespace bookfiler {
+namespace bench {
+
+/* Pixmap owning its pixels
+ * Lines of dark word boxes laid out from the seed, so every page has ink and
+ * pages of different seeds do not look alike to the duplicate check.
+ */
+class MockPixmap : public Pixmap {
+public:
+  // size of a rendered or opened page
+  static constexpr long pageWidth = 256, pageHeight = 330;
+  std::vector<unsigned char> storage;
+  MockPixmap(long width_, long height_, std::size_t seed = 0) {
+    width = width_;
+    height = height_;
+    bitsPerPixel = 8;
+    samplesPerPixel = 1;
+    informat = 0;
+    widthBytes = width_;
+    storage.assign(static_cast<std::size_t>(width_ * height_), 255);
+    data = storage.data();
+    dataUINT = nullptr;
+    unsigned long long state = seed * 2654435761ULL + 1;
+    auto next = [&state](unsigned int range) {
+      state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+      return static_cast<long>((state >> 33) % range);
+    };
+    for (long y = height_ / 20; y + 6 < height_ * 19 / 20; y += 12) {
+      for (long x = width_ / 16 + next(8); x < width_ * 15 / 16;) {
+        long wordWidth = 8 + next(32);
+        for (long row = y; row < y + 6; row++) {
+          std::fill(storage.begin() + row * width_ + x,
+                    storage.begin() + row * width_ +
+                        std::min(x + wordWidth, width_ * 15 / 16),
+                    0);
+        }
+        x += wordWidth + 4 + next(6);
+      }
+    }
+  }
+};
+
+/* Ocr returning the same generated hOCR for every image after sleeping for
+ * the configured latency. The latency is for a whole page and shrinks with
+ * the pixels recognized, as it does in a real engine.
+ */
+class MockOcr : public Ocr, public std::enable_shared_from_this<MockOcr> {
+public:
+  std::shared_ptr<const std::string> hocr;
+  std::chrono::microseconds latency, setupLatency;
+  std::shared_ptr<Pixmap> pixmap;
+  std::function<void(std::shared_ptr<Ocr>)> doneCallback;
+  // every silentEvery-th recognize of the module never calls back
+  std::shared_ptr<std::atomic<unsigned long long>> recognizeCount;
+  unsigned int silentEvery = 0;
+  // recognize on a thread of the engine and return at once
+  bool async = false;
+
+  MockOcr(std::shared_ptr<const std::string> hocr_,
+          std::chrono::microseconds latency_,
+          std::chrono::microseconds setupLatency_)
+      : hocr(hocr_), latency(latency_), setupLatency(setupLatency_){};
+  bool openImageFile(std::string filePath) {
+    pixmap = std::make_shared<MockPixmap>(MockPixmap::pageWidth,
+                                          MockPixmap::pageHeight,
+                                          std::hash<std::string>()(filePath));
+    return true;
+  }
+  bool openImagePixmap(unsigned char *, long width, long height, long) {
+    pixmap = std::make_shared<MockPixmap>(width, height);
+    return true;
+  }
+  bool openImagePixmapPtr(std::shared_ptr<Pixmap> pixmap_) {
+    pixmap = pixmap_;
+    return pixmap != nullptr;
+  }
+  std::shared_ptr<Pixmap> getPixmap() { return pixmap; }
+  void recognize() {
+    if (async) {
+      std::shared_ptr<MockOcr> self = shared_from_this();
+      std::thread([self]() { self->recognizeNow(); }).detach();
+      return;
+    }
+    recognizeNow();
+  }
+  void recognizeNow() {
+    if (latency.count() > 0) {
+      const double pageArea =
+          static_cast<double>(MockPixmap::pageWidth) * MockPixmap::pageHeight;
+      double area = pixmap ? static_cast<double>(pixmap->width) *
+                                 pixmap->height / pageArea
+                           : 1.0;
+      std::this_thread::sleep_for(std::chrono::microseconds(
+          static_cast<long long>(latency.count() * area)));
+    }
+    // an engine that failed and says nothing
+    if (silentEvery > 0 && ++*recognizeCount % silentEvery == 0) {
+      return;
+    }
+    if (doneCallback) {
+      doneCallback(shared_from_this());
+    }
+  }
+  void onRecognizeDone(std::function<void(std::shared_ptr<Ocr>)> callback) {
+    doneCallback = callback;
+  }
+  std::shared_ptr<OcrMonitor> getRecognizeMonitor() { return nullptr; }
+  std::shared_ptr<OcrMonitor> getHocrMonitor() { return nullptr; }
+  void setMode(std::string) {}
+  void setType(std::string) {}
+  // loads the traineddata in a real engine
+  void setLanguage(std::vector<std::string>) {
+    if (setupLatency.count() > 0) {
+      std::this_thread::sleep_for(setupLatency);
+    }
+  }
+  void setDataPath(std::string) {}
+  void setHttpInterface(std::shared_ptr<Http>) {}
+  void installMode(std::string) {}
+  void installType(std::string) {}
+  void installLanguage(std::vector<std::string>) {}
+  std::string getHocr() { return *hocr; }
+};
+
+class MockOcrInterface : public OcrInterface {
+public:
+  std::shared_ptr<const std::string> hocr;
+  std::chrono::microseconds latency, setupLatency;
+  std::atomic<unsigned long long> ocrCount;
+  // see MockOcr::silentEvery, 0 for engines that always call back
+  unsigned int silentEvery = 0;
+  std::shared_ptr<std::atomic<unsigned long long>> recognizeCount;
+  // see MockOcr::async
+  bool async = false;
+
+  /* @param config this corpus is returned for every image, several pages
+   * like a multi-page TIFF
+   * @param latency_ time spent in recognize()
+   * @param setupLatency_ time spent in setLanguage()
+   */
+  MockOcrInterface(HocrCorpusConfig config,
+                   std::chrono::microseconds latency_,
+                   std::chrono::microseconds setupLatency_ =
+                       std::chrono::microseconds(0))
+      : latency(latency_), setupLatency(setupLatency_), ocrCount(0),
+        recognizeCount(std::make_shared<std::atomic<unsigned long long>>(0)) {
+    hocr = std::make_shared<const std::string>(generateHocr(config));
+  }
+  void init() {}
+  void registerSettings(
+      std::shared_ptr<rapidjson::Document>,
+      std::shared_ptr<std::unordered_map<
+          std::string,
+          std::function<void(std::shared_ptr<rapidjson::Document>)>>>) {}
+  void setSettings(std::shared_ptr<rapidjson::Value>) {}
+  std::shared_ptr<Ocr> newOcr() {
+    ocrCount++;
+    std::shared_ptr<MockOcr> ocr =
+        std::make_shared<MockOcr>(hocr, latency, setupLatency);
+    ocr->recognizeCount = recognizeCount;
+    ocr->silentEvery = silentEvery;
+    ocr->async = async;
+    return ocr;
+  }
+};
+
+/* Pdf with a fixed number of pages, rendering sleeps for the configured
+ * latency
+ */
+class MockPdf : public Pdf {
+public:
+  int pagesTotal;
+  std::chrono::microseconds latency;
+  std::vector<std::shared_ptr<Pixmap>> pixmapList;
+  // pages of different files look different
+  std::size_t fileSeed = 0;
+  // every file has the pages of the same document
+  bool sameDocument = false;
+  // this page never renders, -1 for none
+  int failPage = -1;
+
+  MockPdf(int pagesTotal_, std::chrono::microseconds latency_)
+      : pagesTotal(pagesTotal_), latency(latency_),
+        pixmapList(static_cast<std::size_t>(pagesTotal_)){};
+  void openFile(std::string filePath) {
+    fileSeed = sameDocument ? 0 : std::hash<std::string>()(filePath);
+  }
+  int getPagesTotal() { return pagesTotal; }
+  void render(int pageNum) {
+    if (pageNum < 0 || pageNum >= pagesTotal || pageNum == failPage) {
+      return;
+    }
+    if (latency.count() > 0) {
+      std::this_thread::sleep_for(latency);
+    }
+    pixmapList[pageNum] = std::make_shared<MockPixmap>(
+        MockPixmap::pageWidth, MockPixmap::pageHeight,
+        fileSeed + static_cast<std::size_t>(pageNum) * 7919);
+  }
+  std::shared_ptr<PdfMonitor> getRenderMonitor() { return nullptr; }
+  std::shared_ptr<Pixmap> getPixmap(int pageNum) {
+    if (pageNum < 0 || pageNum >= pagesTotal) {
+      return nullptr;
+    }
+    // handed to the pipeline, the document does not keep it
+    return std::move(pixmapList[pageNum]);
+  }
+};
+
+class MockPdfInterface : public PdfInterface {
+public:
+  int pagesTotal;
+  std::chrono::microseconds latency;
+  // see MockPdf::sameDocument and MockPdf::failPage
+  bool sameDocument = false;
+  int failPage = -1;
+
+  MockPdfInterface(int pagesTotal_, std::chrono::microseconds latency_)
+      : pagesTotal(pagesTotal_), latency(latency_){};
+  void init() {}
+  void registerSettings(
+      std::shared_ptr<rapidjson::Document>,
+      std::shared_ptr<std::unordered_map<
+          std::string,
+          std::function<void(std::shared_ptr<rapidjson::Document>)>>>) {}
+  void setSettings(std::shared_ptr<rapidjson::Value>) {}
+  std::shared_ptr<Pdf> newPdf() {
+    std::shared_ptr<MockPdf> pdf =
+        std::make_shared<MockPdf>(pagesTotal, latency);
+    pdf->sameDocument = sameDocument;
+    pdf->failPage = failPage;
+    return pdf;
+  }
+};
+
+} // namespace bench
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_BENCH_MOCK_OCR_H
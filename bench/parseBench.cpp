@@ -0,0 +1,285 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief hOCR parsing benchmark.
+ */
+
+// c++17
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/* boost 1.72.0
+ * License: Boost Software License (similar to BSD and MIT)
+ */
+#include <boost/iostreams/stream.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/xml_parser.hpp>
+
+// Local Project
+#include "benchUtil.hpp"
+#include "core/hocrParser.hpp"
+#include "core/recognizeModel.hpp"
+#include "core/recognizeScheduler.hpp"
+#include "syntheticHocr.hpp"
+
+namespace bookfiler {
+namespace bench {
+
+namespace {
+
+/* @return the words of the table that differ from the tree traversal, by
+ * id since the traversal finds them in reverse order. Empty if the text,
+ * id, bbox and confidence of every word are the same.
+ */
+std::string
+diffTreeWords(const std::vector<std::shared_ptr<HocrWord>> &treeList,
+              const HocrWordTable &table) {
+  std::unordered_map<std::string, std::shared_ptr<HocrWord>> treeMap;
+  for (const std::shared_ptr<HocrWord> &wordPtr : treeList) {
+    treeMap[wordPtr->id] = wordPtr;
+  }
+  std::size_t mismatch = 0;
+  std::string first;
+  for (HocrWordRef word : table.view()) {
+    auto it = treeMap.find(std::string(word.id()));
+    if (it != treeMap.end() && it->second->value == word.value() &&
+        it->second->x0 == word.x0() && it->second->y0 == word.y0() &&
+        it->second->x1 == word.x1() && it->second->y1 == word.y1() &&
+        it->second->confidence == word.confidence()) {
+      continue;
+    }
+    if (mismatch++ == 0) {
+      first = std::string(word.id()) + " \"" + std::string(word.value()) +
+              "\"";
+      if (it != treeMap.end()) {
+        first += " for \"" + it->second->value + "\"";
+      }
+    }
+  }
+  if (treeList.size() != table.size()) {
+    return std::to_string(table.size()) + " words for " +
+           std::to_string(treeList.size());
+  }
+  if (mismatch) {
+    return std::to_string(mismatch) + " words differ, first " + first;
+  }
+  return std::string();
+}
+
+std::shared_ptr<std::vector<std::shared_ptr<HocrWord>>>
+parseTree(RecognizeModelInternal &model, const std::string &hocr) {
+  boost::property_tree::ptree hocrTree;
+  boost::iostreams::stream<boost::iostreams::array_source> stream(
+      hocr.c_str(), hocr.size());
+  boost::property_tree::read_xml(stream, hocrTree);
+  return model.toHocrWordListTree(hocrTree);
+}
+
+/* Markup the corpus never has, each case a page of one word the two
+ * parsers must read the same
+ */
+void runParserEdgeCases(BenchReport &report, RecognizeModelInternal &model) {
+  const std::vector<std::pair<std::string, std::string>> caseList = {
+      {"entities", "<span class='ocrx_word' id='word_1' title='bbox 10 20 "
+                   "90 50; x_wconf 91'>AT&amp;T &lt;5&gt; &quot;Q&quot; "
+                   "&apos;s &#36;12 &#x41;</span>"},
+      {"entityInId", "<span class='ocrx_word' id='word_&amp;1' title='bbox "
+                     "10 20 90 50; x_wconf 91'>id</span>"},
+      {"cdata", "<span class='ocrx_word' id='word_1' title='bbox 10 20 90 "
+                "50; x_wconf 91'><![CDATA[a<b> & c]]></span>"},
+      {"quotedGreater", "<span class='ocrx_word' id='word_1' lang='a>b' "
+                        "title='bbox 10 20 90 50; x_wconf 91'>1>0</span>"},
+      {"doubleQuotedGreater", "<span class=\"ocrx_word\" id=\"word_1\" "
+                              "data-x=\"</span>\" title=\"bbox 10 20 90 "
+                              "50; x_wconf 91\">word</span>"},
+      {"comment", "<span class='ocrx_word' id='word_1' title='bbox 10 20 90 "
+                  "50; x_wconf 91'>wo<!-- <span> -->rd</span>"},
+      {"nested", "<span class='ocrx_word' id='word_1' title='bbox 10 20 90 "
+                 "50; x_wconf 91'><strong>bold</strong></span>"}};
+  for (const std::pair<std::string, std::string> &edgeCase : caseList) {
+    std::string hocr = "<body><div class='ocr_page' id='page_1' "
+                       "title='bbox 0 0 100 100'><span class='ocr_line' "
+                       "id='line_1' title='bbox 10 20 90 50'>" +
+                       edgeCase.second + "</span></div></body>";
+    std::string error;
+    try {
+      std::shared_ptr<HocrWordTable> table = hocrWordTableFromString(hocr);
+      error = table->size() == 1 ? diffTreeWords(*parseTree(model, hocr),
+                                                 *table)
+                                 : std::to_string(table->size()) + " words";
+    } catch (const std::exception &e) {
+      error = std::string("read_xml failed, ") + e.what();
+    }
+    if (!error.empty()) {
+      report.fail("parse", "treeEquivalence/" + edgeCase.first + " " + error);
+    }
+  }
+}
+
+} // namespace
+
+/* read_xml with the tree traversal against the streaming parser, both
+ * into the word list and into the word table. The words found must be the
+ * same down to the geometry, on the corpus and on the edge cases above.
+ * The tree traversal copies subtrees and grows quadratically, it runs once
+ * and only on single pages.
+ * Documents of several pages are also cut at the pages and parsed on a
+ * worker pool.
+ */
+void runParseBench(BenchReport &report, const BenchOptions &options) {
+  std::vector<HocrCorpusConfig> configList(4);
+  configList[0].lines = 40;
+  configList[1].lines = 60;
+  configList[1].words = 12;
+  configList[2].lines = 60;
+  configList[2].words = 12;
+  configList[2].noise = 10;
+  configList[3].pages = options.quick ? 4 : 20;
+  configList[3].lines = 60;
+  configList[3].words = 10;
+  // only used for the tree traversal
+  RecognizeModelInternal model(nullptr, nullptr, nullptr, nullptr);
+  for (const HocrCorpusConfig &config : configList) {
+    std::string hocr = generateHocr(config);
+    std::string name = std::to_string(config.pages) + "x" +
+                       std::to_string(config.lines) + "x" +
+                       std::to_string(config.words) + "/noise" +
+                       std::to_string(config.noise);
+    std::vector<std::pair<std::string, double>> params = {
+        {"pages", config.pages},
+        {"lines", config.lines},
+        {"words", config.words},
+        {"noise", config.noise},
+        {"bytes", static_cast<double>(hocr.size())}};
+    // about 64MB of hOCR through each streaming path, 8MB when quick
+    std::size_t totalBytes = (options.quick ? 8u : 64u) << 20;
+    unsigned int repeat = static_cast<unsigned int>(
+        std::max<std::size_t>(1, totalBytes / hocr.size()));
+    double megabytes = hocr.size() / 1e6;
+
+    std::shared_ptr<std::vector<std::shared_ptr<HocrWord>>> treeList;
+    if (config.pages == 1) {
+      BenchTimer treeTimer;
+      treeList = parseTree(model, hocr);
+      report.add("parse", name + "/read_xml+tree", "MB/s",
+                 megabytes / treeTimer.seconds(), params);
+    }
+
+    std::shared_ptr<std::vector<std::shared_ptr<HocrWord>>> streamList;
+    BenchTimer listTimer;
+    for (unsigned int i = 0; i < repeat; i++) {
+      streamList = hocrWordListFromString(hocr);
+    }
+    double listSeconds = listTimer.seconds() / repeat;
+
+    std::shared_ptr<HocrWordTable> table;
+    BenchTimer tableTimer;
+    for (unsigned int i = 0; i < repeat; i++) {
+      table = hocrWordTableFromString(hocr);
+    }
+    double tableSeconds = tableTimer.seconds() / repeat;
+
+    /* Same table with a callback on every line, as recognizeDone does when
+     * wordBatchUpdateSignal has a slot. The first line is what a viewer
+     * waits for before it can draw anything.
+     */
+    std::size_t lineCount = 0;
+    double firstLineSeconds = 0;
+    BenchTimer streamTimer;
+    for (unsigned int i = 0; i < repeat; i++) {
+      BenchTimer firstTimer;
+      bool first = true;
+      table = hocrWordTableFromString(
+          hocr, HocrEvent::lineEnd,
+          [&](const HocrWordTable &, std::size_t, std::size_t, HocrEvent) {
+            if (first) {
+              firstLineSeconds += firstTimer.seconds();
+              first = false;
+            }
+            lineCount++;
+          });
+    }
+    double streamSeconds = streamTimer.seconds() / repeat;
+    if (lineCount != repeat * (config.pages * config.lines + 1)) {
+      report.fail("parse", name + " line events do not match the corpus");
+    }
+
+    report.add("parse", name + "/wordList", "MB/s", megabytes / listSeconds,
+               params);
+    report.add("parse", name + "/wordTable", "MB/s", megabytes / tableSeconds,
+               params);
+    report.add("parse", name + "/wordTable", "words/s",
+               table->size() / tableSeconds, params);
+    report.add("parse", name + "/wordTable+lines", "MB/s",
+               megabytes / streamSeconds, params);
+    report.add("parse", name + "/firstLine", "us",
+               firstLineSeconds * 1e6 / repeat, params);
+    report.add("parse", name + "/wholeDocument", "us", tableSeconds * 1e6,
+               params);
+
+    /* The pages parsed on their own on every core, as recognizeDone does
+     * with a multi-page TIFF. Joined in page order they are the same words
+     * and lines as the serial table.
+     */
+    if (config.pages > 1) {
+      RecognizeScheduler scheduler;
+      std::shared_ptr<SchedulerClient> client =
+          scheduler.addClient(0, nullptr);
+      std::vector<std::shared_ptr<HocrWordTable>> pageTableList;
+      BenchTimer pagesTimer;
+      for (unsigned int i = 0; i < repeat; i++) {
+        std::vector<std::string_view> pageList = splitHocrPages(hocr);
+        pageTableList.assign(pageList.size(), nullptr);
+        scheduler.forEach(
+            *client, pageList.size(),
+            [&](std::size_t page) {
+              pageTableList[page] = hocrWordTableFromString(pageList[page]);
+            },
+            0);
+      }
+      double pagesSeconds = pagesTimer.seconds() / repeat;
+      std::vector<std::pair<std::string, double>> pagesParams = params;
+      pagesParams.push_back({"threads", scheduler.getThreadCount()});
+      report.add("parse", name + "/wordTable/pagesParallel", "MB/s",
+                 megabytes / pagesSeconds, pagesParams);
+      report.add("parse", name + "/wordTable/pagesParallel/speedup", "x",
+                 tableSeconds / pagesSeconds, pagesParams);
+      HocrWordTable joined;
+      for (std::shared_ptr<HocrWordTable> &pageTable : pageTableList) {
+        joined.append(*pageTable, 0, pageTable->size());
+        joined.pageEnd.push_back(static_cast<unsigned int>(joined.size()));
+      }
+      bool same = pageTableList.size() == config.pages &&
+                  joined.size() == table->size() &&
+                  joined.lineEnd == table->lineEnd;
+      for (std::size_t i = 0; same && i < joined.size(); i++) {
+        same = joined[i].value() == (*table)[i].value() &&
+               joined[i].id() == (*table)[i].id() &&
+               joined[i].x0() == (*table)[i].x0() &&
+               joined[i].y1() == (*table)[i].y1();
+      }
+      if (!same) {
+        report.fail("parse", name + " pages parsed apart differ from the "
+                                    "whole document");
+      }
+    }
+
+    if (streamList->size() != table->size()) {
+      report.fail("parse", name + " word list and word table differ");
+    }
+    if (treeList) {
+      std::string error = diffTreeWords(*treeList, *table);
+      if (!error.empty()) {
+        report.fail("parse", name + " tree parser: " + error);
+      }
+    }
+  }
+  runParserEdgeCases(report, model);
+}
+
+} // namespace bench
+} // namespace bookfiler
@@ -0,0 +1,402 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief payee matching benchmark.
+ */
+
+// c++17
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Local Project
+#include "benchUtil.hpp"
+#include "core/payeeMatcher.hpp"
+#include "core/recognizeScheduler.hpp"
+#include "syntheticStatement.hpp"
+
+namespace bookfiler {
+namespace bench {
+
+namespace {
+
+/* Payee names of one to three made up words, some with a business suffix
+ * or a store number, every name different
+ * @param foreign names of payees not in the catalog, their syllables start
+ * with letters no catalog name starts one with, so they are no misread of
+ * a catalog name
+ */
+std::vector<std::string> makePayeeCatalog(std::size_t payeeCount,
+                                          unsigned int seed, bool foreign) {
+  static const char *catalogOnsetList[] = {
+      "B",  "C",  "D",  "F",  "G",  "H",  "K",  "L",  "M",
+      "N",  "P",  "R",  "S",  "T",  "V",  "W",  "BR", "CH",
+      "CL", "DR", "GR", "PL", "ST", "TR", "SH", "TH"};
+  static const char *foreignOnsetList[] = {"J", "X", "Y", "QU", "KW", "ZH"};
+  const char *const *onsetList = foreign ? foreignOnsetList : catalogOnsetList;
+  const unsigned int onsetCount =
+      foreign ? sizeof(foreignOnsetList) / sizeof(char *)
+              : sizeof(catalogOnsetList) / sizeof(char *);
+  static const char *vowelList[] = {"A", "E", "I", "O", "U", "AI", "EE", "OU"};
+  static const char *suffixList[] = {"INC",    "LLC",   "CO",      "MARKET",
+                                     "COFFEE", "FOODS", "SERVICE", "STORE",
+                                     "PHARMACY", "GAS"};
+  BenchRandom random(seed);
+  auto makeWord = [&]() {
+    std::string word;
+    unsigned int syllables = 2 + random.next(2);
+    for (unsigned int i = 0; i < syllables; i++) {
+      word += onsetList[random.next(onsetCount)];
+      word += vowelList[random.next(sizeof(vowelList) / sizeof(char *))];
+    }
+    if (random.next(2)) {
+      word += onsetList[random.next(std::min(onsetCount, 12u))];
+    }
+    return word;
+  };
+  std::vector<std::string> catalog;
+  std::unordered_set<std::string> nameSet;
+  while (catalog.size() < payeeCount) {
+    std::string name = makeWord();
+    unsigned int words = random.next(3);
+    for (unsigned int i = 0; i < words; i++) {
+      name += ' ' + makeWord();
+    }
+    if (random.next(3) == 0) {
+      name += ' ';
+      name += suffixList[random.next(sizeof(suffixList) / sizeof(char *))];
+    }
+    if (random.next(4) == 0) {
+      name += " #" + std::to_string(100 + random.next(9900));
+    }
+    if (nameSet.insert(name).second) {
+      catalog.push_back(name);
+    }
+  }
+  return catalog;
+}
+
+/* Names of payees not in the catalog, from the generator of the catalog so
+ * only their distance tells them apart, none within minEdits edits of a
+ * catalog name found anywhere in it. One in four is foreign, see
+ * makePayeeCatalog.
+ */
+std::vector<std::string>
+makeUnknownList(const std::vector<std::string> &catalog, std::size_t count,
+                unsigned int seed, unsigned int minEdits) {
+  // folded with a space on each side, as the matcher lines them up
+  const char space = foldPayeeText("A A")[1];
+  auto pad = [space](const std::string &name) {
+    return space + foldPayeeText(name) + space;
+  };
+  auto addGrams = [](const std::string &folded,
+                     std::vector<unsigned int> &gramList) {
+    gramList.clear();
+    for (std::size_t i = 0; i + 2 < folded.size(); i++) {
+      gramList.push_back(
+          (static_cast<unsigned int>(folded[i]) * payeeSymbolCount +
+           static_cast<unsigned int>(folded[i + 1])) *
+              payeeSymbolCount +
+          static_cast<unsigned int>(folded[i + 2]));
+    }
+    std::sort(gramList.begin(), gramList.end());
+    gramList.erase(std::unique(gramList.begin(), gramList.end()),
+                   gramList.end());
+  };
+  /* a name within minEdits - 1 edits keeps all but 3 per edit of its
+   * distinct trigrams (q-gram lemma), only those are searched
+   */
+  std::vector<std::string> foldedCatalog;
+  std::vector<unsigned int> neededList, alwaysList, gramList;
+  std::unordered_map<unsigned int, std::vector<unsigned int>> gramMap;
+  for (std::size_t i = 0; i < catalog.size(); i++) {
+    foldedCatalog.push_back(pad(catalog[i]));
+    addGrams(foldedCatalog.back(), gramList);
+    int needed = static_cast<int>(gramList.size()) -
+                 3 * static_cast<int>(minEdits - 1);
+    neededList.push_back(static_cast<unsigned int>(std::max(needed, 0)));
+    if (needed <= 0) {
+      alwaysList.push_back(static_cast<unsigned int>(i));
+    }
+    for (unsigned int gram : gramList) {
+      gramMap[gram].push_back(static_cast<unsigned int>(i));
+    }
+  }
+  std::vector<unsigned int> sharedList(catalog.size(), 0);
+  std::vector<unsigned int> touchedList;
+  auto isFar = [&](const std::string &name) {
+    std::string text = pad(name);
+    addGrams(text, gramList);
+    touchedList.clear();
+    for (unsigned int gram : gramList) {
+      auto it = gramMap.find(gram);
+      if (it == gramMap.end()) {
+        continue;
+      }
+      for (unsigned int payee : it->second) {
+        if (sharedList[payee]++ == 0) {
+          touchedList.push_back(payee);
+        }
+      }
+    }
+    bool far = true;
+    for (unsigned int payee : touchedList) {
+      if (far && neededList[payee] > 0 &&
+          sharedList[payee] >= neededList[payee]) {
+        far = payeeSearchDistance(foldedCatalog[payee], text) >= minEdits;
+      }
+      sharedList[payee] = 0;
+    }
+    for (std::size_t i = 0; far && i < alwaysList.size(); i++) {
+      far = payeeSearchDistance(foldedCatalog[alwaysList[i]], text) >=
+            minEdits;
+    }
+    return far;
+  };
+  std::vector<std::string> unknownList =
+      makePayeeCatalog(count / 4, seed + 1, true);
+  for (unsigned int round = 0; unknownList.size() < count; round++) {
+    for (const std::string &name :
+         makePayeeCatalog(count, seed + 100 * round, false)) {
+      if (unknownList.size() < count && isFar(name)) {
+        unknownList.push_back(name);
+      }
+    }
+  }
+  return unknownList;
+}
+
+/* The payee as OCR reads it, with at most one edit in eight characters
+ * and any number of confused characters
+ */
+std::string makeNoisyPayee(const std::string &payee, BenchRandom &random) {
+  static const std::string confusedFrom = "OISBZGL01582";
+  static const std::string confusedTo = "015826|OLSBZ";
+  std::size_t editsLeft = payee.size() / 8;
+  std::string noisy;
+  for (char c : payee) {
+    std::size_t confused = confusedFrom.find(c);
+    unsigned int roll = random.next(100);
+    if (confused != std::string::npos && roll < 15) {
+      noisy += confusedTo[confused];
+    } else if (editsLeft > 0 && c != ' ' && roll < 20) {
+      editsLeft--;
+      switch (random.next(3)) {
+      case 0:
+        // dropped
+        break;
+      case 1:
+        noisy += static_cast<char>('A' + random.next(26));
+        break;
+      default:
+        noisy += c;
+        noisy += static_cast<char>('A' + random.next(26));
+      }
+    } else {
+      noisy += c;
+    }
+  }
+  return noisy;
+}
+
+/* Statement descriptions around noisy payees, truthList holds the catalog
+ * index of each or PayeeMatch::none for the payees not in the catalog
+ */
+void makeDescriptionList(const std::vector<std::string> &catalog,
+                         const std::vector<std::string> &unknownList,
+                         std::size_t rowCount, unsigned int seed,
+                         std::vector<std::string> &descriptionList,
+                         std::vector<unsigned int> &truthList) {
+  static const char *prefixList[] = {"POS PURCHASE ", "DEBIT CARD ", "ACH ",
+                                     "", "CHECKCARD "};
+  BenchRandom random(seed);
+  char buffer[64];
+  for (std::size_t i = 0; i < rowCount; i++) {
+    unsigned int truth = PayeeMatch::none;
+    const std::string *payee;
+    if (random.next(10) == 0) {
+      payee = &unknownList[random.next(
+          static_cast<unsigned int>(unknownList.size()))];
+    } else {
+      truth = random.next(static_cast<unsigned int>(catalog.size()));
+      payee = &catalog[truth];
+    }
+    std::snprintf(buffer, sizeof(buffer), " %02u/%02u REF%06u",
+                  1 + random.next(12), 1 + random.next(28),
+                  random.next(1000000));
+    descriptionList.push_back(prefixList[random.next(5)] +
+                              makeNoisyPayee(*payee, random) + buffer);
+    truthList.push_back(truth);
+  }
+}
+
+/* Edit distance of pattern anywhere in text, one cell at a time, what the
+ * matcher is compared with
+ */
+unsigned int naiveSearchDistance(const std::string &pattern,
+                                 const std::string &text,
+                                 std::vector<unsigned int> &column) {
+  column.resize(pattern.size() + 1);
+  for (std::size_t i = 0; i <= pattern.size(); i++) {
+    column[i] = static_cast<unsigned int>(i);
+  }
+  unsigned int best = column[pattern.size()];
+  for (char c : text) {
+    unsigned int diagonal = column[0];
+    for (std::size_t i = 1; i <= pattern.size(); i++) {
+      unsigned int above = column[i];
+      column[i] = std::min({column[i] + 1, column[i - 1] + 1,
+                            diagonal + (pattern[i - 1] == c ? 0u : 1u)});
+      diagonal = above;
+    }
+    best = std::min(best, column[pattern.size()]);
+  }
+  return best;
+}
+
+} // namespace
+
+/* Statement descriptions matched to a catalog of payees
+ * Made up payee names, read with OCR confusions and a few real edits,
+ * between a card prefix and a date and reference. One row in ten has a
+ * payee not in the catalog, at least two edits from every catalog name,
+ * and must match none.
+ * index: the matcher, rows/s, recall and the unknown payees matched, then
+ * chunks of rows on every worker of a scheduler
+ * scan: every payee compared with each row, bit-parallel and cell by cell
+ */
+void runPayeeBench(BenchReport &report, const BenchOptions &options) {
+  std::size_t payeeCount = 50000;
+  std::size_t rowCount = options.quick ? 5000 : 100000;
+  std::vector<std::string> catalog = makePayeeCatalog(payeeCount, 7, false);
+  std::vector<std::string> unknownList = makeUnknownList(catalog, 2000, 13, 2);
+  std::vector<std::string> descriptionList;
+  std::vector<unsigned int> truthList;
+  makeDescriptionList(catalog, unknownList, rowCount, 11, descriptionList,
+                      truthList);
+  std::vector<std::string_view> viewList(descriptionList.begin(),
+                                         descriptionList.end());
+  std::vector<std::pair<std::string, double>> params = {
+      {"payees", static_cast<double>(payeeCount)},
+      {"rows", static_cast<double>(rowCount)}};
+
+  BenchTimer buildTimer;
+  PayeeMatcher matcher(catalog);
+  report.add("payee", "index/build", "ms", buildTimer.seconds() * 1e3,
+             params);
+
+  std::vector<PayeeMatch> matchList;
+  BenchTimer serialTimer;
+  matcher.matchList(viewList, matchList);
+  double serialSeconds = serialTimer.seconds();
+  report.add("payee", "index/serial", "rows/s", rowCount / serialSeconds,
+             params);
+
+  RecognizeScheduler scheduler;
+  std::shared_ptr<SchedulerClient> client = scheduler.addClient(0, nullptr);
+  std::vector<PayeeMatch> parallelMatchList;
+  BenchTimer parallelTimer;
+  matcher.matchList(viewList, parallelMatchList, &scheduler, client.get());
+  double parallelSeconds = parallelTimer.seconds();
+  std::vector<std::pair<std::string, double>> parallelParams = params;
+  parallelParams.push_back({"threads", scheduler.getThreadCount()});
+  double speedup = serialSeconds / parallelSeconds;
+  report.add("payee", "index/parallel", "rows/s", rowCount / parallelSeconds,
+             parallelParams);
+  report.add("payee", "index/parallel/speedup", "x", speedup, parallelParams);
+  if (std::thread::hardware_concurrency() > 1 && speedup < 1) {
+    report.fail("payee", "rows matched on every worker slower than in turn");
+  }
+  for (std::size_t i = 0; i < rowCount; i++) {
+    if (parallelMatchList[i].payeeIndex != matchList[i].payeeIndex ||
+        parallelMatchList[i].distance != matchList[i].distance) {
+      report.fail("payee", "parallel matched row " + std::to_string(i) +
+                               " differently");
+      break;
+    }
+  }
+
+  // the same payee under another name folds to the same symbols
+  std::size_t known = 0, found = 0, wrong = 0, unknown = 0, falseMatch = 0;
+  for (std::size_t i = 0; i < rowCount; i++) {
+    unsigned int result = matchList[i].payeeIndex;
+    if (truthList[i] == PayeeMatch::none) {
+      unknown++;
+      falseMatch += result != PayeeMatch::none;
+      continue;
+    }
+    known++;
+    if (result == PayeeMatch::none) {
+      continue;
+    }
+    if (foldPayeeText(catalog[result]) ==
+        foldPayeeText(catalog[truthList[i]])) {
+      found++;
+    } else {
+      wrong++;
+    }
+  }
+  double recall = static_cast<double>(found) / known;
+  report.add("payee", "index/recall", "ratio", recall, params);
+  report.add("payee", "index/wrong", "ratio",
+             static_cast<double>(wrong) / known, params);
+  double unknownMatched = static_cast<double>(falseMatch) / unknown;
+  report.add("payee", "index/unknownMatched", "ratio", unknownMatched,
+             params);
+  if (recall < 0.95) {
+    report.fail("payee", "recall " + std::to_string(recall));
+  }
+  if (unknownMatched > 0.01) {
+    report.fail("payee", "unknown payees matched " +
+                             std::to_string(unknownMatched));
+  }
+
+  // every payee against each row, a few rows are enough to time it
+  std::vector<std::string> foldedCatalog;
+  foldedCatalog.reserve(catalog.size());
+  for (const std::string &payee : catalog) {
+    foldedCatalog.push_back(foldPayeeText(payee));
+  }
+  std::size_t scanRows = options.quick ? 20 : 100;
+  BenchTimer myersTimer;
+  for (std::size_t i = 0; i < scanRows; i++) {
+    std::string text = foldPayeeText(descriptionList[i]);
+    unsigned int best = UINT32_MAX;
+    for (const std::string &payee : foldedCatalog) {
+      best = std::min(best, payeeSearchDistance(payee, text));
+    }
+    if (matchList[i].payeeIndex != PayeeMatch::none &&
+        best > matchList[i].distance) {
+      report.fail("payee", "scan missed the match of row " + std::to_string(i));
+    }
+  }
+  report.add("payee", "scan/myers", "rows/s", scanRows / myersTimer.seconds(),
+             params);
+  std::vector<unsigned int> column;
+  scanRows = options.quick ? 2 : 10;
+  bool same = true;
+  BenchTimer naiveTimer;
+  for (std::size_t i = 0; i < scanRows; i++) {
+    std::string text = foldPayeeText(descriptionList[i]);
+    for (const std::string &payee : foldedCatalog) {
+      same = naiveSearchDistance(payee, text, column) ==
+                 payeeSearchDistance(payee, text) &&
+             same;
+    }
+  }
+  report.add("payee", "scan/naive", "rows/s", scanRows / naiveTimer.seconds(),
+             params);
+  if (!same) {
+    report.fail("payee", "bit-parallel and cell by cell distances differ");
+  }
+}
+
+} // namespace bench
+} // namespace bookfiler
@@ -0,0 +1,177 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief pixmap buffer pool and page fingerprint benchmark.
+ */
+
+// c++17
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* rapidjson v1.1 (2016-8-25)
+ * Developed by Tencent
+ * License: MITs
+ */
+#include <rapidjson/document.h>
+
+// Local Project
+#include "benchUtil.hpp"
+#include "core/pageFingerprint.hpp"
+#include "core/pixmapPool.hpp"
+#include "mockOcr.hpp"
+
+namespace bookfiler {
+namespace bench {
+
+namespace {
+
+// a letter page at 300 dpi, 24 bit
+const long pageWidth = 2550, pageHeight = 3300, pageBits = 24;
+
+/* @brief Render like a pipeline: fill a page, keep the last depth pages
+ * alive, drop the oldest. A depth of 0 drops each page once filled.
+ * @param allocator null to allocate a new buffer for every page
+ */
+double renderPages(PixmapAllocator *allocator, unsigned int pages,
+                   unsigned int depth) {
+  std::deque<std::shared_ptr<Pixmap>> window;
+  BenchTimer timer;
+  for (unsigned int i = 0; i < pages; i++) {
+    std::shared_ptr<Pixmap> pixmap;
+    if (allocator) {
+      pixmap = allocator->newPixmap(pageWidth, pageHeight, pageBits, 3);
+    } else {
+      // a pooled pixmap without a pool frees its buffer, like a renderer
+      long widthBytes = pageWidth * 3;
+      std::size_t size = static_cast<std::size_t>(widthBytes) * pageHeight;
+      pixmap = std::make_shared<PooledPixmap>(
+          std::unique_ptr<unsigned char[]>(new unsigned char[size]), size,
+          std::weak_ptr<PixmapPool>());
+      pixmap->width = pageWidth;
+      pixmap->height = pageHeight;
+      pixmap->widthBytes = widthBytes;
+    }
+    std::memset(pixmap->data, static_cast<int>(i), pixmap->widthBytes *
+                                                       pixmap->height);
+    window.push_back(pixmap);
+    if (window.size() > depth) {
+      window.pop_front();
+    }
+  }
+  return timer.seconds();
+}
+
+} // namespace
+
+/* 25MB pages through the pool against a fresh buffer per page, then
+ * producers on a budget of two pages, then the fingerprint taken of every
+ * page before OCR
+ */
+void runPixmapBench(BenchReport &report, const BenchOptions &options) {
+  unsigned int pages = options.quick ? 40 : 200;
+  unsigned int depth = 4;
+  std::vector<std::pair<std::string, double>> params = {
+      {"pages", pages},
+      {"depth", depth},
+      {"pageBytes", static_cast<double>(pageWidth * 3 * pageHeight)}};
+
+  double newSeconds = renderPages(nullptr, pages, depth);
+  report.add("pixmap", "render/newBuffer", "pages/s", pages / newSeconds,
+             params);
+
+  std::shared_ptr<PixmapPool> pool = std::make_shared<PixmapPool>();
+  double poolSeconds = renderPages(pool.get(), pages, depth);
+  report.add("pixmap", "render/pool", "pages/s", pages / poolSeconds, params);
+  rapidjson::Document document;
+  rapidjson::Value stats;
+  pool->toJson(stats, document.GetAllocator());
+  report.add("pixmap", "render/pool/hitRate", "ratio",
+             stats["hitRate"].GetDouble(), params);
+  report.add("pixmap", "render/pool/bytesInUsePeak", "bytes",
+             static_cast<double>(stats["bytesInUsePeak"].GetUint64()),
+             params);
+
+  // four producers of one page at a time on a budget of two pages
+  RecognizeSettings settings;
+  settings.pixmapBudgetBytes =
+      2 * PixmapPool::getSizeClass(pageWidth * 3 * pageHeight);
+  std::shared_ptr<PixmapPool> budgetPool = std::make_shared<PixmapPool>();
+  budgetPool->configure(settings);
+  std::vector<std::thread> threadList;
+  BenchTimer budgetTimer;
+  for (unsigned int t = 0; t < 4; t++) {
+    threadList.emplace_back(
+        [&]() { renderPages(budgetPool.get(), pages / 4, 0); });
+  }
+  for (std::thread &thread : threadList) {
+    thread.join();
+  }
+  double budgetSeconds = budgetTimer.seconds();
+  budgetPool->toJson(stats, document.GetAllocator());
+  params.push_back(
+      {"budgetBytes", static_cast<double>(settings.pixmapBudgetBytes)});
+  report.add("pixmap", "budget/4producers", "pages/s", pages / budgetSeconds,
+             params);
+  report.add("pixmap", "budget/bytesInUsePeak", "bytes",
+             static_cast<double>(stats["bytesInUsePeak"].GetUint64()),
+             params);
+  report.add("pixmap", "budget/throttled", "calls",
+             static_cast<double>(stats["throttled"].GetUint64()), params);
+  if (stats["budgetOverruns"].GetUint64() == 0 &&
+      stats["bytesInUsePeak"].GetUint64() > settings.pixmapBudgetBytes) {
+    report.fail("pixmap", "budget exceeded without a timed out wait");
+  }
+
+  // 8 bit grey pages of text, a copy with noise and pages of other text
+  PageSkipOptions skipOptions;
+  unsigned int fingerprintPages = options.quick ? 10 : 50;
+  MockPixmap page(pageWidth, pageHeight, 1);
+  MockPixmap noisyPage = page;
+  noisyPage.data = noisyPage.storage.data();
+  for (std::size_t i = 0; i < noisyPage.storage.size(); i += 37) {
+    noisyPage.storage[i] = static_cast<unsigned char>(255 - page.storage[i]);
+  }
+  PageFingerprint fingerprint, noisyFingerprint;
+  BenchTimer fingerprintTimer;
+  for (unsigned int i = 0; i < fingerprintPages; i++) {
+    computePageFingerprint(page, skipOptions, fingerprint);
+  }
+  double fingerprintSeconds = fingerprintTimer.seconds();
+  computePageFingerprint(noisyPage, skipOptions, noisyFingerprint);
+  std::vector<std::pair<std::string, double>> fingerprintParams = {
+      {"pages", fingerprintPages},
+      {"pageBytes", static_cast<double>(pageWidth * pageHeight)}};
+  report.add("pixmap", "fingerprint", "pages/s",
+             fingerprintPages / fingerprintSeconds, fingerprintParams);
+  PageFingerprintIndex index;
+  for (unsigned int i = 2; i < 10; i++) {
+    MockPixmap otherPage(pageWidth, pageHeight, i);
+    std::shared_ptr<PageFingerprint> otherFingerprint =
+        std::make_shared<PageFingerprint>();
+    computePageFingerprint(otherPage, skipOptions, *otherFingerprint);
+    index.add(otherFingerprint, "other", i);
+  }
+  PageFingerprintIndex::Entry entry;
+  if (index.find(fingerprint, skipOptions.duplicateDistance,
+                 skipOptions.duplicateBitDistance, entry)) {
+    report.fail("pixmap", "a page of other text found as a duplicate");
+  }
+  report.add("pixmap", "fingerprint/noisyCopy/bitDistance", "ratio",
+             getFingerprintBitDistance(fingerprint, noisyFingerprint),
+             fingerprintParams);
+  index.add(std::make_shared<PageFingerprint>(fingerprint), "page", 1);
+  if (!index.find(noisyFingerprint, skipOptions.duplicateDistance,
+                  skipOptions.duplicateBitDistance, entry) ||
+      entry.pageNum != 1) {
+    report.fail("pixmap", "a noisy copy of a page not found as a duplicate");
+  }
+}
+
+} // namespace bench
+} // namespace bookfiler
@@ -0,0 +1,175 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief bank statement row reconstruction benchmark.
+ */
+
+// c++17
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Local Project
+#include "benchUtil.hpp"
+#include "core/bankStatement.hpp"
+#include "core/statementFields.hpp"
+#include "syntheticStatement.hpp"
+
+namespace bookfiler {
+namespace bench {
+
+namespace {
+
+/* Amount and date columns of a statement with rowCount rows
+ * A statement keeps one style: "us" $1,234.56 and (1,234.56) with 01/15,
+ * "eu" 1.234,56 and 1.234,56- with 15.01.2020, "cr" 1234.56 and
+ * 1234.56 CR with Jan 15, 2020. A third of the amounts are negative and one
+ * in a hundred has a zero read as the letter O.
+ */
+void makeFieldColumns(unsigned int rowCount, unsigned int style,
+                      std::vector<std::string> &amountList,
+                      std::vector<std::string> &dateList) {
+  static const char *monthList[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                    "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+  BenchRandom random(rowCount + style);
+  char buffer[64];
+  amountList.resize(rowCount);
+  dateList.resize(rowCount);
+  for (unsigned int i = 0; i < rowCount; i++) {
+    unsigned int whole = random.next(100000), cents = random.next(100);
+    bool negative = random.next(3) == 0;
+    if (style == 0) {
+      std::snprintf(buffer, sizeof(buffer),
+                    negative ? "($%u,%03u.%02u)" : "$%u,%03u.%02u",
+                    whole / 1000, whole % 1000, cents);
+    } else if (style == 1) {
+      std::snprintf(buffer, sizeof(buffer),
+                    negative ? "%u.%03u,%02u-" : "%u.%03u,%02u", whole / 1000,
+                    whole % 1000, cents);
+    } else {
+      std::snprintf(buffer, sizeof(buffer),
+                    negative ? "%u.%02u CR" : "%u.%02u", whole, cents);
+    }
+    if (random.next(100) == 0) {
+      for (char *c = buffer; *c; c++) {
+        if (*c == '0') {
+          *c = 'O';
+          break;
+        }
+      }
+    }
+    amountList[i] = buffer;
+    unsigned int month = 1 + random.next(12), day = 1 + random.next(28);
+    if (style == 0) {
+      std::snprintf(buffer, sizeof(buffer), "%02u/%02u", month, day);
+    } else if (style == 1) {
+      std::snprintf(buffer, sizeof(buffer), "%02u.%02u.2020", day, month);
+    } else {
+      std::snprintf(buffer, sizeof(buffer), "%s %u, 2020",
+                    monthList[month - 1], day);
+    }
+    dateList[i] = buffer;
+  }
+}
+
+/* The amount and date columns of a statement parsed in bulk, the budget
+ * is a millisecond for 10k rows. It is checked on the fastest amount pass
+ * plus the fastest date pass, the mean of a shared machine also counts the
+ * time other work took the core.
+ */
+void runFieldBench(BenchReport &report, const BenchOptions &options) {
+  static const char *styleList[] = {"us", "eu", "cr"};
+  unsigned int rowCount = 10000, repeat = options.quick ? 50 : 200;
+  for (unsigned int style = 0; style < 3; style++) {
+    std::vector<std::string> amountList, dateList;
+    makeFieldColumns(rowCount, style, amountList, dateList);
+    std::vector<std::string_view> amountTokens(amountList.begin(),
+                                               amountList.end()),
+        dateTokens(dateList.begin(), dateList.end());
+    StatementAmountColumn amountColumn;
+    StatementDateColumn dateColumn;
+    StatementFieldOptions fieldOptions;
+    fieldOptions.monthFirst = style != 1;
+    double amountSeconds = 0, dateSeconds = 0;
+    double amountBest = 1e9, dateBest = 1e9;
+    for (unsigned int i = 0; i < repeat; i++) {
+      BenchTimer amountTimer;
+      parseAmountColumn(amountTokens, amountColumn);
+      double amountRepeat = amountTimer.seconds();
+      BenchTimer dateTimer;
+      parseDateColumn(dateTokens, fieldOptions, dateColumn);
+      double dateRepeat = dateTimer.seconds();
+      amountSeconds += amountRepeat / repeat;
+      dateSeconds += dateRepeat / repeat;
+      amountBest = std::min(amountBest, amountRepeat);
+      dateBest = std::min(dateBest, dateRepeat);
+    }
+    double bestSeconds = amountBest + dateBest;
+    std::vector<std::pair<std::string, double>> params = {
+        {"rows", static_cast<double>(rowCount)}};
+    std::string name = std::string("parseFields/") + styleList[style];
+    report.add("statement", name + "/amounts", "ms", amountSeconds * 1e3,
+               params);
+    report.add("statement", name + "/dates", "ms", dateSeconds * 1e3, params);
+    report.add("statement", name + "/10kRows", "ms",
+               (amountSeconds + dateSeconds) * 1e3, params);
+    report.add("statement", name + "/10kRows/best", "ms", bestSeconds * 1e3,
+               params);
+    if (bestSeconds > 1e-3) {
+      report.fail("statement", name + " parsed 10k rows in " +
+                                   std::to_string(bestSeconds * 1e3) +
+                                   " ms, over the 1 ms budget");
+    }
+    std::size_t amountsRead = 0, datesRead = 0;
+    for (unsigned int i = 0; i < rowCount; i++) {
+      amountsRead += amountColumn.confidence[i] > 0;
+      datesRead += dateColumn.confidence[i] > 0;
+    }
+    if (amountsRead != rowCount || datesRead != rowCount) {
+      report.fail("statement", name + " read " + std::to_string(amountsRead) +
+                                   " amounts and " +
+                                   std::to_string(datesRead) + " dates");
+    }
+  }
+}
+
+} // namespace
+
+/* Rows per second at growing sizes, ns/(n log2 n) stays flat when the
+ * reconstruction is O(n log n)
+ */
+void runStatementBench(BenchReport &report, const BenchOptions &options) {
+  unsigned int maxRows = options.quick ? 2000 : 32000;
+  for (unsigned int rowCount = 250; rowCount <= maxRows; rowCount *= 2) {
+    std::shared_ptr<HocrWordTable> table =
+        makeStatementTable(rowCount, rowCount);
+    unsigned int repeat = std::max(1u, 64000 / rowCount);
+    std::shared_ptr<FileTypeBankStatement> statement;
+    BenchTimer timer;
+    for (unsigned int i = 0; i < repeat; i++) {
+      statement = toBankStatement(table);
+    }
+    double seconds = timer.seconds() / repeat;
+    double n = static_cast<double>(table->size());
+    std::vector<std::pair<std::string, double>> params = {
+        {"rows", static_cast<double>(rowCount)}, {"words", n}};
+    std::string name = "toBankStatement/" + std::to_string(rowCount);
+    report.add("statement", name, "rows/s", rowCount / seconds, params);
+    report.add("statement", name + "/scaled", "ns/(n log2 n)",
+               seconds * 1e9 / (n * std::log2(n)), params);
+    if (statement->rowMap.size() != rowCount) {
+      report.fail("statement", name + " found " +
+                                   std::to_string(statement->rowMap.size()) +
+                                   " rows");
+    }
+  }
+  runFieldBench(report, options);
+}
+
+} // namespace bench
+} // namespace bookfiler
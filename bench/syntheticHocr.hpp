@@ -0,0 +1,111 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief synthetic hOCR documents for the benchmarks.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_BENCH_SYNTHETIC_HOCR_H
+#define BOOKFILER_MODULE_RECOGNIZE_BENCH_SYNTHETIC_HOCR_H
+
+// c++17
+#include <cstdio>
+#include <string>
+
+// Local Project
+#include "syntheticStatement.hpp"
+
+namespace bookfiler {
+namespace bench {
+
+class HocrCorpusConfig {
+public:
+  unsigned int pages = 1, lines = 40, words = 8;
+  /* Percent of the words with noise: an entity in the text, a malformed
+   * title property or extra whitespace and newlines between the tags
+   */
+  unsigned int noise = 0;
+  unsigned long long seed = 1;
+};
+
+/* @brief hOCR in the layout tesseract writes
+ * page > carea > par > line > word, single quoted attributes, baseline and
+ * x_size on the lines, bbox and x_wconf on the words. The pages are wrapped
+ * in a body element so read_xml sees one root.
+ */
+inline std::string generateHocr(const HocrCorpusConfig &config) {
+  static const char *vocabularyList[] = {
+      "the",     "account", "balance", "payment", "GROCERY", "PAYROLL",
+      "deposit", "01/15",   "12.50",   "1,234.56", "(45.00)", "Jan",
+      "invoice", "total",   "ATM",     "TRANSFER", "fee",     "interest"};
+  BenchRandom random(config.seed);
+  std::string hocr;
+  hocr.reserve(static_cast<std::size_t>(config.pages) * config.lines *
+               (config.words * 110 + 120));
+  char buffer[256];
+  hocr += "<body>\n";
+  unsigned int wordId = 1;
+  for (unsigned int page = 0; page < config.pages; page++) {
+    std::snprintf(buffer, sizeof(buffer),
+                  "<div class='ocr_page' id='page_%u' title='image "
+                  "\"page%u.png\"; bbox 0 0 2550 3300; ppageno %u'>\n",
+                  page + 1, page + 1, page);
+    hocr += buffer;
+    std::snprintf(buffer, sizeof(buffer),
+                  " <div class='ocr_carea' id='block_%u_1' title=\"bbox 100 "
+                  "100 2450 3200\">\n  <p class='ocr_par' id='par_%u_1' "
+                  "lang='eng' title=\"bbox 100 100 2450 3200\">\n",
+                  page + 1, page + 1);
+    hocr += buffer;
+    for (unsigned int line = 0; line < config.lines; line++) {
+      unsigned int y = 100 + line * 45;
+      std::snprintf(buffer, sizeof(buffer),
+                    "   <span class='ocr_line' id='line_%u_%u' title=\"bbox "
+                    "100 %u 2400 %u; baseline 0.002 -%u; x_size 32; "
+                    "x_descenders 7; x_ascenders 8\">",
+                    page + 1, line + 1, y, y + 36, 4 + random.next(6));
+      hocr += buffer;
+      unsigned int x = 100;
+      for (unsigned int word = 0; word < config.words; word++) {
+        const char *text = vocabularyList[random.next(18)];
+        unsigned int width = 30 + random.next(200);
+        bool noisy = random.next(100) < config.noise;
+        unsigned int noiseKind = noisy ? random.next(3) : 3;
+        if (noiseKind == 0) {
+          hocr += "\n      \n    ";
+        }
+        if (noiseKind == 1) {
+          std::snprintf(buffer, sizeof(buffer),
+                        "<span class='ocrx_word' id='word_%u' title='bbox %u "
+                        "%u %u ?; x_wconf'>",
+                        wordId, x, y + 2, x + width);
+        } else {
+          std::snprintf(buffer, sizeof(buffer),
+                        "<span class='ocrx_word' id='word_%u' title='bbox %u "
+                        "%u %u %u; x_wconf %u'>",
+                        wordId, x, y + 2, x + width, y + 34,
+                        50 + random.next(50));
+        }
+        hocr += buffer;
+        hocr += text;
+        if (noiseKind == 2) {
+          hocr += "&amp;co";
+        }
+        hocr += "</span> ";
+        x += width + 15;
+        wordId++;
+      }
+      hocr += "\n   </span>\n";
+    }
+    hocr += "  </p>\n </div>\n</div>\n";
+  }
+  hocr += "</body>\n";
+  return hocr;
+}
+
+} // namespace bench
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_BENCH_SYNTHETIC_HOCR_H
@@ -0,0 +1,128 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief synthetic invoice and receipt pages for the benchmarks.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_BENCH_SYNTHETIC_INVOICE_H
+#define BOOKFILER_MODULE_RECOGNIZE_BENCH_SYNTHETIC_INVOICE_H
+
+// c++17
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+
+// Local Project
+#include "Interface.hpp"
+#include "syntheticStatement.hpp"
+
+namespace bookfiler {
+namespace bench {
+
+/* What the extractor should find on a synthetic invoice
+ */
+class InvoiceTruth {
+public:
+  std::string number;
+  // in cents
+  unsigned long long subtotal = 0, tax = 0, total = 0;
+};
+
+/* @brief Word table of an invoice with itemCount items
+ * A header with the number and date, then quantity, two to four
+ * description words, unit price and amount columns with every seventh
+ * item on two lines, then the subtotal, tax and total lines. A receipt
+ * has the description and amount columns only.
+ */
+inline std::shared_ptr<HocrWordTable>
+makeInvoiceTable(unsigned int itemCount, unsigned int seed, bool receipt,
+                 InvoiceTruth &truth) {
+  static const char *itemList[] = {"WIDGET", "BOLT",   "PANEL",  "CABLE",
+                                   "SERVICE", "HOURS", "BRACKET", "FILTER",
+                                   "LABOR",  "SHIPPING", "PAPER", "TONER"};
+  BenchRandom random(seed);
+  std::shared_ptr<HocrWordTable> table = std::make_shared<HocrWordTable>();
+  table->reserve(itemCount * 7 + 32);
+  const unsigned int lineHeight = 40, wordHeight = 28;
+  unsigned int y = 100;
+  auto addWord = [&](unsigned int x, unsigned int width,
+                     const std::string &text) {
+    table->addWord(x, y, x + width, y + wordHeight, 90.0f + random.next(10),
+                   text, "word_" + std::to_string(table->size()));
+  };
+  // right aligned at x
+  auto addAmount = [&](unsigned int x, unsigned long long cents) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%llu.%02llu", cents / 100,
+                  cents % 100);
+    unsigned int width = static_cast<unsigned int>(std::strlen(buffer)) * 20;
+    addWord(x - width, width, buffer);
+  };
+  truth.number = std::to_string(1000 + seed % 9000);
+  addWord(150, 300, "ACME");
+  addWord(470, 300, "SUPPLY");
+  y += lineHeight * 2;
+  addWord(150, 200, receipt ? "Receipt" : "Invoice");
+  addWord(370, 60, receipt ? "No." : "#");
+  addWord(450, 120, truth.number);
+  y += lineHeight;
+  addWord(150, 120, "Date:");
+  addWord(290, 220, "01/15/2020");
+  y += lineHeight * 2;
+  if (!receipt) {
+    addWord(150, 80, "Qty");
+  }
+  addWord(400, 300, "Description");
+  if (!receipt) {
+    addWord(1300, 200, "Price");
+  }
+  addWord(1700, 200, "Amount");
+  y += lineHeight;
+  for (unsigned int item = 0; item < itemCount; item++) {
+    unsigned int quantity = receipt ? 1 : 1 + random.next(9);
+    unsigned long long unitPrice = 100 + random.next(50000);
+    if (!receipt) {
+      addWord(150, 30, std::to_string(quantity));
+    }
+    unsigned int descriptionWords = 2 + random.next(3);
+    unsigned int x = 400;
+    for (unsigned int i = 0; i < descriptionWords; i++) {
+      std::string word = itemList[random.next(12)];
+      unsigned int width = static_cast<unsigned int>(word.size()) * 22;
+      addWord(x, width, word);
+      x += width + 18;
+    }
+    if (!receipt) {
+      addAmount(1500, unitPrice);
+    }
+    addAmount(1900, unitPrice * quantity);
+    truth.subtotal += unitPrice * quantity;
+    y += lineHeight;
+    if (item % 7 == 6) {
+      addWord(400, 200, "PART");
+      addWord(620, 260, std::to_string(100000 + item));
+      y += lineHeight;
+    }
+  }
+  truth.tax = truth.subtotal * 8 / 100;
+  truth.total = truth.subtotal + truth.tax;
+  y += lineHeight;
+  addWord(1300, 200, "Subtotal");
+  addAmount(1900, truth.subtotal);
+  y += lineHeight;
+  addWord(1300, 100, "Tax");
+  addAmount(1900, truth.tax);
+  y += lineHeight;
+  addWord(1300, 150, "Total");
+  addAmount(1900, truth.total);
+  return table;
+}
+
+} // namespace bench
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_BENCH_SYNTHETIC_INVOICE_H
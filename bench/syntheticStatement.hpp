@@ -0,0 +1,108 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief synthetic bank statement pages for the benchmarks.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_BENCH_SYNTHETIC_STATEMENT_H
+#define BOOKFILER_MODULE_RECOGNIZE_BENCH_SYNTHETIC_STATEMENT_H
+
+// c++17
+#include <cstdio>
+#include <memory>
+#include <string>
+
+// Local Project
+#include "Interface.hpp"
+
+namespace bookfiler {
+namespace bench {
+
+/* Deterministic linear congruential generator, the same corpus on every
+ * machine
+ */
+class BenchRandom {
+public:
+  unsigned long long state;
+  BenchRandom(unsigned long long seed_) : state(seed_){};
+  unsigned int next() {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return static_cast<unsigned int>(state >> 33);
+  }
+  unsigned int next(unsigned int bound) { return next() % bound; }
+};
+
+/* @brief Word table of a statement with rowCount transactions
+ * Date, two to four description words, amount and balance columns, a
+ * header block and every fifth row with a second description line.
+ */
+inline std::shared_ptr<HocrWordTable> makeStatementTable(unsigned int rowCount,
+                                                         unsigned int seed) {
+  static const char *payeeList[] = {"GROCERY", "PAYROLL", "ATM",     "CHECK",
+                                    "TRANSFER", "ONLINE", "CAFE",    "RENT",
+                                    "UTILITY",  "FUEL",   "PHARMACY", "FEE"};
+  BenchRandom random(seed);
+  std::shared_ptr<HocrWordTable> table = std::make_shared<HocrWordTable>();
+  table->reserve(rowCount * 7 + 16);
+  const unsigned int lineHeight = 40, wordHeight = 28;
+  unsigned int y = 100;
+  auto addWord = [&](unsigned int x, unsigned int width,
+                     const std::string &text) {
+    table->addWord(x, y, x + width, y + wordHeight, 90.0f + random.next(10),
+                   text, "word_" + std::to_string(table->size()));
+  };
+  addWord(150, 300, "STATEMENT");
+  addWord(470, 200, "OF");
+  addWord(690, 300, "ACCOUNT");
+  y += lineHeight * 2;
+  addWord(150, 120, "Date");
+  addWord(400, 300, "Description");
+  addWord(1500, 200, "Amount");
+  addWord(1900, 200, "Balance");
+  y += lineHeight;
+  long long balance = 100000;
+  char buffer[64];
+  for (unsigned int row = 0; row < rowCount; row++) {
+    std::snprintf(buffer, sizeof(buffer), "%02u/%02u", 1 + row % 12,
+                  1 + row % 28);
+    addWord(150, 110, buffer);
+    unsigned int descriptionWords = 2 + random.next(3);
+    unsigned int x = 400;
+    for (unsigned int i = 0; i < descriptionWords; i++) {
+      std::string word = payeeList[random.next(12)];
+      unsigned int width = static_cast<unsigned int>(word.size()) * 22;
+      addWord(x, width, word);
+      x += width + 18;
+    }
+    long long amount = static_cast<long long>(random.next(500000)) - 250000;
+    balance += amount;
+    std::snprintf(buffer, sizeof(buffer), "%s%lld.%02lld",
+                  amount < 0 ? "-" : "", (amount < 0 ? -amount : amount) / 100,
+                  (amount < 0 ? -amount : amount) % 100);
+    std::string amountText = buffer;
+    unsigned int width = static_cast<unsigned int>(amountText.size()) * 20;
+    addWord(1700 - width, width, amountText);
+    std::snprintf(buffer, sizeof(buffer), "%s%lld.%02lld",
+                  balance < 0 ? "-" : "",
+                  (balance < 0 ? -balance : balance) / 100,
+                  (balance < 0 ? -balance : balance) % 100);
+    std::string balanceText = buffer;
+    width = static_cast<unsigned int>(balanceText.size()) * 20;
+    addWord(2100 - width, width, balanceText);
+    y += lineHeight;
+    if (row % 5 == 4) {
+      addWord(400, 200, "REF");
+      addWord(620, 260, std::to_string(100000 + row));
+      y += lineHeight;
+    }
+  }
+  return table;
+}
+
+} // namespace bench
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_BENCH_SYNTHETIC_STATEMENT_H
@@ -0,0 +1,113 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief hOCR title attribute parsing benchmark.
+ */
+
+// c++17
+#include <string>
+#include <vector>
+
+/* boost 1.72.0
+ * License: Boost Software License (similar to BSD and MIT)
+ */
+#include <boost/algorithm/string.hpp>
+
+// Local Project
+#include "Interface.hpp"
+#include "benchUtil.hpp"
+#include "core/hocrTitle.hpp"
+
+namespace {
+
+/* The title parsing done in toBankStatementTable before parseHocrTitle.
+ * Kept here as the baseline.
+ */
+void parseTitleSplit(const std::string &titleStr, bookfiler::HocrWord &word) {
+  std::vector<std::string> attributeProperties;
+  boost::split(attributeProperties, titleStr, boost::is_any_of(";"));
+  for (std::string property : attributeProperties) {
+    std::vector<std::string> propertyParts;
+    std::string propertyTrim = boost::algorithm::trim_copy(property);
+    boost::split(propertyParts, propertyTrim, boost::is_any_of(" "));
+    try {
+      if (propertyParts.size() == 5 && propertyParts.at(0) == "bbox") {
+        word.x0 = std::stoi(propertyParts.at(1));
+        word.y0 = std::stoi(propertyParts.at(2));
+        word.x1 = std::stoi(propertyParts.at(3));
+        word.y1 = std::stoi(propertyParts.at(4));
+        word.w = word.x1 - word.x0;
+        word.h = word.y1 - word.y0;
+      } else if (propertyParts.size() == 2 &&
+                 propertyParts.at(0) == "x_wconf") {
+        word.confidence = std::stof(propertyParts.at(1));
+      }
+    } catch (...) {
+    }
+  }
+}
+
+std::vector<std::string> makeTitles(std::size_t count) {
+  std::vector<std::string> titleList;
+  titleList.reserve(count);
+  unsigned int seed = 12345;
+  for (std::size_t i = 0; i < count; i++) {
+    seed = seed * 1103515245 + 12345;
+    unsigned int x = (seed >> 8) % 2400, y = (seed >> 4) % 3200;
+    std::string title = "bbox " + std::to_string(x) + " " + std::to_string(y) +
+                        " " + std::to_string(x + 40 + seed % 200) + " " +
+                        std::to_string(y + 30) +
+                        "; x_wconf " + std::to_string(60 + seed % 40);
+    // every 10th word carries font size, every 50th is malformed
+    if (i % 10 == 0) {
+      title += "; x_fsize 11";
+    }
+    if (i % 50 == 0) {
+      title += "; x_wconf ??";
+    }
+    titleList.push_back(title);
+  }
+  return titleList;
+}
+
+} // namespace
+
+namespace bookfiler {
+namespace bench {
+
+void runTitleBench(BenchReport &report, const BenchOptions &options) {
+  std::size_t count = options.quick ? 20000 : 200000;
+  std::vector<std::string> titleList = makeTitles(count);
+  std::vector<std::pair<std::string, double>> params = {
+      {"titles", static_cast<double>(count)}};
+
+  unsigned long long checksumSplit = 0, checksumView = 0;
+  BenchTimer splitTimer;
+  for (const std::string &title : titleList) {
+    HocrWord word;
+    parseTitleSplit(title, word);
+    checksumSplit += word.x0 + word.y1 + (unsigned int)word.confidence;
+  }
+  double splitSeconds = splitTimer.seconds();
+  BenchTimer viewTimer;
+  for (const std::string &title : titleList) {
+    HocrTitle parsed;
+    parseHocrTitle(title, parsed);
+    checksumView += parsed.x0 + parsed.y1 + (unsigned int)parsed.confidence;
+  }
+  double viewSeconds = viewTimer.seconds();
+
+  report.add("title", "split+stoi", "titles/s", count / splitSeconds, params);
+  report.add("title", "parseHocrTitle", "titles/s", count / viewSeconds,
+             params);
+  report.add("title", "speedup", "x", splitSeconds / viewSeconds, params);
+  if (checksumSplit != checksumView) {
+    report.fail("title", "checksum mismatch " + std::to_string(checksumSplit) +
+                             " != " + std::to_string(checksumView));
+  }
+}
+
+} // namespace bench
+} // namespace bookfiler
@@ -10,9 +10,12 @@
 #define RECOGNIZE_TEXT_INTERFACE_H
 
 // c++17
+#include <atomic>
 #include <functional>
+#include <future>
 #include <iostream>
 #include <memory>
+#include <string>
 #include <string_view>
 #include <vector>
 
@@ -64,12 +67,26 @@ public:
 };
 #endif // end BOOKFILER_PIXMAP_H
 
+#ifndef BOOKFILER_PIXMAP_ALLOCATOR_H
+#define BOOKFILER_PIXMAP_ALLOCATOR_H
+/* Pixmap storage shared between the modules
+ * The pixels are not cleared. The storage is recycled when the last
+ * reference to the pixmap drops.
+ */
+class PixmapAllocator {
+public:
+  virtual std::shared_ptr<Pixmap> newPixmap(long width, long height,
+                                            long bitsPerPixel,
+                                            long samplesPerPixel) = 0;
+};
+#endif // end BOOKFILER_PIXMAP_ALLOCATOR_H
+
 #ifndef BOOKFILER_MODULE_OCR_INTERFACE_H
 #define BOOKFILER_MODULE_OCR_INTERFACE_H
 class OcrMonitor {
 public:
-  virtual unsigned long getAvailable();
-  virtual unsigned long getTotal();
+  virtual unsigned long getAvailable() = 0;
+  virtual unsigned long getTotal() = 0;
 };
 
 class Ocr {
@@ -93,7 +110,8 @@ public:
   // Mode example: engine selection
   virtual void setMode(std::string) = 0;
   /* Type example: document type
-   * general, messageInstant, messageLong, bankStatement, invoice
+   * general, messageInstant, messageLong, bankStatement, invoice, receipt
+   * bankStatement, invoice and receipt pages are extracted into tables
    */
   virtual void setType(std::string) = 0;
   virtual void setLanguage(std::vector<std::string>) = 0;
@@ -110,15 +128,15 @@ public:
 
 class OcrInterface {
 public:
-  virtual void init();
+  virtual void init() = 0;
   virtual void registerSettings(
       std::shared_ptr<rapidjson::Document> moduleRequest,
       std::shared_ptr<std::unordered_map<
           std::string,
           std::function<void(std::shared_ptr<rapidjson::Document>)>>>
-          moduleCallbackMap);
-  virtual void setSettings(std::shared_ptr<rapidjson::Value> data);
-  virtual std::shared_ptr<Ocr> newOcr();
+          moduleCallbackMap) = 0;
+  virtual void setSettings(std::shared_ptr<rapidjson::Value> data) = 0;
+  virtual std::shared_ptr<Ocr> newOcr() = 0;
 };
 #endif // end BOOKFILER_MODULE_OCR_INTERFACE_H
 
@@ -131,11 +149,12 @@ public:
 
 class Pdf {
 public:
-  void openFile(std::string);
-  int getPagesTotal();
-  void render(int pageNum);
-  std::shared_ptr<PdfMonitor> getRenderMonitor();
-  std::shared_ptr<Pixmap> getPixmap(int pageNum);
+  virtual void openFile(std::string) = 0;
+  virtual int getPagesTotal() = 0;
+  // @param pageNum zero based
+  virtual void render(int pageNum) = 0;
+  virtual std::shared_ptr<PdfMonitor> getRenderMonitor() = 0;
+  virtual std::shared_ptr<Pixmap> getPixmap(int pageNum) = 0;
 };
 
 class PdfInterface {
@@ -159,27 +178,544 @@ public:
   /* BoundingBox
    * http://kba.cloud/hocr-spec/1.2/#bbox
    */
-  unsigned int x0, y0, x1, y1, w, h;
+  unsigned int x0 = 0, y0 = 0, x1 = 0, y1 = 0, w = 0, h = 0;
   std::string value;
   std::string id;
   // http://kba.cloud/hocr-spec/1.2/#x_wconf
-  float confidence;
+  float confidence = 0;
+  /* http://kba.cloud/hocr-spec/1.2/#baseline
+   * Taken from the enclosing line when the word has none
+   */
+  float baselineSlope = 0, baselineOffset = 0;
+  // http://kba.cloud/hocr-spec/1.2/#x_size
+  float xSize = 0;
+  // http://kba.cloud/hocr-spec/1.2/#x_fsize
+  float xFsize = 0;
+  // http://kba.cloud/hocr-spec/1.2/#textangle
+  float textAngle = 0;
 };
 #endif // end BOOKFILER_HOCR_WORD_H
 
+#ifndef BOOKFILER_HOCR_WORD_TABLE_H
+#define BOOKFILER_HOCR_WORD_TABLE_H
+/* Page level word storage as a structure of arrays.
+ * Geometry and confidence are kept in contiguous columns, one entry per
+ * word. Word text and ids are indexes into a string table whose characters
+ * all live in one arena. Word text is interned so repeated words share one
+ * entry.
+ * Everything is inline so the application does not link against the module.
+ */
+class HocrWordTable;
+
+class HocrWordRef {
+public:
+  const HocrWordTable *table;
+  std::size_t index;
+
+  HocrWordRef(const HocrWordTable *table_, std::size_t index_)
+      : table(table_), index(index_){};
+  inline unsigned int x0() const;
+  inline unsigned int y0() const;
+  inline unsigned int x1() const;
+  inline unsigned int y1() const;
+  inline unsigned int w() const { return x1() - x0(); }
+  inline unsigned int h() const { return y1() - y0(); }
+  inline float confidence() const;
+  inline float baselineSlope() const;
+  inline float baselineOffset() const;
+  inline float xSize() const;
+  inline float xFsize() const;
+  inline float textAngle() const;
+  inline std::string_view value() const;
+  inline std::string_view id() const;
+};
+
+/* A range of words in a table. Cheap to copy, iterate with range-for.
+ */
+class HocrWordTableView {
+public:
+  class iterator {
+  public:
+    const HocrWordTable *table;
+    std::size_t index;
+
+    iterator(const HocrWordTable *table_, std::size_t index_)
+        : table(table_), index(index_){};
+    HocrWordRef operator*() const { return HocrWordRef(table, index); }
+    iterator &operator++() {
+      index++;
+      return *this;
+    }
+    bool operator!=(const iterator &other) const {
+      return index != other.index;
+    }
+    bool operator==(const iterator &other) const {
+      return index == other.index;
+    }
+  };
+
+  const HocrWordTable *table;
+  std::size_t beginIndex, endIndex;
+
+  HocrWordTableView(const HocrWordTable *table_, std::size_t beginIndex_,
+                    std::size_t endIndex_)
+      : table(table_), beginIndex(beginIndex_), endIndex(endIndex_){};
+  iterator begin() const { return iterator(table, beginIndex); }
+  iterator end() const { return iterator(table, endIndex); }
+  std::size_t size() const { return endIndex - beginIndex; }
+  bool empty() const { return beginIndex == endIndex; }
+  HocrWordRef operator[](std::size_t i) const {
+    return HocrWordRef(table, beginIndex + i);
+  }
+};
+
+class HocrWordTable {
+private:
+  /* open addressing hash of the interned strings
+   * a slot holds string index + 1, zero is empty
+   */
+  std::vector<unsigned int> internSlots;
+  std::size_t internCount = 0;
+
+  static std::size_t hashString(std::string_view value) {
+    // FNV-1a
+    std::size_t hash = 14695981039346656037ULL;
+    for (char c : value) {
+      hash ^= static_cast<unsigned char>(c);
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+  void growIntern() {
+    std::vector<unsigned int> oldSlots;
+    oldSlots.swap(internSlots);
+    internSlots.assign(oldSlots.empty() ? 256 : oldSlots.size() * 2, 0);
+    std::size_t mask = internSlots.size() - 1;
+    for (unsigned int slot : oldSlots) {
+      if (slot) {
+        std::size_t i = hashString(getString(slot - 1)) & mask;
+        while (internSlots[i]) {
+          i = (i + 1) & mask;
+        }
+        internSlots[i] = slot;
+      }
+    }
+  }
+
+public:
+  // page number of the first word, 0 if unknown
+  unsigned int pageNum = 0;
+  /* BoundingBox
+   * http://kba.cloud/hocr-spec/1.2/#bbox
+   */
+  std::vector<unsigned int> x0, y0, x1, y1;
+  // http://kba.cloud/hocr-spec/1.2/#x_wconf
+  std::vector<float> confidence;
+  // same meaning as the HocrWord members
+  std::vector<float> baselineSlope, baselineOffset, xSize, xFsize, textAngle;
+  // index into the string table
+  std::vector<unsigned int> valueIndex, idIndex;
+  /* One past the last word of each ocr_line, in document order. The words
+   * between two ends are one line.
+   */
+  std::vector<unsigned int> lineEnd;
+  /* One past the last word of each ocr_page when the table holds more than
+   * one page, empty for a single page
+   */
+  std::vector<unsigned int> pageEnd;
+  // string table
+  std::string stringArena;
+  std::vector<unsigned int> stringOffset, stringLength;
+
+  std::size_t size() const { return x0.size(); }
+  bool empty() const { return x0.empty(); }
+  HocrWordRef operator[](std::size_t i) const { return HocrWordRef(this, i); }
+  HocrWordTableView view() const { return HocrWordTableView(this, 0, size()); }
+  HocrWordTableView view(std::size_t beginIndex, std::size_t endIndex) const {
+    return HocrWordTableView(this, beginIndex, endIndex);
+  }
+  std::string_view getString(unsigned int index) const {
+    return std::string_view(stringArena.data() + stringOffset[index],
+                            stringLength[index]);
+  }
+  // move every bounding box, from region to page coordinates
+  void translate(unsigned int dx, unsigned int dy) {
+    for (std::size_t i = 0; i < size(); i++) {
+      x0[i] += dx;
+      y0[i] += dy;
+      x1[i] += dx;
+      y1[i] += dy;
+    }
+  }
+  void reserve(std::size_t wordCount) {
+    x0.reserve(wordCount);
+    y0.reserve(wordCount);
+    x1.reserve(wordCount);
+    y1.reserve(wordCount);
+    confidence.reserve(wordCount);
+    baselineSlope.reserve(wordCount);
+    baselineOffset.reserve(wordCount);
+    xSize.reserve(wordCount);
+    xFsize.reserve(wordCount);
+    textAngle.reserve(wordCount);
+    valueIndex.reserve(wordCount);
+    idIndex.reserve(wordCount);
+  }
+  /* @brief Add a string to the string table without looking for a copy
+   * @return string index
+   */
+  unsigned int addString(std::string_view value) {
+    unsigned int index = static_cast<unsigned int>(stringOffset.size());
+    stringOffset.push_back(static_cast<unsigned int>(stringArena.size()));
+    stringLength.push_back(static_cast<unsigned int>(value.size()));
+    stringArena.append(value.data(), value.size());
+    return index;
+  }
+  /* @brief Add a string to the string table, reusing an equal one
+   * @return string index
+   */
+  unsigned int intern(std::string_view value) {
+    if ((internCount + 1) * 2 > internSlots.size()) {
+      growIntern();
+    }
+    std::size_t mask = internSlots.size() - 1;
+    std::size_t i = hashString(value) & mask;
+    while (internSlots[i]) {
+      if (getString(internSlots[i] - 1) == value) {
+        return internSlots[i] - 1;
+      }
+      i = (i + 1) & mask;
+    }
+    unsigned int index = addString(value);
+    internSlots[i] = index + 1;
+    internCount++;
+    return index;
+  }
+  /* @brief Append a word
+   * The line properties start at zero, set them through the returned index.
+   * @return word index
+   */
+  std::size_t addWord(unsigned int x0_, unsigned int y0_, unsigned int x1_,
+                      unsigned int y1_, float confidence_,
+                      std::string_view value_, std::string_view id_) {
+    x0.push_back(x0_);
+    y0.push_back(y0_);
+    x1.push_back(x1_);
+    y1.push_back(y1_);
+    confidence.push_back(confidence_);
+    baselineSlope.push_back(0);
+    baselineOffset.push_back(0);
+    xSize.push_back(0);
+    xFsize.push_back(0);
+    textAngle.push_back(0);
+    valueIndex.push_back(intern(value_));
+    idIndex.push_back(addString(id_));
+    return x0.size() - 1;
+  }
+  /* @brief Append the words [beginIndex, endIndex) of another table with
+   * their lines, the values are interned again
+   */
+  void append(const HocrWordTable &other, std::size_t beginIndex,
+              std::size_t endIndex) {
+    std::size_t base = size();
+    reserve(base + endIndex - beginIndex);
+    for (std::size_t i = beginIndex; i < endIndex; i++) {
+      std::size_t index = addWord(
+          other.x0[i], other.y0[i], other.x1[i], other.y1[i],
+          other.confidence[i], other.getString(other.valueIndex[i]),
+          other.getString(other.idIndex[i]));
+      baselineSlope[index] = other.baselineSlope[i];
+      baselineOffset[index] = other.baselineOffset[i];
+      xSize[index] = other.xSize[i];
+      xFsize[index] = other.xFsize[i];
+      textAngle[index] = other.textAngle[i];
+    }
+    for (unsigned int end : other.lineEnd) {
+      if (end > beginIndex && end <= endIndex) {
+        lineEnd.push_back(static_cast<unsigned int>(base + end - beginIndex));
+      }
+    }
+  }
+  // @return bytes held by the table, the vectors at their capacity
+  std::size_t getMemoryBytes() const {
+    std::size_t bytes = sizeof(*this) + stringArena.capacity() +
+                        internSlots.capacity() * sizeof(unsigned int);
+    bytes += (x0.capacity() + y0.capacity() + x1.capacity() + y1.capacity() +
+              valueIndex.capacity() + idIndex.capacity() +
+              lineEnd.capacity() + pageEnd.capacity() +
+              stringOffset.capacity() + stringLength.capacity()) *
+             sizeof(unsigned int);
+    bytes += (confidence.capacity() + baselineSlope.capacity() +
+              baselineOffset.capacity() + xSize.capacity() +
+              xFsize.capacity() + textAngle.capacity()) *
+             sizeof(float);
+    return bytes;
+  }
+  /* @brief Compatibility adapter for textUpdateSignal slots
+   */
+  std::shared_ptr<std::vector<std::shared_ptr<HocrWord>>>
+  toHocrWordList(HocrWordTableView range) const {
+    std::shared_ptr<std::vector<std::shared_ptr<HocrWord>>> wordList =
+        std::make_shared<std::vector<std::shared_ptr<HocrWord>>>();
+    wordList->reserve(range.size());
+    for (HocrWordRef ref : range) {
+      std::shared_ptr<HocrWord> wordPtr = std::make_shared<HocrWord>();
+      wordPtr->x0 = ref.x0();
+      wordPtr->y0 = ref.y0();
+      wordPtr->x1 = ref.x1();
+      wordPtr->y1 = ref.y1();
+      wordPtr->w = ref.w();
+      wordPtr->h = ref.h();
+      wordPtr->confidence = ref.confidence();
+      wordPtr->baselineSlope = ref.baselineSlope();
+      wordPtr->baselineOffset = ref.baselineOffset();
+      wordPtr->xSize = ref.xSize();
+      wordPtr->xFsize = ref.xFsize();
+      wordPtr->textAngle = ref.textAngle();
+      wordPtr->value = std::string(ref.value());
+      wordPtr->id = std::string(ref.id());
+      wordList->push_back(wordPtr);
+    }
+    return wordList;
+  }
+  std::shared_ptr<std::vector<std::shared_ptr<HocrWord>>>
+  toHocrWordList() const {
+    return toHocrWordList(view());
+  }
+};
+
+inline unsigned int HocrWordRef::x0() const { return table->x0[index]; }
+inline unsigned int HocrWordRef::y0() const { return table->y0[index]; }
+inline unsigned int HocrWordRef::x1() const { return table->x1[index]; }
+inline unsigned int HocrWordRef::y1() const { return table->y1[index]; }
+inline float HocrWordRef::confidence() const {
+  return table->confidence[index];
+}
+inline float HocrWordRef::baselineSlope() const {
+  return table->baselineSlope[index];
+}
+inline float HocrWordRef::baselineOffset() const {
+  return table->baselineOffset[index];
+}
+inline float HocrWordRef::xSize() const { return table->xSize[index]; }
+inline float HocrWordRef::xFsize() const { return table->xFsize[index]; }
+inline float HocrWordRef::textAngle() const {
+  return table->textAngle[index];
+}
+inline std::string_view HocrWordRef::value() const {
+  return table->getString(table->valueIndex[index]);
+}
+inline std::string_view HocrWordRef::id() const {
+  return table->getString(table->idIndex[index]);
+}
+#endif // end BOOKFILER_HOCR_WORD_TABLE_H
+
+/* Where the hOCR parser stopped: a word or the end of a block
+ * The block ends are ordered from the smallest block to the largest so a
+ * level can be compared: an event at or above the level closes it.
+ */
+enum class HocrEvent : unsigned int {
+  word = 0,
+  // ocr_line and the other line classes
+  lineEnd = 1,
+  parEnd = 2,
+  pageEnd = 3,
+  documentEnd = 4
+};
+
+/* Words of a page sent while its hOCR is still being parsed
+ * Every line, paragraph or ocr_page block (see the stream settings) is one
+ * batch. sequence counts the batches of a page from 0 and the last batch of
+ * the page has endOfDocument set, it may have no words. Pages that were not
+ * parsed, from the cache or already recognized, are sent as one batch.
+ */
+class HocrWordBatch {
+public:
+  std::string filePath;
+  unsigned int pageNum = 0;
+  unsigned long long sequence = 0;
+  // the block that closed, documentEnd for the last batch
+  HocrEvent event = HocrEvent::documentEnd;
+  bool endOfDocument = false;
+  std::shared_ptr<std::vector<std::shared_ptr<HocrWord>>> wordList;
+};
+
+/* Order of the work queued by a model, higher runs first.
+ * The files from addPaths run as background.
+ */
+enum class RecognizePriority : unsigned int {
+  background = 0,
+  normal = 1,
+  interactive = 2
+};
+
+/* Part of a page sent to the OCR engine, in fractions of the page size so
+ * it holds at any render resolution. The words are returned in page
+ * coordinates.
+ */
+class RecognizeRegion {
+public:
+  double x0 = 0, y0 = 0, x1 = 1, y1 = 1;
+  /* Learn the region instead: the first learnPages pages with statement
+   * rows are recognized whole, then the union of their rows grown by
+   * margin on every side is used.
+   */
+  bool learn = false;
+  unsigned int learnPages = 3;
+  double margin = 0.02;
+};
+
+class RecognizeResult {
+public:
+  std::string filePath;
+  // word table of each page, indexed by page number, null if it failed
+  std::vector<std::shared_ptr<HocrWordTable>> pageList;
+  bool cancelled = false;
+};
+
+/* Handle of one requestRecognizeAsync call
+ * cancel() drops the request if it has not started. A running request
+ * stops between pages and the pages still in the OCR engine are discarded
+ * when they come back. The future is always fulfilled, with cancelled set
+ * if the request was cancelled. It throws std::future_error if the model is
+ * destroyed before the request ran.
+ */
+class RecognizeTicket {
+public:
+  unsigned long long id = 0;
+  RecognizePriority priority = RecognizePriority::normal;
+  std::atomic<bool> cancelFlag{false};
+  std::shared_future<std::shared_ptr<RecognizeResult>> future;
+  void cancel() { cancelFlag = true; }
+  bool isCancelled() const { return cancelFlag.load(); }
+};
+
+/* A word found in the recognized documents, see RecognizeModel::findWords
+ * The box is in page coordinates, to highlight the word on the page.
+ */
+class WordHit {
+public:
+  std::string filePath;
+  unsigned int pageNum = 0;
+  unsigned int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+  // the word as it was indexed, lower case, empty for an amount
+  std::string term;
+  // cents of an amount, negative for a debit
+  long long amount = 0;
+};
+
 class RecognizeModel {
 public:
   /* @brief Add files and directory paths to the recognizer model
-   * @return vector of path handle/identifier
+   * Directories are walked on the crawler threads and their files queued as
+   * they are found. Only images and PDFs are recognized, told apart by their
+   * first bytes. With the cache on, a file with the size, time and inode it
+   * had when recognized is not queued again, its words load from the cache.
    * The virtual keyword stops the binary including this from trying to link
    */
   virtual void
   addPaths(std::shared_ptr<std::vector<std::string>> fileSelectedList) = 0;
+  // Same as requestRecognizeAsync at interactive priority without the ticket
   virtual void requestRecognize(std::string fileRequested) = 0;
+  /* @brief Recognize a file on the worker pool of the model
+   * The signals are emitted for every page as with requestRecognize, unless
+   * the ticket is cancelled. A file that was already recognized returns the
+   * stored pages.
+   */
+  virtual std::shared_ptr<RecognizeTicket>
+  requestRecognizeAsync(std::string fileRequested,
+                        RecognizePriority priority) = 0;
+  /* @brief Progress of the files queued by addPaths
+   * crawling, pending, queued, running, pagesDone, pagesFailed,
+   * filesUnchanged, filesIgnored, pagesPerSecond
+   * pagesDone counts the pages of the unchanged files too. scheduler holds
+   * the share of the module workers used by the model.
+   */
+  virtual std::shared_ptr<rapidjson::Document> getBatchStatus() = 0;
+  /* @brief Runtime metrics, turned on and off with the debug settings
+   * counters, latency histograms of each stage in nanoseconds, page latency
+   * in microseconds and words per page. pagesBlank and pagesDuplicate count
+   * the pages stored without OCR, see the "skip" settings. memory holds the
+   * bytes kept by the model and its evictions, see the "model" settings.
+   */
+  virtual std::shared_ptr<rapidjson::Document> getMetrics() = 0;
+  /* @brief Bytes of the recognized pages kept by the model, images and
+   * words, bounded by the "model" settings
+   */
+  virtual std::size_t getMemoryBytes() = 0;
+  /* @brief Only recognize a region of the pages of a document type
+   * The type in use is the one of the "ocr" "type" setting: "" is a
+   * "bankStatement", "invoice" and "receipt" have their own extractor and
+   * any other type is "general". The region applies to the files started
+   * after the call, null recognizes the whole page again.
+   */
+  virtual void setDocumentRegion(std::string documentType,
+                                 std::shared_ptr<const RecognizeRegion>
+                                     region) = 0;
+  /* @return the region in use, the learned one for a learn region, null
+   * for the whole page or while the region is being learned
+   */
+  virtual std::shared_ptr<const RecognizeRegion>
+  getDocumentRegion(std::string documentType) = 0;
+  /* @brief Write the recognized pages of a file for another program
+   * @param format "binary" for the memory mappable document file read with
+   * DocumentFileView, "json" for the same content as JSON
+   * @return false if the file has no recognized pages or on a write error
+   */
+  virtual bool exportDocument(std::string filePath, std::string exportPath,
+                              std::string format) = 0;
+  /* @brief Find a word in every document recognized, by any model of the
+   * module and, with the cache on, in earlier sessions
+   * Words are matched lower case without the punctuation around them, so
+   * "Payee," is found by "payee". Hits come in the order the pages were
+   * recognized.
+   * @param maxHits stop after this many, 0 for all
+   */
+  virtual std::shared_ptr<std::vector<WordHit>>
+  findWords(std::string term, std::size_t maxHits) = 0;
+  // @brief Words starting with prefix, see findWords
+  virtual std::shared_ptr<std::vector<WordHit>>
+  findWordPrefix(std::string prefix, std::size_t maxHits) = 0;
+  /* @brief Amounts from minimum to maximum cents, both included, debits
+   * negative, in order of value, see findWords
+   */
+  virtual std::shared_ptr<std::vector<WordHit>>
+  findAmounts(long long minimum, long long maximum, std::size_t maxHits) = 0;
+  /* @brief Known payees the statement descriptions are matched to
+   * The rows of the pages recognized from then on get the closest payee
+   * despite OCR mistakes, see the "payee" settings. Null or empty to stop.
+   */
+  virtual void
+  setPayeeCatalog(std::shared_ptr<const std::vector<std::string>> catalog) = 0;
+  /* @brief Run the slots of the signals below through the executor, for
+   * example to post them to the UI thread of the host. Null runs them on
+   * the dispatch thread of the model, see the "signal" settings.
+   */
+  virtual void setSignalExecutor(
+      std::function<void(std::function<void()>)> executor) = 0;
+  /* @brief Wait until the signals of the pages done so far are delivered
+   * Not from a slot or from the thread of the executor.
+   */
+  virtual void flushSignals() = 0;
+  /* The signals are queued by the threads recognizing and delivered in
+   * order, after the call that recognized the page may have returned. An
+   * image update already followed by a newer one is not delivered.
+   */
   boost::signals2::signal<void(std::shared_ptr<Pixmap>)> imageUpdateSignal;
+  /* Same words as wordTableUpdateSignal, one HocrWord per word.
+   * Only built when a slot is connected.
+   */
   boost::signals2::signal<void(
       std::shared_ptr<std::vector<std::shared_ptr<HocrWord>>>)>
       textUpdateSignal;
+  boost::signals2::signal<void(std::shared_ptr<HocrWordTable>)>
+      wordTableUpdateSignal;
+  /* Words of the page sent block by block, before the page is done.
+   * Only parsed in blocks when a slot is connected. Blocks queued together
+   * may come as one batch.
+   */
+  boost::signals2::signal<void(std::shared_ptr<HocrWordBatch>)>
+      wordBatchUpdateSignal;
 };
 
 /* RecognizeInterface
@@ -196,9 +732,23 @@ public:
           std::function<void(std::shared_ptr<rapidjson::Document>)>>>
           moduleCallbackMap) = 0;
   virtual void setSettings(std::shared_ptr<rapidjson::Value> data) = 0;
+  /* @brief A new model using the module settings and modules
+   * The module does not keep the model alive, it is freed with the last
+   * reference of the host. Do not release it from one of its own signals,
+   * the model waits for its workers when it is freed.
+   */
   virtual std::shared_ptr<RecognizeModel> newModel() = 0;
   virtual void setPdfModule(std::shared_ptr<PdfInterface>) = 0;
   virtual void setOcrModule(std::shared_ptr<OcrInterface>) = 0;
+  /* @brief Pixel buffer pool for the PDF and OCR modules to render and
+   * open pages into, bounded by the pixmap settings
+   */
+  virtual std::shared_ptr<PixmapAllocator> getPixmapAllocator() = 0;
+  /* @brief Workers shared by the models, see the "scheduler" settings
+   * threads, maxJobs, maxOcrJobs, maxBytes, running, ocrRunning, ocrPeak,
+   * memoryBytes and models, the queue, utilization and memory of each
+   */
+  virtual std::shared_ptr<rapidjson::Document> getSchedulerStatus() = 0;
 };
 
 } // namespace bookfiler
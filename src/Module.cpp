@@ -29,7 +29,19 @@ namespace bookfiler {
 extern "C" BOOST_SYMBOL_EXPORT ModuleExport bookfilerRecognizeModule;
 ModuleExport bookfilerRecognizeModule;
 
-ModuleExport::ModuleExport() {}
+ModuleExport::ModuleExport()
+    : settings(std::make_shared<RecognizeSettings>()),
+      recognizeCache(std::make_shared<RecognizeCache>()),
+      pixmapPool(std::make_shared<PixmapPool>()),
+      fileManifest(std::make_shared<FileManifest>()),
+      wordIndex(std::make_shared<WordIndex>()),
+      scheduler(std::make_shared<RecognizeScheduler>()) {
+  recognizeCache->configure(*settings);
+  pixmapPool->configure(*settings);
+  fileManifest->configure(*settings);
+  wordIndex->configure(*settings);
+  scheduler->configure(*settings);
+}
 ModuleExport::~ModuleExport() {}
 
 void ModuleExport::init() { printf("Recognize Module: init()\n"); }
@@ -55,11 +67,39 @@ void ModuleExport::setSettings(std::shared_ptr<rapidjson::Value> data) {
   std::cout << "bookfiler::ModuleExport::setSettings:\n"
             << buffer.GetString() << std::endl;
 #endif
+  if (!data) {
+    return;
+  }
+  std::shared_ptr<RecognizeSettings> settingsNew =
+      std::make_shared<RecognizeSettings>(*settings);
+  settingsNew->load(*data);
+  settings = settingsNew;
+  recognizeCache->configure(*settings);
+  pixmapPool->configure(*settings);
+  fileManifest->configure(*settings);
+  wordIndex->configure(*settings);
+  scheduler->configure(*settings);
+  if (ocrEnginePool) {
+    ocrEnginePool->configure(*settings);
+  }
+  for (auto modelWeak : modelList) {
+    if (std::shared_ptr<RecognizeModelInternal> modelPtr = modelWeak.lock()) {
+      modelPtr->setSettings(settings);
+    }
+  }
 }
 
 std::shared_ptr<RecognizeModel> ModuleExport::newModel() {
   std::shared_ptr<RecognizeModelInternal> modelPtr =
-      std::make_shared<RecognizeModelInternal>(ocrModule, pdfModule);
+      std::make_shared<RecognizeModelInternal>(ocrModule, pdfModule, settings,
+                                               recognizeCache, pixmapPool,
+                                               ocrEnginePool, fileManifest,
+                                               wordIndex, scheduler);
+  modelList.erase(std::remove_if(modelList.begin(), modelList.end(),
+                                 [](auto &modelWeak) {
+                                   return modelWeak.expired();
+                                 }),
+                  modelList.end());
   modelList.push_back(modelPtr);
   return std::dynamic_pointer_cast<RecognizeModel>(modelPtr);
 }
@@ -69,6 +109,20 @@ void ModuleExport::setPdfModule(std::shared_ptr<PdfInterface> module) {
 }
 void ModuleExport::setOcrModule(std::shared_ptr<OcrInterface> module) {
   ocrModule = module;
+  ocrEnginePool = std::make_shared<OcrEnginePool>(ocrModule);
+  ocrEnginePool->configure(*settings);
+  // load the engine data now instead of on the first page
+  ocrEnginePool->warmUp(*settings, settings->ocrWarmEngines);
+}
+std::shared_ptr<PixmapAllocator> ModuleExport::getPixmapAllocator() {
+  return pixmapPool;
+}
+std::shared_ptr<rapidjson::Document> ModuleExport::getSchedulerStatus() {
+  std::shared_ptr<rapidjson::Document> document =
+      std::make_shared<rapidjson::Document>();
+  document->SetObject();
+  scheduler->toJson(*document, document->GetAllocator());
+  return document;
 }
 
 } // namespace bookfiler
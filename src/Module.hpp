@@ -13,6 +13,7 @@
 #include "core/config.hpp"
 
 // C++17
+#include <algorithm>
 #include <fstream>
 #include <functional>
 #include <iostream>
@@ -52,9 +53,20 @@ namespace bookfiler {
  * storage
  */
 class ModuleExport : public RecognizeInterface {
-  std::vector<std::shared_ptr<RecognizeModelInternal>> modelList;
+  // models still held by the host, expired ones are dropped on the way
+  std::vector<std::weak_ptr<RecognizeModelInternal>> modelList;
   std::shared_ptr<OcrInterface> ocrModule;
   std::shared_ptr<PdfInterface> pdfModule;
+  std::shared_ptr<const RecognizeSettings> settings;
+  std::shared_ptr<RecognizeCache> recognizeCache;
+  std::shared_ptr<PixmapPool> pixmapPool;
+  std::shared_ptr<FileManifest> fileManifest;
+  // words of the pages recognized by every model
+  std::shared_ptr<WordIndex> wordIndex;
+  // engines of ocrModule, replaced with it
+  std::shared_ptr<OcrEnginePool> ocrEnginePool;
+  // runs the jobs of every model
+  std::shared_ptr<RecognizeScheduler> scheduler;
 
 public:
   ModuleExport();
@@ -71,6 +83,8 @@ public:
   std::shared_ptr<RecognizeModel> newModel();
   void setPdfModule(std::shared_ptr<PdfInterface>);
   void setOcrModule(std::shared_ptr<OcrInterface>);
+  std::shared_ptr<PixmapAllocator> getPixmapAllocator();
+  std::shared_ptr<rapidjson::Document> getSchedulerStatus();
 };
 
 } // namespace bookfiler
@@ -0,0 +1,219 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+// c++17
+#include <algorithm>
+
+// Local Project
+#include "bankStatement.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+namespace {
+
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+// "Jan", "Sept." or "January,"
+bool isMonthName(std::string_view token) {
+  if (!token.empty() && (token.back() == '.' || token.back() == ',')) {
+    token.remove_suffix(1);
+  }
+  return parseMonthName(token) != 0;
+}
+
+// day after a month name: "15" or "15,"
+bool isDayNumber(std::string_view token) {
+  if (!token.empty() && token.back() == ',') {
+    token.remove_suffix(1);
+  }
+  if (token.empty() || token.size() > 2) {
+    return false;
+  }
+  for (char c : token) {
+    if (!isDigit(c)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool isYearNumber(std::string_view token) {
+  if (token.size() != 4) {
+    return false;
+  }
+  for (char c : token) {
+    if (!isDigit(c)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Transaction lines start with a date, the head column
+ * one amount column: amount
+ * two: amount, balance
+ * three or more: the last three are debit, credit, balance
+ */
+class BankStatementSchema {
+public:
+  using Document = FileTypeBankStatement;
+  enum Column : unsigned int {
+    date = 0,
+    description,
+    amount,
+    debit,
+    credit,
+    balance,
+    columnCount
+  };
+  static constexpr DocumentFieldKind fieldKind[columnCount] = {
+      DocumentFieldKind::date,   DocumentFieldKind::text,
+      DocumentFieldKind::amount, DocumentFieldKind::amount,
+      DocumentFieldKind::amount, DocumentFieldKind::amount};
+  static constexpr unsigned int headColumn = date;
+  static constexpr unsigned int textColumn = description;
+
+  static bool matchRow(const HocrWordTable &table,
+                       const std::vector<unsigned int> &wordList,
+                       unsigned int &headWords) {
+    headWords = 0;
+    int dateType = isStatementDate(table[wordList[0]].value());
+    if (dateType == 1) {
+      headWords = 1;
+    } else if (dateType == 2 && wordList.size() > 1 &&
+               isDayNumber(table[wordList[1]].value())) {
+      headWords = 2;
+      if (wordList.size() > 2 && isYearNumber(table[wordList[2]].value())) {
+        headWords = 3;
+      }
+    }
+    return headWords > 0 && wordList.size() > headWords;
+  }
+
+  static void assignBands(const DocumentLayout &layout,
+                          std::vector<unsigned char> &bandColumn) {
+    const std::vector<int> &amountBandList = layout.amountBandList;
+    std::size_t amountBands = amountBandList.size();
+    if (amountBands >= 3) {
+      bandColumn[amountBandList[amountBands - 3]] = debit;
+      bandColumn[amountBandList[amountBands - 2]] = credit;
+      bandColumn[amountBandList[amountBands - 1]] = balance;
+    } else if (amountBands == 2) {
+      bandColumn[amountBandList[0]] = amount;
+      bandColumn[amountBandList[1]] = balance;
+    } else if (amountBands == 1) {
+      bandColumn[amountBandList[0]] = amount;
+    }
+  }
+
+  static void store(FileTypeBankStatement &statement, const HocrWordTable &,
+                    const DocumentLayout &,
+                    DocumentFields<BankStatementSchema> &fields,
+                    const StatementFieldOptions &) {
+    const StatementAmountColumn &amountColumn = fields.amountList[amount],
+                                &debitColumn = fields.amountList[debit],
+                                &creditColumn = fields.amountList[credit],
+                                &balanceColumn = fields.amountList[balance];
+    const StatementDateColumn &dateColumn = fields.dateList[date];
+    for (unsigned int i = 0; i < fields.rowCount; i++) {
+      FileTypeBankStatementRow &row = statement.rowMap[i];
+      row.date = std::move(fields.textList[date][i]);
+      row.description = std::move(fields.textList[description][i]);
+      const DocumentRowBox &box = fields.boxList[i];
+      row.x0 = box.x0;
+      row.y0 = box.y0;
+      row.x1 = box.x1;
+      row.y1 = box.y1;
+      if (amountColumn.confidence[i] > 0) {
+        row.amount = amountColumn.value[i];
+        row.amountSign = amountColumn.negative[i];
+        row.amountConfidence = amountColumn.confidence[i];
+      } else if (debitColumn.confidence[i] > 0) {
+        row.amount = debitColumn.value[i];
+        row.amountSign = true;
+        row.amountConfidence = debitColumn.confidence[i];
+      } else if (creditColumn.confidence[i] > 0) {
+        row.amount = creditColumn.value[i];
+        row.amountSign = creditColumn.negative[i];
+        row.amountConfidence = creditColumn.confidence[i];
+      }
+      if (balanceColumn.confidence[i] > 0) {
+        row.balance = balanceColumn.value[i];
+        row.balanceSign = balanceColumn.negative[i];
+        row.balanceConfidence = balanceColumn.confidence[i];
+      }
+      row.dateDay = dateColumn.day[i];
+      row.dateConfidence = dateColumn.confidence[i];
+    }
+  }
+};
+
+} // namespace
+
+bool parseStatementAmount(std::string_view token, unsigned long long &value,
+                          bool &negative) {
+  return parseAmountToken(token, value, negative) > 0;
+}
+
+int isStatementDate(std::string_view token) {
+  if (isMonthName(token)) {
+    return 2;
+  }
+  char separator = 0;
+  unsigned int partList[3] = {0, 0, 0}, partDigits[3] = {0, 0, 0};
+  unsigned int partCount = 1;
+  for (char c : token) {
+    if (isDigit(c)) {
+      partList[partCount - 1] = partList[partCount - 1] * 10 + (c - '0');
+      if (++partDigits[partCount - 1] > 4) {
+        return 0;
+      }
+    } else if (c == '/' || c == '-' || c == '.') {
+      if (separator && c != separator) {
+        return 0;
+      }
+      separator = c;
+      if (partDigits[partCount - 1] == 0 || ++partCount > 3) {
+        return 0;
+      }
+    } else {
+      return 0;
+    }
+  }
+  if (partCount < 2 || partDigits[partCount - 1] == 0) {
+    return 0;
+  }
+  // year first, 2020-01-15
+  if (partDigits[0] == 4) {
+    return partCount == 3 && partDigits[1] <= 2 && partDigits[2] <= 2 &&
+                   partList[1] >= 1 && partList[1] <= 12 && partList[2] >= 1 &&
+                   partList[2] <= 31
+               ? 1
+               : 0;
+  }
+  if (partDigits[0] > 2 || partDigits[1] > 2 || partList[0] == 0 ||
+      partList[1] == 0 || partList[0] > 31 || partList[1] > 31 ||
+      (partList[0] > 12 && partList[1] > 12)) {
+    return 0;
+  }
+  if (partCount == 3 && partDigits[2] != 2 && partDigits[2] != 4) {
+    return 0;
+  }
+  return 1;
+}
+
+std::shared_ptr<FileTypeBankStatement>
+toBankStatement(std::shared_ptr<HocrWordTable> wordTable,
+                const StatementFieldOptions &options) {
+  return extractDocumentTable<BankStatementSchema>(wordTable, options);
+}
+
+} // namespace bookfiler
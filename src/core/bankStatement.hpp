@@ -0,0 +1,89 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_BANK_STATEMENT_H
+#define BOOKFILER_MODULE_RECOGNIZE_BANK_STATEMENT_H
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Local Project
+#include "../Interface.hpp"
+#include "documentLayout.hpp"
+#include "statementFields.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+class FileTypeBankStatementRow {
+public:
+  // true when the value is negative (debit, overdrawn balance)
+  bool amountSign = false, balanceSign = false;
+  // in cents
+  unsigned long long amount = 0, balance = 0;
+  std::string date, description;
+  // the catalog payee matched to the description, see PayeeMatcher
+  std::string payee;
+  // days from 1970-01-01 of the date, see parseDateColumn
+  int dateDay = 0;
+  // 0 to 1, 0 when the field could not be read
+  float dateConfidence = 0, amountConfidence = 0, balanceConfidence = 0;
+  float payeeConfidence = 0;
+  // bounding box of the words of the row, all lines included
+  unsigned int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+};
+
+class FileTypeBankStatement {
+public:
+  std::shared_ptr<HocrWordTable> wordTable;
+  // keyed by row number, top to bottom
+  std::unordered_map<unsigned int, FileTypeBankStatementRow> rowMap;
+};
+
+/* @brief Parse an amount like "$1,234.56", "(12.00)", "12.00-" or "5.00 CR"
+ * Same as parseAmountToken without the confidence.
+ * @param value cents
+ * @param negative true for parentheses, a minus sign or DR
+ * @return false if the token is not an amount
+ */
+bool parseStatementAmount(std::string_view token, unsigned long long &value,
+                          bool &negative);
+/* @brief Check if the token is a date or the month part of one
+ * "01/15", "1/15/2020", "2020-01-15", "15.01.20", "Jan"
+ * @return 1 for a full date, 2 for a month name that takes the next word as
+ * the day, 0 otherwise
+ */
+int isStatementDate(std::string_view token);
+
+/* @brief Rebuild the transaction rows of a bank statement page
+ * Words are sorted by their vertical center and swept into lines. A line
+ * starting with a date is a transaction. The column bands come from the
+ * x coverage of the transaction words, and the amount bands are the ones
+ * holding mostly amounts. Lines without amounts right below a transaction
+ * continue its description. Everything is sorting and binary searching,
+ * O(n log n) in the number of words. The amounts and dates of the rows
+ * are parsed a column at a time with parseAmountColumn and
+ * parseDateColumn. See extractDocumentTable.
+ */
+std::shared_ptr<FileTypeBankStatement>
+toBankStatement(std::shared_ptr<HocrWordTable> wordTable,
+                const StatementFieldOptions &options = StatementFieldOptions());
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_BANK_STATEMENT_H
@@ -0,0 +1,99 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_BOUNDED_QUEUE_H
+#define BOOKFILER_MODULE_RECOGNIZE_BOUNDED_QUEUE_H
+
+// c++17
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+/* Blocking FIFO between two pipeline stages.
+ * push blocks while the queue is full so a fast stage can not run ahead of
+ * a slow one by more than the capacity. After close, push fails and pop
+ * drains the remaining items before failing. tryPush and tryPop never
+ * block, for stages run as jobs that must not hold a worker waiting.
+ */
+template <typename T> class BoundedQueue {
+private:
+  std::mutex mutex;
+  std::condition_variable notFull, notEmpty;
+  std::deque<T> queue;
+  std::size_t capacity;
+  bool closed;
+
+public:
+  BoundedQueue(std::size_t capacity_)
+      : capacity(capacity_ ? capacity_ : 1), closed(false){};
+  bool push(T item) {
+    std::unique_lock<std::mutex> lock(mutex);
+    notFull.wait(lock, [this] { return closed || queue.size() < capacity; });
+    if (closed) {
+      return false;
+    }
+    queue.push_back(std::move(item));
+    notEmpty.notify_one();
+    return true;
+  }
+  bool pop(T &item) {
+    std::unique_lock<std::mutex> lock(mutex);
+    notEmpty.wait(lock, [this] { return closed || !queue.empty(); });
+    if (queue.empty()) {
+      return false;
+    }
+    item = std::move(queue.front());
+    queue.pop_front();
+    notFull.notify_one();
+    return true;
+  }
+  // item is moved only when it was pushed
+  bool tryPush(T &item) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (closed || queue.size() >= capacity) {
+      return false;
+    }
+    queue.push_back(std::move(item));
+    notEmpty.notify_one();
+    return true;
+  }
+  bool tryPop(T &item) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (queue.empty()) {
+      return false;
+    }
+    item = std::move(queue.front());
+    queue.pop_front();
+    notFull.notify_one();
+    return true;
+  }
+  bool full() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size() >= capacity;
+  }
+  void close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    notFull.notify_all();
+    notEmpty.notify_all();
+  }
+  std::size_t size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size();
+  }
+};
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_BOUNDED_QUEUE_H
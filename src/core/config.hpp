@@ -10,10 +10,29 @@
 #define BOOKFILER_RECOGNIZE_CONFIG_H
 
 #define BOOKFILER_RECOGNIZE_DEBUG 1
+/* Trace compiled in by these prints only when the debug level set at
+ * runtime with setSettings {"debug": {"level": n}} is high enough
+ */
 #define BOOKFILER_RECOGNIZE_MODEL_ADD_PATHS 1
 #define BOOKFILER_RECOGNIZE_MODEL_REQUEST_RECOGNIZE 1
-#define BOOKFILER_RECOGNIZE_MODEL_RECOGNIZE_DONE_DEBUG 0
+#define BOOKFILER_RECOGNIZE_MODEL_RECOGNIZE_DONE_DEBUG 1
 #define BOOKFILER_RECOGNIZE_MODEL_TO_STATEMENT_TABLE_DEBUG 0
 #define BOOKFILER_RECOGNIZE_MODEL_TO_STATEMENT_TABLE_DEBUG2 0
+#define BOOKFILER_RECOGNIZE_MODEL_BATCH_DEBUG 1
+#define BOOKFILER_RECOGNIZE_MODEL_PDF_DEBUG 1
+
+// Batch recognition, 0 threads uses every hardware thread
+#define BOOKFILER_RECOGNIZE_BATCH_THREADS 0
+#define BOOKFILER_RECOGNIZE_BATCH_QUEUE_CAPACITY 32
+// Pages allowed to wait between two PDF pipeline stages
+#define BOOKFILER_RECOGNIZE_PIPELINE_DEPTH 2
+// Recognized pages of a batch kept to find duplicate pages
+#define BOOKFILER_RECOGNIZE_FINGERPRINT_INDEX_PAGES 1024
+// Page fingerprints read 16 bytes at a time, the byte loop elsewhere
+#if defined(__SSE2__) || defined(_M_X64)
+#define BOOKFILER_RECOGNIZE_FINGERPRINT_SSE2 1
+#else
+#define BOOKFILER_RECOGNIZE_FINGERPRINT_SSE2 0
+#endif
 
 #endif // BOOKFILER_RECOGNIZE_CONFIG_H
@@ -0,0 +1,77 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+// c++17
+#include <array>
+
+// Local Project
+#include "documentExtractor.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+namespace {
+
+template <class Document, std::shared_ptr<Document> DocumentExtract::*member,
+          std::shared_ptr<Document> (*extractor)(std::shared_ptr<HocrWordTable>,
+                                                 const StatementFieldOptions &)>
+void extractInto(std::shared_ptr<HocrWordTable> wordTable,
+                 const StatementFieldOptions &options,
+                 DocumentExtract &result) {
+  result.*member = extractor(wordTable, options);
+}
+
+// indexed by DocumentType, a receipt is read as an invoice
+const std::array<DocumentExtractor,
+                 static_cast<unsigned int>(DocumentType::count)>
+    extractorList = {{
+        {DocumentType::general, "general", nullptr},
+        {DocumentType::bankStatement, "bankStatement",
+         &extractInto<FileTypeBankStatement, &DocumentExtract::statement,
+                      &toBankStatement>},
+        {DocumentType::invoice, "invoice",
+         &extractInto<FileTypeInvoice, &DocumentExtract::invoice,
+                      &toInvoice>},
+        {DocumentType::receipt, "receipt",
+         &extractInto<FileTypeInvoice, &DocumentExtract::invoice,
+                      &toInvoice>},
+    }};
+
+} // namespace
+
+DocumentType getDocumentType(std::string_view name) {
+  if (name.empty()) {
+    return DocumentType::bankStatement;
+  }
+  for (const DocumentExtractor &extractor : extractorList) {
+    if (name == extractor.name) {
+      return extractor.type;
+    }
+  }
+  return DocumentType::general;
+}
+
+const DocumentExtractor &getDocumentExtractor(DocumentType type) {
+  unsigned int index = static_cast<unsigned int>(type);
+  return extractorList[index < extractorList.size() ? index : 0];
+}
+
+DocumentExtract extractDocument(DocumentType type,
+                                std::shared_ptr<HocrWordTable> wordTable,
+                                const StatementFieldOptions &options) {
+  DocumentExtract result;
+  const DocumentExtractor &extractor = getDocumentExtractor(type);
+  if (extractor.extract && wordTable) {
+    extractor.extract(wordTable, options, result);
+  }
+  return result;
+}
+
+} // namespace bookfiler
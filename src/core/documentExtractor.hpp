@@ -0,0 +1,78 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_DOCUMENT_EXTRACTOR_H
+#define BOOKFILER_MODULE_RECOGNIZE_DOCUMENT_EXTRACTOR_H
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <memory>
+#include <string_view>
+
+// Local Project
+#include "../Interface.hpp"
+#include "bankStatement.hpp"
+#include "invoice.hpp"
+#include "statementFields.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+/* Document types of Ocr::setType that have an extractor, general keeps the
+ * words only
+ */
+enum class DocumentType : unsigned int {
+  general = 0,
+  bankStatement,
+  invoice,
+  receipt,
+  count
+};
+
+/* Tables read from one page, only the one of the document type is set
+ */
+class DocumentExtract {
+public:
+  std::shared_ptr<FileTypeBankStatement> statement;
+  std::shared_ptr<FileTypeInvoice> invoice;
+};
+
+/* An entry of the registry, one per document type
+ * Each extract is extractDocumentTable specialized for the schema of the
+ * type, the only call through a pointer is the one per page.
+ */
+class DocumentExtractor {
+public:
+  DocumentType type;
+  // the Ocr::setType name, also the key of setDocumentRegion
+  const char *name;
+  // null for general
+  void (*extract)(std::shared_ptr<HocrWordTable> wordTable,
+                  const StatementFieldOptions &options,
+                  DocumentExtract &result);
+};
+
+/* @return the type of an Ocr::setType name, bankStatement when empty as
+ * every page was one before the types, general for the types without an
+ * extractor
+ */
+DocumentType getDocumentType(std::string_view name);
+const DocumentExtractor &getDocumentExtractor(DocumentType type);
+// @brief Read the tables of the page with the extractor of the type
+DocumentExtract extractDocument(DocumentType type,
+                                std::shared_ptr<HocrWordTable> wordTable,
+                                const StatementFieldOptions &options);
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_DOCUMENT_EXTRACTOR_H
@@ -0,0 +1,351 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+// c++17
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+/* boost 1.72.0
+ * License: Boost Software License (similar to BSD and MIT)
+ */
+#include <boost/endian/conversion.hpp>
+#include <boost/filesystem.hpp>
+
+// Local Project
+#include "documentFile.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+namespace {
+
+const char documentFileMagic[4] = {'B', 'F', 'D', 'C'};
+const unsigned int documentColumnCount =
+    static_cast<unsigned int>(DocumentColumn::count);
+const std::size_t headerBytes = 4 * sizeof(uint32_t);
+const std::size_t directoryBytes = documentColumnCount * 2 * sizeof(uint64_t);
+constexpr bool nativeLittleEndian =
+    boost::endian::order::native == boost::endian::order::little;
+
+std::size_t getEntryBytes(DocumentColumn column) {
+  switch (column) {
+  case DocumentColumn::rowAmount:
+  case DocumentColumn::rowBalance:
+    return sizeof(uint64_t);
+  case DocumentColumn::confidence:
+    return sizeof(float);
+  case DocumentColumn::stringArena:
+    return 1;
+  default:
+    return sizeof(uint32_t);
+  }
+}
+
+std::size_t alignUp(std::size_t offset) {
+  return (offset + 7) & ~std::size_t(7);
+}
+
+/* Columns of the whole document before they are written
+ */
+class DocumentColumns {
+public:
+  std::vector<uint32_t> pageNum, pageWordEnd, pageLineEnd, pageRowEnd;
+  std::vector<uint32_t> x0, y0, x1, y1, valueIndex, lineEnd;
+  std::vector<float> confidence;
+  std::vector<uint64_t> rowAmount, rowBalance;
+  std::vector<uint32_t> rowFlags, rowDateIndex, rowDescriptionIndex, rowX0,
+      rowY0, rowX1, rowY1;
+  std::vector<uint32_t> stringOffset, stringLength;
+  std::string stringArena;
+
+  uint32_t addString(std::string_view value) {
+    uint32_t index = static_cast<uint32_t>(stringOffset.size());
+    stringOffset.push_back(static_cast<uint32_t>(stringArena.size()));
+    stringLength.push_back(static_cast<uint32_t>(value.size()));
+    stringArena.append(value.data(), value.size());
+    return index;
+  }
+  void addPage(const DocumentPage &page);
+  // pointer and entry count of a column
+  std::pair<const char *, std::size_t> get(DocumentColumn column) const;
+};
+
+void DocumentColumns::addPage(const DocumentPage &page) {
+  pageNum.push_back(page.pageNum);
+  const HocrWordTable *table = page.wordTable.get();
+  if (table) {
+    uint32_t wordBase = static_cast<uint32_t>(x0.size());
+    x0.insert(x0.end(), table->x0.begin(), table->x0.end());
+    y0.insert(y0.end(), table->y0.begin(), table->y0.end());
+    x1.insert(x1.end(), table->x1.begin(), table->x1.end());
+    y1.insert(y1.end(), table->y1.begin(), table->y1.end());
+    confidence.insert(confidence.end(), table->confidence.begin(),
+                      table->confidence.end());
+    for (unsigned int end : table->lineEnd) {
+      lineEnd.push_back(wordBase + end);
+    }
+    /* Only the word values are kept, the page string table holds the ids
+     * too. Values are interned by the parser so each is copied once.
+     */
+    std::vector<uint32_t> stringMap(table->stringOffset.size(), UINT32_MAX);
+    for (unsigned int index : table->valueIndex) {
+      if (stringMap[index] == UINT32_MAX) {
+        stringMap[index] = addString(table->getString(index));
+      }
+      valueIndex.push_back(stringMap[index]);
+    }
+  }
+  pageWordEnd.push_back(static_cast<uint32_t>(x0.size()));
+  pageLineEnd.push_back(static_cast<uint32_t>(lineEnd.size()));
+  if (page.statement) {
+    std::vector<unsigned int> rowNumList;
+    rowNumList.reserve(page.statement->rowMap.size());
+    for (auto &rowPair : page.statement->rowMap) {
+      rowNumList.push_back(rowPair.first);
+    }
+    std::sort(rowNumList.begin(), rowNumList.end());
+    for (unsigned int rowNum : rowNumList) {
+      const FileTypeBankStatementRow &row = page.statement->rowMap.at(rowNum);
+      rowAmount.push_back(row.amount);
+      rowBalance.push_back(row.balance);
+      rowFlags.push_back((row.amountSign ? 1u : 0u) |
+                         (row.balanceSign ? 2u : 0u));
+      rowDateIndex.push_back(addString(row.date));
+      rowDescriptionIndex.push_back(addString(row.description));
+      rowX0.push_back(row.x0);
+      rowY0.push_back(row.y0);
+      rowX1.push_back(row.x1);
+      rowY1.push_back(row.y1);
+    }
+  }
+  pageRowEnd.push_back(static_cast<uint32_t>(rowAmount.size()));
+}
+
+template <typename T>
+std::pair<const char *, std::size_t> columnPair(const std::vector<T> &column) {
+  return {reinterpret_cast<const char *>(column.data()), column.size()};
+}
+
+std::pair<const char *, std::size_t>
+DocumentColumns::get(DocumentColumn column) const {
+  switch (column) {
+  case DocumentColumn::pageNum:
+    return columnPair(pageNum);
+  case DocumentColumn::pageWordEnd:
+    return columnPair(pageWordEnd);
+  case DocumentColumn::pageLineEnd:
+    return columnPair(pageLineEnd);
+  case DocumentColumn::pageRowEnd:
+    return columnPair(pageRowEnd);
+  case DocumentColumn::x0:
+    return columnPair(x0);
+  case DocumentColumn::y0:
+    return columnPair(y0);
+  case DocumentColumn::x1:
+    return columnPair(x1);
+  case DocumentColumn::y1:
+    return columnPair(y1);
+  case DocumentColumn::confidence:
+    return columnPair(confidence);
+  case DocumentColumn::valueIndex:
+    return columnPair(valueIndex);
+  case DocumentColumn::lineEnd:
+    return columnPair(lineEnd);
+  case DocumentColumn::rowAmount:
+    return columnPair(rowAmount);
+  case DocumentColumn::rowBalance:
+    return columnPair(rowBalance);
+  case DocumentColumn::rowFlags:
+    return columnPair(rowFlags);
+  case DocumentColumn::rowDateIndex:
+    return columnPair(rowDateIndex);
+  case DocumentColumn::rowDescriptionIndex:
+    return columnPair(rowDescriptionIndex);
+  case DocumentColumn::rowX0:
+    return columnPair(rowX0);
+  case DocumentColumn::rowY0:
+    return columnPair(rowY0);
+  case DocumentColumn::rowX1:
+    return columnPair(rowX1);
+  case DocumentColumn::rowY1:
+    return columnPair(rowY1);
+  case DocumentColumn::stringOffset:
+    return columnPair(stringOffset);
+  case DocumentColumn::stringLength:
+    return columnPair(stringLength);
+  case DocumentColumn::stringArena:
+    return {stringArena.data(), stringArena.size()};
+  default:
+    return {nullptr, 0};
+  }
+}
+
+// entries [0, count) of a page column are monotone and at most limit
+bool checkEnds(const uint32_t *endList, std::size_t count, std::size_t limit) {
+  uint32_t last = 0;
+  for (std::size_t i = 0; i < count; i++) {
+    if (endList[i] < last || endList[i] > limit) {
+      return false;
+    }
+    last = endList[i];
+  }
+  return count == 0 || last == limit;
+}
+
+} // namespace
+
+bool writeDocumentFile(const std::string &filePath,
+                       const std::string &sourcePath,
+                       const std::vector<DocumentPage> &pageList) {
+  if (!nativeLittleEndian) {
+    return false;
+  }
+  DocumentColumns columns;
+  uint32_t sourcePathIndex = columns.addString(sourcePath);
+  for (const DocumentPage &page : pageList) {
+    columns.addPage(page);
+  }
+  // lay the columns out after the directory, each 8 byte aligned
+  uint64_t directory[documentColumnCount * 2];
+  std::size_t offset = headerBytes + directoryBytes;
+  for (unsigned int i = 0; i < documentColumnCount; i++) {
+    DocumentColumn column = static_cast<DocumentColumn>(i);
+    offset = alignUp(offset);
+    directory[i * 2] = offset;
+    directory[i * 2 + 1] = columns.get(column).second;
+    offset += columns.get(column).second * getEntryBytes(column);
+  }
+  std::string tempPath = filePath + ".tmp";
+  {
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      return false;
+    }
+    uint32_t header[4] = {0, documentFileVersion, documentColumnCount,
+                          sourcePathIndex};
+    std::memcpy(&header[0], documentFileMagic, 4);
+    file.write(reinterpret_cast<const char *>(header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(directory), sizeof(directory));
+    const char padding[8] = {0};
+    std::size_t position = headerBytes + directoryBytes;
+    for (unsigned int i = 0; i < documentColumnCount; i++) {
+      DocumentColumn column = static_cast<DocumentColumn>(i);
+      file.write(padding, directory[i * 2] - position);
+      std::pair<const char *, std::size_t> data = columns.get(column);
+      std::size_t bytes = data.second * getEntryBytes(column);
+      file.write(data.first, bytes);
+      position = directory[i * 2] + bytes;
+    }
+    if (!file) {
+      return false;
+    }
+  }
+  boost::system::error_code ec;
+  boost::filesystem::rename(tempPath, filePath, ec);
+  return !ec;
+}
+
+bool DocumentFileView::open(const std::string &filePath) {
+  close();
+  if (!nativeLittleEndian) {
+    return false;
+  }
+  try {
+    mapping = std::make_unique<boost::interprocess::file_mapping>(
+        filePath.c_str(), boost::interprocess::read_only);
+    region = std::make_unique<boost::interprocess::mapped_region>(
+        *mapping, boost::interprocess::read_only);
+  } catch (...) {
+    close();
+    return false;
+  }
+  const char *data = static_cast<const char *>(region->get_address());
+  std::size_t fileBytes = region->get_size();
+  uint32_t header[4];
+  if (fileBytes < headerBytes + directoryBytes ||
+      std::memcmp(data, documentFileMagic, 4) != 0) {
+    close();
+    return false;
+  }
+  std::memcpy(header, data, headerBytes);
+  if (header[1] != documentFileVersion || header[2] != documentColumnCount) {
+    close();
+    return false;
+  }
+  uint64_t directory[documentColumnCount * 2];
+  std::memcpy(directory, data + headerBytes, directoryBytes);
+  for (unsigned int i = 0; i < documentColumnCount; i++) {
+    uint64_t offset = directory[i * 2], count = directory[i * 2 + 1];
+    std::size_t entryBytes = getEntryBytes(static_cast<DocumentColumn>(i));
+    if (offset % 8 != 0 || offset > fileBytes ||
+        count > (fileBytes - offset) / entryBytes) {
+      close();
+      return false;
+    }
+    columnData[i] = data + offset;
+    columnCount[i] = static_cast<std::size_t>(count);
+  }
+  /* Only the sizes and the page columns are checked, nothing that grows
+   * with the words. getString checks its own bounds.
+   */
+  std::size_t pageCount = getPageCount(), wordCount = getWordCount(),
+              rowCount = getRowCount();
+  bool valid =
+      size(DocumentColumn::pageWordEnd) == pageCount &&
+      size(DocumentColumn::pageLineEnd) == pageCount &&
+      size(DocumentColumn::pageRowEnd) == pageCount &&
+      size(DocumentColumn::stringLength) == getStringCount() &&
+      checkEnds(column<uint32_t>(DocumentColumn::pageWordEnd), pageCount,
+                wordCount) &&
+      checkEnds(column<uint32_t>(DocumentColumn::pageLineEnd), pageCount,
+                getLineCount()) &&
+      checkEnds(column<uint32_t>(DocumentColumn::pageRowEnd), pageCount,
+                rowCount);
+  for (unsigned int i = static_cast<unsigned int>(DocumentColumn::y0);
+       valid && i <= static_cast<unsigned int>(DocumentColumn::valueIndex);
+       i++) {
+    valid = columnCount[i] == wordCount;
+  }
+  for (unsigned int i = static_cast<unsigned int>(DocumentColumn::rowBalance);
+       valid && i <= static_cast<unsigned int>(DocumentColumn::rowY1); i++) {
+    valid = columnCount[i] == rowCount;
+  }
+  if (!valid) {
+    close();
+    return false;
+  }
+  sourcePathIndex = header[3];
+  return true;
+}
+
+void DocumentFileView::close() {
+  region.reset();
+  mapping.reset();
+  sourcePathIndex = 0;
+  columnData.fill(nullptr);
+  columnCount.fill(0);
+}
+
+std::string_view DocumentFileView::getString(unsigned int index) const {
+  if (index >= getStringCount()) {
+    return std::string_view();
+  }
+  std::size_t offset = column<uint32_t>(DocumentColumn::stringOffset)[index],
+              length = column<uint32_t>(DocumentColumn::stringLength)[index],
+              arenaBytes = size(DocumentColumn::stringArena);
+  if (offset > arenaBytes || length > arenaBytes - offset) {
+    return std::string_view();
+  }
+  return std::string_view(column<char>(DocumentColumn::stringArena) + offset,
+                          length);
+}
+
+} // namespace bookfiler
@@ -0,0 +1,150 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_DOCUMENT_FILE_H
+#define BOOKFILER_MODULE_RECOGNIZE_DOCUMENT_FILE_H
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* boost 1.72.0
+ * License: Boost Software License (similar to BSD and MIT)
+ */
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+// Local Project
+#include "../Interface.hpp"
+#include "bankStatement.hpp"
+#include "invoice.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+/* One recognized page of a document, the statement and invoice may be null
+ */
+class DocumentPage {
+public:
+  unsigned int pageNum = 0;
+  std::shared_ptr<HocrWordTable> wordTable;
+  std::shared_ptr<FileTypeBankStatement> statement;
+  // written to the JSON only, the binary format keeps the statement
+  std::shared_ptr<FileTypeInvoice> invoice;
+};
+
+/* Columns of a document file, in file order
+ * The page columns hold one entry per page, the *End columns are one past
+ * the last word, line or row of the page, so page i is [End[i-1], End[i]).
+ * lineEnd indexes the document wide word columns.
+ */
+enum class DocumentColumn : unsigned int {
+  pageNum = 0,
+  pageWordEnd,
+  pageLineEnd,
+  pageRowEnd,
+  x0,
+  y0,
+  x1,
+  y1,
+  confidence,
+  valueIndex,
+  lineEnd,
+  rowAmount,
+  rowBalance,
+  // bit 0 amountSign, bit 1 balanceSign
+  rowFlags,
+  rowDateIndex,
+  rowDescriptionIndex,
+  rowX0,
+  rowY0,
+  rowX1,
+  rowY1,
+  stringOffset,
+  stringLength,
+  stringArena,
+  count
+};
+
+/* Recognized document file, little endian
+ * header: "BFDC", version, columnCount, sourcePathIndex (four 32 bit words)
+ * directory: offset, entry count (two 64 bit words) per column
+ * columns: each starts on an 8 byte boundary, u64 for the row amounts,
+ *          f32 for the confidence, bytes for the arena, u32 otherwise
+ * Words and rows of every page are concatenated, rows sorted top to bottom
+ * within a page. The string indices point into one document wide table.
+ */
+const unsigned int documentFileVersion = 1;
+
+/* @brief Write the pages to filePath through a temporary file so readers
+ * never see a partial file
+ * @param sourcePath the recognized PDF or image, stored in the file
+ * @return false on error
+ */
+bool writeDocumentFile(const std::string &filePath,
+                       const std::string &sourcePath,
+                       const std::vector<DocumentPage> &pageList);
+
+/* Read only view of a document file
+ * The file is mapped and the columns are used in place, open() only checks
+ * the header and that every column lies inside the file.
+ * DocumentFileView view;
+ * if (view.open(path)) {
+ *   const uint32_t *x0 = view.column<uint32_t>(DocumentColumn::x0);
+ * }
+ */
+class DocumentFileView {
+private:
+  std::unique_ptr<boost::interprocess::file_mapping> mapping;
+  std::unique_ptr<boost::interprocess::mapped_region> region;
+  unsigned int sourcePathIndex = 0;
+  std::array<const char *, static_cast<unsigned int>(DocumentColumn::count)>
+      columnData{};
+  std::array<std::size_t, static_cast<unsigned int>(DocumentColumn::count)>
+      columnCount{};
+
+public:
+  /* @brief Map the file, closing the one open before
+   * @return false if the file is missing, truncated or another version
+   */
+  bool open(const std::string &filePath);
+  void close();
+  bool isOpen() const { return region != nullptr; }
+  // entry count of a column
+  std::size_t size(DocumentColumn column) const {
+    return columnCount[static_cast<unsigned int>(column)];
+  }
+  template <typename T> const T *column(DocumentColumn column) const {
+    return reinterpret_cast<const T *>(
+        columnData[static_cast<unsigned int>(column)]);
+  }
+  std::size_t getPageCount() const { return size(DocumentColumn::pageNum); }
+  std::size_t getWordCount() const { return size(DocumentColumn::x0); }
+  std::size_t getLineCount() const { return size(DocumentColumn::lineEnd); }
+  std::size_t getRowCount() const { return size(DocumentColumn::rowAmount); }
+  std::size_t getStringCount() const {
+    return size(DocumentColumn::stringOffset);
+  }
+  // @return the string, empty if the index or its bounds are out of range
+  std::string_view getString(unsigned int index) const;
+  std::string_view getSourcePath() const { return getString(sourcePathIndex); }
+};
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_DOCUMENT_FILE_H
@@ -0,0 +1,216 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+// c++17
+#include <algorithm>
+#include <cstdio>
+
+/* boost 1.72.0
+ * License: Boost Software License (similar to BSD and MIT)
+ */
+#include <boost/filesystem.hpp>
+
+/* rapidjson v1.1 (2016-8-25)
+ * Developed by Tencent
+ * License: MITs
+ */
+#include <rapidjson/filewritestream.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+// Local Project
+#include "documentJson.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+namespace {
+
+template <typename Writer>
+void writeString(Writer &writer, std::string_view value) {
+  writer.String(value.data(), static_cast<rapidjson::SizeType>(value.size()));
+}
+
+template <typename Writer>
+void writeSigned(Writer &writer, unsigned long long value, bool negative) {
+  long long signedValue = static_cast<long long>(value);
+  writer.Int64(negative ? -signedValue : signedValue);
+}
+
+template <typename Writer>
+void writeInvoice(Writer &writer, const FileTypeInvoice &invoice) {
+  writer.Key("invoice");
+  writer.StartObject();
+  writer.Key("number");
+  writeString(writer, invoice.number);
+  writer.Key("date");
+  writeString(writer, invoice.date);
+  writer.Key("subtotal");
+  writer.Uint64(invoice.subtotal);
+  writer.Key("tax");
+  writer.Uint64(invoice.tax);
+  writer.Key("total");
+  writer.Uint64(invoice.total);
+  writer.Key("items");
+  writer.StartArray();
+  for (unsigned int rowNum = 0; rowNum < invoice.rowMap.size(); rowNum++) {
+    auto rowIt = invoice.rowMap.find(rowNum);
+    if (rowIt == invoice.rowMap.end()) {
+      continue;
+    }
+    const FileTypeInvoiceRow &row = rowIt->second;
+    writer.StartObject();
+    writer.Key("description");
+    writeString(writer, row.description);
+    writer.Key("quantity");
+    writer.Uint64(row.quantity);
+    writer.Key("unitPrice");
+    writer.Uint64(row.unitPrice);
+    writer.Key("amount");
+    writeSigned(writer, row.amount, row.amountSign);
+    writer.Key("x0");
+    writer.Uint(row.x0);
+    writer.Key("y0");
+    writer.Uint(row.y0);
+    writer.Key("x1");
+    writer.Uint(row.x1);
+    writer.Key("y1");
+    writer.Uint(row.y1);
+    writer.EndObject();
+  }
+  writer.EndArray();
+  writer.EndObject();
+}
+
+template <typename Writer>
+void writePage(Writer &writer, const DocumentPage &page) {
+  writer.StartObject();
+  writer.Key("page");
+  writer.Uint(page.pageNum);
+  writer.Key("words");
+  writer.StartArray();
+  const HocrWordTable *table = page.wordTable.get();
+  if (table) {
+    for (std::size_t i = 0; i < table->size(); i++) {
+      writer.StartObject();
+      writer.Key("text");
+      writeString(writer, table->getString(table->valueIndex[i]));
+      writer.Key("x0");
+      writer.Uint(table->x0[i]);
+      writer.Key("y0");
+      writer.Uint(table->y0[i]);
+      writer.Key("x1");
+      writer.Uint(table->x1[i]);
+      writer.Key("y1");
+      writer.Uint(table->y1[i]);
+      writer.Key("confidence");
+      writer.Double(table->confidence[i]);
+      writer.EndObject();
+    }
+  }
+  writer.EndArray();
+  writer.Key("lines");
+  writer.StartArray();
+  if (table) {
+    for (unsigned int end : table->lineEnd) {
+      writer.Uint(end);
+    }
+  }
+  writer.EndArray();
+  writer.Key("rows");
+  writer.StartArray();
+  if (page.statement) {
+    std::vector<unsigned int> rowNumList;
+    rowNumList.reserve(page.statement->rowMap.size());
+    for (auto &rowPair : page.statement->rowMap) {
+      rowNumList.push_back(rowPair.first);
+    }
+    std::sort(rowNumList.begin(), rowNumList.end());
+    for (unsigned int rowNum : rowNumList) {
+      const FileTypeBankStatementRow &row = page.statement->rowMap.at(rowNum);
+      writer.StartObject();
+      writer.Key("date");
+      writeString(writer, row.date);
+      writer.Key("description");
+      writeString(writer, row.description);
+      writer.Key("payee");
+      writeString(writer, row.payee);
+      writer.Key("amount");
+      writeSigned(writer, row.amount, row.amountSign);
+      writer.Key("balance");
+      writeSigned(writer, row.balance, row.balanceSign);
+      writer.Key("x0");
+      writer.Uint(row.x0);
+      writer.Key("y0");
+      writer.Uint(row.y0);
+      writer.Key("x1");
+      writer.Uint(row.x1);
+      writer.Key("y1");
+      writer.Uint(row.y1);
+      writer.EndObject();
+    }
+  }
+  writer.EndArray();
+  if (page.invoice) {
+    writeInvoice(writer, *page.invoice);
+  }
+  writer.EndObject();
+}
+
+template <typename Writer>
+void writeDocument(Writer &writer, const std::string &sourcePath,
+                   const std::vector<DocumentPage> &pageList) {
+  writer.StartObject();
+  writer.Key("file");
+  writeString(writer, sourcePath);
+  writer.Key("pages");
+  writer.StartArray();
+  for (const DocumentPage &page : pageList) {
+    writePage(writer, page);
+  }
+  writer.EndArray();
+  writer.EndObject();
+}
+
+} // namespace
+
+std::string writeDocumentJson(const std::string &sourcePath,
+                              const std::vector<DocumentPage> &pageList) {
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+  writeDocument(writer, sourcePath, pageList);
+  return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+bool writeDocumentJsonFile(const std::string &filePath,
+                           const std::string &sourcePath,
+                           const std::vector<DocumentPage> &pageList) {
+  std::string tempPath = filePath + ".tmp";
+  std::FILE *file = std::fopen(tempPath.c_str(), "wb");
+  if (!file) {
+    return false;
+  }
+  {
+    char buffer[65536];
+    rapidjson::FileWriteStream stream(file, buffer, sizeof(buffer));
+    rapidjson::Writer<rapidjson::FileWriteStream> writer(stream);
+    writeDocument(writer, sourcePath, pageList);
+    stream.Flush();
+  }
+  bool failed = std::ferror(file) != 0;
+  if (std::fclose(file) != 0 || failed) {
+    return false;
+  }
+  boost::system::error_code ec;
+  boost::filesystem::rename(tempPath, filePath, ec);
+  return !ec;
+}
+
+} // namespace bookfiler
@@ -0,0 +1,50 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_DOCUMENT_JSON_H
+#define BOOKFILER_MODULE_RECOGNIZE_DOCUMENT_JSON_H
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <string>
+#include <vector>
+
+// Local Project
+#include "documentFile.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+/* Recognized document as JSON, written with a rapidjson Writer straight to
+ * the output without building a Document
+ * {"file": "", "pages": [{"page": 0,
+ *   "words": [{"text", "x0", "y0", "x1", "y1", "confidence"}],
+ *   "lines": [one past the last word of each line, in the page],
+ *   "rows": [{"date", "description", "payee", "amount", "balance",
+ *             "x0", "y0", "x1", "y1"}]}]}
+ * Amounts are signed cents.
+ */
+
+// @return the JSON text
+std::string writeDocumentJson(const std::string &sourcePath,
+                              const std::vector<DocumentPage> &pageList);
+/* @brief Write the JSON to filePath through a temporary file
+ * @return false on error
+ */
+bool writeDocumentJsonFile(const std::string &filePath,
+                           const std::string &sourcePath,
+                           const std::vector<DocumentPage> &pageList);
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_DOCUMENT_JSON_H
@@ -0,0 +1,165 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+// c++17
+#include <algorithm>
+
+// Local Project
+#include "documentLayout.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+bool hasAmountCents(std::string_view token) {
+  // past the sign, parentheses and "CR" or "DR"
+  while (!token.empty() && (token.back() < '0' || token.back() > '9')) {
+    token.remove_suffix(1);
+  }
+  std::size_t digits = 0;
+  while (digits < token.size() && digits < 3) {
+    char c = token[token.size() - 1 - digits];
+    if (c < '0' || c > '9') {
+      break;
+    }
+    digits++;
+  }
+  if (digits == 0 || digits > 2 || digits == token.size()) {
+    return false;
+  }
+  char separator = token[token.size() - 1 - digits];
+  return separator == '.' || separator == ',';
+}
+
+void DocumentLayout::findLines(const HocrWordTable &table) {
+  const unsigned int wordCount = static_cast<unsigned int>(table.size());
+  lineList.clear();
+  if (wordCount == 0) {
+    return;
+  }
+  std::vector<unsigned int> heightList(wordCount);
+  for (unsigned int i = 0; i < wordCount; i++) {
+    heightList[i] = table.y1[i] > table.y0[i] ? table.y1[i] - table.y0[i] : 0;
+  }
+  std::nth_element(heightList.begin(), heightList.begin() + wordCount / 2,
+                   heightList.end());
+  medianHeight = std::max(1u, heightList[wordCount / 2]);
+
+  std::vector<unsigned int> orderList(wordCount);
+  for (unsigned int i = 0; i < wordCount; i++) {
+    orderList[i] = i;
+  }
+  std::sort(orderList.begin(), orderList.end(),
+            [&table](unsigned int a, unsigned int b) {
+              unsigned int centerA = table.y0[a] + table.y1[a];
+              unsigned int centerB = table.y0[b] + table.y1[b];
+              return centerA != centerB ? centerA < centerB
+                                        : table.x0[a] < table.x0[b];
+            });
+  unsigned int bandY0 = 0, bandY1 = 0;
+  for (unsigned int index : orderList) {
+    unsigned int center2 = table.y0[index] + table.y1[index];
+    if (lineList.empty() || center2 > bandY1 * 2 || center2 < bandY0 * 2) {
+      lineList.emplace_back();
+      bandY0 = table.y0[index];
+      bandY1 = table.y1[index];
+      lineList.back().y0 = bandY0;
+      lineList.back().y1 = bandY1;
+    }
+    DocumentLine &line = lineList.back();
+    line.wordList.push_back(index);
+    line.y0 = std::min(line.y0, table.y0[index]);
+    line.y1 = std::max(line.y1, table.y1[index]);
+  }
+  for (DocumentLine &line : lineList) {
+    std::sort(line.wordList.begin(), line.wordList.end(),
+              [&table](unsigned int a, unsigned int b) {
+                return table.x0[a] < table.x0[b];
+              });
+  }
+}
+
+void DocumentLayout::findBands(const HocrWordTable &table) {
+  bandList.clear();
+  amountBandList.clear();
+  std::vector<std::pair<unsigned int, int>> eventList;
+  for (const DocumentLine &line : lineList) {
+    if (!line.row) {
+      continue;
+    }
+    for (std::size_t i = line.headWords; i < line.wordList.size(); i++) {
+      unsigned int index = line.wordList[i];
+      eventList.push_back({table.x0[index], 1});
+      eventList.push_back({std::max(table.x1[index], table.x0[index] + 1), -1});
+    }
+  }
+  std::sort(eventList.begin(), eventList.end());
+  int threshold = std::max(1, static_cast<int>(rowLineCount / 10));
+  int coverage = 0;
+  for (const auto &event : eventList) {
+    int before = coverage;
+    coverage += event.second;
+    if (before < threshold && coverage >= threshold) {
+      if (!bandList.empty() &&
+          event.first <= bandList.back().x1 + medianHeight / 2) {
+        // small gap, same column
+        continue;
+      }
+      bandList.emplace_back();
+      bandList.back().x0 = event.first;
+    } else if (before >= threshold && coverage < threshold) {
+      bandList.back().x1 = event.first;
+    }
+  }
+
+  // amount columns hold mostly amounts
+  unsigned long long value;
+  bool negative;
+  for (const DocumentLine &line : lineList) {
+    if (!line.row) {
+      continue;
+    }
+    for (std::size_t i = line.headWords; i < line.wordList.size(); i++) {
+      int band = findBand(table, line.wordList[i]);
+      if (band < 0) {
+        continue;
+      }
+      std::string_view text = table[line.wordList[i]].value();
+      bandList[band].wordCount++;
+      if (parseAmountToken(text, value, negative) > 0) {
+        bandList[band].amountCount++;
+        bandList[band].wholeCount += !hasAmountCents(text);
+      }
+    }
+  }
+  for (std::size_t i = 0; i < bandList.size(); i++) {
+    DocumentColumnBand &band = bandList[i];
+    band.isAmount = band.wordCount * 4 >= rowLineCount &&
+                    band.amountCount * 10 >= band.wordCount * 6;
+    if (band.isAmount) {
+      amountBandList.push_back(static_cast<int>(i));
+    }
+  }
+}
+
+int DocumentLayout::findBand(const HocrWordTable &table,
+                             unsigned int index) const {
+  unsigned int center = (table.x0[index] + table.x1[index]) / 2;
+  auto it = std::upper_bound(bandList.begin(), bandList.end(), center,
+                             [](unsigned int x, const DocumentColumnBand &b) {
+                               return x < b.x0;
+                             });
+  if (it == bandList.begin()) {
+    return -1;
+  }
+  --it;
+  return center <= it->x1 ? static_cast<int>(it - bandList.begin()) : -1;
+}
+
+} // namespace bookfiler
@@ -0,0 +1,270 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_DOCUMENT_LAYOUT_H
+#define BOOKFILER_MODULE_RECOGNIZE_DOCUMENT_LAYOUT_H
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Local Project
+#include "../Interface.hpp"
+#include "statementFields.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+/* What a column of a document table holds, each kind has one parser
+ * text is kept as read, amount goes through parseAmountColumn and date
+ * through parseDateColumn.
+ */
+enum class DocumentFieldKind : unsigned int { text = 0, amount, date };
+
+/* A line of the page, words sorted left to right
+ */
+class DocumentLine {
+public:
+  std::vector<unsigned int> wordList;
+  unsigned int y0 = 0, y1 = 0;
+  // a row of the table, its headWords leading words are the head column
+  bool row = false;
+  unsigned int headWords = 0;
+};
+
+/* A horizontal band of the page holding one column of the table
+ */
+class DocumentColumnBand {
+public:
+  unsigned int x0 = 0, x1 = 0;
+  // words of row lines whose center falls in the band
+  unsigned int wordCount = 0, amountCount = 0;
+  // amounts written without cents, "2" or "1,200"
+  unsigned int wholeCount = 0;
+  bool isAmount = false;
+};
+
+/* Bounding box of the words of a row, all lines included
+ */
+class DocumentRowBox {
+public:
+  unsigned int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+};
+
+/* Lines and column bands of a page, shared by every extractor
+ */
+class DocumentLayout {
+public:
+  // median word height, the unit of every tolerance
+  unsigned int medianHeight = 1;
+  std::vector<DocumentLine> lineList;
+  std::vector<DocumentColumnBand> bandList;
+  // indices of the amount bands, left to right
+  std::vector<int> amountBandList;
+  unsigned int rowLineCount = 0;
+
+  /* @brief Sweep the words by vertical center into lines
+   * A word belongs to the current line while its center is inside the
+   * band of the word that opened the line.
+   */
+  void findLines(const HocrWordTable &table);
+  /* @brief Column bands from the x coverage of the row words past their
+   * head, the amount bands hold mostly amounts
+   * A column is a run where enough row lines have a word, so one long
+   * description does not join two columns.
+   */
+  void findBands(const HocrWordTable &table);
+  // @return the band holding the center of the word, -1 if none
+  int findBand(const HocrWordTable &table, unsigned int index) const;
+};
+
+// @return true if the amount ends in one or two decimals, "12.00-" or "5,5"
+bool hasAmountCents(std::string_view token);
+
+/* Text of the columns of every row, then the parsed fields
+ * Only the entries of the kind of each column are filled.
+ */
+template <class Schema> class DocumentFields {
+public:
+  unsigned int rowCount = 0;
+  std::array<std::vector<std::string>, Schema::columnCount> textList;
+  std::array<StatementAmountColumn, Schema::columnCount> amountList;
+  std::array<StatementDateColumn, Schema::columnCount> dateList;
+  std::vector<DocumentRowBox> boxList;
+};
+
+// columns whose words are joined with a space, the amounts are not
+template <class Schema>
+constexpr std::array<bool, Schema::columnCount> getSpacedColumns() {
+  std::array<bool, Schema::columnCount> spaced{};
+  for (unsigned int column = 0; column < Schema::columnCount; column++) {
+    spaced[column] = Schema::fieldKind[column] != DocumentFieldKind::amount;
+  }
+  return spaced;
+}
+
+template <class Schema, unsigned int column>
+void parseDocumentColumn(DocumentFields<Schema> &fields,
+                         const StatementFieldOptions &options,
+                         std::vector<std::string_view> &tokenList) {
+  constexpr DocumentFieldKind kind = Schema::fieldKind[column];
+  if constexpr (kind != DocumentFieldKind::text) {
+    const std::vector<std::string> &textList = fields.textList[column];
+    tokenList.assign(textList.begin(), textList.end());
+    if constexpr (kind == DocumentFieldKind::amount) {
+      parseAmountColumn(tokenList, fields.amountList[column]);
+    } else {
+      parseDateColumn(tokenList, options, fields.dateList[column]);
+    }
+  }
+}
+
+template <class Schema, unsigned int... column>
+void parseDocumentColumns(DocumentFields<Schema> &fields,
+                          const StatementFieldOptions &options,
+                          std::integer_sequence<unsigned int, column...>) {
+  std::vector<std::string_view> tokenList;
+  (parseDocumentColumn<Schema, column>(fields, options, tokenList), ...);
+}
+
+/* @brief Collect the text of the row lines column by column
+ * The head words go to Schema::headColumn, the others to the column of
+ * their band and the words outside a column to Schema::textColumn. A line
+ * without amounts right below a row continues its text column.
+ */
+template <class Schema>
+void fillDocumentFields(const HocrWordTable &table,
+                        const DocumentLayout &layout,
+                        const std::vector<unsigned char> &bandColumn,
+                        DocumentFields<Schema> &fields) {
+  static constexpr std::array<bool, Schema::columnCount> spaced =
+      getSpacedColumns<Schema>();
+  for (std::vector<std::string> &textList : fields.textList) {
+    textList.resize(layout.rowLineCount);
+  }
+  fields.boxList.resize(layout.rowLineCount);
+  auto append = [&fields](unsigned int column, unsigned int rowIndex,
+                          std::string_view text) {
+    std::string &field = fields.textList[column][rowIndex];
+    // "$" "12.00" or "12.00" "CR" are split by the OCR
+    if (spaced[column] && !field.empty()) {
+      field += ' ';
+    }
+    field.append(text.data(), text.size());
+  };
+  auto extendBox = [&table](DocumentRowBox &box, unsigned int index) {
+    box.x0 = std::min(box.x0, table.x0[index]);
+    box.y0 = std::min(box.y0, table.y0[index]);
+    box.x1 = std::max(box.x1, table.x1[index]);
+    box.y1 = std::max(box.y1, table.y1[index]);
+  };
+  bool inRow = false;
+  unsigned int lastY1 = 0;
+  for (const DocumentLine &line : layout.lineList) {
+    if (line.row) {
+      unsigned int rowIndex = fields.rowCount++;
+      DocumentRowBox &box = fields.boxList[rowIndex];
+      unsigned int first = line.wordList[0];
+      box.x0 = table.x0[first];
+      box.y0 = table.y0[first];
+      box.x1 = table.x1[first];
+      box.y1 = table.y1[first];
+      for (std::size_t i = 0; i < line.wordList.size(); i++) {
+        unsigned int index = line.wordList[i];
+        extendBox(box, index);
+        unsigned int column = Schema::headColumn;
+        if (i >= line.headWords) {
+          int band = layout.findBand(table, index);
+          column = band >= 0 ? bandColumn[band] : Schema::textColumn;
+        }
+        append(column, rowIndex, table[index].value());
+      }
+      inRow = true;
+      lastY1 = line.y1;
+      continue;
+    }
+    bool hasAmount = false;
+    for (unsigned int index : line.wordList) {
+      int band = layout.findBand(table, index);
+      if (band >= 0 && layout.bandList[band].isAmount) {
+        hasAmount = true;
+        break;
+      }
+    }
+    if (inRow && !hasAmount &&
+        line.y0 < lastY1 + layout.medianHeight * 3 / 2) {
+      unsigned int rowIndex = fields.rowCount - 1;
+      for (unsigned int index : line.wordList) {
+        append(Schema::textColumn, rowIndex, table[index].value());
+        extendBox(fields.boxList[rowIndex], index);
+      }
+      lastY1 = line.y1;
+    } else {
+      inRow = false;
+    }
+  }
+}
+
+/* @brief Rebuild the table of a page as the schema declares it
+ * The schema is a class with
+ *   Document: the result, with a wordTable member
+ *   columnCount, fieldKind[columnCount], headColumn and textColumn
+ *   matchRow(table, wordList, headWords): true for a row line
+ *   assignBands(layout, bandColumn): the column of each band
+ *   store(document, table, layout, fields, options): the document from
+ *     the parsed fields
+ * Everything the schema declares is known at compile time, the loop over
+ * the words routes each by its band with no call through a pointer and
+ * each column is parsed by the parser of its kind. O(n log n) in the
+ * number of words.
+ */
+template <class Schema>
+std::shared_ptr<typename Schema::Document>
+extractDocumentTable(std::shared_ptr<HocrWordTable> wordTable,
+                     const StatementFieldOptions &options) {
+  std::shared_ptr<typename Schema::Document> document =
+      std::make_shared<typename Schema::Document>();
+  document->wordTable = wordTable;
+  const HocrWordTable &table = *wordTable;
+  DocumentLayout layout;
+  DocumentFields<Schema> fields;
+  if (table.size() > 0) {
+    layout.findLines(table);
+    for (DocumentLine &line : layout.lineList) {
+      line.row = Schema::matchRow(table, line.wordList, line.headWords);
+      layout.rowLineCount += line.row;
+    }
+  }
+  if (layout.rowLineCount > 0) {
+    layout.findBands(table);
+    std::vector<unsigned char> bandColumn(layout.bandList.size(),
+                                          Schema::textColumn);
+    Schema::assignBands(layout, bandColumn);
+    fillDocumentFields<Schema>(table, layout, bandColumn, fields);
+    parseDocumentColumns<Schema>(
+        fields, options,
+        std::make_integer_sequence<unsigned int, Schema::columnCount>());
+  }
+  Schema::store(*document, table, layout, fields, options);
+  return document;
+}
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_DOCUMENT_LAYOUT_H
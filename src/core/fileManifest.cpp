@@ -0,0 +1,246 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+/* boost 1.72.0
+ * License: Boost Software License (similar to BSD and MIT)
+ */
+#include <boost/endian/conversion.hpp>
+#include <boost/filesystem.hpp>
+
+// Local Project
+#include "fileManifest.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+namespace {
+
+const char fileManifestMagic[4] = {'B', 'F', 'F', 'M'};
+const uint32_t fileManifestVersion = 1;
+const std::size_t headerBytes = 2 * sizeof(uint32_t);
+const std::size_t recordBytes = 2 * sizeof(uint32_t) + 4 * sizeof(uint64_t);
+const uint32_t erasedPages = 0xFFFFFFFF;
+// records appended before the journal is flushed
+const std::size_t flushRecords = 64;
+constexpr bool nativeLittleEndian =
+    boost::endian::order::native == boost::endian::order::little;
+
+void writeRecord(std::ofstream &file, const std::string &filePath,
+                 const FileManifestEntry &entry) {
+  char record[recordBytes];
+  uint32_t head[2] = {static_cast<uint32_t>(filePath.size()), entry.pages};
+  uint64_t body[4] = {entry.size, static_cast<uint64_t>(entry.mtime),
+                      entry.inode, entry.configHash};
+  std::memcpy(record, head, sizeof(head));
+  std::memcpy(record + sizeof(head), body, sizeof(body));
+  file.write(record, recordBytes);
+  file.write(filePath.data(), static_cast<std::streamsize>(filePath.size()));
+}
+
+} // namespace
+
+FileManifest::FileManifest()
+    : enabled(false), loaded(false), journalRecords(0), unflushedRecords(0) {}
+
+FileManifest::~FileManifest() { flush(); }
+
+void FileManifest::configure(const RecognizeSettings &settings) {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::string path;
+  if (settings.crawlManifest && settings.cacheEnabled &&
+      !settings.cachePath.empty() && nativeLittleEndian) {
+    path = (boost::filesystem::path(settings.cachePath) / "manifest").string();
+  }
+  if (path == manifestPath && enabled == !path.empty()) {
+    return;
+  }
+  journal.close();
+  entryMap.clear();
+  loaded = false;
+  journalRecords = 0;
+  unflushedRecords = 0;
+  manifestPath = path;
+  enabled = !path.empty();
+}
+
+bool FileManifest::isEnabled() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return enabled;
+}
+
+void FileManifest::loadLocked() {
+  loaded = true;
+  std::vector<char> data;
+  {
+    std::ifstream file(manifestPath, std::ios::binary);
+    if (file) {
+      data.assign(std::istreambuf_iterator<char>(file),
+                  std::istreambuf_iterator<char>());
+    }
+  }
+  uint32_t header[2];
+  bool valid = data.size() >= headerBytes;
+  if (valid) {
+    std::memcpy(header, data.data(), headerBytes);
+    valid = std::memcmp(header, fileManifestMagic, 4) == 0 &&
+            header[1] == fileManifestVersion;
+  }
+  std::size_t offset = headerBytes;
+  while (valid && data.size() - offset >= recordBytes) {
+    uint32_t head[2];
+    uint64_t body[4];
+    std::memcpy(head, data.data() + offset, sizeof(head));
+    std::memcpy(body, data.data() + offset + sizeof(head), sizeof(body));
+    // a record cut short by a crash ends the journal
+    if (data.size() - offset - recordBytes < head[0]) {
+      break;
+    }
+    std::string filePath(data.data() + offset + recordBytes, head[0]);
+    offset += recordBytes + head[0];
+    journalRecords++;
+    if (head[1] == erasedPages) {
+      entryMap.erase(filePath);
+      continue;
+    }
+    FileManifestEntry &entry = entryMap[filePath];
+    entry.pages = head[1];
+    entry.size = body[0];
+    entry.mtime = static_cast<long long>(body[1]);
+    entry.inode = body[2];
+    entry.configHash = body[3];
+  }
+  // start over on a missing or damaged file, or one of mostly old records
+  if (!valid || offset != data.size() ||
+      journalRecords > 2 * entryMap.size() + 1024) {
+    if (!writeAllLocked()) {
+      enabled = false;
+    }
+    return;
+  }
+  journal.open(manifestPath, std::ios::binary | std::ios::app);
+  enabled = journal.good();
+}
+
+bool FileManifest::writeAllLocked() {
+  journal.close();
+  std::string tempPath = manifestPath + ".tmp";
+  {
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      return false;
+    }
+    uint32_t header[2] = {0, fileManifestVersion};
+    std::memcpy(&header[0], fileManifestMagic, 4);
+    file.write(reinterpret_cast<const char *>(header), sizeof(header));
+    for (auto &entry : entryMap) {
+      writeRecord(file, entry.first, entry.second);
+    }
+    if (!file) {
+      return false;
+    }
+  }
+  boost::system::error_code ec;
+  boost::filesystem::rename(tempPath, manifestPath, ec);
+  if (ec) {
+    return false;
+  }
+  journalRecords = entryMap.size();
+  journal.open(manifestPath, std::ios::binary | std::ios::app);
+  return journal.good();
+}
+
+void FileManifest::appendLocked(const std::string &filePath,
+                                const FileManifestEntry &entry) {
+  writeRecord(journal, filePath, entry);
+  journalRecords++;
+  if (++unflushedRecords >= flushRecords) {
+    journal.flush();
+    unflushedRecords = 0;
+  }
+}
+
+bool FileManifest::find(const std::string &filePath,
+                        FileManifestEntry &entry) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!enabled) {
+    return false;
+  }
+  if (!loaded) {
+    loadLocked();
+  }
+  auto entryIt = entryMap.find(filePath);
+  if (entryIt == entryMap.end()) {
+    return false;
+  }
+  entry = entryIt->second;
+  return true;
+}
+
+void FileManifest::record(const std::string &filePath,
+                          const FileManifestEntry &entry) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!enabled) {
+    return;
+  }
+  if (!loaded) {
+    loadLocked();
+    if (!enabled) {
+      return;
+    }
+  }
+  entryMap[filePath] = entry;
+  appendLocked(filePath, entry);
+}
+
+void FileManifest::erase(const std::string &filePath) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!enabled) {
+    return;
+  }
+  if (!loaded) {
+    loadLocked();
+    if (!enabled) {
+      return;
+    }
+  }
+  if (entryMap.erase(filePath) == 0) {
+    return;
+  }
+  FileManifestEntry erased;
+  erased.pages = erasedPages;
+  appendLocked(filePath, erased);
+}
+
+void FileManifest::flush() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (journal.is_open()) {
+    journal.flush();
+  }
+  unflushedRecords = 0;
+}
+
+std::size_t FileManifest::size() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (enabled && !loaded) {
+    loadLocked();
+  }
+  return entryMap.size();
+}
+
+} // namespace bookfiler
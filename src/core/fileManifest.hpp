@@ -0,0 +1,86 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_FILE_MANIFEST_H
+#define BOOKFILER_MODULE_RECOGNIZE_FILE_MANIFEST_H
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Local Project
+#include "recognizeSettings.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+/* What a file looked like when it was recognized
+ * configHash is the OCR configuration and region its pages were recognized
+ * with, the words are in the cache under the same configuration.
+ */
+class FileManifestEntry {
+public:
+  unsigned long long size = 0;
+  // nanoseconds since the epoch
+  long long mtime = 0;
+  unsigned long long inode = 0;
+  unsigned long long configHash = 0;
+  unsigned int pages = 0;
+};
+
+/* Files recognized before, kept next to the cache
+ * A journal of records appended as the files finish: "BFFM", version (two
+ * 32 bit words), then for each record pathLength, pages (u32), size, mtime,
+ * inode, configHash (64 bit) and the path bytes. A later record of a path
+ * replaces an earlier one, pages 0xFFFFFFFF removes it. Loaded on first use
+ * and written again without the replaced records when they are most of it.
+ * Safe from any thread.
+ */
+class FileManifest {
+private:
+  std::mutex mutex;
+  bool enabled;
+  std::string manifestPath;
+  bool loaded;
+  std::unordered_map<std::string, FileManifestEntry> entryMap;
+  std::ofstream journal;
+  // records in the file, and appended since the last flush
+  std::size_t journalRecords, unflushedRecords;
+
+  void loadLocked();
+  void appendLocked(const std::string &filePath,
+                    const FileManifestEntry &entry);
+  bool writeAllLocked();
+
+public:
+  FileManifest();
+  ~FileManifest();
+  // on with the cache, in "manifest" in the cache directory
+  void configure(const RecognizeSettings &settings);
+  bool isEnabled();
+  // @return false if the file was not recorded
+  bool find(const std::string &filePath, FileManifestEntry &entry);
+  void record(const std::string &filePath, const FileManifestEntry &entry);
+  // the file is recognized again the next time it is added
+  void erase(const std::string &filePath);
+  // write the appended records through to the file
+  void flush();
+  std::size_t size();
+};
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_FILE_MANIFEST_H
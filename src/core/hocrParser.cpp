@@ -0,0 +1,590 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+// c++17
+#include <cstring>
+
+/* boost 1.72.0
+ * License: Boost Software License (similar to BSD and MIT)
+ */
+// Local Project
+#include "hocrParser.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+namespace {
+
+inline bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+inline bool startsWith(std::string_view data, std::size_t pos,
+                       std::string_view prefix) {
+  return data.size() - pos >= prefix.size() &&
+         data.compare(pos, prefix.size(), prefix) == 0;
+}
+
+/* @return position just past the end of a comment, CDATA section, doctype
+ * or processing instruction starting at pos. npos if pos is not one of these.
+ */
+std::size_t skipSpecial(std::string_view data, std::size_t pos) {
+  std::size_t end;
+  if (startsWith(data, pos, "<!--")) {
+    end = data.find("-->", pos + 4);
+    return end == std::string_view::npos ? data.size() : end + 3;
+  }
+  if (startsWith(data, pos, "<![CDATA[")) {
+    end = data.find("]]>", pos + 9);
+    return end == std::string_view::npos ? data.size() : end + 3;
+  }
+  if (startsWith(data, pos, "<!") || startsWith(data, pos, "<?")) {
+    end = data.find('>', pos + 2);
+    return end == std::string_view::npos ? data.size() : end + 1;
+  }
+  return std::string_view::npos;
+}
+
+/* @return position of the '>' closing the tag that starts at pos.
+ * Quoted attribute values may contain '>'.
+ */
+std::size_t findTagEnd(std::string_view data, std::size_t pos) {
+  char quote = 0;
+  for (std::size_t i = pos + 1; i < data.size(); i++) {
+    char c = data[i];
+    if (quote) {
+      if (c == quote) {
+        quote = 0;
+      }
+    } else if (c == '"' || c == '\'') {
+      quote = c;
+    } else if (c == '>') {
+      return i;
+    }
+  }
+  return data.size();
+}
+
+inline std::size_t findOpen(std::string_view data, std::size_t pos) {
+  if (pos >= data.size()) {
+    return std::string_view::npos;
+  }
+  const void *found =
+      std::memchr(data.data() + pos, '<', data.size() - pos);
+  return found ? static_cast<const char *>(found) - data.data()
+               : std::string_view::npos;
+}
+
+/* @return word for ocrx_word, the end event of a line, paragraph or page
+ * class, documentEnd for any other class
+ */
+HocrEvent getClassBlock(std::string_view value) {
+  HocrEvent block = HocrEvent::documentEnd;
+  std::size_t i = 0;
+  while (i < value.size()) {
+    while (i < value.size() && isSpace(value[i])) {
+      i++;
+    }
+    std::size_t start = i;
+    while (i < value.size() && !isSpace(value[i])) {
+      i++;
+    }
+    std::string_view token = value.substr(start, i - start);
+    if (token == "ocrx_word") {
+      return HocrEvent::word;
+    }
+    if (token == "ocr_line" || token == "ocr_textfloat" ||
+        token == "ocr_header" || token == "ocr_caption") {
+      block = HocrEvent::lineEnd;
+    } else if (token == "ocr_par") {
+      block = HocrEvent::parEnd;
+    } else if (token == "ocr_page") {
+      block = HocrEvent::pageEnd;
+    }
+  }
+  return block;
+}
+
+void appendUtf8(unsigned long code, std::string &out) {
+  if (code < 0x80) {
+    out.push_back(static_cast<char>(code));
+  } else if (code < 0x800) {
+    out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+    out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+  } else if (code < 0x10000) {
+    out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+    out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+  } else {
+    out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+    out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+  }
+}
+
+/* @return number of characters consumed from value at pos, 0 if the
+ * ampersand does not start a known entity
+ */
+std::size_t decodeEntity(std::string_view value, std::size_t pos,
+                         std::string &out) {
+  std::size_t semi = value.find(';', pos);
+  if (semi == std::string_view::npos || semi - pos > 10) {
+    return 0;
+  }
+  std::string_view name = value.substr(pos + 1, semi - pos - 1);
+  if (name == "amp") {
+    out.push_back('&');
+  } else if (name == "lt") {
+    out.push_back('<');
+  } else if (name == "gt") {
+    out.push_back('>');
+  } else if (name == "quot") {
+    out.push_back('"');
+  } else if (name == "apos") {
+    out.push_back('\'');
+  } else if (name.size() > 1 && name[0] == '#') {
+    bool hex = name[1] == 'x' || name[1] == 'X';
+    std::size_t i = hex ? 2 : 1;
+    if (i >= name.size()) {
+      return 0;
+    }
+    unsigned long code = 0;
+    for (; i < name.size(); i++) {
+      char c = name[i];
+      unsigned long digit;
+      if (c >= '0' && c <= '9') {
+        digit = c - '0';
+      } else if (hex && c >= 'a' && c <= 'f') {
+        digit = c - 'a' + 10;
+      } else if (hex && c >= 'A' && c <= 'F') {
+        digit = c - 'A' + 10;
+      } else {
+        return 0;
+      }
+      code = code * (hex ? 16 : 10) + digit;
+    }
+    appendUtf8(code, out);
+  } else {
+    return 0;
+  }
+  return semi - pos + 1;
+}
+
+} // namespace
+
+HocrParser::HocrParser(std::string_view data_)
+    : data(data_), pos(0), depth(0) {}
+
+bool HocrParser::skipMarkup() {
+  std::size_t end = skipSpecial(data, pos);
+  if (end != std::string_view::npos) {
+    pos = end;
+    return true;
+  }
+  return false;
+}
+
+bool HocrParser::readStartTag(std::string_view &name, std::string_view &id,
+                              std::string_view &title, HocrEvent &block,
+                              bool &selfClose) {
+  std::size_t i = pos + 1;
+  std::size_t nameStart = i;
+  while (i < data.size() && !isSpace(data[i]) && data[i] != '>' &&
+         data[i] != '/') {
+    i++;
+  }
+  name = data.substr(nameStart, i - nameStart);
+  block = HocrEvent::documentEnd;
+  selfClose = false;
+  while (i < data.size()) {
+    while (i < data.size() && isSpace(data[i])) {
+      i++;
+    }
+    if (i >= data.size()) {
+      break;
+    }
+    if (data[i] == '>') {
+      pos = i + 1;
+      return true;
+    }
+    if (data[i] == '/') {
+      i++;
+      if (i < data.size() && data[i] == '>') {
+        selfClose = true;
+        pos = i + 1;
+        return true;
+      }
+      continue;
+    }
+    // attribute name
+    std::size_t attrStart = i;
+    while (i < data.size() && !isSpace(data[i]) && data[i] != '=' &&
+           data[i] != '>' && data[i] != '/') {
+      i++;
+    }
+    std::string_view attrName = data.substr(attrStart, i - attrStart);
+    while (i < data.size() && isSpace(data[i])) {
+      i++;
+    }
+    std::string_view attrValue;
+    if (i < data.size() && data[i] == '=') {
+      i++;
+      while (i < data.size() && isSpace(data[i])) {
+        i++;
+      }
+      if (i < data.size() && (data[i] == '"' || data[i] == '\'')) {
+        char quote = data[i];
+        std::size_t valueEnd = data.find(quote, i + 1);
+        if (valueEnd == std::string_view::npos) {
+          valueEnd = data.size();
+        }
+        attrValue = data.substr(i + 1, valueEnd - i - 1);
+        i = valueEnd + 1;
+      } else {
+        std::size_t valueStart = i;
+        while (i < data.size() && !isSpace(data[i]) && data[i] != '>') {
+          i++;
+        }
+        attrValue = data.substr(valueStart, i - valueStart);
+      }
+    }
+    if (attrName == "class") {
+      block = getClassBlock(attrValue);
+    } else if (attrName == "id") {
+      id = attrValue;
+    } else if (attrName == "title") {
+      title = attrValue;
+    }
+  }
+  pos = data.size();
+  return false;
+}
+
+bool HocrParser::skipElement(std::string_view &inner) {
+  std::size_t contentStart = pos;
+  unsigned int depth = 1;
+  while (true) {
+    std::size_t open = findOpen(data, pos);
+    if (open == std::string_view::npos) {
+      inner = data.substr(contentStart);
+      pos = data.size();
+      return false;
+    }
+    pos = open;
+    std::size_t end = skipSpecial(data, pos);
+    if (end != std::string_view::npos) {
+      pos = end;
+      continue;
+    }
+    std::size_t tagEnd = findTagEnd(data, pos);
+    if (pos + 1 < data.size() && data[pos + 1] == '/') {
+      depth--;
+      if (depth == 0) {
+        inner = data.substr(contentStart, open - contentStart);
+        pos = tagEnd + 1;
+        return true;
+      }
+    } else if (data[tagEnd - 1] != '/') {
+      depth++;
+    }
+    pos = tagEnd + 1;
+  }
+}
+
+bool HocrParser::nextWord(HocrWordView &word) {
+  while (true) {
+    HocrEvent event = next(word);
+    if (event == HocrEvent::word) {
+      return true;
+    }
+    if (event == HocrEvent::documentEnd) {
+      return false;
+    }
+  }
+}
+
+HocrEvent HocrParser::next(HocrWordView &word) {
+  while (true) {
+    std::size_t open = findOpen(data, pos);
+    if (open == std::string_view::npos) {
+      pos = data.size();
+      return HocrEvent::documentEnd;
+    }
+    pos = open;
+    if (skipMarkup()) {
+      continue;
+    }
+    if (startsWith(data, pos, "</")) {
+      pos = findTagEnd(data, pos) + 1;
+      if (depth > 0) {
+        depth--;
+      }
+      if (!blockStack.empty() && blockStack.back().first == depth) {
+        HocrEvent event = blockStack.back().second;
+        blockStack.pop_back();
+        return event;
+      }
+      continue;
+    }
+    std::string_view name, id, title;
+    HocrEvent block;
+    bool selfClose;
+    if (!readStartTag(name, id, title, block, selfClose)) {
+      return HocrEvent::documentEnd;
+    }
+    if (block == HocrEvent::word) {
+      word.id = id;
+      word.title = title;
+      word.lineTitle = lineTitle;
+      word.inner = std::string_view();
+      // the whole word element is consumed, the depth does not change
+      if (!selfClose) {
+        skipElement(word.inner);
+      }
+      return HocrEvent::word;
+    }
+    if (block == HocrEvent::lineEnd) {
+      lineTitle = title;
+    }
+    if (!selfClose) {
+      if (block != HocrEvent::documentEnd) {
+        blockStack.push_back({depth, block});
+      }
+      depth++;
+    }
+  }
+}
+
+void appendHocrDecoded(std::string_view value, std::string &out) {
+  std::size_t i = 0;
+  while (i < value.size()) {
+    std::size_t amp = value.find('&', i);
+    if (amp == std::string_view::npos) {
+      out.append(value.data() + i, value.size() - i);
+      return;
+    }
+    out.append(value.data() + i, amp - i);
+    std::size_t consumed = decodeEntity(value, amp, out);
+    if (consumed == 0) {
+      out.push_back('&');
+      consumed = 1;
+    }
+    i = amp + consumed;
+  }
+}
+
+void appendHocrText(std::string_view inner, std::string &out) {
+  unsigned int depth = 0;
+  std::size_t i = 0;
+  while (i < inner.size()) {
+    std::size_t open = findOpen(inner, i);
+    if (open == std::string_view::npos) {
+      open = inner.size();
+    }
+    if (depth == 0) {
+      appendHocrDecoded(inner.substr(i, open - i), out);
+    }
+    if (open == inner.size()) {
+      return;
+    }
+    if (startsWith(inner, open, "<![CDATA[")) {
+      std::size_t end = skipSpecial(inner, open);
+      if (depth == 0) {
+        std::size_t cdataEnd = end >= open + 12 ? end - 3 : inner.size();
+        out.append(inner.data() + open + 9, cdataEnd - open - 9);
+      }
+      i = end;
+      continue;
+    }
+    std::size_t end = skipSpecial(inner, open);
+    if (end != std::string_view::npos) {
+      i = end;
+      continue;
+    }
+    std::size_t tagEnd = findTagEnd(inner, open);
+    if (open + 1 < inner.size() && inner[open + 1] == '/') {
+      if (depth > 0) {
+        depth--;
+      }
+    } else if (tagEnd < inner.size() && inner[tagEnd - 1] != '/') {
+      depth++;
+    }
+    i = tagEnd + 1;
+  }
+}
+
+void mergeHocrLineTitle(HocrTitle &title, const HocrTitle &lineTitle) {
+  if (!title.hasBaseline && lineTitle.hasBaseline) {
+    title.baselineSlope = lineTitle.baselineSlope;
+    title.baselineOffset = lineTitle.baselineOffset;
+    title.hasBaseline = true;
+  }
+  if (!title.hasXSize && lineTitle.hasXSize) {
+    title.xSize = lineTitle.xSize;
+    title.hasXSize = true;
+  }
+  if (!title.hasTextAngle && lineTitle.hasTextAngle) {
+    title.textAngle = lineTitle.textAngle;
+    title.hasTextAngle = true;
+  }
+}
+
+void hocrWordFromView(const HocrWordView &view, const HocrTitle &lineTitle,
+                      HocrWord &word) {
+  appendHocrText(view.inner, word.value);
+  appendHocrDecoded(view.id, word.id);
+  HocrTitle title;
+  parseHocrTitle(view.title, title);
+  mergeHocrLineTitle(title, lineTitle);
+  if (title.hasBbox) {
+    word.x0 = title.x0;
+    word.y0 = title.y0;
+    word.x1 = title.x1;
+    word.y1 = title.y1;
+    word.w = word.x1 - word.x0;
+    word.h = word.y1 - word.y0;
+  }
+  if (title.hasConfidence) {
+    word.confidence = title.confidence;
+  }
+  word.baselineSlope = title.baselineSlope;
+  word.baselineOffset = title.baselineOffset;
+  word.xSize = title.xSize;
+  word.xFsize = title.xFsize;
+  word.textAngle = title.textAngle;
+}
+
+std::shared_ptr<std::vector<std::shared_ptr<HocrWord>>>
+hocrWordListFromString(std::string_view hocr) {
+  std::shared_ptr<std::vector<std::shared_ptr<HocrWord>>> wordList =
+      std::make_shared<std::vector<std::shared_ptr<HocrWord>>>();
+  HocrParser parser(hocr);
+  HocrWordView view;
+  // every word of a line shares the line title, only parse it once
+  std::string_view lineTitleView;
+  HocrTitle lineTitle;
+  while (parser.nextWord(view)) {
+    if (view.lineTitle.data() != lineTitleView.data()) {
+      lineTitleView = view.lineTitle;
+      lineTitle = HocrTitle();
+      parseHocrTitle(lineTitleView, lineTitle);
+    }
+    std::shared_ptr<HocrWord> wordPtr = std::make_shared<HocrWord>();
+    hocrWordFromView(view, lineTitle, *wordPtr);
+    wordList->push_back(wordPtr);
+  }
+  return wordList;
+}
+
+std::vector<std::string_view> splitHocrPages(std::string_view hocr) {
+  const std::string_view pageClass = "ocr_page";
+  std::vector<std::size_t> beginList;
+  for (std::size_t pos = hocr.find(pageClass); pos != std::string_view::npos;
+       pos = hocr.find(pageClass, pos + pageClass.size())) {
+    std::size_t tagBegin = hocr.rfind('<', pos);
+    if (tagBegin == std::string_view::npos ||
+        (!beginList.empty() && tagBegin == beginList.back())) {
+      continue;
+    }
+    // inside the class value of a start tag, not text, a comment or a title
+    std::string_view tag = hocr.substr(tagBegin, pos - tagBegin);
+    std::size_t classPos = tag.rfind("class=");
+    if (tag.size() < 2 || tag[1] == '/' || tag[1] == '!' ||
+        tag.find('>') != std::string_view::npos ||
+        classPos == std::string_view::npos || classPos + 6 >= tag.size()) {
+      continue;
+    }
+    char quote = tag[classPos + 6];
+    std::size_t end = pos + pageClass.size();
+    if ((quote != '\'' && quote != '"') ||
+        tag.find(quote, classPos + 7) != std::string_view::npos ||
+        (tag.back() != quote && tag.back() != ' ') || end >= hocr.size() ||
+        (hocr[end] != quote && hocr[end] != ' ')) {
+      continue;
+    }
+    beginList.push_back(tagBegin);
+  }
+  std::vector<std::string_view> pageList;
+  if (beginList.size() < 2) {
+    pageList.push_back(hocr);
+    return pageList;
+  }
+  pageList.reserve(beginList.size());
+  for (std::size_t i = 0; i < beginList.size(); i++) {
+    std::size_t begin = i == 0 ? 0 : beginList[i];
+    std::size_t end =
+        i + 1 < beginList.size() ? beginList[i + 1] : hocr.size();
+    pageList.push_back(hocr.substr(begin, end - begin));
+  }
+  return pageList;
+}
+
+std::shared_ptr<HocrWordTable> hocrWordTableFromString(std::string_view hocr) {
+  return hocrWordTableFromString(hocr, HocrEvent::documentEnd, nullptr);
+}
+
+std::shared_ptr<HocrWordTable> hocrWordTableFromString(
+    std::string_view hocr, HocrEvent level,
+    const std::function<void(const HocrWordTable &table,
+                             std::size_t beginIndex, std::size_t endIndex,
+                             HocrEvent event)> &onBlock) {
+  std::shared_ptr<HocrWordTable> table = std::make_shared<HocrWordTable>();
+  HocrParser parser(hocr);
+  HocrWordView view;
+  std::string_view lineTitleView;
+  HocrTitle lineTitle;
+  // decode buffers are reused so a word costs no allocation
+  std::string value, id;
+  std::size_t blockBegin = 0;
+  while (true) {
+    HocrEvent event = parser.next(view);
+    if (event != HocrEvent::word) {
+      // the end of any block ends the line
+      std::size_t lineBegin =
+          table->lineEnd.empty() ? 0 : table->lineEnd.back();
+      if (table->size() > lineBegin) {
+        table->lineEnd.push_back(static_cast<unsigned int>(table->size()));
+      }
+      // only blocks with words are reported, except the document end
+      if (onBlock && event >= level &&
+          (table->size() > blockBegin || event == HocrEvent::documentEnd)) {
+        onBlock(*table, blockBegin, table->size(), event);
+        blockBegin = table->size();
+      }
+      if (event == HocrEvent::documentEnd) {
+        break;
+      }
+      continue;
+    }
+    if (view.lineTitle.data() != lineTitleView.data()) {
+      lineTitleView = view.lineTitle;
+      lineTitle = HocrTitle();
+      parseHocrTitle(lineTitleView, lineTitle);
+    }
+    value.clear();
+    id.clear();
+    appendHocrText(view.inner, value);
+    appendHocrDecoded(view.id, id);
+    HocrTitle title;
+    parseHocrTitle(view.title, title);
+    mergeHocrLineTitle(title, lineTitle);
+    std::size_t i = table->addWord(title.x0, title.y0, title.x1, title.y1,
+                                   title.confidence, value, id);
+    table->baselineSlope[i] = title.baselineSlope;
+    table->baselineOffset[i] = title.baselineOffset;
+    table->xSize[i] = title.xSize;
+    table->xFsize[i] = title.xFsize;
+    table->textAngle[i] = title.textAngle;
+  }
+  return table;
+}
+
+} // namespace bookfiler
@@ -0,0 +1,129 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_HOCR_PARSER_H
+#define BOOKFILER_MODULE_RECOGNIZE_HOCR_PARSER_H
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Local Project
+#include "../Interface.hpp"
+#include "hocrTitle.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+/* A single ocrx_word element found by the HocrParser.
+ * All views point into the buffer given to the parser and are only valid
+ * while that buffer is alive. Attribute values and text are still encoded.
+ */
+class HocrWordView {
+public:
+  std::string_view id;
+  std::string_view title;
+  // everything between the start and end tag of the word element
+  std::string_view inner;
+  /* title of the last ocr_line (or other line class) opened before the word
+   * line properties like baseline and x_size are found here
+   */
+  std::string_view lineTitle;
+};
+
+/* Streaming hOCR parser
+ * Walks the hOCR buffer once, tag by tag, and stops on every ocrx_word
+ * element. No DOM is built and nothing is copied.
+ */
+class HocrParser {
+private:
+  std::string_view data;
+  std::size_t pos;
+  std::string_view lineTitle;
+  // element depth, and the depth and kind of the open line/par/page blocks
+  unsigned int depth;
+  std::vector<std::pair<unsigned int, HocrEvent>> blockStack;
+
+  bool skipMarkup();
+  /* @param block the end event of the element if it is a line, paragraph
+   * or page, word for an ocrx_word and documentEnd for anything else
+   */
+  bool readStartTag(std::string_view &name, std::string_view &id,
+                    std::string_view &title, HocrEvent &block,
+                    bool &selfClose);
+  bool skipElement(std::string_view &inner);
+
+public:
+  HocrParser(std::string_view data_);
+  /* @brief Advance to the next ocrx_word element
+   * @return false when the end of the document is reached
+   */
+  bool nextWord(HocrWordView &word);
+  /* @brief Advance to the next word or the end of a line, paragraph or page
+   * word is only set for HocrEvent::word. Blocks still open at the end of
+   * the buffer are not reported, documentEnd closes them.
+   */
+  HocrEvent next(HocrWordView &word);
+};
+
+/* @brief Append the text directly inside a word element, decoding entities.
+ * Text inside nested elements is skipped, which matches what read_xml
+ * stores as the node data.
+ */
+void appendHocrText(std::string_view inner, std::string &out);
+/* @brief Append an attribute value decoding XML entities
+ */
+void appendHocrDecoded(std::string_view value, std::string &out);
+/* @brief Fill the baseline, x_size and textangle missing from a word title
+ * with the values of the line title
+ */
+void mergeHocrLineTitle(HocrTitle &title, const HocrTitle &lineTitle);
+/* @brief Convert a parsed word element to a HocrWord
+ * @param lineTitle parsed view.lineTitle. Baseline, x_size and textangle are
+ * taken from the line when the word does not have its own.
+ */
+void hocrWordFromView(const HocrWordView &view, const HocrTitle &lineTitle,
+                      HocrWord &word);
+/* @brief Cut a multi-page hOCR buffer before each ocr_page start tag
+ * One scan for the class name, no parsing. The first slice keeps the
+ * document head, the last the closing tags, each slice parses on its own.
+ * @return one slice per page, the whole buffer if it has one page or none
+ */
+std::vector<std::string_view> splitHocrPages(std::string_view hocr);
+/* @brief Parse a whole hOCR buffer to the word list
+ */
+std::shared_ptr<std::vector<std::shared_ptr<HocrWord>>>
+hocrWordListFromString(std::string_view hocr);
+/* @brief Parse a whole hOCR buffer to a word table
+ */
+std::shared_ptr<HocrWordTable> hocrWordTableFromString(std::string_view hocr);
+/* @brief Parse a whole hOCR buffer to a word table, reporting blocks as
+ * they close
+ * Same single pass as above. onBlock gets the words [beginIndex, endIndex)
+ * added since the last call each time a block at or above level closes,
+ * and a last call with documentEnd, possibly with no words.
+ */
+std::shared_ptr<HocrWordTable> hocrWordTableFromString(
+    std::string_view hocr, HocrEvent level,
+    const std::function<void(const HocrWordTable &table,
+                             std::size_t beginIndex, std::size_t endIndex,
+                             HocrEvent event)> &onBlock);
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_HOCR_PARSER_H
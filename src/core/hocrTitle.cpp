@@ -0,0 +1,150 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+// c++17
+#include <charconv>
+
+// Local Project
+#include "hocrTitle.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+namespace {
+
+inline bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+inline void skipSpace(std::string_view &value) {
+  std::size_t i = 0;
+  while (i < value.size() && isSpace(value[i])) {
+    i++;
+  }
+  value.remove_prefix(i);
+}
+
+/* The number must be followed by whitespace or the end of the value,
+ * "12abc" is rejected.
+ */
+template <typename T> bool readNumber(std::string_view &value, T &out) {
+  skipSpace(value);
+  const char *first = value.data();
+  const char *last = first + value.size();
+  std::from_chars_result result = std::from_chars(first, last, out);
+  if (result.ec != std::errc() ||
+      (result.ptr != last && !isSpace(*result.ptr))) {
+    return false;
+  }
+  value.remove_prefix(result.ptr - first);
+  return true;
+}
+
+inline bool atEnd(std::string_view value) {
+  skipSpace(value);
+  return value.empty();
+}
+
+} // namespace
+
+bool parseHocrTitle(std::string_view title, HocrTitle &out) {
+  bool valid = true;
+  std::size_t i = 0;
+  const std::size_t n = title.size();
+  while (i < n) {
+    while (i < n && (isSpace(title[i]) || title[i] == ';')) {
+      i++;
+    }
+    std::size_t nameStart = i;
+    while (i < n && !isSpace(title[i]) && title[i] != ';') {
+      i++;
+    }
+    std::string_view name = title.substr(nameStart, i - nameStart);
+    std::size_t valueStart = i;
+    bool quoted = false;
+    while (i < n && (quoted || title[i] != ';')) {
+      if (title[i] == '"') {
+        quoted = !quoted;
+      }
+      i++;
+    }
+    std::string_view value = title.substr(valueStart, i - valueStart);
+    float number;
+    if (name.empty()) {
+      continue;
+    }
+    switch (name[0]) {
+    case 'b':
+      if (name == "bbox") {
+        unsigned int x0, y0, x1, y1;
+        if (readNumber(value, x0) && readNumber(value, y0) &&
+            readNumber(value, x1) && readNumber(value, y1) && atEnd(value)) {
+          out.x0 = x0;
+          out.y0 = y0;
+          out.x1 = x1;
+          out.y1 = y1;
+          out.hasBbox = true;
+        } else {
+          valid = false;
+        }
+      } else if (name == "baseline") {
+        float slope, offset;
+        if (readNumber(value, slope) && readNumber(value, offset) &&
+            atEnd(value)) {
+          out.baselineSlope = slope;
+          out.baselineOffset = offset;
+          out.hasBaseline = true;
+        } else {
+          valid = false;
+        }
+      }
+      break;
+    case 't':
+      if (name == "textangle") {
+        if (readNumber(value, number) && atEnd(value)) {
+          out.textAngle = number;
+          out.hasTextAngle = true;
+        } else {
+          valid = false;
+        }
+      }
+      break;
+    case 'x':
+      if (name == "x_wconf") {
+        if (readNumber(value, number) && atEnd(value)) {
+          out.confidence = number;
+          out.hasConfidence = true;
+        } else {
+          valid = false;
+        }
+      } else if (name == "x_size") {
+        if (readNumber(value, number) && atEnd(value)) {
+          out.xSize = number;
+          out.hasXSize = true;
+        } else {
+          valid = false;
+        }
+      } else if (name == "x_fsize") {
+        if (readNumber(value, number) && atEnd(value)) {
+          out.xFsize = number;
+          out.hasXFsize = true;
+        } else {
+          valid = false;
+        }
+      }
+      break;
+    default:
+      break;
+    }
+  }
+  return valid;
+}
+
+} // namespace bookfiler
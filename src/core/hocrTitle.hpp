@@ -0,0 +1,57 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_HOCR_TITLE_H
+#define BOOKFILER_MODULE_RECOGNIZE_HOCR_TITLE_H
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <string_view>
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+/* Properties of a hOCR title attribute
+ * http://kba.cloud/hocr-spec/1.2/#properties
+ * Only the properties used by the recognizer are kept. The has* flags tell
+ * which ones were present in the title.
+ */
+class HocrTitle {
+public:
+  bool hasBbox = false, hasConfidence = false, hasBaseline = false,
+       hasXSize = false, hasXFsize = false, hasTextAngle = false;
+  // http://kba.cloud/hocr-spec/1.2/#bbox
+  unsigned int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+  // http://kba.cloud/hocr-spec/1.2/#x_wconf
+  float confidence = 0;
+  // http://kba.cloud/hocr-spec/1.2/#baseline
+  float baselineSlope = 0, baselineOffset = 0;
+  // http://kba.cloud/hocr-spec/1.2/#x_size
+  float xSize = 0;
+  // http://kba.cloud/hocr-spec/1.2/#x_fsize
+  float xFsize = 0;
+  // http://kba.cloud/hocr-spec/1.2/#textangle
+  float textAngle = 0;
+};
+
+/* @brief Parse a hOCR title attribute without allocating
+ * Properties are separated by ';' and values by whitespace. Unknown
+ * properties are skipped, quoted values (image "a;b.png") are respected.
+ * @return false if a known property was malformed. The other properties are
+ * still parsed.
+ */
+bool parseHocrTitle(std::string_view title, HocrTitle &out);
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_HOCR_TITLE_H
@@ -0,0 +1,343 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+// c++17
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+// Local Project
+#include "bankStatement.hpp"
+#include "invoice.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+namespace {
+
+// ordered, the highest label of a line wins: "Total Tax" is the tax
+enum class InvoiceLabel : unsigned int {
+  none = 0,
+  other,
+  total,
+  tax,
+  subtotal
+};
+
+// up to eight lower case letters in one integer, the first in the high byte
+constexpr unsigned long long packLabel(std::string_view name) {
+  unsigned long long key = 0;
+  for (char c : name) {
+    key = key << 8 | static_cast<unsigned char>(c);
+  }
+  return key;
+}
+
+inline char toLower(char c) {
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+/* @brief Lower case word without the punctuation around it
+ * @return false if the word is longer than the buffer
+ */
+bool getLowerWord(std::string_view word, char (&buffer)[16],
+                  std::string_view &lower) {
+  while (!word.empty() && (word.back() == ':' || word.back() == '.' ||
+                           word.back() == '#' || word.back() == ',')) {
+    word.remove_suffix(1);
+  }
+  if (word.size() > sizeof(buffer)) {
+    return false;
+  }
+  for (std::size_t i = 0; i < word.size(); i++) {
+    buffer[i] = toLower(word[i]);
+  }
+  lower = std::string_view(buffer, word.size());
+  return true;
+}
+
+/* @brief Label of a word like "Total:", "GST" or "Sub-Total"
+ * The first byte and the length turn most words away, the rest is one
+ * switch on the packed letters.
+ */
+InvoiceLabel getInvoiceLabel(std::string_view word) {
+  while (!word.empty() && (word.back() == ':' || word.back() == '.' ||
+                           word.back() == '#' || word.back() == ',')) {
+    word.remove_suffix(1);
+  }
+  // "sub-total" is the only label of nine bytes, packed without its hyphen
+  if (word.size() < 3 || word.size() > 9 ||
+      (word.size() == 9 && word[3] != '-')) {
+    return InvoiceLabel::none;
+  }
+  unsigned long long key = 0;
+  for (std::size_t i = 0; i < word.size(); i++) {
+    char c = toLower(word[i]);
+    if (c < 'a' || c > 'z') {
+      if (i == 3 && word.size() == 9) {
+        continue;
+      }
+      return InvoiceLabel::none;
+    }
+    key = key << 8 | static_cast<unsigned char>(c);
+  }
+  switch (key) {
+  case packLabel("subtotal"):
+    return InvoiceLabel::subtotal;
+  case packLabel("tax"):
+  case packLabel("vat"):
+  case packLabel("gst"):
+  case packLabel("hst"):
+  case packLabel("pst"):
+    return InvoiceLabel::tax;
+  case packLabel("total"):
+  case packLabel("due"):
+  case packLabel("balance"):
+    return InvoiceLabel::total;
+  case packLabel("cash"):
+  case packLabel("change"):
+  case packLabel("tendered"):
+  case packLabel("tip"):
+  case packLabel("paid"):
+  case packLabel("payment"):
+    return InvoiceLabel::other;
+  default:
+    return InvoiceLabel::none;
+  }
+}
+
+bool isAmountWord(std::string_view word) {
+  unsigned long long value;
+  bool negative;
+  return parseAmountToken(word, value, negative) > 0;
+}
+
+bool hasDigit(std::string_view word) {
+  return std::any_of(word.begin(), word.end(),
+                     [](char c) { return c >= '0' && c <= '9'; });
+}
+
+/* @brief The invoice number of a line, "Invoice # 1042", "Receipt No.
+ * 88-12" or "INV-1042"
+ * @return false if the line has none
+ */
+bool findInvoiceNumber(const HocrWordTable &table,
+                       const std::vector<unsigned int> &wordList,
+                       std::string &number) {
+  static const std::string_view keyList[] = {"invoice", "receipt", "order",
+                                             "inv"};
+  static const std::string_view fillerList[] = {"", "no", "num", "number",
+                                                "nr"};
+  char buffer[16];
+  std::string_view lower;
+  for (std::size_t i = 0; i < wordList.size(); i++) {
+    std::string_view word = table[wordList[i]].value();
+    if (!getLowerWord(word, buffer, lower)) {
+      continue;
+    }
+    if (lower.size() > 4 && lower.substr(0, 4) == "inv-" && hasDigit(lower)) {
+      number.assign(word.data(), word.size());
+      return true;
+    }
+    if (std::find(std::begin(keyList), std::end(keyList), lower) ==
+        std::end(keyList)) {
+      continue;
+    }
+    for (std::size_t j = i + 1; j < wordList.size() && j <= i + 3; j++) {
+      std::string_view next = table[wordList[j]].value();
+      if (hasDigit(next)) {
+        while (!next.empty() && next.front() == '#') {
+          next.remove_prefix(1);
+        }
+        number.assign(next.data(), next.size());
+        return true;
+      }
+      if (!getLowerWord(next, buffer, lower) ||
+          std::find(std::begin(fillerList), std::end(fillerList), lower) ==
+              std::end(fillerList)) {
+        break;
+      }
+    }
+  }
+  return false;
+}
+
+/* Items end in an amount with cents, the line amount
+ * the other amount columns right to left: the first of mostly whole
+ * numbers is the quantity, the first with cents the unit price
+ */
+class InvoiceSchema {
+public:
+  using Document = FileTypeInvoice;
+  enum Column : unsigned int {
+    description = 0,
+    quantity,
+    unitPrice,
+    amount,
+    columnCount
+  };
+  static constexpr DocumentFieldKind fieldKind[columnCount] = {
+      DocumentFieldKind::text, DocumentFieldKind::amount,
+      DocumentFieldKind::amount, DocumentFieldKind::amount};
+  // items have no head, the quantity may come first or not at all
+  static constexpr unsigned int headColumn = description;
+  static constexpr unsigned int textColumn = description;
+
+  static bool matchRow(const HocrWordTable &table,
+                       const std::vector<unsigned int> &wordList,
+                       unsigned int &headWords) {
+    headWords = 0;
+    if (wordList.size() < 2) {
+      return false;
+    }
+    std::string_view last = table[wordList.back()].value();
+    if (!hasAmountCents(last) || !isAmountWord(last)) {
+      return false;
+    }
+    // one label switch and at most one amount parse a word, a word
+    // starting with a letter fails the parse at its first byte
+    bool hasText = false;
+    for (std::size_t i = 0; i + 1 < wordList.size(); i++) {
+      std::string_view word = table[wordList[i]].value();
+      // a total, not an item
+      if (getInvoiceLabel(word) != InvoiceLabel::none) {
+        return false;
+      }
+      hasText = hasText || !isAmountWord(word);
+    }
+    return hasText;
+  }
+
+  static void assignBands(const DocumentLayout &layout,
+                          std::vector<unsigned char> &bandColumn) {
+    const std::vector<int> &amountBandList = layout.amountBandList;
+    if (amountBandList.empty()) {
+      return;
+    }
+    bandColumn[amountBandList.back()] = amount;
+    bool hasQuantity = false, hasUnitPrice = false;
+    for (std::size_t i = amountBandList.size() - 1; i-- > 0;) {
+      const DocumentColumnBand &band = layout.bandList[amountBandList[i]];
+      if (band.wholeCount * 2 > band.amountCount) {
+        if (!hasQuantity) {
+          bandColumn[amountBandList[i]] = quantity;
+          hasQuantity = true;
+        }
+      } else if (!hasUnitPrice) {
+        bandColumn[amountBandList[i]] = unitPrice;
+        hasUnitPrice = true;
+      }
+    }
+  }
+
+  static void store(FileTypeInvoice &invoice, const HocrWordTable &table,
+                    const DocumentLayout &layout,
+                    DocumentFields<InvoiceSchema> &fields,
+                    const StatementFieldOptions &options) {
+    const StatementAmountColumn &quantityColumn = fields.amountList[quantity],
+                                &unitPriceColumn = fields.amountList[unitPrice],
+                                &amountColumn = fields.amountList[amount];
+    for (unsigned int i = 0; i < fields.rowCount; i++) {
+      FileTypeInvoiceRow &row = invoice.rowMap[i];
+      row.description = std::move(fields.textList[description][i]);
+      const DocumentRowBox &box = fields.boxList[i];
+      row.x0 = box.x0;
+      row.y0 = box.y0;
+      row.x1 = box.x1;
+      row.y1 = box.y1;
+      row.quantity = quantityColumn.value[i];
+      row.quantityConfidence = quantityColumn.confidence[i];
+      row.unitPrice = unitPriceColumn.value[i];
+      row.unitPriceConfidence = unitPriceColumn.confidence[i];
+      row.amount = amountColumn.value[i];
+      row.amountSign = amountColumn.negative[i];
+      row.amountConfidence = amountColumn.confidence[i];
+    }
+    // the totals, number and date are on the lines around the items
+    unsigned long long value;
+    bool negative;
+    for (const DocumentLine &line : layout.lineList) {
+      if (line.row) {
+        continue;
+      }
+      if (invoice.number.empty()) {
+        findInvoiceNumber(table, line.wordList, invoice.number);
+      }
+      if (invoice.date.empty()) {
+        for (std::size_t i = 0; i < line.wordList.size(); i++) {
+          std::string_view word = table[line.wordList[i]].value();
+          int dateType = isStatementDate(word);
+          if (dateType == 0) {
+            continue;
+          }
+          // "Jan 15, 2020" takes the day and year after the month
+          std::size_t end = dateType == 1
+                                ? i + 1
+                                : std::min(i + 3, line.wordList.size());
+          for (std::size_t j = i; j < end; j++) {
+            if (!invoice.date.empty()) {
+              invoice.date += ' ';
+            }
+            std::string_view part = table[line.wordList[j]].value();
+            invoice.date.append(part.data(), part.size());
+          }
+          break;
+        }
+      }
+      if (line.wordList.size() < 2) {
+        continue;
+      }
+      InvoiceLabel label = InvoiceLabel::none;
+      for (std::size_t i = 0; i + 1 < line.wordList.size(); i++) {
+        label = std::max(label,
+                         getInvoiceLabel(table[line.wordList[i]].value()));
+      }
+      if (label < InvoiceLabel::total) {
+        continue;
+      }
+      float confidence = parseAmountToken(
+          table[line.wordList.back()].value(), value, negative);
+      if (confidence == 0) {
+        continue;
+      }
+      if (label == InvoiceLabel::subtotal) {
+        invoice.subtotal = value;
+        invoice.subtotalConfidence = confidence;
+      } else if (label == InvoiceLabel::tax) {
+        // GST and PST on two lines are one tax
+        invoice.taxConfidence = invoice.taxConfidence > 0
+                                    ? std::min(invoice.taxConfidence,
+                                               confidence)
+                                    : confidence;
+        invoice.tax += value;
+      } else {
+        invoice.total = value;
+        invoice.totalConfidence = confidence;
+      }
+    }
+    if (!invoice.date.empty()) {
+      std::vector<std::string_view> tokenList = {invoice.date};
+      StatementDateColumn dateColumn;
+      parseDateColumn(tokenList, options, dateColumn);
+      invoice.dateDay = dateColumn.day[0];
+      invoice.dateConfidence = dateColumn.confidence[0];
+    }
+  }
+};
+
+} // namespace
+
+std::shared_ptr<FileTypeInvoice>
+toInvoice(std::shared_ptr<HocrWordTable> wordTable,
+          const StatementFieldOptions &options) {
+  return extractDocumentTable<InvoiceSchema>(wordTable, options);
+}
+
+} // namespace bookfiler
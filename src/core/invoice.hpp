@@ -0,0 +1,79 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_INVOICE_H
+#define BOOKFILER_MODULE_RECOGNIZE_INVOICE_H
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Local Project
+#include "../Interface.hpp"
+#include "documentLayout.hpp"
+#include "statementFields.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+class FileTypeInvoiceRow {
+public:
+  // true for a credit or a discount line
+  bool amountSign = false;
+  // in hundredths, 150 for 1.5
+  unsigned long long quantity = 0;
+  // in cents
+  unsigned long long unitPrice = 0, amount = 0;
+  std::string description;
+  // 0 to 1, 0 when the field could not be read or has no column
+  float quantityConfidence = 0, unitPriceConfidence = 0,
+        amountConfidence = 0;
+  // bounding box of the words of the row, all lines included
+  unsigned int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+};
+
+/* An invoice or a receipt page, the totals are read from the labelled
+ * lines around the items
+ */
+class FileTypeInvoice {
+public:
+  std::shared_ptr<HocrWordTable> wordTable;
+  // keyed by row number, top to bottom
+  std::unordered_map<unsigned int, FileTypeInvoiceRow> rowMap;
+  // "INV-1042" or the word after "Invoice #", empty if none
+  std::string number;
+  // first full date of the page, dateDay counts from 1970-01-01
+  std::string date;
+  int dateDay = 0;
+  // in cents, the last line labelled total, due or balance
+  unsigned long long subtotal = 0, tax = 0, total = 0;
+  float dateConfidence = 0, subtotalConfidence = 0, taxConfidence = 0,
+        totalConfidence = 0;
+};
+
+/* @brief Rebuild the items and totals of an invoice or receipt page
+ * An item is a line ending in an amount with cents and holding a word
+ * that is not an amount. Of the amount columns the last is the line
+ * amount, one of whole numbers is the quantity and the one left with
+ * cents the unit price. Lines labelled subtotal, tax, total, due or
+ * balance are the totals, not items. See extractDocumentTable.
+ */
+std::shared_ptr<FileTypeInvoice>
+toInvoice(std::shared_ptr<HocrWordTable> wordTable,
+          const StatementFieldOptions &options = StatementFieldOptions());
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_INVOICE_H
@@ -0,0 +1,77 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_MPSC_QUEUE_H
+#define BOOKFILER_MODULE_RECOGNIZE_MPSC_QUEUE_H
+
+// c++17
+#include <atomic>
+#include <utility>
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+/* Unbounded FIFO, many threads push and one thread pops.
+ * push is one atomic exchange and never blocks. pop only belongs to the
+ * consumer; it may miss an item whose push has not finished yet, the
+ * producer is expected to wake the consumer after push returns.
+ */
+template <typename T> class MpscQueue {
+private:
+  class Node {
+  public:
+    std::atomic<Node *> next;
+    T value;
+    Node() : next(nullptr){};
+  };
+  // the newest node, producers link after it
+  std::atomic<Node *> head;
+  // the node before the oldest item, owned by the consumer
+  Node *tail;
+
+public:
+  MpscQueue() : head(new Node()) { tail = head.load(); };
+  MpscQueue(const MpscQueue &) = delete;
+  MpscQueue &operator=(const MpscQueue &) = delete;
+  ~MpscQueue() {
+    while (tail) {
+      Node *next = tail->next.load(std::memory_order_relaxed);
+      delete tail;
+      tail = next;
+    }
+  }
+  void push(T item) {
+    Node *node = new Node();
+    node->value = std::move(item);
+    Node *previous = head.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_release);
+  }
+  // consumer only
+  bool pop(T &item) {
+    Node *next = tail->next.load(std::memory_order_acquire);
+    if (!next) {
+      return false;
+    }
+    item = std::move(next->value);
+    next->value = T();
+    delete tail;
+    tail = next;
+    return true;
+  }
+  // consumer only
+  bool empty() const {
+    return tail->next.load(std::memory_order_acquire) == nullptr;
+  }
+};
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_MPSC_QUEUE_H
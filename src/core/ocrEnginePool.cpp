@@ -0,0 +1,159 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+// Local Project
+#include "ocrEnginePool.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+OcrEnginePool::OcrEnginePool(std::shared_ptr<OcrInterface> ocrModule_)
+    : ocrModule(ocrModule_), maxIdle(16), idleTimeout(300), checkouts(0),
+      hits(0), created(0), trimmed(0) {}
+
+void OcrEnginePool::configure(const RecognizeSettings &settings) {
+  std::vector<std::shared_ptr<Ocr>> dropList;
+  std::lock_guard<std::mutex> lock(mutex);
+  maxIdle = settings.ocrPoolMaxIdle;
+  idleTimeout = std::chrono::seconds(settings.ocrPoolIdleSeconds);
+  std::string ocrKey = settings.getOcrKey();
+  for (auto it = idleMap.begin(); it != idleMap.end();) {
+    if (it->first != ocrKey) {
+      for (OcrEngineIdle &idle : it->second) {
+        dropList.push_back(std::move(idle.ocr));
+      }
+      it = idleMap.erase(it);
+    } else {
+      it++;
+    }
+  }
+  auto it = idleMap.find(ocrKey);
+  if (it != idleMap.end() && it->second.size() > maxIdle) {
+    // the oldest go first
+    std::size_t dropCount = it->second.size() - maxIdle;
+    for (std::size_t i = 0; i < dropCount; i++) {
+      dropList.push_back(std::move(it->second[i].ocr));
+    }
+    it->second.erase(it->second.begin(), it->second.begin() + dropCount);
+  }
+  trimmed += dropList.size();
+  // the engines are destroyed after the lock, dropList outlives it
+}
+
+std::shared_ptr<Ocr>
+OcrEnginePool::checkOut(const RecognizeSettings &settings) {
+  checkouts++;
+  std::string ocrKey = settings.getOcrKey();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = idleMap.find(ocrKey);
+    if (it != idleMap.end() && !it->second.empty()) {
+      std::shared_ptr<Ocr> ocr = std::move(it->second.back().ocr);
+      it->second.pop_back();
+      hits++;
+      return ocr;
+    }
+  }
+  if (!ocrModule) {
+    return nullptr;
+  }
+  std::shared_ptr<Ocr> ocr = ocrModule->newOcr();
+  if (!ocr) {
+    return ocr;
+  }
+  created++;
+  ocr->setMode(settings.ocrMode);
+  ocr->setType(settings.ocrType);
+  ocr->setLanguage(settings.ocrLanguage);
+  ocr->setDataPath(settings.ocrDataPath);
+  return ocr;
+}
+
+void OcrEnginePool::checkIn(const std::string &ocrKey,
+                            std::shared_ptr<Ocr> ocr) {
+  if (!ocr) {
+    return;
+  }
+  // an idle engine calls back into no page, whoever set the last callback
+  ocr->onRecognizeDone([](std::shared_ptr<Ocr>) {});
+  std::vector<std::shared_ptr<Ocr>> dropList;
+  std::lock_guard<std::mutex> lock(mutex);
+  trimLocked(dropList);
+  std::vector<OcrEngineIdle> &idleList = idleMap[ocrKey];
+  if (idleList.size() >= maxIdle) {
+    trimmed++;
+    dropList.push_back(std::move(ocr));
+    return;
+  }
+  idleList.push_back({std::move(ocr), std::chrono::steady_clock::now()});
+}
+
+void OcrEnginePool::warmUp(const RecognizeSettings &settings,
+                           unsigned int count) {
+  std::string ocrKey = settings.getOcrKey();
+  std::vector<std::shared_ptr<Ocr>> ocrList;
+  while (getIdleCount() + ocrList.size() < count) {
+    std::shared_ptr<Ocr> ocr = checkOut(settings);
+    if (!ocr) {
+      break;
+    }
+    ocrList.push_back(ocr);
+  }
+  for (std::shared_ptr<Ocr> &ocr : ocrList) {
+    checkIn(ocrKey, std::move(ocr));
+  }
+}
+
+void OcrEnginePool::trimLocked(std::vector<std::shared_ptr<Ocr>> &dropList) {
+  std::chrono::steady_clock::time_point oldest =
+      std::chrono::steady_clock::now() - idleTimeout;
+  for (auto &idle : idleMap) {
+    std::vector<OcrEngineIdle> &idleList = idle.second;
+    // sorted by idleSince, the old ones are at the front
+    std::size_t dropCount = 0;
+    while (dropCount < idleList.size() &&
+           idleList[dropCount].idleSince < oldest) {
+      dropList.push_back(std::move(idleList[dropCount].ocr));
+      dropCount++;
+    }
+    idleList.erase(idleList.begin(), idleList.begin() + dropCount);
+    trimmed += dropCount;
+  }
+}
+
+void OcrEnginePool::trim() {
+  std::vector<std::shared_ptr<Ocr>> dropList;
+  std::lock_guard<std::mutex> lock(mutex);
+  trimLocked(dropList);
+}
+
+unsigned int OcrEnginePool::getIdleCount() {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::size_t idleCount = 0;
+  for (auto &idle : idleMap) {
+    idleCount += idle.second.size();
+  }
+  return static_cast<unsigned int>(idleCount);
+}
+
+void OcrEnginePool::toJson(rapidjson::Value &value,
+                           rapidjson::Document::AllocatorType &allocator) {
+  value.SetObject();
+  value.AddMember("checkouts", static_cast<uint64_t>(checkouts.load()),
+                  allocator);
+  value.AddMember("hits", static_cast<uint64_t>(hits.load()), allocator);
+  value.AddMember("created", static_cast<uint64_t>(created.load()),
+                  allocator);
+  value.AddMember("trimmed", static_cast<uint64_t>(trimmed.load()),
+                  allocator);
+  value.AddMember("idle", getIdleCount(), allocator);
+}
+
+} // namespace bookfiler
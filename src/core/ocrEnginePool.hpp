@@ -0,0 +1,92 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_OCR_ENGINE_POOL_H
+#define BOOKFILER_MODULE_RECOGNIZE_OCR_ENGINE_POOL_H
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/* rapidjson v1.1 (2016-8-25)
+ * Developed by Tencent
+ * License: MITs
+ */
+#include <rapidjson/document.h>
+
+// Local Project
+#include "../Interface.hpp"
+#include "recognizeSettings.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+class OcrEngineIdle {
+public:
+  std::shared_ptr<Ocr> ocr;
+  std::chrono::steady_clock::time_point idleSince;
+};
+
+/* Idle OCR engines kept configured between pages
+ * newOcr and the setMode, setType, setLanguage and setDataPath calls load
+ * the engine data, so an engine is checked out for a page and checked back
+ * in once its hOCR is read. Engines are keyed by the OCR configuration,
+ * RecognizeSettings::getOcrKey, so a settings change never hands out an
+ * engine set up for other languages. An idle engine keeps its last image
+ * until it is used again or trimmed.
+ */
+class OcrEnginePool {
+private:
+  std::mutex mutex;
+  std::shared_ptr<OcrInterface> ocrModule;
+  // most recently checked in last
+  std::unordered_map<std::string, std::vector<OcrEngineIdle>> idleMap;
+  unsigned int maxIdle;
+  std::chrono::seconds idleTimeout;
+  std::atomic<unsigned long long> checkouts, hits, created, trimmed;
+
+  // drop the engines idle longer than idleTimeout, mutex must be held
+  void trimLocked(std::vector<std::shared_ptr<Ocr>> &dropList);
+
+public:
+  OcrEnginePool(std::shared_ptr<OcrInterface> ocrModule_);
+  // pool size and idle timeout, idle engines of another configuration go
+  void configure(const RecognizeSettings &settings);
+  /* @brief An engine set up for the settings, idle or new
+   * @return null if the OCR module did not make one
+   */
+  std::shared_ptr<Ocr> checkOut(const RecognizeSettings &settings);
+  /* @brief Keep the engine idle, its recognize callback is reset first
+   * @param ocrKey the getOcrKey of the settings it was checked out with
+   */
+  void checkIn(const std::string &ocrKey, std::shared_ptr<Ocr> ocr);
+  /* @brief Create and set up engines until count are idle
+   * Blocks while the engines load their data.
+   */
+  void warmUp(const RecognizeSettings &settings, unsigned int count);
+  void trim();
+  unsigned int getIdleCount();
+  // {"checkouts", "hits", "created", "trimmed", "idle"}
+  void toJson(rapidjson::Value &value,
+              rapidjson::Document::AllocatorType &allocator);
+};
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_OCR_ENGINE_POOL_H
@@ -0,0 +1,256 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <algorithm>
+#include <cstdint>
+
+#if BOOKFILER_RECOGNIZE_FINGERPRINT_SSE2
+#include <emmintrin.h>
+#endif
+
+// Local Project
+#include "pageFingerprint.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+namespace {
+
+const unsigned int gridSize = PageFingerprint::gridSize;
+const unsigned int bitGridSize = PageFingerprint::bitGridSize;
+// fine cells per coarse cell on each side
+const unsigned int bitScale = bitGridSize / gridSize;
+
+// @return bytes below threshold
+inline std::size_t countDark(const unsigned char *p, std::size_t size,
+                             unsigned char threshold) {
+  std::size_t count = 0, i = 0;
+#if BOOKFILER_RECOGNIZE_FINGERPRINT_SSE2
+  if (threshold > 0) {
+    const __m128i limit = _mm_set1_epi8(static_cast<char>(threshold - 1));
+    const __m128i zero = _mm_setzero_si128();
+    while (size - i >= 16) {
+      // 255 chunks at most before a byte counter wraps
+      std::size_t end = i + std::min<std::size_t>((size - i) / 16, 255) * 16;
+      __m128i counter = zero;
+      for (; i < end; i += 16) {
+        __m128i bytes =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+        // 0xFF where the byte is at most threshold - 1, counted as -1
+        __m128i dark = _mm_cmpeq_epi8(_mm_min_epu8(bytes, limit), bytes);
+        counter = _mm_sub_epi8(counter, dark);
+      }
+      __m128i sum = _mm_sad_epu8(counter, zero);
+      count += static_cast<std::size_t>(_mm_cvtsi128_si32(sum)) +
+               static_cast<std::size_t>(
+                   _mm_cvtsi128_si32(_mm_srli_si128(sum, 8)));
+    }
+  }
+#endif
+  for (; i < size; i++) {
+    count += p[i] < threshold;
+  }
+  return count;
+}
+
+} // namespace
+
+bool computePageFingerprint(const Pixmap &pixmap,
+                            const PageSkipOptions &options,
+                            PageFingerprint &fingerprint) {
+  if (!pixmap.data || pixmap.bitsPerPixel < 8 || pixmap.bitsPerPixel % 8 ||
+      pixmap.width <= 0 || pixmap.height <= 0) {
+    return false;
+  }
+  long pixelBytes = pixmap.bitsPerPixel / 8;
+  double margin = std::min(std::max(options.margin, 0.0), 0.45);
+  long x0 = static_cast<long>(pixmap.width * margin);
+  long y0 = static_cast<long>(pixmap.height * margin);
+  long width = pixmap.width - 2 * x0, height = pixmap.height - 2 * y0;
+  if (width < static_cast<long>(bitGridSize) ||
+      height < static_cast<long>(bitGridSize)) {
+    return false;
+  }
+  unsigned char threshold =
+      static_cast<unsigned char>(std::min(options.inkThreshold, 255u));
+  /* byte offset of each fine column in a scan line, the coarse columns are
+   * every bitScale of them
+   */
+  std::size_t columnList[bitGridSize + 1];
+  for (unsigned int column = 0; column <= bitGridSize; column++) {
+    columnList[column] = static_cast<std::size_t>(
+        (x0 + width * static_cast<long>(column) / bitGridSize) * pixelBytes);
+  }
+  unsigned long long darkTotal = 0;
+  // dark samples of the fine cells of one coarse row
+  std::size_t darkList[bitScale][bitGridSize];
+  long rowList[bitScale + 1];
+  unsigned int inkSum = 0;
+  fingerprint.inkBits.reset();
+  for (unsigned int gridRow = 0; gridRow < gridSize; gridRow++) {
+    for (unsigned int part = 0; part <= bitScale; part++) {
+      rowList[part] =
+          y0 + height * static_cast<long>(gridRow * bitScale + part) /
+                   bitGridSize;
+    }
+    for (unsigned int part = 0; part < bitScale; part++) {
+      std::size_t *dark = darkList[part];
+      std::fill(dark, dark + bitGridSize, 0);
+      for (long y = rowList[part]; y < rowList[part + 1]; y++) {
+        const unsigned char *line = pixmap.data + y * pixmap.widthBytes;
+        for (unsigned int column = 0; column < bitGridSize; column++) {
+          dark[column] += countDark(line + columnList[column],
+                                    columnList[column + 1] - columnList[column],
+                                    threshold);
+        }
+      }
+    }
+    for (unsigned int column = 0; column < gridSize; column++) {
+      unsigned int first = column * bitScale, last = first + bitScale;
+      std::size_t coarseDark = 0;
+      for (unsigned int part = 0; part < bitScale; part++) {
+        for (unsigned int fine = first; fine < last; fine++) {
+          coarseDark += darkList[part][fine];
+        }
+      }
+      std::size_t coarseBytes = (columnList[last] - columnList[first]) *
+                                static_cast<std::size_t>(rowList[bitScale] -
+                                                         rowList[0]);
+      unsigned char ink = static_cast<unsigned char>(std::min<std::size_t>(
+          coarseDark * 255 / std::max<std::size_t>(coarseBytes, 1), 255));
+      fingerprint.inkGrid[gridRow * gridSize + column] = ink;
+      inkSum += ink;
+      darkTotal += coarseDark;
+      /* a fine cell is set when it is darker than its coarse cell, where the
+       * ink sits and not how much of it, so dense text still differs
+       */
+      for (unsigned int part = 0; part < bitScale; part++) {
+        std::size_t fineRows =
+            static_cast<std::size_t>(rowList[part + 1] - rowList[part]);
+        for (unsigned int fine = first; fine < last; fine++) {
+          std::size_t fineBytes =
+              (columnList[fine + 1] - columnList[fine]) * fineRows;
+          if (darkList[part][fine] * coarseBytes > coarseDark * fineBytes) {
+            fingerprint.inkBits.set((gridRow * bitScale + part) * bitGridSize +
+                                    fine);
+          }
+        }
+      }
+    }
+  }
+  fingerprint.inkSum = inkSum;
+  fingerprint.inkRatio = static_cast<double>(darkTotal) /
+                         (static_cast<double>(width) * pixelBytes * height);
+  return true;
+}
+
+bool isBlankPage(const PageFingerprint &fingerprint,
+                 const PageSkipOptions &options) {
+  return fingerprint.inkRatio < options.blankInkRatio;
+}
+
+double getFingerprintDistance(const PageFingerprint &a,
+                              const PageFingerprint &b) {
+  if (a.inkSum + b.inkSum == 0) {
+    return 0;
+  }
+  const unsigned char *p = a.inkGrid.data(), *q = b.inkGrid.data();
+  std::size_t size = a.inkGrid.size();
+  unsigned long long difference = 0;
+#if BOOKFILER_RECOGNIZE_FINGERPRINT_SSE2
+  __m128i sum = _mm_setzero_si128();
+  for (std::size_t i = 0; i < size; i += 16) {
+    __m128i left = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+    __m128i right = _mm_loadu_si128(reinterpret_cast<const __m128i *>(q + i));
+    sum = _mm_add_epi64(sum, _mm_sad_epu8(left, right));
+  }
+  difference = static_cast<unsigned long long>(_mm_cvtsi128_si32(sum)) +
+               static_cast<unsigned long long>(
+                   _mm_cvtsi128_si32(_mm_srli_si128(sum, 8)));
+#else
+  for (std::size_t i = 0; i < size; i++) {
+    difference += p[i] > q[i] ? p[i] - q[i] : q[i] - p[i];
+  }
+#endif
+  return static_cast<double>(difference) / (a.inkSum + b.inkSum);
+}
+
+double getFingerprintBitDistance(const PageFingerprint &a,
+                                 const PageFingerprint &b) {
+  std::size_t either = (a.inkBits | b.inkBits).count();
+  if (either == 0) {
+    return 0;
+  }
+  return static_cast<double>((a.inkBits ^ b.inkBits).count()) / either;
+}
+
+void PageFingerprintIndex::add(
+    std::shared_ptr<const PageFingerprint> fingerprint,
+    const std::string &filePath, unsigned int pageNum) {
+  if (!fingerprint || capacity == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  if (entryList.size() >= capacity) {
+    entryList.pop_front();
+  }
+  Entry entry;
+  entry.fingerprint = fingerprint;
+  entry.filePath = filePath;
+  entry.pageNum = pageNum;
+  entryList.push_back(entry);
+}
+
+bool PageFingerprintIndex::find(const PageFingerprint &fingerprint,
+                                double maxDistance, double maxBitDistance,
+                                Entry &entry) {
+  std::lock_guard<std::mutex> lock(mutex);
+  const Entry *best = nullptr;
+  double bestDistance = maxDistance;
+  for (const Entry &candidate : entryList) {
+    const PageFingerprint &other = *candidate.fingerprint;
+    /* the distance is at least the difference of the sums over their
+     * total, most pages are ruled out without reading the grids
+     */
+    unsigned int low = std::min(fingerprint.inkSum, other.inkSum),
+                 high = std::max(fingerprint.inkSum, other.inkSum);
+    if (high > 0 && static_cast<double>(high - low) / (high + low) >
+                        bestDistance) {
+      continue;
+    }
+    double distance = getFingerprintDistance(fingerprint, other);
+    if (distance <= bestDistance &&
+        getFingerprintBitDistance(fingerprint, other) <= maxBitDistance) {
+      best = &candidate;
+      bestDistance = distance;
+    }
+  }
+  if (!best) {
+    return false;
+  }
+  entry = *best;
+  return true;
+}
+
+void PageFingerprintIndex::clear() {
+  std::lock_guard<std::mutex> lock(mutex);
+  entryList.clear();
+}
+
+std::size_t PageFingerprintIndex::size() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return entryList.size();
+}
+
+} // namespace bookfiler
@@ -0,0 +1,128 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_PAGE_FINGERPRINT_H
+#define BOOKFILER_MODULE_RECOGNIZE_PAGE_FINGERPRINT_H
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <array>
+#include <bitset>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Local Project
+#include "../Interface.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+/* Pages checked before OCR
+ * A blank page is stored with an empty word table, a page close to one
+ * recognized earlier in the batch is stored with the word table of that
+ * page. Neither goes to the engine. A duplicate may differ in a few words
+ * from the page it copies, so it is only skipped when asked for.
+ */
+class PageSkipOptions {
+public:
+  bool skipBlank = true;
+  bool skipDuplicate = false;
+  // a sample byte darker than this is ink
+  unsigned int inkThreshold = 128;
+  // a page with less ink over the samples inside the margin is blank
+  double blankInkRatio = 0.001;
+  /* pages whose ink grids are this close are the same page if their ink
+   * bits are also within duplicateBitDistance
+   * 0 for the same ink in every cell, 1 for no ink in common
+   */
+  double duplicateDistance = 0.1;
+  double duplicateBitDistance = 0.25;
+  // left out on each side in fractions of the page, scanner edges and holes
+  double margin = 0.03;
+};
+
+/* Ink of a page inside the margin, downscaled to a grid
+ * The coarse grid finds the pages worth comparing, the bits at four times
+ * its size tell pages of the same layout apart.
+ */
+class PageFingerprint {
+public:
+  static const unsigned int gridSize = 32;
+  static const unsigned int bitGridSize = gridSize * 4;
+  // ink of each cell row by row, 255 is a cell of ink
+  std::array<unsigned char, gridSize * gridSize> inkGrid{};
+  // sum of inkGrid
+  unsigned int inkSum = 0;
+  // set for each fine cell an eighth ink or more, row by row
+  std::bitset<bitGridSize * bitGridSize> inkBits;
+  // dark samples over the samples
+  double inkRatio = 0;
+};
+
+/* @brief Count the ink of the pixmap in one pass over its scan lines
+ * Works on pixmaps of whole bytes per pixel, every sample byte is compared
+ * to the ink threshold.
+ * @return false if the pixmap can not be fingerprinted
+ */
+bool computePageFingerprint(const Pixmap &pixmap,
+                            const PageSkipOptions &options,
+                            PageFingerprint &fingerprint);
+bool isBlankPage(const PageFingerprint &fingerprint,
+                 const PageSkipOptions &options);
+/* @return sum of the cell differences over the sum of the cells, 0 when
+ * both pages are empty
+ */
+double getFingerprintDistance(const PageFingerprint &a,
+                              const PageFingerprint &b);
+// @return ink bits set in one page only over those set in either
+double getFingerprintBitDistance(const PageFingerprint &a,
+                                 const PageFingerprint &b);
+
+/* Pages recognized so far, looked up by fingerprint
+ * Holds the newest capacity pages. Safe from any thread.
+ */
+class PageFingerprintIndex {
+public:
+  class Entry {
+  public:
+    std::shared_ptr<const PageFingerprint> fingerprint;
+    std::string filePath;
+    unsigned int pageNum = 0;
+  };
+
+private:
+  std::mutex mutex;
+  std::deque<Entry> entryList;
+  std::size_t capacity;
+
+public:
+  PageFingerprintIndex(
+      std::size_t capacity_ = BOOKFILER_RECOGNIZE_FINGERPRINT_INDEX_PAGES)
+      : capacity(capacity_){};
+  void add(std::shared_ptr<const PageFingerprint> fingerprint,
+           const std::string &filePath, unsigned int pageNum);
+  /* @brief Closest page within maxDistance by the grid and maxBitDistance
+   * by the bits
+   * @return false if no page is that close
+   */
+  bool find(const PageFingerprint &fingerprint, double maxDistance,
+            double maxBitDistance, Entry &entry);
+  void clear();
+  std::size_t size();
+};
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_PAGE_FINGERPRINT_H
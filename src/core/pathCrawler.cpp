@@ -0,0 +1,229 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#endif
+
+/* boost 1.72.0
+ * License: Boost Software License (similar to BSD and MIT)
+ */
+#include <boost/filesystem.hpp>
+
+// Local Project
+#include "pathCrawler.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+namespace {
+
+bool startsWith(const unsigned char *data, std::size_t size,
+                const char *magic, std::size_t magicSize,
+                std::size_t offset = 0) {
+  return size >= offset + magicSize &&
+         std::memcmp(data + offset, magic, magicSize) == 0;
+}
+
+} // namespace
+
+FileKind sniffFileKind(const std::string &filePath) {
+  unsigned char data[16];
+  std::ifstream file(filePath, std::ios::binary);
+  file.read(reinterpret_cast<char *>(data), sizeof(data));
+  std::size_t size = static_cast<std::size_t>(file.gcount());
+  if (startsWith(data, size, "%PDF-", 5)) {
+    return FileKind::pdf;
+  }
+  if (startsWith(data, size, "\x89PNG\r\n\x1a\n", 8)) {
+    return FileKind::png;
+  }
+  if (startsWith(data, size, "\xff\xd8\xff", 3)) {
+    return FileKind::jpeg;
+  }
+  if (startsWith(data, size, "II*\0", 4) ||
+      startsWith(data, size, "MM\0*", 4)) {
+    return FileKind::tiff;
+  }
+  if (startsWith(data, size, "BM", 2)) {
+    return FileKind::bmp;
+  }
+  if (startsWith(data, size, "GIF87a", 6) ||
+      startsWith(data, size, "GIF89a", 6)) {
+    return FileKind::gif;
+  }
+  if (startsWith(data, size, "RIFF", 4) &&
+      startsWith(data, size, "WEBP", 4, 8)) {
+    return FileKind::webp;
+  }
+  if (size >= 3 && data[0] == 'P' && data[1] >= '1' && data[1] <= '7' &&
+      (data[2] == '\n' || data[2] == '\r' || data[2] == ' ' ||
+       data[2] == '\t')) {
+    return FileKind::pnm;
+  }
+  if (startsWith(data, size, "\0\0\0\x0cjP  \r\n\x87\n", 12) ||
+      startsWith(data, size, "\xff\x4f\xff\x51", 4)) {
+    return FileKind::jp2;
+  }
+  return FileKind::unknown;
+}
+
+bool isImageFileKind(FileKind kind) {
+  return kind != FileKind::unknown && kind != FileKind::pdf;
+}
+
+bool statCrawlFile(const std::string &filePath, CrawlFile &file) {
+  file.path = filePath;
+#if defined(_WIN32)
+  boost::system::error_code ec;
+  if (!boost::filesystem::is_regular_file(filePath, ec)) {
+    return false;
+  }
+  file.size = boost::filesystem::file_size(filePath, ec);
+  file.mtime = static_cast<long long>(
+                   boost::filesystem::last_write_time(filePath, ec)) *
+               1000000000LL;
+  file.inode = 0;
+  return !ec;
+#else
+  struct stat status;
+  if (::stat(filePath.c_str(), &status) != 0 || !S_ISREG(status.st_mode)) {
+    return false;
+  }
+  file.size = static_cast<unsigned long long>(status.st_size);
+#if defined(__APPLE__)
+  file.mtime =
+      static_cast<long long>(status.st_mtimespec.tv_sec) * 1000000000LL +
+      status.st_mtimespec.tv_nsec;
+#else
+  file.mtime = static_cast<long long>(status.st_mtim.tv_sec) * 1000000000LL +
+               status.st_mtim.tv_nsec;
+#endif
+  file.inode = static_cast<unsigned long long>(status.st_ino);
+  return true;
+#endif
+}
+
+PathCrawler::PathCrawler(unsigned int threadCount, FileCallback onFile_)
+    : active(0), stopFlag(false), onFile(onFile_), filesFound(0),
+      directoriesListed(0) {
+  if (threadCount == 0) {
+    threadCount = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (unsigned int i = 0; i < threadCount; i++) {
+    threadList.emplace_back(&PathCrawler::run, this);
+  }
+}
+
+PathCrawler::~PathCrawler() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopFlag = true;
+    pathList.clear();
+  }
+  workCondition.notify_all();
+  for (std::thread &thread : threadList) {
+    thread.join();
+  }
+}
+
+void PathCrawler::add(const std::vector<std::string> &pathList_) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pathList.insert(pathList.end(), pathList_.begin(), pathList_.end());
+  }
+  workCondition.notify_all();
+}
+
+void PathCrawler::run() {
+  while (true) {
+    std::string path;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      workCondition.wait(lock,
+                         [this] { return stopFlag || !pathList.empty(); });
+      if (stopFlag) {
+        return;
+      }
+      path = std::move(pathList.front());
+      pathList.pop_front();
+      active++;
+    }
+    crawlPath(path);
+    std::lock_guard<std::mutex> lock(mutex);
+    active--;
+  }
+}
+
+void PathCrawler::crawlPath(const std::string &path) {
+  CrawlFile file;
+  if (statCrawlFile(path, file)) {
+    filesFound++;
+    onFile(file);
+    return;
+  }
+  boost::system::error_code ec;
+  if (!boost::filesystem::is_directory(path, ec)) {
+    return;
+  }
+  directoriesListed++;
+  std::vector<std::string> directoryList;
+  for (boost::filesystem::directory_iterator it(path, ec), end;
+       !ec && it != end; it.increment(ec)) {
+    boost::system::error_code statusEc;
+    boost::filesystem::file_status status = it->symlink_status(statusEc);
+    if (statusEc) {
+      continue;
+    }
+    if (boost::filesystem::is_directory(status)) {
+      directoryList.push_back(it->path().string());
+      continue;
+    }
+    if (statCrawlFile(it->path().string(), file)) {
+      filesFound++;
+      onFile(file);
+    }
+    if (stopFlag) {
+      return;
+    }
+  }
+  if (!directoryList.empty()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (stopFlag) {
+        return;
+      }
+      pathList.insert(pathList.end(), directoryList.begin(),
+                      directoryList.end());
+    }
+    workCondition.notify_all();
+  }
+}
+
+std::size_t PathCrawler::getPending() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return pathList.size() + active;
+}
+
+unsigned long long PathCrawler::getFilesFound() { return filesFound; }
+
+unsigned long long PathCrawler::getDirectoriesListed() {
+  return directoriesListed;
+}
+
+} // namespace bookfiler
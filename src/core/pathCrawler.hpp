@@ -0,0 +1,110 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_PATH_CRAWLER_H
+#define BOOKFILER_MODULE_RECOGNIZE_PATH_CRAWLER_H
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+// what the first bytes of a file say it is
+enum class FileKind : unsigned int {
+  unknown = 0,
+  pdf,
+  png,
+  jpeg,
+  tiff,
+  bmp,
+  gif,
+  webp,
+  pnm,
+  jp2
+};
+
+/* @brief Read the magic bytes at the start of a file
+ * @return unknown if the file can not be read or is none of the kinds
+ */
+FileKind sniffFileKind(const std::string &filePath);
+// @return true for the kinds the OCR engine opens
+bool isImageFileKind(FileKind kind);
+
+/* A regular file found by the crawler
+ */
+class CrawlFile {
+public:
+  std::string path;
+  // unknown until sniffed
+  FileKind kind = FileKind::unknown;
+  unsigned long long size = 0;
+  // nanoseconds since the epoch
+  long long mtime = 0;
+  // 0 where the file system has none
+  unsigned long long inode = 0;
+};
+
+/* @brief Size, time and inode of a regular file
+ * @return false if it is not a regular file
+ */
+bool statCrawlFile(const std::string &filePath, CrawlFile &file);
+
+/* Walks directory trees on its own threads
+ * Each thread lists one directory at a time, hands every regular file in
+ * it to the callback and queues the subdirectories for the next free
+ * thread, so files come out while the walk goes on. Directory links are
+ * not followed. The callback runs on the crawler threads.
+ */
+class PathCrawler {
+public:
+  using FileCallback = std::function<void(CrawlFile &)>;
+
+private:
+  std::mutex mutex;
+  std::condition_variable workCondition;
+  // directories and added files waiting for a thread
+  std::deque<std::string> pathList;
+  std::size_t active;
+  std::atomic<bool> stopFlag;
+  std::vector<std::thread> threadList;
+  FileCallback onFile;
+  std::atomic<unsigned long long> filesFound, directoriesListed;
+
+  void run();
+  void crawlPath(const std::string &path);
+
+public:
+  // @param threadCount 0 uses the number of hardware threads
+  PathCrawler(unsigned int threadCount, FileCallback onFile_);
+  // drops the paths not reached yet
+  ~PathCrawler();
+  // files are handed over as they are, directories are walked
+  void add(const std::vector<std::string> &pathList_);
+  // @return paths waiting or being listed, 0 once the walk is done
+  std::size_t getPending();
+  unsigned long long getFilesFound();
+  unsigned long long getDirectoriesListed();
+};
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_PATH_CRAWLER_H
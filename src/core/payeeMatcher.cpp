@@ -0,0 +1,330 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+
+// Local Project
+#include "payeeMatcher.hpp"
+#include "recognizeScheduler.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+namespace {
+
+const unsigned char spaceSymbol = 1;
+const std::size_t maxPatternSymbols = 64;
+// a description is cut here, past the payee name are references
+const std::size_t maxTextSymbols = 256;
+const unsigned int gramSpace =
+    payeeSymbolCount * payeeSymbolCount * payeeSymbolCount;
+// descriptions matched by one job of matchList
+const std::size_t matchChunkRows = 64;
+
+/* Symbol of every byte, 0 for the ones dropped and spaceSymbol for the
+ * separators
+ */
+class PayeeSymbolTable {
+public:
+  std::array<unsigned char, 256> symbol{};
+
+  PayeeSymbolTable() {
+    symbol.fill(spaceSymbol);
+    unsigned char next = spaceSymbol + 1;
+    for (char c = 'A'; c <= 'Z'; c++) {
+      symbol[static_cast<unsigned char>(c)] = next;
+      symbol[static_cast<unsigned char>(c - 'A' + 'a')] = next;
+      next++;
+    }
+    for (char c = '0'; c <= '9'; c++) {
+      symbol[static_cast<unsigned char>(c)] = next++;
+    }
+    // what OCR reads one as the other
+    const char *confusionList[] = {"0OoQq", "1IiLl|", "2Zz",
+                                   "5Ss",   "6Gg",    "8Bb"};
+    for (const char *confusion : confusionList) {
+      unsigned char shared = symbol[static_cast<unsigned char>(confusion[0])];
+      for (const char *c = confusion; *c; c++) {
+        symbol[static_cast<unsigned char>(*c)] = shared;
+      }
+    }
+    symbol[static_cast<unsigned char>('\'')] = 0;
+    // UTF-8 letters are kept apart from the separators
+    for (unsigned int c = 0x80; c < 0x100; c++) {
+      symbol[c] = next;
+    }
+  }
+};
+
+const PayeeSymbolTable payeeSymbolTable;
+
+unsigned int getGram(const std::string &text, std::size_t i) {
+  return (static_cast<unsigned int>(text[i]) * payeeSymbolCount +
+          static_cast<unsigned int>(text[i + 1])) *
+             payeeSymbolCount +
+         static_cast<unsigned int>(text[i + 2]);
+}
+
+/* Spaces around the folded text, a payee starts and ends on a word of the
+ * description or pays an edit for each side that does not
+ */
+std::string padPayeeText(const std::string &folded) {
+  if (folded.empty()) {
+    return folded;
+  }
+  std::string padded(1, static_cast<char>(spaceSymbol));
+  padded += folded;
+  padded.push_back(static_cast<char>(spaceSymbol));
+  return padded;
+}
+
+unsigned int getMaxEdits(unsigned int paddedLength, double maxErrorRate) {
+  return static_cast<unsigned int>(
+      std::floor((paddedLength - 2) * maxErrorRate));
+}
+
+// distinct trigrams of text, sorted
+void getGramList(const std::string &text, std::vector<unsigned int> &gramList) {
+  gramList.clear();
+  for (std::size_t i = 0; i + 3 <= text.size(); i++) {
+    gramList.push_back(getGram(text, i));
+  }
+  std::sort(gramList.begin(), gramList.end());
+  gramList.erase(std::unique(gramList.begin(), gramList.end()),
+                 gramList.end());
+}
+
+} // namespace
+
+std::string foldPayeeText(std::string_view text) {
+  std::string folded;
+  folded.reserve(text.size());
+  for (char c : text) {
+    unsigned char symbol =
+        payeeSymbolTable.symbol[static_cast<unsigned char>(c)];
+    if (symbol == 0 ||
+        (symbol == spaceSymbol &&
+         (folded.empty() || folded.back() == static_cast<char>(spaceSymbol)))) {
+      continue;
+    }
+    folded.push_back(static_cast<char>(symbol));
+  }
+  if (!folded.empty() && folded.back() == static_cast<char>(spaceSymbol)) {
+    folded.pop_back();
+  }
+  return folded;
+}
+
+unsigned int payeeSearchDistance(std::string_view pattern,
+                                 std::string_view text) {
+  std::size_t m = std::min(pattern.size(), maxPatternSymbols);
+  if (m == 0) {
+    return 0;
+  }
+  std::array<uint64_t, payeeSymbolCount> peq{};
+  for (std::size_t i = 0; i < m; i++) {
+    peq[static_cast<unsigned char>(pattern[i])] |= uint64_t(1) << i;
+  }
+  uint64_t pv = ~uint64_t(0), mv = 0, high = uint64_t(1) << (m - 1);
+  unsigned int score = static_cast<unsigned int>(m), best = score;
+  for (char c : text) {
+    uint64_t eq = peq[static_cast<unsigned char>(c)];
+    uint64_t xv = eq | mv;
+    uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+    uint64_t ph = mv | ~(xh | pv);
+    uint64_t mh = pv & xh;
+    if (ph & high) {
+      score++;
+    } else if (mh & high) {
+      score--;
+    }
+    // the match may start anywhere in the text, row 0 stays 0
+    ph <<= 1;
+    mh <<= 1;
+    pv = mh | ~(xv | ph);
+    mv = ph & xv;
+    best = std::min(best, score);
+  }
+  return best;
+}
+
+PayeeMatcher::PayeeMatcher(std::vector<std::string> catalog_,
+                           const PayeeMatchOptions &options_)
+    : options(options_), catalog(std::move(catalog_)) {
+  patternEnd.reserve(catalog.size());
+  gramCount.reserve(catalog.size());
+  minShared.reserve(catalog.size());
+  // (trigram, payee) pairs counted, then placed, like a counting sort
+  gramStart.assign(gramSpace + 1, 0);
+  std::vector<std::vector<unsigned int>> payeeGramList(catalog.size());
+  for (std::size_t i = 0; i < catalog.size(); i++) {
+    std::string folded = padPayeeText(foldPayeeText(catalog[i]));
+    if (folded.size() > maxPatternSymbols) {
+      folded.resize(maxPatternSymbols - 1);
+      folded.push_back(static_cast<char>(spaceSymbol));
+    }
+    patternArena += folded;
+    patternEnd.push_back(static_cast<unsigned int>(patternArena.size()));
+    getGramList(folded, payeeGramList[i]);
+    gramCount.push_back(static_cast<unsigned char>(payeeGramList[i].size()));
+    int needed = static_cast<int>(gramCount.back()) -
+                 3 * static_cast<int>(getMaxEdits(
+                         static_cast<unsigned int>(folded.size()),
+                         options.maxErrorRate));
+    minShared.push_back(static_cast<unsigned char>(std::max(needed, 1)));
+    for (unsigned int gram : payeeGramList[i]) {
+      gramStart[gram + 1]++;
+    }
+  }
+  for (unsigned int g = 0; g < gramSpace; g++) {
+    gramStart[g + 1] += gramStart[g];
+  }
+  gramPayees.resize(gramStart[gramSpace]);
+  std::vector<unsigned int> cursor(gramStart.begin(), gramStart.end() - 1);
+  for (std::size_t i = 0; i < catalog.size(); i++) {
+    for (unsigned int gram : payeeGramList[i]) {
+      gramPayees[cursor[gram]++] = static_cast<unsigned int>(i);
+    }
+  }
+}
+
+PayeeMatch PayeeMatcher::match(std::string_view description,
+                               Scratch &scratch) const {
+  PayeeMatch result;
+  std::string text = foldPayeeText(description);
+  text.resize(std::min(text.size(), maxTextSymbols));
+  text = padPayeeText(text);
+  /* A payee of m symbols found with k edits keeps at least m - 2 - 3k of
+   * its trigrams, a payee is a candidate once it shares that many
+   */
+  if (scratch.countList.size() != catalog.size() ||
+      ++scratch.epoch == (1U << 24)) {
+    scratch.countList.assign(catalog.size(), 0);
+    scratch.epoch = 1;
+  }
+  const unsigned int stamp = scratch.epoch << 8;
+  getGramList(text, scratch.gramList);
+  scratch.touchedList.clear();
+  for (unsigned int gram : scratch.gramList) {
+    for (unsigned int i = gramStart[gram]; i < gramStart[gram + 1]; i++) {
+      unsigned int payee = gramPayees[i];
+      unsigned int &count = scratch.countList[payee];
+      count = (count & ~0xffU) == stamp ? count + 1 : stamp | 1;
+      if ((count & 0xff) == minShared[payee]) {
+        scratch.touchedList.push_back(payee);
+      }
+    }
+  }
+  // most shared first, of those the payees with the fewest trigrams
+  scratch.candidateList.clear();
+  for (unsigned int payee : scratch.touchedList) {
+    unsigned long long count = scratch.countList[payee] & 0xff;
+    unsigned long long key = count << 8 | (255 - gramCount[payee]);
+    scratch.candidateList.push_back(key << 32 | (UINT32_MAX - payee));
+  }
+  std::size_t candidates =
+      std::min<std::size_t>(options.candidates, scratch.candidateList.size());
+  std::nth_element(scratch.candidateList.begin(),
+                   scratch.candidateList.begin() + candidates,
+                   scratch.candidateList.end(),
+                   std::greater<unsigned long long>());
+  std::sort(scratch.candidateList.begin(),
+            scratch.candidateList.begin() + candidates,
+            std::greater<unsigned long long>());
+  /* Each edit costs a symbol matched and one more, so a long payee read
+   * with a few mistakes wins over a short one found in one of its words.
+   * The runner up is the best payee folding to other symbols, the same
+   * name twice in the catalog is not a doubt.
+   */
+  int bestScore = 0, secondScore = 0;
+  std::string_view bestPattern;
+  for (std::size_t i = 0; i < candidates; i++) {
+    unsigned int payee = UINT32_MAX - static_cast<unsigned int>(
+                                          scratch.candidateList[i]);
+    unsigned int begin = payee == 0 ? 0 : patternEnd[payee - 1];
+    unsigned int length = patternEnd[payee] - begin;
+    std::string_view pattern(patternArena.data() + begin, length);
+    unsigned int distance = payeeSearchDistance(pattern, text);
+    int score = static_cast<int>(length) - 2 * static_cast<int>(distance);
+    if (distance > getMaxEdits(length, options.maxErrorRate)) {
+      continue;
+    }
+    if (score <= bestScore) {
+      if (pattern != bestPattern) {
+        secondScore = std::max(secondScore, score);
+      }
+      continue;
+    }
+    if (pattern != bestPattern) {
+      secondScore = bestScore;
+    }
+    bestScore = score;
+    bestPattern = pattern;
+    result.payeeIndex = payee;
+    result.distance = distance;
+    result.confidence = 1 - static_cast<float>(distance) / (length - 2);
+  }
+  // the floors of the options, see PayeeMatchOptions
+  if (result.payeeIndex != PayeeMatch::none &&
+      (bestPattern.size() - 2 - result.distance < options.minSymbols ||
+       result.confidence < options.minConfidence ||
+       bestScore - secondScore < static_cast<int>(options.minMargin))) {
+    result = PayeeMatch();
+  }
+  return result;
+}
+
+void PayeeMatcher::matchList(
+    const std::vector<std::string_view> &descriptionList,
+    std::vector<PayeeMatch> &matchList_, RecognizeScheduler *scheduler,
+    SchedulerClient *client) const {
+  matchList_.assign(descriptionList.size(), PayeeMatch());
+  std::size_t chunkCount =
+      (descriptionList.size() + matchChunkRows - 1) / matchChunkRows;
+  auto matchChunk = [&](std::size_t chunk) {
+    Scratch scratch;
+    std::size_t end =
+        std::min(descriptionList.size(), (chunk + 1) * matchChunkRows);
+    for (std::size_t i = chunk * matchChunkRows; i < end; i++) {
+      matchList_[i] = match(descriptionList[i], scratch);
+    }
+  };
+  if (scheduler && client) {
+    scheduler->forEach(*client, chunkCount, matchChunk, 0);
+    return;
+  }
+  for (std::size_t chunk = 0; chunk < chunkCount; chunk++) {
+    matchChunk(chunk);
+  }
+}
+
+void PayeeMatcher::matchStatement(FileTypeBankStatement &statement) const {
+  Scratch scratch;
+  for (auto &rowPair : statement.rowMap) {
+    FileTypeBankStatementRow &row = rowPair.second;
+    PayeeMatch result = match(row.description, scratch);
+    if (result.payeeIndex == PayeeMatch::none) {
+      row.payee.clear();
+      row.payeeConfidence = 0;
+      continue;
+    }
+    row.payee = catalog[result.payeeIndex];
+    row.payeeConfidence = result.confidence;
+  }
+}
+
+} // namespace bookfiler
@@ -0,0 +1,138 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_PAYEE_MATCHER_H
+#define BOOKFILER_MODULE_RECOGNIZE_PAYEE_MATCHER_H
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Local Project
+#include "bankStatement.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+// recognizeScheduler.hpp includes the settings, which include this file
+class RecognizeScheduler;
+class SchedulerClient;
+
+/* How close a description has to be to a payee
+ */
+class PayeeMatchOptions {
+public:
+  // edits allowed per character of the payee name
+  double maxErrorRate = 0.25;
+  // payees sharing the most trigrams with the description that are checked
+  unsigned int candidates = 32;
+  /* A match is dropped unless it finds minSymbols of the payee less its
+   * edits, reaches minConfidence and beats the runner up by minMargin
+   * symbols of score. A description of an unknown payee is otherwise
+   * matched to any short name one edit from one of its words.
+   */
+  unsigned int minSymbols = 4;
+  double minConfidence = 0.85;
+  unsigned int minMargin = 2;
+};
+
+class PayeeMatch {
+public:
+  static const unsigned int none = UINT32_MAX;
+  // index in the catalog, none if nothing matched
+  unsigned int payeeIndex = none;
+  // edits, the OCR confusions not counted
+  unsigned int distance = 0;
+  // 1 - distance / payee symbols, 0 if nothing matched
+  float confidence = 0;
+};
+
+/* @brief Fold text to the alphabet the payees are matched in
+ * Letters are upper cased and the characters OCR confuses share one symbol:
+ * 0 O Q, 1 I L |, 2 Z, 5 S, 6 G and 8 B. Apostrophes are dropped and every
+ * other run of punctuation or space is one space.
+ * @return one symbol per byte, 1 to payeeSymbolCount - 1
+ */
+std::string foldPayeeText(std::string_view text);
+const unsigned int payeeSymbolCount = 40;
+
+/* Matches statement descriptions to a catalog of known payees
+ * The payees are folded, given a space on each side so they line up with
+ * the words of a description, and indexed by their trigrams. A description
+ * counts the trigrams it shares with each payee. Those that could be
+ * within maxErrorRate edits (q-gram lemma) and share the most are checked
+ * with the bit-parallel edit distance of Myers, the payee searched
+ * anywhere in the description. The payee matching the most symbols, two
+ * less for every edit, wins if it passes the floors of the options.
+ * Payees are cut to 62 symbols, empty ones never match. Immutable once
+ * built, match from any thread.
+ */
+class PayeeMatcher {
+public:
+  // per thread state of a match, reused between descriptions
+  class Scratch {
+  public:
+    /* epoch << 8 | shared trigrams of each payee, the count is 0 unless the
+     * epoch is the one of the call
+     */
+    std::vector<unsigned int> countList;
+    unsigned int epoch = 0;
+    std::vector<unsigned int> gramList, touchedList;
+    // shared << 40 | 255 - trigrams << 32 | ~payee
+    std::vector<unsigned long long> candidateList;
+  };
+
+private:
+  PayeeMatchOptions options;
+  std::vector<std::string> catalog;
+  // folded payees, payee i is [patternEnd[i-1], patternEnd[i]) of the arena
+  std::string patternArena;
+  std::vector<unsigned int> patternEnd;
+  // distinct trigrams of each payee, and how many a match keeps at least
+  std::vector<unsigned char> gramCount, minShared;
+  // payees of trigram g are [gramStart[g], gramStart[g + 1]) of gramPayees
+  std::vector<unsigned int> gramStart, gramPayees;
+
+public:
+  PayeeMatcher(std::vector<std::string> catalog_,
+               const PayeeMatchOptions &options_ = PayeeMatchOptions());
+  std::size_t size() const { return catalog.size(); }
+  const std::string &getPayee(unsigned int index) const {
+    return catalog[index];
+  }
+  PayeeMatch match(std::string_view description, Scratch &scratch) const;
+  /* @brief Match every description
+   * Chunks of rows, each with its own scratch, are jobs of the client on
+   * the scheduler. Without a scheduler they are matched in turn.
+   */
+  void matchList(const std::vector<std::string_view> &descriptionList,
+                 std::vector<PayeeMatch> &matchList_,
+                 RecognizeScheduler *scheduler = nullptr,
+                 SchedulerClient *client = nullptr) const;
+  // set the payee of every row of the statement
+  void matchStatement(FileTypeBankStatement &statement) const;
+};
+
+/* @brief Edit distance of the best match of pattern anywhere in text,
+ * both folded, Myers' bit-parallel algorithm
+ * @param pattern at most 64 symbols
+ */
+unsigned int payeeSearchDistance(std::string_view pattern,
+                                 std::string_view text);
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_PAYEE_MATCHER_H
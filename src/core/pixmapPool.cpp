@@ -0,0 +1,173 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+// Local Project
+#include "pixmapPool.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+PooledPixmap::PooledPixmap(std::unique_ptr<unsigned char[]> buffer_,
+                           std::size_t capacity_,
+                           std::weak_ptr<PixmapPool> pool_)
+    : buffer(std::move(buffer_)), capacity(capacity_), pool(pool_) {
+  data = buffer.get();
+  dataUINT = nullptr;
+}
+
+PooledPixmap::~PooledPixmap() {
+  std::shared_ptr<PixmapPool> poolPtr = pool.lock();
+  if (poolPtr) {
+    poolPtr->release(std::move(buffer), capacity);
+  }
+}
+
+PixmapPool::PixmapPool()
+    : cacheMaxBytes(256ULL * 1024 * 1024), budgetBytes(0),
+      budgetWait(1000), bytesCached(0), bytesInUse(0), bytesInUsePeak(0),
+      acquires(0), hits(0), misses(0), throttled(0), budgetOverruns(0),
+      dropped(0) {}
+
+void PixmapPool::configure(const RecognizeSettings &settings) {
+  bool overCache;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    cacheMaxBytes = settings.pixmapCacheMaxBytes;
+    budgetBytes = settings.pixmapBudgetBytes;
+    budgetWait = std::chrono::milliseconds(settings.pixmapBudgetWaitMs);
+    overCache = bytesCached > cacheMaxBytes;
+  }
+  if (overCache) {
+    trim();
+  }
+  // a larger budget lets the waiting producers go
+  releaseCondition.notify_all();
+}
+
+std::size_t PixmapPool::getSizeClass(std::size_t size) {
+  // below 4KB the classes would be smaller than a memory page
+  if (size <= 4096) {
+    return 4096;
+  }
+  std::size_t power = 4096;
+  while (power * 2 < size) {
+    power *= 2;
+  }
+  // power < size <= 2 * power, in steps of power / 4
+  std::size_t step = power / 4;
+  return power + (size - power + step - 1) / step * step;
+}
+
+std::shared_ptr<Pixmap> PixmapPool::newPixmap(long width, long height,
+                                              long bitsPerPixel,
+                                              long samplesPerPixel) {
+  if (width <= 0 || height <= 0 || bitsPerPixel <= 0) {
+    return nullptr;
+  }
+  long widthBytes = (width * bitsPerPixel + 31) / 32 * 4;
+  std::size_t size = static_cast<std::size_t>(widthBytes) * height;
+  std::size_t capacity = getSizeClass(size);
+  acquires++;
+  std::unique_ptr<unsigned char[]> buffer;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (budgetBytes && bytesInUse > 0 &&
+        bytesInUse + capacity > budgetBytes) {
+      throttled++;
+      bool fits = releaseCondition.wait_for(lock, budgetWait, [&]() {
+        return bytesInUse == 0 || bytesInUse + capacity <= budgetBytes;
+      });
+      if (!fits) {
+        budgetOverruns++;
+      }
+    }
+    auto it = freeMap.find(capacity);
+    if (it != freeMap.end() && !it->second.empty()) {
+      buffer = std::move(it->second.back());
+      it->second.pop_back();
+      bytesCached -= capacity;
+    }
+    bytesInUse += capacity;
+    if (bytesInUse > bytesInUsePeak) {
+      bytesInUsePeak = bytesInUse;
+    }
+  }
+  if (buffer) {
+    hits++;
+  } else {
+    misses++;
+    buffer.reset(new unsigned char[capacity]);
+  }
+  std::shared_ptr<PooledPixmap> pixmap = std::make_shared<PooledPixmap>(
+      std::move(buffer), capacity, weak_from_this());
+  pixmap->width = width;
+  pixmap->height = height;
+  pixmap->widthBytes = widthBytes;
+  pixmap->bitsPerPixel = bitsPerPixel;
+  pixmap->samplesPerPixel = samplesPerPixel;
+  pixmap->informat = 0;
+  return pixmap;
+}
+
+void PixmapPool::release(std::unique_ptr<unsigned char[]> buffer,
+                         std::size_t capacity) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    bytesInUse -= capacity;
+    if (bytesCached + capacity <= cacheMaxBytes) {
+      freeMap[capacity].push_back(std::move(buffer));
+      bytesCached += capacity;
+    } else {
+      dropped++;
+    }
+  }
+  releaseCondition.notify_all();
+  // a dropped buffer is freed here, outside the lock
+}
+
+void PixmapPool::trim() {
+  std::unordered_map<std::size_t, std::vector<std::unique_ptr<unsigned char[]>>>
+      freeOld;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    freeOld.swap(freeMap);
+    bytesCached = 0;
+  }
+  // freed here, outside the lock
+}
+
+void PixmapPool::toJson(rapidjson::Value &value,
+                        rapidjson::Document::AllocatorType &allocator) {
+  value.SetObject();
+  unsigned long long acquiresValue = acquires, hitsValue = hits;
+  value.AddMember("acquires", static_cast<uint64_t>(acquiresValue), allocator);
+  value.AddMember("hits", static_cast<uint64_t>(hitsValue), allocator);
+  value.AddMember("misses", static_cast<uint64_t>(misses.load()), allocator);
+  value.AddMember("hitRate",
+                  acquiresValue ? static_cast<double>(hitsValue) / acquiresValue
+                                : 0.0,
+                  allocator);
+  value.AddMember("throttled", static_cast<uint64_t>(throttled.load()),
+                  allocator);
+  value.AddMember("budgetOverruns",
+                  static_cast<uint64_t>(budgetOverruns.load()), allocator);
+  value.AddMember("dropped", static_cast<uint64_t>(dropped.load()),
+                  allocator);
+  std::lock_guard<std::mutex> lock(mutex);
+  value.AddMember("bytesInUse", static_cast<uint64_t>(bytesInUse), allocator);
+  value.AddMember("bytesInUsePeak", static_cast<uint64_t>(bytesInUsePeak),
+                  allocator);
+  value.AddMember("bytesCached", static_cast<uint64_t>(bytesCached),
+                  allocator);
+  value.AddMember("budgetBytes", static_cast<uint64_t>(budgetBytes),
+                  allocator);
+}
+
+} // namespace bookfiler
@@ -0,0 +1,100 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_PIXMAP_POOL_H
+#define BOOKFILER_MODULE_RECOGNIZE_PIXMAP_POOL_H
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/* rapidjson v1.1 (2016-8-25)
+ * Developed by Tencent
+ * License: MITs
+ */
+#include <rapidjson/document.h>
+
+// Local Project
+#include "../Interface.hpp"
+#include "recognizeSettings.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+class PixmapPool;
+
+/* Pixmap whose pixels belong to a PixmapPool
+ * The buffer goes back to the pool when the last reference drops, or is
+ * freed if the pool is gone.
+ */
+class PooledPixmap : public Pixmap {
+public:
+  std::unique_ptr<unsigned char[]> buffer;
+  std::size_t capacity;
+  std::weak_ptr<PixmapPool> pool;
+
+  PooledPixmap(std::unique_ptr<unsigned char[]> buffer_, std::size_t capacity_,
+               std::weak_ptr<PixmapPool> pool_);
+  ~PooledPixmap();
+};
+
+/* Recycles the pixel buffers of the rendered and opened pages
+ * A request is rounded up to a size class, a quarter of a power of two, so
+ * pages of about the same size share buffers. Released buffers are kept up
+ * to cacheMaxBytes. With a budget, newPixmap waits while the buffers handed
+ * out would go over it, until one is released or budgetWait passes. A
+ * budget only throttles, a wait that times out allocates anyway.
+ */
+class PixmapPool : public PixmapAllocator,
+                   public std::enable_shared_from_this<PixmapPool> {
+private:
+  std::mutex mutex;
+  std::condition_variable releaseCondition;
+  // released buffers keyed by size class
+  std::unordered_map<std::size_t, std::vector<std::unique_ptr<unsigned char[]>>>
+      freeMap;
+  unsigned long long cacheMaxBytes, budgetBytes;
+  std::chrono::milliseconds budgetWait;
+  unsigned long long bytesCached, bytesInUse, bytesInUsePeak;
+  std::atomic<unsigned long long> acquires, hits, misses, throttled,
+      budgetOverruns, dropped;
+
+public:
+  PixmapPool();
+  void configure(const RecognizeSettings &settings);
+  // @return the size class holding size bytes
+  static std::size_t getSizeClass(std::size_t size);
+  /* @brief A pixmap with uninitialized pixels
+   * Scan lines are padded to 4 bytes.
+   * @return null if the size is not positive
+   */
+  std::shared_ptr<Pixmap> newPixmap(long width, long height,
+                                    long bitsPerPixel, long samplesPerPixel);
+  // called by PooledPixmap
+  void release(std::unique_ptr<unsigned char[]> buffer, std::size_t capacity);
+  // free every cached buffer
+  void trim();
+  // {"acquires", "hits", "hitRate", "bytesInUse", "bytesInUsePeak", ...}
+  void toJson(rapidjson::Value &value,
+              rapidjson::Document::AllocatorType &allocator);
+};
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_PIXMAP_POOL_H
@@ -0,0 +1,77 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+// c++17
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+// Local Project
+#include "pixmapView.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+PixmapView::PixmapView(std::shared_ptr<Pixmap> parent_, long x_, long y_,
+                       long width_, long height_)
+    : parent(parent_), x(x_), y(y_) {
+  width = width_;
+  height = height_;
+  widthBytes = parent->widthBytes;
+  bitsPerPixel = parent->bitsPerPixel;
+  informat = parent->informat;
+  samplesPerPixel = parent->samplesPerPixel;
+  data = parent->data + y * parent->widthBytes + x * parent->bitsPerPixel / 8;
+  dataUINT = nullptr;
+}
+
+std::shared_ptr<PixmapView> newPixmapView(std::shared_ptr<Pixmap> parent,
+                                          long x, long y, long width,
+                                          long height) {
+  if (!parent || !parent->data) {
+    return nullptr;
+  }
+  long x1 = std::min(x + width, parent->width);
+  long y1 = std::min(y + height, parent->height);
+  x = std::max(x, 0L);
+  y = std::max(y, 0L);
+  if (parent->bitsPerPixel < 8 && parent->bitsPerPixel > 0) {
+    long pixelsPerByte = 8 / parent->bitsPerPixel;
+    x -= x % pixelsPerByte;
+  }
+  if (x1 <= x || y1 <= y) {
+    return nullptr;
+  }
+  return std::make_shared<PixmapView>(parent, x, y, x1 - x, y1 - y);
+}
+
+std::shared_ptr<PixmapView> newPixmapView(std::shared_ptr<Pixmap> parent,
+                                          const RecognizeRegion &region) {
+  if (!parent) {
+    return nullptr;
+  }
+  long x0 = static_cast<long>(std::floor(region.x0 * parent->width));
+  long y0 = static_cast<long>(std::floor(region.y0 * parent->height));
+  long x1 = static_cast<long>(std::ceil(region.x1 * parent->width));
+  long y1 = static_cast<long>(std::ceil(region.y1 * parent->height));
+  return newPixmapView(parent, x0, y0, x1 - x0, y1 - y0);
+}
+
+std::string getRegionKey(const RecognizeRegion *region) {
+  if (!region) {
+    return "";
+  }
+  char buffer[96];
+  std::snprintf(buffer, sizeof(buffer), "region %.4f %.4f %.4f %.4f",
+                region->x0, region->y0, region->x1, region->y1);
+  return buffer;
+}
+
+} // namespace bookfiler
@@ -0,0 +1,63 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_PIXMAP_VIEW_H
+#define BOOKFILER_MODULE_RECOGNIZE_PIXMAP_VIEW_H
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <memory>
+#include <string>
+
+// Local Project
+#include "../Interface.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+/* Rectangle of another pixmap sharing its pixels
+ * data points at the first pixel of the rectangle and widthBytes is the
+ * stride of the parent, so every scan line of the view is read in place.
+ * The parent is kept alive as long as the view.
+ */
+class PixmapView : public Pixmap {
+public:
+  std::shared_ptr<Pixmap> parent;
+  // top left corner in the parent
+  long x, y;
+
+  PixmapView(std::shared_ptr<Pixmap> parent_, long x_, long y_, long width_,
+             long height_);
+};
+
+/* @brief View of a rectangle of the pixmap, clipped to it
+ * x is moved left to a whole byte for pixels smaller than a byte.
+ * @return null if the rectangle holds no pixel
+ */
+std::shared_ptr<PixmapView> newPixmapView(std::shared_ptr<Pixmap> parent,
+                                          long x, long y, long width,
+                                          long height);
+/* @brief View of the region of the page, the region is in fractions of the
+ * pixmap size
+ * @return null if the region holds no pixel
+ */
+std::shared_ptr<PixmapView> newPixmapView(std::shared_ptr<Pixmap> parent,
+                                          const RecognizeRegion &region);
+
+/* @return the region as text for the cache key, empty for the whole page
+ */
+std::string getRegionKey(const RecognizeRegion *region);
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_PIXMAP_VIEW_H
@@ -0,0 +1,242 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+// c++17
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <vector>
+
+/* boost 1.72.0
+ * License: Boost Software License (similar to BSD and MIT)
+ */
+#include <boost/filesystem.hpp>
+
+// Local Project
+#include "recognizeCache.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+namespace {
+
+const char *cacheEntryExtension = ".bfwt";
+
+inline uint64_t rotl64(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+inline uint64_t mix64(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+} // namespace
+
+unsigned long long hashBytes(const void *data, std::size_t size,
+                             unsigned long long seed) {
+  const uint64_t prime1 = 0x9E3779B185EBCA87ULL, prime2 = 0xC2B2AE3D27D4EB4FULL;
+  const unsigned char *bytes = static_cast<const unsigned char *>(data);
+  uint64_t h = seed ^ (size * prime1);
+  std::size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t k;
+    std::memcpy(&k, bytes + i, 8);
+    h ^= rotl64(k * prime2, 31) * prime1;
+    h = rotl64(h, 27) * prime1 + prime2;
+  }
+  for (; i < size; i++) {
+    h ^= bytes[i] * prime1;
+    h = rotl64(h, 11) * prime2;
+  }
+  return mix64(h);
+}
+
+RecognizeCache::RecognizeCache()
+    : enabled(false), maxBytes(0), totalBytes(0), scanned(false), hits(0),
+      misses(0), stores(0), evictions(0) {}
+
+void RecognizeCache::configure(const RecognizeSettings &settings) {
+  std::lock_guard<std::mutex> lock(mutex);
+  enabled = settings.cacheEnabled && !settings.cachePath.empty() &&
+            settings.cacheMaxBytes > 0;
+  if (cachePath != settings.cachePath) {
+    scanned = false;
+  }
+  cachePath = settings.cachePath;
+  maxBytes = settings.cacheMaxBytes;
+  if (enabled) {
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(cachePath, ec);
+    enabled = !ec;
+  }
+}
+
+bool RecognizeCache::isEnabled() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return enabled;
+}
+
+bool RecognizeCache::hashFile(const std::string &filePath,
+                              unsigned long long &fileHash) {
+  std::ifstream file(filePath, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  std::vector<char> buffer(1 << 16);
+  unsigned long long hash = 0;
+  while (file) {
+    file.read(buffer.data(), buffer.size());
+    std::streamsize count = file.gcount();
+    if (count <= 0) {
+      break;
+    }
+    hash = hashBytes(buffer.data(), static_cast<std::size_t>(count), hash);
+  }
+  fileHash = hash;
+  return true;
+}
+
+std::string RecognizeCache::getKey(unsigned long long fileHash,
+                                   const std::string &ocrKey) {
+  unsigned long long settingsHash =
+      hashBytes(ocrKey.data(), ocrKey.size(), wordTableFileVersion);
+  char key[40];
+  std::snprintf(key, sizeof(key), "%016llx%016llx", fileHash, settingsHash);
+  return key;
+}
+
+std::string RecognizeCache::getEntryPath(const std::string &key) {
+  return (boost::filesystem::path(cachePath) / (key + cacheEntryExtension))
+      .string();
+}
+
+std::shared_ptr<HocrWordTable> RecognizeCache::load(const std::string &key) {
+  std::string entryPath;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!enabled) {
+      return nullptr;
+    }
+    entryPath = getEntryPath(key);
+  }
+  std::shared_ptr<HocrWordTable> table = readWordTableFile(entryPath);
+  if (!table) {
+    misses++;
+    return nullptr;
+  }
+  hits++;
+  // most recently used
+  boost::system::error_code ec;
+  boost::filesystem::last_write_time(entryPath, std::time(nullptr), ec);
+  return table;
+}
+
+void RecognizeCache::store(const std::string &key, const HocrWordTable &table) {
+  std::string entryPath;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!enabled) {
+      return;
+    }
+    entryPath = getEntryPath(key);
+  }
+  if (!writeWordTableFile(entryPath, table)) {
+    return;
+  }
+  stores++;
+  boost::system::error_code ec;
+  unsigned long long entryBytes = boost::filesystem::file_size(entryPath, ec);
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!scanned) {
+    scanLocked();
+  } else if (!ec) {
+    totalBytes += entryBytes;
+  }
+  if (totalBytes > maxBytes) {
+    evictLocked();
+  }
+}
+
+void RecognizeCache::scanLocked() {
+  totalBytes = 0;
+  boost::system::error_code ec;
+  for (boost::filesystem::directory_iterator it(cachePath, ec), end;
+       !ec && it != end; it.increment(ec)) {
+    if (it->path().extension() == cacheEntryExtension) {
+      boost::system::error_code sizeEc;
+      unsigned long long entryBytes =
+          boost::filesystem::file_size(it->path(), sizeEc);
+      if (!sizeEc) {
+        totalBytes += entryBytes;
+      }
+    }
+  }
+  scanned = true;
+}
+
+void RecognizeCache::evictLocked() {
+  class CacheEntry {
+  public:
+    std::time_t lastUse;
+    unsigned long long bytes;
+    boost::filesystem::path path;
+  };
+  std::vector<CacheEntry> entryList;
+  totalBytes = 0;
+  boost::system::error_code ec;
+  for (boost::filesystem::directory_iterator it(cachePath, ec), end;
+       !ec && it != end; it.increment(ec)) {
+    if (it->path().extension() != cacheEntryExtension) {
+      continue;
+    }
+    boost::system::error_code entryEc;
+    CacheEntry entry;
+    entry.path = it->path();
+    entry.bytes = boost::filesystem::file_size(entry.path, entryEc);
+    entry.lastUse = boost::filesystem::last_write_time(entry.path, entryEc);
+    if (!entryEc) {
+      totalBytes += entry.bytes;
+      entryList.push_back(entry);
+    }
+  }
+  // evict down to 90% so the next few stores do not evict again
+  unsigned long long target = maxBytes - maxBytes / 10;
+  std::sort(entryList.begin(), entryList.end(),
+            [](const CacheEntry &a, const CacheEntry &b) {
+              return a.lastUse < b.lastUse;
+            });
+  for (const CacheEntry &entry : entryList) {
+    if (totalBytes <= target) {
+      break;
+    }
+    boost::system::error_code removeEc;
+    if (boost::filesystem::remove(entry.path, removeEc)) {
+      totalBytes -= entry.bytes;
+      evictions++;
+    }
+  }
+}
+
+unsigned long long RecognizeCache::getHits() { return hits; }
+unsigned long long RecognizeCache::getMisses() { return misses; }
+unsigned long long RecognizeCache::getStores() { return stores; }
+unsigned long long RecognizeCache::getEvictions() { return evictions; }
+unsigned long long RecognizeCache::getTotalBytes() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return totalBytes;
+}
+
+} // namespace bookfiler
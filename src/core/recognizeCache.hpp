@@ -0,0 +1,82 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_CACHE_H
+#define BOOKFILER_MODULE_RECOGNIZE_CACHE_H
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Local Project
+#include "../Interface.hpp"
+#include "recognizeSettings.hpp"
+#include "wordTableFile.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+/* @brief 64 bit hash of a byte range, seed chains calls together
+ */
+unsigned long long hashBytes(const void *data, std::size_t size,
+                             unsigned long long seed);
+
+/* Content addressed on disk cache of recognized pages
+ * An entry is keyed by the hash of the input file, the page number and the
+ * OCR settings, so an edited file or a different language is a miss. Each
+ * entry is one word table file. The total size is bounded by evicting the
+ * least recently used entries, a hit touches the file modification time.
+ */
+class RecognizeCache {
+private:
+  std::mutex mutex;
+  bool enabled;
+  std::string cachePath;
+  unsigned long long maxBytes;
+  // bytes on disk, counted on the first store after configure
+  unsigned long long totalBytes;
+  bool scanned;
+  std::atomic<unsigned long long> hits, misses, stores, evictions;
+
+  std::string getEntryPath(const std::string &key);
+  void scanLocked();
+  void evictLocked();
+
+public:
+  RecognizeCache();
+  void configure(const RecognizeSettings &settings);
+  bool isEnabled();
+  /* @brief Hash the content of a file
+   * @return false if the file could not be read
+   */
+  bool hashFile(const std::string &filePath, unsigned long long &fileHash);
+  /* @return key of a file, append '-' and the page number for the key of
+   * one page
+   */
+  std::string getKey(unsigned long long fileHash, const std::string &ocrKey);
+  // @return null on a miss
+  std::shared_ptr<HocrWordTable> load(const std::string &key);
+  void store(const std::string &key, const HocrWordTable &table);
+  unsigned long long getHits();
+  unsigned long long getMisses();
+  unsigned long long getStores();
+  unsigned long long getEvictions();
+  unsigned long long getTotalBytes();
+};
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_CACHE_H
@@ -0,0 +1,295 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+// Local Project
+#include "recognizeMetrics.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+namespace {
+
+unsigned int bitWidth(std::uint64_t value) {
+  unsigned int width = 0;
+  while (value) {
+    value >>= 1;
+    width++;
+  }
+  return width;
+}
+
+// largest value of bucket i, which holds [2^(i-1), 2^i - 1]
+std::uint64_t bucketUpper(unsigned int i) {
+  return i == 0 ? 0 : (1ULL << i) - 1;
+}
+
+std::uint64_t toNanos(std::chrono::steady_clock::duration duration) {
+  long long nanos =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+  return nanos > 0 ? static_cast<std::uint64_t>(nanos) : 0;
+}
+
+} // namespace
+
+MetricHistogram::MetricHistogram() { reset(); }
+
+void MetricHistogram::record(std::uint64_t value) {
+  unsigned int index = bitWidth(value);
+  if (index >= bucketCount) {
+    index = bucketCount - 1;
+  }
+  bucketList[index].fetch_add(1, std::memory_order_relaxed);
+  count.fetch_add(1, std::memory_order_relaxed);
+  sum.fetch_add(value, std::memory_order_relaxed);
+  std::uint64_t maxOld = max.load(std::memory_order_relaxed);
+  while (value > maxOld &&
+         !max.compare_exchange_weak(maxOld, value, std::memory_order_relaxed)) {
+  }
+}
+
+void MetricHistogram::reset() {
+  for (std::atomic<std::uint64_t> &bucket : bucketList) {
+    bucket = 0;
+  }
+  count = 0;
+  sum = 0;
+  max = 0;
+}
+
+std::uint64_t MetricHistogram::getQuantile(double quantile) const {
+  std::uint64_t total = count.load(std::memory_order_relaxed);
+  if (total == 0) {
+    return 0;
+  }
+  std::uint64_t rank = static_cast<std::uint64_t>(quantile * total);
+  if (rank >= total) {
+    rank = total - 1;
+  }
+  std::uint64_t seen = 0;
+  for (unsigned int i = 0; i < bucketCount; i++) {
+    seen += bucketList[i].load(std::memory_order_relaxed);
+    if (seen > rank) {
+      std::uint64_t upper = bucketUpper(i);
+      std::uint64_t maxValue = max.load(std::memory_order_relaxed);
+      return upper < maxValue ? upper : maxValue;
+    }
+  }
+  return max.load(std::memory_order_relaxed);
+}
+
+void MetricHistogram::toJson(
+    rapidjson::Value &value,
+    rapidjson::Document::AllocatorType &allocator) const {
+  value.SetObject();
+  std::uint64_t total = count.load(std::memory_order_relaxed);
+  std::uint64_t sumValue = sum.load(std::memory_order_relaxed);
+  value.AddMember("count", static_cast<uint64_t>(total), allocator);
+  value.AddMember("sum", static_cast<uint64_t>(sumValue), allocator);
+  value.AddMember("mean",
+                  total ? static_cast<double>(sumValue) / total : 0.0,
+                  allocator);
+  value.AddMember("p50", static_cast<uint64_t>(getQuantile(0.5)), allocator);
+  value.AddMember("p90", static_cast<uint64_t>(getQuantile(0.9)), allocator);
+  value.AddMember("p99", static_cast<uint64_t>(getQuantile(0.99)), allocator);
+  value.AddMember("max",
+                  static_cast<uint64_t>(max.load(std::memory_order_relaxed)),
+                  allocator);
+  // only the non empty buckets, as [upper bound, count]
+  rapidjson::Value buckets(rapidjson::kArrayType);
+  for (unsigned int i = 0; i < bucketCount; i++) {
+    std::uint64_t bucketValue = bucketList[i].load(std::memory_order_relaxed);
+    if (bucketValue == 0) {
+      continue;
+    }
+    rapidjson::Value bucket(rapidjson::kArrayType);
+    bucket.PushBack(static_cast<uint64_t>(bucketUpper(i)), allocator);
+    bucket.PushBack(static_cast<uint64_t>(bucketValue), allocator);
+    buckets.PushBack(bucket, allocator);
+  }
+  value.AddMember("buckets", buckets, allocator);
+}
+
+RecognizeMetrics::RecognizeMetrics()
+    : enabled(true),
+      startNanos(toNanos(std::chrono::steady_clock::now().time_since_epoch())),
+      pagesDone(0), pagesFailed(0), wordsDone(0), hocrBytes(0), cacheHits(0),
+      cacheMisses(0), pagesBlank(0), pagesDuplicate(0), signalsQueued(0),
+      signalsDelivered(0), signalsCoalesced(0), signalsMerged(0) {}
+
+void RecognizeMetrics::reset() {
+  startNanos = toNanos(std::chrono::steady_clock::now().time_since_epoch());
+  for (MetricStageData &stageData : stageList) {
+    stageData.errors = 0;
+    stageData.latency.reset();
+  }
+  pageLatency.reset();
+  pageWords.reset();
+  parseNanosPerWord.reset();
+  pagesDone = 0;
+  pagesFailed = 0;
+  wordsDone = 0;
+  hocrBytes = 0;
+  cacheHits = 0;
+  cacheMisses = 0;
+  pagesBlank = 0;
+  pagesDuplicate = 0;
+  signalsQueued = 0;
+  signalsDelivered = 0;
+  signalsCoalesced = 0;
+  signalsMerged = 0;
+  signalQueueLatency.reset();
+}
+
+void RecognizeMetrics::record(MetricStage stage,
+                              std::chrono::steady_clock::duration duration) {
+  stageList[static_cast<unsigned int>(stage)].latency.record(
+      toNanos(duration));
+}
+
+void RecognizeMetrics::recordError(MetricStage stage) {
+  stageList[static_cast<unsigned int>(stage)].errors.fetch_add(
+      1, std::memory_order_relaxed);
+}
+
+void RecognizeMetrics::recordPage(
+    std::chrono::steady_clock::duration pageTime, std::size_t wordCount,
+    std::chrono::steady_clock::duration parseTime) {
+  if (!isEnabled()) {
+    return;
+  }
+  pagesDone.fetch_add(1, std::memory_order_relaxed);
+  wordsDone.fetch_add(wordCount, std::memory_order_relaxed);
+  if (pageTime.count() > 0) {
+    pageLatency.record(toNanos(pageTime) / 1000);
+  }
+  pageWords.record(wordCount);
+  if (wordCount > 0 && parseTime.count() > 0) {
+    parseNanosPerWord.record(toNanos(parseTime) / wordCount);
+  }
+}
+
+void RecognizeMetrics::recordPageFailed() {
+  if (isEnabled()) {
+    pagesFailed.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void RecognizeMetrics::recordCache(bool hit) {
+  if (isEnabled()) {
+    (hit ? cacheHits : cacheMisses).fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void RecognizeMetrics::recordPageSkipped(bool duplicate) {
+  if (isEnabled()) {
+    (duplicate ? pagesDuplicate : pagesBlank)
+        .fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+const char *RecognizeMetrics::getStageName(MetricStage stage) {
+  switch (stage) {
+  case MetricStage::render:
+    return "render";
+  case MetricStage::openImage:
+    return "openImage";
+  case MetricStage::ocr:
+    return "ocr";
+  case MetricStage::hocrText:
+    return "hocrText";
+  case MetricStage::hocrParse:
+    return "hocrParse";
+  case MetricStage::wordExtraction:
+    return "wordExtraction";
+  case MetricStage::cacheLoad:
+    return "cacheLoad";
+  case MetricStage::cacheStore:
+    return "cacheStore";
+  case MetricStage::signalDispatch:
+    return "signalDispatch";
+  case MetricStage::ocrSetup:
+    return "ocrSetup";
+  case MetricStage::fingerprint:
+    return "fingerprint";
+  case MetricStage::wordIndex:
+    return "wordIndex";
+  case MetricStage::payeeMatch:
+    return "payeeMatch";
+  default:
+    return "unknown";
+  }
+}
+
+std::shared_ptr<rapidjson::Document> RecognizeMetrics::toJson() const {
+  std::shared_ptr<rapidjson::Document> document =
+      std::make_shared<rapidjson::Document>();
+  document->SetObject();
+  rapidjson::Document::AllocatorType &allocator = document->GetAllocator();
+  document->AddMember("enabled", isEnabled(), allocator);
+  document->AddMember(
+      "uptimeSeconds",
+      (toNanos(std::chrono::steady_clock::now().time_since_epoch()) -
+       startNanos.load()) /
+          1e9,
+      allocator);
+  rapidjson::Value counters(rapidjson::kObjectType);
+  counters.AddMember("pagesDone", static_cast<uint64_t>(pagesDone.load()),
+                     allocator);
+  counters.AddMember("pagesFailed", static_cast<uint64_t>(pagesFailed.load()),
+                     allocator);
+  counters.AddMember("wordsDone", static_cast<uint64_t>(wordsDone.load()),
+                     allocator);
+  counters.AddMember("hocrBytes", static_cast<uint64_t>(hocrBytes.load()),
+                     allocator);
+  counters.AddMember("cacheHits", static_cast<uint64_t>(cacheHits.load()),
+                     allocator);
+  counters.AddMember("cacheMisses", static_cast<uint64_t>(cacheMisses.load()),
+                     allocator);
+  counters.AddMember("pagesBlank", static_cast<uint64_t>(pagesBlank.load()),
+                     allocator);
+  counters.AddMember("pagesDuplicate",
+                     static_cast<uint64_t>(pagesDuplicate.load()), allocator);
+  counters.AddMember("signalsQueued",
+                     static_cast<uint64_t>(signalsQueued.load()), allocator);
+  counters.AddMember("signalsDelivered",
+                     static_cast<uint64_t>(signalsDelivered.load()), allocator);
+  counters.AddMember("signalsCoalesced",
+                     static_cast<uint64_t>(signalsCoalesced.load()), allocator);
+  counters.AddMember("signalsMerged",
+                     static_cast<uint64_t>(signalsMerged.load()), allocator);
+  document->AddMember("counters", counters, allocator);
+  // stage latencies in nanoseconds
+  rapidjson::Value stages(rapidjson::kObjectType);
+  for (unsigned int i = 0; i < stageList.size(); i++) {
+    rapidjson::Value stage;
+    stageList[i].latency.toJson(stage, allocator);
+    stage.AddMember("errors",
+                    static_cast<uint64_t>(stageList[i].errors.load()),
+                    allocator);
+    stages.AddMember(rapidjson::StringRef(
+                         getStageName(static_cast<MetricStage>(i))),
+                     stage, allocator);
+  }
+  document->AddMember("stages", stages, allocator);
+  rapidjson::Value histograms(rapidjson::kObjectType);
+  rapidjson::Value histogram;
+  pageLatency.toJson(histogram, allocator);
+  histograms.AddMember("pageLatencyMicros", histogram, allocator);
+  pageWords.toJson(histogram, allocator);
+  histograms.AddMember("pageWords", histogram, allocator);
+  parseNanosPerWord.toJson(histogram, allocator);
+  histograms.AddMember("parseNanosPerWord", histogram, allocator);
+  signalQueueLatency.toJson(histogram, allocator);
+  histograms.AddMember("signalQueueMicros", histogram, allocator);
+  document->AddMember("histograms", histograms, allocator);
+  return document;
+}
+
+} // namespace bookfiler
@@ -0,0 +1,176 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_METRICS_H
+#define BOOKFILER_MODULE_RECOGNIZE_METRICS_H
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+/* rapidjson v1.1 (2016-8-25)
+ * Developed by Tencent
+ * License: MITs
+ */
+#include <rapidjson/document.h>
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+/* Log2 histogram, bucket i holds the values of bit width i.
+ * Recording is a few relaxed atomic adds, safe from any thread.
+ */
+class MetricHistogram {
+public:
+  static const unsigned int bucketCount = 64;
+  std::array<std::atomic<std::uint64_t>, bucketCount> bucketList;
+  std::atomic<std::uint64_t> count, sum, max;
+
+  MetricHistogram();
+  void record(std::uint64_t value);
+  void reset();
+  /* @brief Upper bound of the bucket holding the quantile
+   * @param quantile 0 to 1
+   */
+  std::uint64_t getQuantile(double quantile) const;
+  // {"count", "sum", "mean", "p50", "p90", "p99", "max", "buckets": [[le, n]]}
+  void toJson(rapidjson::Value &value,
+              rapidjson::Document::AllocatorType &allocator) const;
+};
+
+/* Stages of recognizing a page, each has a call count and a latency
+ * histogram in nanoseconds
+ */
+enum class MetricStage : unsigned int {
+  render = 0,
+  openImage,
+  ocr,
+  hocrText,
+  hocrParse,
+  wordExtraction,
+  cacheLoad,
+  cacheStore,
+  signalDispatch,
+  // engine from the pool or newOcr and its set up
+  ocrSetup,
+  // ink count of a page before OCR, see PageFingerprint
+  fingerprint,
+  // words of a stored page added to the word index
+  wordIndex,
+  // statement descriptions matched to the payee catalog
+  payeeMatch,
+  count
+};
+
+class MetricStageData {
+public:
+  std::atomic<std::uint64_t> errors;
+  MetricHistogram latency;
+  MetricStageData() : errors(0){};
+};
+
+/* Runtime metrics of one model
+ * Timers are only read when enabled, a disabled model pays one relaxed
+ * load per stage.
+ */
+class RecognizeMetrics {
+public:
+  std::atomic<bool> enabled;
+  // steady clock nanoseconds of the construction or the last reset
+  std::atomic<std::uint64_t> startNanos;
+  std::array<MetricStageData, static_cast<unsigned int>(MetricStage::count)>
+      stageList;
+  // open to stored, microseconds
+  MetricHistogram pageLatency;
+  // words per page
+  MetricHistogram pageWords;
+  // parse nanoseconds per word of each page
+  MetricHistogram parseNanosPerWord;
+  std::atomic<std::uint64_t> pagesDone, pagesFailed, wordsDone, hocrBytes,
+      cacheHits, cacheMisses;
+  // pages stored without OCR, counted in pagesDone too
+  std::atomic<std::uint64_t> pagesBlank, pagesDuplicate;
+  /* signals posted and delivered, see SignalDispatcher, and the posted
+   * ones dropped for a newer image or merged into an earlier word batch
+   */
+  std::atomic<std::uint64_t> signalsQueued, signalsDelivered,
+      signalsCoalesced, signalsMerged;
+  // posted to delivered, microseconds
+  MetricHistogram signalQueueLatency;
+
+  RecognizeMetrics();
+  bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+  void setEnabled(bool enabled_) { enabled = enabled_; }
+  void reset();
+  void record(MetricStage stage, std::chrono::steady_clock::duration duration);
+  void recordError(MetricStage stage);
+  /* @brief Count a stored page
+   * @param pageTime open to stored, zero if the page was not timed
+   * @param parseTime time spent in hocrParse for this page
+   */
+  void recordPage(std::chrono::steady_clock::duration pageTime,
+                  std::size_t wordCount,
+                  std::chrono::steady_clock::duration parseTime);
+  void recordPageFailed();
+  void recordCache(bool hit);
+  // a blank or duplicate page left out of the OCR
+  void recordPageSkipped(bool duplicate);
+  static const char *getStageName(MetricStage stage);
+  std::shared_ptr<rapidjson::Document> toJson() const;
+};
+
+/* Records the time from construction to stop() or destruction
+ * MetricTimer timer(metrics, MetricStage::ocr);
+ */
+class MetricTimer {
+public:
+  RecognizeMetrics *metrics;
+  MetricStage stage;
+  std::chrono::steady_clock::time_point start;
+
+  MetricTimer(RecognizeMetrics &metrics_, MetricStage stage_)
+      : metrics(metrics_.isEnabled() ? &metrics_ : nullptr), stage(stage_) {
+    if (metrics) {
+      start = std::chrono::steady_clock::now();
+    }
+  }
+  MetricTimer(const MetricTimer &) = delete;
+  MetricTimer &operator=(const MetricTimer &) = delete;
+  ~MetricTimer() { stop(); }
+  // @return the time recorded, zero if disabled or already stopped
+  std::chrono::steady_clock::duration stop() {
+    if (!metrics) {
+      return std::chrono::steady_clock::duration::zero();
+    }
+    std::chrono::steady_clock::duration duration =
+        std::chrono::steady_clock::now() - start;
+    metrics->record(stage, duration);
+    metrics = nullptr;
+    return duration;
+  }
+  // the stage failed, count it as an error instead of a latency
+  void cancel(bool error = true) {
+    if (metrics && error) {
+      metrics->recordError(stage);
+    }
+    metrics = nullptr;
+  }
+};
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_METRICS_H
@@ -14,68 +14,1666 @@
  */
 namespace bookfiler {
 
+namespace {
+
+bool isPdfFile(const std::string &filePath) {
+  std::ifstream file(filePath, std::ios::binary);
+  char magic[5];
+  file.read(magic, 5);
+  return file.gcount() == 5 && std::string_view(magic, 5) == "%PDF-";
+}
+
+bool isCancelled(const RecognizeTicket *ticket) {
+  return ticket && ticket->isCancelled();
+}
+
+// set by the engine callback, shared with it so a late call is harmless
+class OcrDone {
+public:
+  std::mutex mutex;
+  std::condition_variable condition;
+  bool done = false;
+};
+
+std::size_t getPixmapBytes(const Pixmap *pixmap) {
+  if (!pixmap || !pixmap->data || pixmap->widthBytes <= 0 ||
+      pixmap->height <= 0) {
+    return 0;
+  }
+  return static_cast<std::size_t>(pixmap->widthBytes) *
+         static_cast<std::size_t>(pixmap->height);
+}
+
+// the word table is counted with the hocrMap entry it shares
+std::size_t getStatementBytes(const FileTypeBankStatement *statement) {
+  if (!statement) {
+    return 0;
+  }
+  std::size_t bytes = sizeof(*statement) +
+                      statement->rowMap.bucket_count() * sizeof(void *);
+  for (const auto &row : statement->rowMap) {
+    bytes += sizeof(row) + 2 * sizeof(void *) + row.second.date.capacity() +
+             row.second.description.capacity() + row.second.payee.capacity();
+  }
+  return bytes;
+}
+
+std::size_t getInvoiceBytes(const FileTypeInvoice *invoice) {
+  if (!invoice) {
+    return 0;
+  }
+  std::size_t bytes = sizeof(*invoice) + invoice->number.capacity() +
+                      invoice->date.capacity() +
+                      invoice->rowMap.bucket_count() * sizeof(void *);
+  for (const auto &row : invoice->rowMap) {
+    bytes +=
+        sizeof(row) + 2 * sizeof(void *) + row.second.description.capacity();
+  }
+  return bytes;
+}
+
+// bounds of the rows of a table, false if it has none
+template <class Document>
+bool getRowBounds(const Document *document, DocumentRowBox &box) {
+  if (!document || document->rowMap.empty()) {
+    return false;
+  }
+  box.x0 = ~0u;
+  box.y0 = ~0u;
+  box.x1 = 0;
+  box.y1 = 0;
+  for (const auto &row : document->rowMap) {
+    box.x0 = std::min(box.x0, row.second.x0);
+    box.y0 = std::min(box.y0, row.second.y0);
+    box.x1 = std::max(box.x1, row.second.x1);
+    box.y1 = std::max(box.y1, row.second.y1);
+  }
+  return true;
+}
+
+} // namespace
+
 RecognizeModelInternal::RecognizeModelInternal(
     std::shared_ptr<OcrInterface> ocrModule_,
-    std::shared_ptr<PdfInterface> pdfModule_)
-    : ocrModule(ocrModule_), pdfModule(pdfModule_) {}
-RecognizeModelInternal::~RecognizeModelInternal() {}
+    std::shared_ptr<PdfInterface> pdfModule_,
+    std::shared_ptr<const RecognizeSettings> settings_,
+    std::shared_ptr<RecognizeCache> recognizeCache_,
+    std::shared_ptr<PixmapPool> pixmapPool_,
+    std::shared_ptr<OcrEnginePool> ocrEnginePool_,
+    std::shared_ptr<FileManifest> fileManifest_,
+    std::shared_ptr<WordIndex> wordIndex_,
+    std::shared_ptr<RecognizeScheduler> scheduler_)
+    : ocrModule(ocrModule_), pdfModule(pdfModule_), settings(settings_),
+      recognizeCache(recognizeCache_), pixmapPool(pixmapPool_),
+      ocrEnginePool(ocrEnginePool_), fileManifest(fileManifest_),
+      wordIndex(wordIndex_),
+      batchPagesDone(0), batchPagesFailed(0), batchFilesUnchanged(0),
+      batchFilesIgnored(0), nextTicketId(0), scheduler(scheduler_) {
+  if (!settings) {
+    settings = std::make_shared<RecognizeSettings>();
+  }
+  // a model made without the module keeps its own engines
+  if (!ocrEnginePool) {
+    ocrEnginePool = std::make_shared<OcrEnginePool>(ocrModule);
+    ocrEnginePool->configure(*settings);
+  }
+  // and its own index, in memory
+  if (!wordIndex) {
+    wordIndex = std::make_shared<WordIndex>();
+  }
+  // and its own workers
+  if (!scheduler) {
+    scheduler = std::make_shared<RecognizeScheduler>();
+    scheduler->configure(*settings);
+  }
+  schedulerClient = scheduler->addClient(
+      BOOKFILER_RECOGNIZE_BATCH_QUEUE_CAPACITY, [this]() { trimMemory(); });
+  metrics.setEnabled(settings->metricsEnabled);
+  signalDispatcher = std::make_unique<SignalDispatcher>(*this, metrics);
+  signalDispatcher->configure(settings->signalThread,
+                              settings->signalMergeBatches);
+}
+RecognizeModelInternal::~RecognizeModelInternal() {
+  // the crawler feeds the batch too, it stops first
+  pathCrawler.reset();
+  // running jobs call feedBatch when they finish, give them nothing to feed
+  {
+    std::lock_guard<std::mutex> lock(batchMutex);
+    pendingPaths.clear();
+  }
+  // queued jobs are dropped, running jobs finish before the model is gone
+  scheduler->removeClient(*schedulerClient);
+  // the signals they queued are still delivered
+  signalDispatcher.reset();
+}
+
+void RecognizeModelInternal::setSettings(
+    std::shared_ptr<const RecognizeSettings> settings_) {
+  std::atomic_store(&settings, settings_);
+  metrics.setEnabled(settings_->metricsEnabled);
+  signalDispatcher->configure(settings_->signalThread,
+                              settings_->signalMergeBatches);
+}
+
+std::shared_ptr<const RecognizeSettings> RecognizeModelInternal::getSettings() {
+  return std::atomic_load(&settings);
+}
+
+unsigned int RecognizeModelInternal::getDebugLevel() {
+  return getSettings()->debugLevel;
+}
+
+std::string
+RecognizeModelInternal::getCacheKeyBase(const std::string &filePath,
+                                        const RecognizeRegion *region) {
+  unsigned long long fileHash;
+  if (!recognizeCache || !recognizeCache->isEnabled() ||
+      !recognizeCache->hashFile(filePath, fileHash)) {
+    return "";
+  }
+  std::shared_ptr<const RecognizeSettings> settingsPtr = getSettings();
+  std::string ocrKey = settingsPtr->getOcrKey();
+  if (region) {
+    ocrKey += '\n' + getRegionKey(region);
+  }
+  // a page stored as skipped is not reused with other skip options
+  std::string skipKey = settingsPtr->getPageSkipKey();
+  if (!skipKey.empty()) {
+    ocrKey += '\n' + skipKey;
+  }
+  return recognizeCache->getKey(fileHash, ocrKey);
+}
+
+std::string RecognizeModelInternal::getCacheKey(const std::string &keyBase,
+                                                unsigned int pageNum) {
+  if (keyBase.empty()) {
+    return keyBase;
+  }
+  return keyBase + '-' + std::to_string(pageNum);
+}
+
+std::shared_ptr<HocrWordTable>
+RecognizeModelInternal::loadCached(const std::string &cacheKey) {
+  if (cacheKey.empty()) {
+    return nullptr;
+  }
+  MetricTimer timer(metrics, MetricStage::cacheLoad);
+  std::shared_ptr<HocrWordTable> wordTable = recognizeCache->load(cacheKey);
+  metrics.recordCache(wordTable != nullptr);
+  if (wordTable) {
+    metrics.recordPage(std::chrono::steady_clock::duration::zero(),
+                       wordTable->size(),
+                       std::chrono::steady_clock::duration::zero());
+  }
+  return wordTable;
+}
+
+void RecognizeModelInternal::storeCached(const std::string &cacheKey,
+                                         const HocrWordTable &table) {
+  if (cacheKey.empty()) {
+    return;
+  }
+  MetricTimer timer(metrics, MetricStage::cacheStore);
+  recognizeCache->store(cacheKey, table);
+}
+
+void RecognizeModelInternal::setDocumentRegion(
+    std::string documentType, std::shared_ptr<const RecognizeRegion> region) {
+  std::lock_guard<std::mutex> lock(regionMutex);
+  if (!region) {
+    regionMap.erase(documentType);
+    return;
+  }
+  DocumentRegion &documentRegion = regionMap[documentType];
+  documentRegion = DocumentRegion();
+  documentRegion.declared = region;
+  if (!region->learn) {
+    documentRegion.active = region;
+  }
+}
+
+std::shared_ptr<const RecognizeRegion>
+RecognizeModelInternal::getDocumentRegion(std::string documentType) {
+  std::lock_guard<std::mutex> lock(regionMutex);
+  auto it = regionMap.find(documentType);
+  return it == regionMap.end() ? nullptr : it->second.active;
+}
+
+std::shared_ptr<const RecognizeRegion>
+RecognizeModelInternal::getActiveRegion() {
+  return getDocumentRegion(
+      getDocumentExtractor(getSettings()->documentType).name);
+}
+
+void RecognizeModelInternal::learnRegion(const std::string &filePath,
+                                         unsigned int pageNum, long pageWidth,
+                                         long pageHeight) {
+  if (pageWidth <= 0 || pageHeight <= 0) {
+    return;
+  }
+  const char *documentType =
+      getDocumentExtractor(getSettings()->documentType).name;
+  {
+    std::lock_guard<std::mutex> lock(regionMutex);
+    auto it = regionMap.find(documentType);
+    if (it == regionMap.end() || it->second.active) {
+      return;
+    }
+  }
+  DocumentRowBox box;
+  if (!getRowBounds(getBankStatement(filePath, pageNum).get(), box) &&
+      !getRowBounds(getInvoice(filePath, pageNum).get(), box)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(regionMutex);
+  auto it = regionMap.find(documentType);
+  if (it == regionMap.end() || it->second.active) {
+    return;
+  }
+  DocumentRegion &documentRegion = it->second;
+  documentRegion.x0 =
+      std::min(documentRegion.x0, static_cast<double>(box.x0) / pageWidth);
+  documentRegion.y0 =
+      std::min(documentRegion.y0, static_cast<double>(box.y0) / pageHeight);
+  documentRegion.x1 =
+      std::max(documentRegion.x1, static_cast<double>(box.x1) / pageWidth);
+  documentRegion.y1 =
+      std::max(documentRegion.y1, static_cast<double>(box.y1) / pageHeight);
+  documentRegion.pagesLearned++;
+  if (documentRegion.pagesLearned < documentRegion.declared->learnPages) {
+    return;
+  }
+  std::shared_ptr<RecognizeRegion> region =
+      std::make_shared<RecognizeRegion>(*documentRegion.declared);
+  region->learn = false;
+  region->x0 = std::max(0.0, documentRegion.x0 - region->margin);
+  region->y0 = std::max(0.0, documentRegion.y0 - region->margin);
+  region->x1 = std::min(1.0, documentRegion.x1 + region->margin);
+  region->y1 = std::min(1.0, documentRegion.y1 + region->margin);
+  documentRegion.active = region;
+#if BOOKFILER_RECOGNIZE_MODEL_BATCH_DEBUG
+  if (getDebugLevel() >= 2) {
+    std::cout << "bookfiler::RecognizeModelInternal::learnRegion "
+              << getRegionKey(region.get()) << "\n";
+  }
+#endif
+}
+
+void RecognizeModelInternal::storeWordTable(
+    const std::string &filePath, unsigned int pageNum,
+    std::shared_ptr<Pixmap> pixmap, std::shared_ptr<HocrWordTable> wordTable) {
+  // for the Bookfiler™ Accounting
+  std::shared_ptr<const RecognizeSettings> settingsPtr = getSettings();
+  DocumentExtract extract;
+  {
+    MetricTimer timer(metrics, MetricStage::wordExtraction);
+    extract = extractDocument(settingsPtr->documentType, wordTable,
+                              settingsPtr->statementOptions);
+  }
+  std::shared_ptr<const PayeeMatcher> matcher = std::atomic_load(&payeeMatcher);
+  if (matcher && extract.statement) {
+    MetricTimer timer(metrics, MetricStage::payeeMatch);
+    matcher->matchStatement(*extract.statement);
+  }
+  {
+    MetricTimer timer(metrics, MetricStage::wordIndex);
+    wordIndex->addPage(filePath, pageNum, *wordTable);
+  }
+  std::lock_guard<std::mutex> lock(fileMapMutex);
+  std::shared_ptr<RecognizeFile> &filePtr = recognizeFileMap[filePath];
+  if (!filePtr) {
+    filePtr = std::make_shared<RecognizeFile>();
+    filePtr->lruIt = fileLruList.end();
+  }
+  RecognizeFile &file = *filePtr;
+  file.pixmapMap[pageNum] = pixmap;
+  file.hocrMap[pageNum] = wordTable;
+  // the type may have changed since the page was first stored
+  if (extract.statement) {
+    file.statementMap[pageNum] = extract.statement;
+  } else {
+    file.statementMap.erase(pageNum);
+  }
+  if (extract.invoice) {
+    file.invoiceMap[pageNum] = extract.invoice;
+  } else {
+    file.invoiceMap.erase(pageNum);
+  }
+  // counted again for the whole file, a page may replace an earlier one
+  std::size_t pixmapBytes = 0, wordBytes = 0;
+  for (auto &page : file.pixmapMap) {
+    pixmapBytes += getPixmapBytes(page.second.get());
+  }
+  for (auto &page : file.hocrMap) {
+    wordBytes += page.second->getMemoryBytes();
+  }
+  for (auto &page : file.statementMap) {
+    wordBytes += getStatementBytes(page.second.get());
+  }
+  for (auto &page : file.invoiceMap) {
+    wordBytes += getInvoiceBytes(page.second.get());
+  }
+  fileMapBytes += pixmapBytes + wordBytes - file.pixmapBytes - file.wordBytes;
+  fileMapPixmapBytes += pixmapBytes - file.pixmapBytes;
+  file.pixmapBytes = pixmapBytes;
+  file.wordBytes = wordBytes;
+  touchFileLocked(filePath, file);
+  evictFilesLocked(&file);
+}
+
+void RecognizeModelInternal::touchFileLocked(const std::string &filePath,
+                                             RecognizeFile &file) {
+  if (file.lruIt == fileLruList.end()) {
+    fileLruList.push_front(filePath);
+    file.lruIt = fileLruList.begin();
+  } else {
+    fileLruList.splice(fileLruList.begin(), fileLruList, file.lruIt);
+  }
+}
+
+void RecognizeModelInternal::evictFilesLocked(const RecognizeFile *keep) {
+  std::size_t maxBytes =
+      static_cast<std::size_t>(getSettings()->modelMaxBytes);
+  std::size_t schedulerBytes = scheduler->getMemoryLimit(*schedulerClient);
+  if (schedulerBytes > 0 && (maxBytes == 0 || schedulerBytes < maxBytes)) {
+    maxBytes = schedulerBytes;
+  }
+  if (maxBytes == 0 || fileMapBytes <= maxBytes) {
+    scheduler->setMemoryBytes(*schedulerClient, fileMapBytes);
+    return;
+  }
+  // the images first, the least recently used file first
+  for (auto it = fileLruList.rbegin();
+       it != fileLruList.rend() && fileMapBytes > maxBytes; ++it) {
+    RecognizeFile &file = *recognizeFileMap.find(*it)->second;
+    if (&file == keep || file.pixmapBytes == 0) {
+      continue;
+    }
+    file.pixmapMap.clear();
+    fileMapBytes -= file.pixmapBytes;
+    fileMapPixmapBytes -= file.pixmapBytes;
+    file.pixmapBytes = 0;
+    pixmapsEvicted++;
+  }
+  // then the words, kept on disk by the cache if it is on
+  bool reloadable = recognizeCache && recognizeCache->isEnabled();
+  while (fileMapBytes > maxBytes && !fileLruList.empty()) {
+    auto fileIt = recognizeFileMap.find(fileLruList.back());
+    RecognizeFile &file = *fileIt->second;
+    // keep was just used, it is last only when it is alone
+    if (&file == keep) {
+      break;
+    }
+    fileMapBytes -= file.pixmapBytes + file.wordBytes;
+    fileMapPixmapBytes -= file.pixmapBytes;
+    fileLruList.pop_back();
+    filesEvicted++;
+    if (!reloadable) {
+      recognizeFileMap.erase(fileIt);
+      continue;
+    }
+    for (auto &page : file.hocrMap) {
+      file.evictedPageList.push_back(page.first);
+    }
+    file.pixmapMap.clear();
+    file.hocrMap.clear();
+    file.statementMap.clear();
+    file.invoiceMap.clear();
+    file.pixmapBytes = 0;
+    file.wordBytes = 0;
+    file.lruIt = fileLruList.end();
+  }
+  scheduler->setMemoryBytes(*schedulerClient, fileMapBytes);
+}
+
+void RecognizeModelInternal::trimMemory() {
+  std::lock_guard<std::mutex> lock(fileMapMutex);
+  evictFilesLocked(nullptr);
+}
+
+void RecognizeModelInternal::reloadEvictedFile(const std::string &filePath) {
+  {
+    std::lock_guard<std::mutex> lock(fileMapMutex);
+    auto fileIt = recognizeFileMap.find(filePath);
+    if (fileIt == recognizeFileMap.end() ||
+        fileIt->second->evictedPageList.empty()) {
+      return;
+    }
+  }
+  // a second caller waits here and finds the pages loaded
+  std::lock_guard<std::mutex> reloadLock(reloadMutex);
+  std::vector<unsigned int> pageList;
+  {
+    std::lock_guard<std::mutex> lock(fileMapMutex);
+    auto fileIt = recognizeFileMap.find(filePath);
+    if (fileIt == recognizeFileMap.end()) {
+      return;
+    }
+    pageList.swap(fileIt->second->evictedPageList);
+    if (pageList.empty()) {
+      return;
+    }
+    filesReloaded++;
+  }
+  std::sort(pageList.begin(), pageList.end());
+  std::string keyBase = getCacheKeyBase(filePath, getActiveRegion().get());
+  // a multi-page image is cached whole under its first page
+  unsigned int coveredEnd = 0;
+  bool covered = false, missed = false;
+  for (unsigned int pageNum : pageList) {
+    if (covered && pageNum < coveredEnd) {
+      continue;
+    }
+    std::shared_ptr<HocrWordTable> wordTable =
+        loadCached(getCacheKey(keyBase, pageNum));
+    if (!wordTable) {
+      missed = true;
+      continue;
+    }
+    storeWordTablePages(filePath, pageNum, nullptr, wordTable);
+    coveredEnd = pageNum + static_cast<unsigned int>(std::max<std::size_t>(
+                               wordTable->pageEnd.size(), 1));
+    covered = true;
+  }
+  // the cache let go of the words, the next batch recognizes the file again
+  if (missed && fileManifest) {
+    fileManifest->erase(filePath);
+  }
+}
+
+void RecognizeModelInternal::storeWordTablePages(
+    const std::string &filePath, unsigned int pageNum,
+    std::shared_ptr<Pixmap> pixmap, std::shared_ptr<HocrWordTable> wordTable) {
+  if (wordTable->pageEnd.size() < 2) {
+    storeWordTable(filePath, pageNum, pixmap, wordTable);
+    return;
+  }
+  std::size_t beginIndex = 0;
+  for (std::size_t i = 0; i < wordTable->pageEnd.size(); i++) {
+    std::shared_ptr<HocrWordTable> pageTable =
+        std::make_shared<HocrWordTable>();
+    pageTable->pageNum = pageNum + static_cast<unsigned int>(i);
+    pageTable->append(*wordTable, beginIndex, wordTable->pageEnd[i]);
+    storeWordTable(filePath, pageTable->pageNum, i == 0 ? pixmap : nullptr,
+                   pageTable);
+    beginIndex = wordTable->pageEnd[i];
+  }
+}
+
+void RecognizeModelInternal::checkPageSkip(const Pixmap &pixmap,
+                                           PipelinePage &page,
+                                           PageFingerprintIndex *fileIndex) {
+  std::shared_ptr<const RecognizeSettings> settingsPtr = getSettings();
+  const PageSkipOptions &options = settingsPtr->pageSkip;
+  if (!options.skipBlank && !options.skipDuplicate) {
+    return;
+  }
+  std::shared_ptr<PageFingerprint> fingerprint =
+      std::make_shared<PageFingerprint>();
+  {
+    MetricTimer timer(metrics, MetricStage::fingerprint);
+    if (!computePageFingerprint(pixmap, options, *fingerprint)) {
+      timer.cancel(false);
+      return;
+    }
+  }
+  page.fingerprint = fingerprint;
+  if (options.skipBlank && isBlankPage(*fingerprint, options)) {
+    page.skip = PageSkip::blank;
+    return;
+  }
+  PageFingerprintIndex::Entry entry;
+  if (options.skipDuplicate &&
+      ((fileIndex &&
+        fileIndex->find(*fingerprint, options.duplicateDistance,
+                        options.duplicateBitDistance, entry)) ||
+       fingerprintIndex.find(*fingerprint, options.duplicateDistance,
+                             options.duplicateBitDistance, entry))) {
+    page.skip = PageSkip::duplicate;
+    page.duplicateFile = entry.filePath;
+    page.duplicatePage = entry.pageNum;
+  }
+}
+
+std::shared_ptr<HocrWordTable>
+RecognizeModelInternal::storeSkippedPage(const std::string &filePath,
+                                         const PipelinePage &page) {
+  std::shared_ptr<HocrWordTable> wordTable;
+  if (page.skip == PageSkip::blank) {
+    wordTable = std::make_shared<HocrWordTable>();
+  } else {
+    wordTable = getWordTable(page.duplicateFile, page.duplicatePage);
+    if (!wordTable) {
+      return nullptr;
+    }
+  }
+#if BOOKFILER_RECOGNIZE_MODEL_BATCH_DEBUG
+  if (getDebugLevel() >= 2) {
+    std::cout << "bookfiler::RecognizeModelInternal::storeSkippedPage("
+              << filePath << ") page " << page.pageNum
+              << (page.skip == PageSkip::blank ? " blank"
+                                               : " duplicate of page ")
+              << (page.skip == PageSkip::blank
+                      ? std::string()
+                      : std::to_string(page.duplicatePage) + " of " +
+                            page.duplicateFile)
+              << "\n";
+  }
+#endif
+  storeWordTable(filePath, page.pageNum, page.pixmap, wordTable);
+  storeCached(page.cacheKey, *wordTable);
+  metrics.recordPage(std::chrono::steady_clock::now() - page.pageStart,
+                     wordTable->size(),
+                     std::chrono::steady_clock::duration::zero());
+  metrics.recordPageSkipped(page.skip == PageSkip::duplicate);
+  return wordTable;
+}
+
+bool RecognizeModelInternal::recognizeSkippedPage(
+    PipelinePage &page, const RecognizeRegion *region,
+    const RecognizeTicket *ticket) {
+  page.skip = PageSkip::none;
+  std::shared_ptr<Pixmap> ocrPixmap = page.pixmap;
+  if (region && page.pixmap) {
+    std::shared_ptr<PixmapView> view = newPixmapView(page.pixmap, *region);
+    if (view) {
+      ocrPixmap = view;
+    }
+  }
+  page.ocr = checkOutOcr(page.ocrKey);
+  MetricTimer openTimer(metrics, MetricStage::openImage);
+  if (!page.ocr || !ocrPixmap || !page.ocr->openImagePixmapPtr(ocrPixmap)) {
+    openTimer.cancel();
+    checkInOcr(page.ocrKey, std::move(page.ocr));
+    return false;
+  }
+  openTimer.stop();
+  RecognizeScheduler::OcrPermit ocrPermit(*scheduler, *schedulerClient);
+  MetricTimer ocrTimer(metrics, MetricStage::ocr);
+  if (!runOcr(*page.ocr, ticket)) {
+    ocrTimer.cancel();
+    page.ocr.reset();
+    return false;
+  }
+  return true;
+}
 
 void RecognizeModelInternal::addPaths(
     std::shared_ptr<std::vector<std::string>> fileSelectedList) {
 #if BOOKFILER_RECOGNIZE_MODEL_ADD_PATHS
-  std::cout << "bookfiler::RecognizeModel::addPaths:\n";
-  for (auto a : *fileSelectedList) {
-    std::cout << a << "\n";
+  if (getDebugLevel() >= 2) {
+    std::cout << "bookfiler::RecognizeModel::addPaths:\n";
+    for (auto a : *fileSelectedList) {
+      std::cout << a << "\n";
+    }
+  }
+#endif
+  if (!ocrModule) {
+#if BOOKFILER_RECOGNIZE_MODEL_ADD_PATHS
+    if (getDebugLevel() >= 1) {
+      std::cout << "bookfiler::RecognizeModel::addPaths ERROR: ocrModule is "
+                   "null\n";
+    }
+#endif
+    return;
+  }
+  PathCrawler *crawler;
+  {
+    std::lock_guard<std::mutex> lock(batchMutex);
+    startCrawlerLocked();
+    // a new batch starts when the previous one is finished
+    if (pendingPaths.empty() && pathCrawler->getPending() == 0 &&
+        scheduler->getQueued(*schedulerClient) == 0 &&
+        scheduler->getRunning(*schedulerClient) == 0) {
+      batchStart = std::chrono::steady_clock::now();
+      batchPagesDone = 0;
+      batchPagesFailed = 0;
+      batchFilesUnchanged = 0;
+      batchFilesIgnored = 0;
+      fingerprintIndex.clear();
+    }
+    crawler = pathCrawler.get();
+  }
+  // the files are queued by the crawler threads as they are found
+  crawler->add(*fileSelectedList);
+}
+
+void RecognizeModelInternal::addCrawledFile(CrawlFile &file) {
+  FileManifestEntry entry;
+  if (fileManifest && fileManifest->find(file.path, entry) &&
+      entry.pages > 0 && entry.size == file.size &&
+      entry.mtime == file.mtime && entry.inode == file.inode &&
+      entry.configHash == getManifestConfigHash()) {
+    addUnchangedFile(file.path, entry.pages);
+    return;
+  }
+  // only the images and PDFs are worth an engine
+  file.kind = sniffFileKind(file.path);
+  if (!isImageFileKind(file.kind) &&
+      !(file.kind == FileKind::pdf && pdfModule)) {
+    batchFilesIgnored++;
+#if BOOKFILER_RECOGNIZE_MODEL_ADD_PATHS
+    if (getDebugLevel() >= 2) {
+      std::cout << "bookfiler::RecognizeModel::addPaths not an image: "
+                << file.path << "\n";
+    }
+#endif
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(batchMutex);
+    pendingPaths.push_back(file);
+  }
+  feedBatch();
+}
+
+void RecognizeModelInternal::addUnchangedFile(const std::string &filePath,
+                                              unsigned int pages) {
+  {
+    std::lock_guard<std::mutex> lock(fileMapMutex);
+    std::shared_ptr<RecognizeFile> &filePtr = recognizeFileMap[filePath];
+    if (!filePtr) {
+      filePtr = std::make_shared<RecognizeFile>();
+      filePtr->lruIt = fileLruList.end();
+    }
+    // stored as if evicted, reloadEvictedFile brings the words back
+    if (filePtr->hocrMap.empty() && filePtr->evictedPageList.empty()) {
+      for (unsigned int pageNum = 0; pageNum < pages; pageNum++) {
+        filePtr->evictedPageList.push_back(pageNum);
+      }
+    }
+  }
+  batchFilesUnchanged++;
+  batchPagesDone += pages;
+}
+
+unsigned long long RecognizeModelInternal::getManifestConfigHash() {
+  std::shared_ptr<const RecognizeSettings> settingsPtr = getSettings();
+  std::string key = settingsPtr->getOcrKey();
+  std::shared_ptr<const RecognizeRegion> region = getActiveRegion();
+  if (region) {
+    key += '\n' + getRegionKey(region.get());
+  }
+  std::string skipKey = settingsPtr->getPageSkipKey();
+  if (!skipKey.empty()) {
+    key += '\n' + skipKey;
+  }
+  return hashBytes(key.data(), key.size(), 0);
+}
+
+void RecognizeModelInternal::recordManifest(const CrawlFile &file) {
+  if (!fileManifest) {
+    return;
+  }
+  FileManifestEntry entry;
+  entry.size = file.size;
+  entry.mtime = file.mtime;
+  entry.inode = file.inode;
+  entry.configHash = getManifestConfigHash();
+  entry.pages = getStoredPageCount(file.path);
+  if (entry.pages > 0) {
+    fileManifest->record(file.path, entry);
+  }
+}
+
+unsigned int
+RecognizeModelInternal::getStoredPageCount(const std::string &filePath) {
+  std::lock_guard<std::mutex> lock(fileMapMutex);
+  auto fileIt = recognizeFileMap.find(filePath);
+  if (fileIt == recognizeFileMap.end()) {
+    return 0;
+  }
+  return static_cast<unsigned int>(fileIt->second->hocrMap.size() +
+                                   fileIt->second->evictedPageList.size());
+}
+
+void RecognizeModelInternal::startCrawlerLocked() {
+  if (!pathCrawler) {
+    pathCrawler = std::make_unique<PathCrawler>(
+        getSettings()->crawlThreads,
+        [this](CrawlFile &file) { addCrawledFile(file); });
+  }
+}
+
+void RecognizeModelInternal::feedBatch() {
+  std::lock_guard<std::mutex> lock(batchMutex);
+  while (!pendingPaths.empty()) {
+    CrawlFile file = pendingPaths.front();
+    bool submitted = scheduler->trySubmit(*schedulerClient, [this, file]() {
+      recognizeBatchFile(file);
+      feedBatch();
+    });
+    if (!submitted) {
+      // the pool is full, the next finished job feeds it again
+      break;
+    }
+    pendingPaths.pop_front();
+  }
+}
+
+void RecognizeModelInternal::recognizeBatchFile(const CrawlFile &file) {
+  const std::string &filePath = file.path;
+#if BOOKFILER_RECOGNIZE_MODEL_BATCH_DEBUG
+  if (getDebugLevel() >= 2) {
+    std::cout << "bookfiler::RecognizeModelInternal::recognizeBatchFile("
+              << filePath << ")\n";
   }
 #endif
+  if (getWordTable(filePath, 0)) {
+    return;
+  }
+  if (pdfModule && file.kind == FileKind::pdf) {
+    unsigned int pagesFailed = 0;
+    unsigned int pagesDone =
+        recognizePdfFile(filePath, false, nullptr, &pagesFailed);
+    batchPagesDone += pagesDone;
+    batchPagesFailed += pagesFailed;
+    // a file that did not open has no page to count
+    if (pagesDone == 0 && pagesFailed == 0) {
+      batchPagesFailed++;
+      metrics.recordPageFailed();
+    } else if (pagesDone > 0) {
+      recordManifest(file);
+    }
+    return;
+  }
+  if (recognizeImageFile(filePath, false, nullptr)) {
+    batchPagesDone++;
+    recordManifest(file);
+  } else {
+    batchPagesFailed++;
+  }
+}
+
+bool RecognizeModelInternal::recognizeImageFile(
+    const std::string &filePath, bool updateSignal,
+    const RecognizeTicket *ticket) {
+  std::chrono::steady_clock::time_point pageStart =
+      std::chrono::steady_clock::now();
+  std::shared_ptr<const RecognizeRegion> region = getActiveRegion();
+  std::string cacheKey =
+      getCacheKey(getCacheKeyBase(filePath, region.get()), 0);
+  std::shared_ptr<HocrWordTable> wordTable = loadCached(cacheKey);
+  PipelinePage page;
+  page.pageStart = pageStart;
+  // a cached page is only opened when it is going to be shown
+  if (!wordTable || updateSignal) {
+    page.ocr = checkOutOcr(page.ocrKey);
+    MetricTimer openTimer(metrics, MetricStage::openImage);
+    if (!page.ocr || !page.ocr->openImageFile(filePath)) {
+      openTimer.cancel();
+      checkInOcr(page.ocrKey, std::move(page.ocr));
+    } else {
+      page.pixmap = page.ocr->getPixmap();
+    }
+  }
+  if (!page.ocr && !wordTable) {
+    metrics.recordPageFailed();
+#if BOOKFILER_RECOGNIZE_MODEL_BATCH_DEBUG
+    if (getDebugLevel() >= 1) {
+      std::cout << "bookfiler::RecognizeModelInternal::recognizeImageFile("
+                << filePath << ") ERROR: can not open the image\n";
+    }
+#endif
+    return false;
+  }
+  if (updateSignal && page.pixmap && !isCancelled(ticket)) {
+    signalDispatcher->postImage(page.pixmap, filePath, 0);
+  }
+  if (wordTable) {
+    checkInOcr(page.ocrKey, std::move(page.ocr));
+    storeWordTablePages(filePath, 0, page.pixmap, wordTable);
+    if (updateSignal && !isCancelled(ticket)) {
+      toBankStatementTable(wordTable, filePath);
+    }
+    return true;
+  }
+  if (isCancelled(ticket)) {
+    checkInOcr(page.ocrKey, std::move(page.ocr));
+    return false;
+  }
+  // only the region goes to the engine, as a view of the decoded page
+  page.pageWidth = page.pixmap ? page.pixmap->width : 0;
+  page.pageHeight = page.pixmap ? page.pixmap->height : 0;
+  std::shared_ptr<Pixmap> ocrPixmap = page.pixmap;
+  if (region) {
+    std::shared_ptr<PixmapView> view = newPixmapView(page.pixmap, *region);
+    if (view && page.ocr->openImagePixmapPtr(view)) {
+      page.offsetX = static_cast<unsigned int>(view->x);
+      page.offsetY = static_cast<unsigned int>(view->y);
+      ocrPixmap = view;
+    } else if (page.pixmap && page.ocr->openImagePixmapPtr(page.pixmap)) {
+      // whole page after all, it must not be cached as the region
+      cacheKey.clear();
+    } else {
+      checkInOcr(page.ocrKey, std::move(page.ocr));
+      metrics.recordPageFailed();
+      return false;
+    }
+  }
+  if (ocrPixmap) {
+    checkPageSkip(*ocrPixmap, page, nullptr);
+  }
+  if (page.skip != PageSkip::none) {
+    page.cacheKey = cacheKey;
+    std::shared_ptr<HocrWordTable> skippedTable =
+        storeSkippedPage(filePath, page);
+    // a duplicate whose page is gone is recognized after all
+    if (skippedTable) {
+      checkInOcr(page.ocrKey, std::move(page.ocr));
+      if (updateSignal && !isCancelled(ticket)) {
+        toBankStatementTable(skippedTable, filePath);
+      }
+      return true;
+    }
+  }
+  /* Hold the worker until the page is done, this keeps the number of open
+   * images at the number of workers.
+   */
+  bool recognized;
+  {
+    // the engines of every model of the module count against maxOcrJobs
+    RecognizeScheduler::OcrPermit ocrPermit(*scheduler, *schedulerClient);
+    MetricTimer ocrTimer(metrics, MetricStage::ocr);
+    recognized = runOcr(*page.ocr, ticket);
+    if (!recognized) {
+      ocrTimer.cancel();
+    }
+  }
+  if (!recognized) {
+    // the engine may still be busy, it is dropped instead of checked in
+    page.ocr.reset();
+    if (isCancelled(ticket)) {
+      return false;
+    }
+    metrics.recordPageFailed();
+#if BOOKFILER_RECOGNIZE_MODEL_BATCH_DEBUG
+    if (getDebugLevel() >= 1) {
+      std::cout << "bookfiler::RecognizeModelInternal::recognizeImageFile("
+                << filePath << ") ERROR: the engine did not call back\n";
+    }
+#endif
+    return false;
+  }
+  // cancelled while the engine was busy, drop the result
+  bool stored = false;
+  if (!isCancelled(ticket)) {
+    std::shared_ptr<HocrWordTable> wordTableDone =
+        recognizeDone(filePath, page, updateSignal);
+    storeCached(cacheKey, *wordTableDone);
+    fingerprintIndex.add(page.fingerprint, filePath, 0);
+    if (!region) {
+      learnRegion(filePath, 0, page.pageWidth, page.pageHeight);
+    }
+    if (updateSignal) {
+      toBankStatementTable(wordTableDone, filePath, true);
+    }
+    stored = true;
+  }
+  // back to the pool once the engine returned from recognize too
+  checkInOcr(page.ocrKey, std::move(page.ocr));
+  return stored;
+}
+
+bool RecognizeModelInternal::renderPdfPage(PdfPipeline &pipeline) {
+  std::lock_guard<std::mutex> lock(pipeline.renderMutex);
+  if (pipeline.renderDone || pipeline.renderQueue.full()) {
+    return false;
+  }
+  if (pipeline.nextPage >= pipeline.pagesTotal ||
+      isCancelled(pipeline.ticket)) {
+    pipeline.renderDone = true;
+    return false;
+  }
+  PipelinePage page;
+  page.pageNum = static_cast<unsigned int>(pipeline.nextPage++);
+  page.pageStart = std::chrono::steady_clock::now();
+  page.cacheKey = getCacheKey(pipeline.cacheKeyBase, page.pageNum);
+  page.wordTable = loadCached(page.cacheKey);
+  // a cached page is only rendered when it is going to be shown
+  if (!page.wordTable || pipeline.updateSignal) {
+    MetricTimer renderTimer(metrics, MetricStage::render);
+    int pageNum = static_cast<int>(page.pageNum);
+    pipeline.pdfFile->render(pageNum);
+    page.pixmap = pipeline.pdfFile->getPixmap(pageNum);
+    if (!page.pixmap) {
+      renderTimer.cancel();
+    }
+  }
+  // one page that does not render does not end the document
+  if (!page.pixmap && !page.wordTable) {
+    pipeline.pagesFailed++;
+    metrics.recordPageFailed();
+#if BOOKFILER_RECOGNIZE_MODEL_PDF_DEBUG
+    if (getDebugLevel() >= 1) {
+      std::cout << "bookfiler::RecognizeModelInternal::renderPdfPage("
+                << pipeline.filePath << ") ERROR: page " << page.pageNum
+                << " did not render\n";
+    }
+#endif
+    return true;
+  }
+  // the only producer and it checked for room
+  pipeline.renderQueue.tryPush(page);
+  return true;
+}
+
+bool RecognizeModelInternal::parsePdfPage(PdfPipeline &pipeline) {
+  std::lock_guard<std::mutex> lock(pipeline.parseMutex);
+  PipelinePage page;
+  if (!pipeline.parseQueue.tryPop(page)) {
+    return false;
+  }
+  const std::string &filePath = pipeline.filePath;
+  if (isCancelled(pipeline.ticket)) {
+    checkInOcr(page.ocrKey, std::move(page.ocr));
+    return true;
+  }
+  std::shared_ptr<HocrWordTable> wordTable = page.wordTable;
+  bool streamed = false, skipped = false;
+  if (page.skip != PageSkip::none) {
+    // the pages before it are stored, the duplicated one too
+    wordTable = storeSkippedPage(filePath, page);
+    skipped = wordTable != nullptr;
+    // a duplicate whose page is gone is recognized after all
+    if (!skipped &&
+        !recognizeSkippedPage(page, pipeline.region.get(), pipeline.ticket)) {
+      if (!isCancelled(pipeline.ticket)) {
+        pipeline.pagesFailed++;
+        metrics.recordPageFailed();
+      }
+      return true;
+    }
+  }
+  // a skipped page is stored already
+  if (wordTable && !skipped) {
+    storeWordTable(filePath, page.pageNum, page.pixmap, wordTable);
+  } else if (!wordTable) {
+    wordTable = recognizeDone(filePath, page, pipeline.updateSignal);
+    checkInOcr(page.ocrKey, std::move(page.ocr));
+    storeCached(page.cacheKey, *wordTable);
+    fingerprintIndex.add(page.fingerprint, filePath, page.pageNum);
+    streamed = true;
+    if (!pipeline.region) {
+      learnRegion(filePath, page.pageNum, page.pageWidth, page.pageHeight);
+    }
+  }
+  pipeline.pagesDone++;
+  if (pipeline.updateSignal) {
+    toBankStatementTable(wordTable, filePath, streamed);
+  }
+  return true;
+}
+
+void RecognizeModelInternal::postPdfStage(
+    std::shared_ptr<PdfPipeline> pipeline, bool render) {
+  std::atomic<bool> &posted =
+      render ? pipeline->renderPosted : pipeline->parsePosted;
+  if (posted.exchange(true)) {
+    return;
+  }
+  // first in line, the OCR stage of the file is waiting on it
+  scheduler->post(
+      *schedulerClient,
+      [this, pipeline, render]() {
+        PdfPipeline &stage = *pipeline;
+        std::atomic<bool> &posted =
+            render ? stage.renderPosted : stage.parsePosted;
+        do {
+          while (render ? renderPdfPage(stage) : parsePdfPage(stage)) {
+          }
+          posted = false;
+          // work added after the last step and before posted was cleared
+        } while ((render ? !stage.renderDone && !stage.renderQueue.full()
+                         : stage.parseQueue.size() > 0) &&
+                 !posted.exchange(true));
+      },
+      WorkerPool::priorityCount - 1);
+}
+
+unsigned int
+RecognizeModelInternal::recognizePdfFile(std::string filePath,
+                                         bool updateSignal,
+                                         const RecognizeTicket *ticket,
+                                         unsigned int *pagesFailed) {
+#if BOOKFILER_RECOGNIZE_MODEL_PDF_DEBUG
+  if (getDebugLevel() >= 2) {
+    std::cout << "bookfiler::RecognizeModelInternal::recognizePdfFile("
+              << filePath << ")\n";
+  }
+#endif
+  std::shared_ptr<Pdf> pdfFile = pdfModule->newPdf();
+  if (!pdfFile) {
+    return 0;
+  }
+  pdfFile->openFile(filePath);
+  std::shared_ptr<PdfPipeline> pipeline = std::make_shared<PdfPipeline>();
+  pipeline->filePath = filePath;
+  pipeline->updateSignal = updateSignal;
+  pipeline->ticket = ticket;
+  pipeline->pdfFile = pdfFile;
+  pipeline->pagesTotal = pdfFile->getPagesTotal();
+  pipeline->region = getActiveRegion();
+  pipeline->cacheKeyBase =
+      getCacheKeyBase(filePath, pipeline->region.get());
+  const RecognizeRegion *region = pipeline->region.get();
+  postPdfStage(pipeline, true);
+  // pages sent to the engine, a duplicate may come before they are stored
+  PageFingerprintIndex fileIndex;
+  // parsed here while the parse queue is full
+  auto toParse = [&](PipelinePage &page) {
+    while (!pipeline->parseQueue.tryPush(page)) {
+      parsePdfPage(*pipeline);
+    }
+    postPdfStage(pipeline, false);
+  };
+
+  // OCR stage
+  while (true) {
+    PipelinePage page;
+    bool renderDone = pipeline->renderDone;
+    if (!pipeline->renderQueue.tryPop(page)) {
+      if (renderDone) {
+        break;
+      }
+      // rendered here when no worker got to it
+      renderPdfPage(*pipeline);
+      continue;
+    }
+    postPdfStage(pipeline, true);
+    // drain the render stage without doing the work
+    if (isCancelled(ticket)) {
+      continue;
+    }
+    if (page.wordTable) {
+      if (updateSignal && page.pixmap) {
+        signalDispatcher->postImage(page.pixmap, filePath, page.pageNum);
+      }
+      toParse(page);
+      continue;
+    }
+    page.pageWidth = page.pixmap->width;
+    page.pageHeight = page.pixmap->height;
+    // only the region goes to the engine, as a view of the rendered page
+    std::shared_ptr<Pixmap> ocrPixmap = page.pixmap;
+    if (region) {
+      std::shared_ptr<PixmapView> view = newPixmapView(page.pixmap, *region);
+      if (view) {
+        page.offsetX = static_cast<unsigned int>(view->x);
+        page.offsetY = static_cast<unsigned int>(view->y);
+        ocrPixmap = view;
+      }
+    }
+    checkPageSkip(*ocrPixmap, page, &fileIndex);
+    if (page.skip != PageSkip::none) {
+      if (updateSignal) {
+        signalDispatcher->postImage(page.pixmap, filePath, page.pageNum);
+      }
+      toParse(page);
+      continue;
+    }
+    page.ocr = checkOutOcr(page.ocrKey);
+    MetricTimer openTimer(metrics, MetricStage::openImage);
+    if (!page.ocr || !page.ocr->openImagePixmapPtr(ocrPixmap)) {
+      openTimer.cancel();
+      checkInOcr(page.ocrKey, std::move(page.ocr));
+      pipeline->pagesFailed++;
+      metrics.recordPageFailed();
+#if BOOKFILER_RECOGNIZE_MODEL_PDF_DEBUG
+      if (getDebugLevel() >= 1) {
+        std::cout << "bookfiler::RecognizeModelInternal::recognizePdfFile("
+                  << filePath << ") ERROR: page " << page.pageNum << "\n";
+      }
+#endif
+      continue;
+    }
+    openTimer.stop();
+    if (updateSignal) {
+      signalDispatcher->postImage(page.pixmap, filePath, page.pageNum);
+    }
+    {
+      RecognizeScheduler::OcrPermit ocrPermit(*scheduler, *schedulerClient);
+      MetricTimer ocrTimer(metrics, MetricStage::ocr);
+      if (!runOcr(*page.ocr, ticket)) {
+        ocrTimer.cancel();
+        page.ocr.reset();
+        if (isCancelled(ticket)) {
+          continue;
+        }
+        pipeline->pagesFailed++;
+        metrics.recordPageFailed();
+#if BOOKFILER_RECOGNIZE_MODEL_PDF_DEBUG
+        if (getDebugLevel() >= 1) {
+          std::cout << "bookfiler::RecognizeModelInternal::recognizePdfFile("
+                    << filePath << ") ERROR: page " << page.pageNum
+                    << " timed out\n";
+        }
+#endif
+        continue;
+      }
+    }
+    if (isCancelled(ticket)) {
+      checkInOcr(page.ocrKey, std::move(page.ocr));
+      continue;
+    }
+    fileIndex.add(page.fingerprint, filePath, page.pageNum);
+    toParse(page);
+  }
+  // the rest of the parse stage, after the step of a worker in progress
+  while (parsePdfPage(*pipeline)) {
+  }
+  std::lock_guard<std::mutex> lock(pipeline->parseMutex);
+  if (pagesFailed) {
+    *pagesFailed = pipeline->pagesFailed;
+  }
+  return pipeline->pagesDone;
+}
+
+std::shared_ptr<rapidjson::Document> RecognizeModelInternal::getBatchStatus() {
+  std::shared_ptr<rapidjson::Document> status =
+      std::make_shared<rapidjson::Document>();
+  status->SetObject();
+  rapidjson::Document::AllocatorType &allocator = status->GetAllocator();
+  std::lock_guard<std::mutex> lock(batchMutex);
+  double elapsed = 0;
+  if (pathCrawler) {
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            batchStart)
+                  .count();
+  }
+  unsigned long long pagesDone = batchPagesDone;
+  // the workers are shared with the other models of the module
+  status->AddMember("threads", scheduler->getThreadCount(), allocator);
+  status->AddMember("queueCapacity",
+                    static_cast<uint64_t>(schedulerClient->queueCapacity),
+                    allocator);
+  status->AddMember(
+      "crawling",
+      static_cast<uint64_t>(pathCrawler ? pathCrawler->getPending() : 0),
+      allocator);
+  status->AddMember("pending", static_cast<uint64_t>(pendingPaths.size()),
+                    allocator);
+  status->AddMember(
+      "queued", static_cast<uint64_t>(scheduler->getQueued(*schedulerClient)),
+      allocator);
+  status->AddMember(
+      "running",
+      static_cast<uint64_t>(scheduler->getRunning(*schedulerClient)),
+      allocator);
+  status->AddMember("pagesDone", static_cast<uint64_t>(pagesDone), allocator);
+  status->AddMember("pagesFailed",
+                    static_cast<uint64_t>(batchPagesFailed.load()), allocator);
+  status->AddMember("filesUnchanged",
+                    static_cast<uint64_t>(batchFilesUnchanged.load()),
+                    allocator);
+  status->AddMember("filesIgnored",
+                    static_cast<uint64_t>(batchFilesIgnored.load()), allocator);
+  status->AddMember("elapsedSeconds", elapsed, allocator);
+  status->AddMember("pagesPerSecond", elapsed > 0 ? pagesDone / elapsed : 0.0,
+                    allocator);
+  rapidjson::Value schedulerValue;
+  scheduler->getClientJson(*schedulerClient, schedulerValue, allocator);
+  status->AddMember("scheduler", schedulerValue, allocator);
+  return status;
+}
+
+std::shared_ptr<rapidjson::Document> RecognizeModelInternal::getMetrics() {
+  std::shared_ptr<rapidjson::Document> document = metrics.toJson();
+  document->AddMember("debugLevel", getDebugLevel(),
+                      document->GetAllocator());
+  rapidjson::Value enginePool;
+  ocrEnginePool->toJson(enginePool, document->GetAllocator());
+  document->AddMember("ocrEnginePool", enginePool, document->GetAllocator());
+  // shared by every model of the module
+  if (pixmapPool) {
+    rapidjson::Value pool;
+    pixmapPool->toJson(pool, document->GetAllocator());
+    document->AddMember("pixmapPool", pool, document->GetAllocator());
+  }
+  rapidjson::Document::AllocatorType &allocator = document->GetAllocator();
+  rapidjson::Value memory(rapidjson::kObjectType);
+  {
+    std::lock_guard<std::mutex> lock(fileMapMutex);
+    memory.AddMember("bytes", static_cast<uint64_t>(fileMapBytes), allocator);
+    memory.AddMember("pixmapBytes", static_cast<uint64_t>(fileMapPixmapBytes),
+                     allocator);
+    memory.AddMember("files", static_cast<uint64_t>(fileLruList.size()),
+                     allocator);
+    memory.AddMember("pixmapsEvicted", static_cast<uint64_t>(pixmapsEvicted),
+                     allocator);
+    memory.AddMember("filesEvicted", static_cast<uint64_t>(filesEvicted),
+                     allocator);
+    memory.AddMember("filesReloaded", static_cast<uint64_t>(filesReloaded),
+                     allocator);
+  }
+  memory.AddMember("maxBytes",
+                   static_cast<uint64_t>(getSettings()->modelMaxBytes),
+                   allocator);
+  document->AddMember("memory", memory, allocator);
+  return document;
+}
+
+void RecognizeModelInternal::setSignalExecutor(
+    std::function<void(std::function<void()>)> executor) {
+  signalDispatcher->setExecutor(executor);
+}
+
+void RecognizeModelInternal::flushSignals() { signalDispatcher->flush(); }
+
+std::shared_ptr<std::vector<WordHit>>
+RecognizeModelInternal::findWords(std::string term, std::size_t maxHits) {
+  std::shared_ptr<std::vector<WordHit>> hitList =
+      std::make_shared<std::vector<WordHit>>();
+  wordIndex->findTerm(term, maxHits, *hitList);
+  return hitList;
+}
+
+std::shared_ptr<std::vector<WordHit>>
+RecognizeModelInternal::findWordPrefix(std::string prefix,
+                                       std::size_t maxHits) {
+  std::shared_ptr<std::vector<WordHit>> hitList =
+      std::make_shared<std::vector<WordHit>>();
+  wordIndex->findPrefix(prefix, maxHits, *hitList);
+  return hitList;
+}
+
+std::shared_ptr<std::vector<WordHit>>
+RecognizeModelInternal::findAmounts(long long minimum, long long maximum,
+                                    std::size_t maxHits) {
+  std::shared_ptr<std::vector<WordHit>> hitList =
+      std::make_shared<std::vector<WordHit>>();
+  wordIndex->findAmounts(minimum, maximum, maxHits, *hitList);
+  return hitList;
+}
+
+void RecognizeModelInternal::setPayeeCatalog(
+    std::shared_ptr<const std::vector<std::string>> catalog) {
+  std::shared_ptr<const PayeeMatcher> matcher;
+  // built before the swap, pages stored meanwhile use the old catalog
+  if (catalog && !catalog->empty()) {
+    matcher = std::make_shared<PayeeMatcher>(*catalog,
+                                             getSettings()->payeeMatch);
+  }
+  std::atomic_store(&payeeMatcher, matcher);
+}
+
+std::size_t RecognizeModelInternal::getMemoryBytes() {
+  std::lock_guard<std::mutex> lock(fileMapMutex);
+  return fileMapBytes;
+}
+
+std::shared_ptr<Ocr> RecognizeModelInternal::checkOutOcr(std::string &ocrKey) {
+  std::shared_ptr<const RecognizeSettings> settingsPtr = getSettings();
+  ocrKey = settingsPtr->getOcrKey();
+  MetricTimer timer(metrics, MetricStage::ocrSetup);
+  std::shared_ptr<Ocr> ocr = ocrEnginePool->checkOut(*settingsPtr);
+  if (!ocr) {
+    timer.cancel();
+  }
+  return ocr;
+}
+
+void RecognizeModelInternal::checkInOcr(const std::string &ocrKey,
+                                        std::shared_ptr<Ocr> ocr) {
+  ocrEnginePool->checkIn(ocrKey, std::move(ocr));
+}
+
+bool RecognizeModelInternal::runOcr(Ocr &ocr,
+                                    const RecognizeTicket *ticket) {
+  std::chrono::milliseconds timeout(getSettings()->ocrTimeoutMs);
+  // how often a ticket is checked for a cancel
+  const std::chrono::milliseconds cancelPoll(10);
+  std::shared_ptr<OcrDone> done = std::make_shared<OcrDone>();
+  ocr.onRecognizeDone([done](std::shared_ptr<Ocr>) {
+    std::lock_guard<std::mutex> lock(done->mutex);
+    done->done = true;
+    done->condition.notify_all();
+  });
+  ocr.recognize();
+  std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::now() + timeout;
+  std::unique_lock<std::mutex> lock(done->mutex);
+  while (!done->done) {
+    if (isCancelled(ticket)) {
+      return false;
+    }
+    std::chrono::steady_clock::time_point wakeAt =
+        std::chrono::steady_clock::time_point::max();
+    if (ticket) {
+      wakeAt = std::chrono::steady_clock::now() + cancelPoll;
+    }
+    if (timeout.count() > 0) {
+      if (std::chrono::steady_clock::now() >= deadline) {
+        return false;
+      }
+      wakeAt = std::min(wakeAt, deadline);
+    }
+    if (wakeAt == std::chrono::steady_clock::time_point::max()) {
+      done->condition.wait(lock);
+    } else {
+      done->condition.wait_until(lock, wakeAt);
+    }
+  }
+  return true;
 }
 
 void RecognizeModelInternal::requestRecognize(std::string fileRequested) {
+  requestRecognizeAsync(fileRequested, RecognizePriority::interactive);
+}
+
+std::shared_ptr<RecognizeTicket>
+RecognizeModelInternal::requestRecognizeAsync(std::string fileRequested,
+                                              RecognizePriority priority) {
 #if BOOKFILER_RECOGNIZE_MODEL_REQUEST_RECOGNIZE
-  std::cout << "bookfiler::RecognizeModelInternal::requestRecognize("
-            << fileRequested << ")\n";
+  if (getDebugLevel() >= 2) {
+    std::cout << "bookfiler::RecognizeModelInternal::requestRecognizeAsync("
+              << fileRequested << ", " << static_cast<unsigned int>(priority)
+              << ")\n";
+  }
 #endif
-  if (!ocrModule) {
+  std::shared_ptr<RecognizeTicket> ticket =
+      std::make_shared<RecognizeTicket>();
+  ticket->id = ++nextTicketId;
+  ticket->priority = priority;
+  std::shared_ptr<std::promise<std::shared_ptr<RecognizeResult>>> promise =
+      std::make_shared<std::promise<std::shared_ptr<RecognizeResult>>>();
+  ticket->future = promise->get_future().share();
+  // not bounded by the batch queue, a user request never waits for room
+  scheduler->post(
+      *schedulerClient,
+      [this, fileRequested, ticket, promise]() {
+        promise->set_value(recognizeTicket(fileRequested, ticket));
+      },
+      static_cast<unsigned int>(priority));
+  return ticket;
+}
+
+std::vector<std::pair<unsigned int, std::shared_ptr<Pixmap>>>
+RecognizeModelInternal::getStoredPages(const std::string &filePath) {
+  reloadEvictedFile(filePath);
+  std::vector<std::pair<unsigned int, std::shared_ptr<Pixmap>>> pageList;
+  {
+    std::lock_guard<std::mutex> lock(fileMapMutex);
+    auto fileIt = recognizeFileMap.find(filePath);
+    if (fileIt != recognizeFileMap.end()) {
+      RecognizeFile &file = *fileIt->second;
+      for (auto &page : file.hocrMap) {
+        auto pixmapIt = file.pixmapMap.find(page.first);
+        pageList.push_back({page.first, pixmapIt == file.pixmapMap.end()
+                                            ? nullptr
+                                            : pixmapIt->second});
+      }
+      if (!file.hocrMap.empty()) {
+        touchFileLocked(filePath, file);
+      }
+    }
+  }
+  std::sort(pageList.begin(), pageList.end(),
+            [](auto &a, auto &b) { return a.first < b.first; });
+  return pageList;
+}
+
+bool RecognizeModelInternal::exportDocument(std::string filePath,
+                                            std::string exportPath,
+                                            std::string format) {
+  reloadEvictedFile(filePath);
+  std::vector<DocumentPage> pageList;
+  {
+    std::lock_guard<std::mutex> lock(fileMapMutex);
+    auto fileIt = recognizeFileMap.find(filePath);
+    if (fileIt == recognizeFileMap.end()) {
+      return false;
+    }
+    for (auto &page : fileIt->second->hocrMap) {
+      DocumentPage documentPage;
+      documentPage.pageNum = page.first;
+      documentPage.wordTable = page.second;
+      auto statementIt = fileIt->second->statementMap.find(page.first);
+      if (statementIt != fileIt->second->statementMap.end()) {
+        documentPage.statement = statementIt->second;
+      }
+      auto invoiceIt = fileIt->second->invoiceMap.find(page.first);
+      if (invoiceIt != fileIt->second->invoiceMap.end()) {
+        documentPage.invoice = invoiceIt->second;
+      }
+      pageList.push_back(documentPage);
+    }
+  }
+  if (pageList.empty()) {
+    return false;
+  }
+  std::sort(pageList.begin(), pageList.end(),
+            [](auto &a, auto &b) { return a.pageNum < b.pageNum; });
+  if (format == "json") {
+    return writeDocumentJsonFile(exportPath, filePath, pageList);
+  }
+  if (format == "binary") {
+    return writeDocumentFile(exportPath, filePath, pageList);
+  }
+  return false;
+}
+
+std::shared_ptr<RecognizeResult> RecognizeModelInternal::recognizeTicket(
+    std::string filePath, std::shared_ptr<RecognizeTicket> ticket) {
+  std::shared_ptr<RecognizeResult> result = std::make_shared<RecognizeResult>();
+  result->filePath = filePath;
+  // dropped while it was queued
+  if (ticket->isCancelled()) {
+    result->cancelled = true;
+    return result;
+  }
+  // the batch or an earlier request may already have done this file
+  std::vector<std::pair<unsigned int, std::shared_ptr<Pixmap>>> pageList =
+      getStoredPages(filePath);
+  if (!pageList.empty()) {
+    for (auto &page : pageList) {
+      if (ticket->isCancelled()) {
+        break;
+      }
+      if (page.second) {
+        signalDispatcher->postImage(page.second, filePath, page.first);
+      }
+      toBankStatementTable(getWordTable(filePath, page.first), filePath);
+    }
+  } else if (!ocrModule) {
 #if BOOKFILER_RECOGNIZE_MODEL_REQUEST_RECOGNIZE
-    std::cout << "bookfiler::RecognizeModelInternal::requestRecognize("
-              << fileRequested << ") ERROR: ocrModule is null\n";
+    if (getDebugLevel() >= 1) {
+      std::cout << "bookfiler::RecognizeModelInternal::recognizeTicket("
+                << filePath << ") ERROR: ocrModule is null\n";
+    }
 #endif
-    return;
+  } else if (pdfModule && isPdfFile(filePath)) {
+    recognizePdfFile(filePath, true, ticket.get());
+    pageList = getStoredPages(filePath);
+  } else {
+    recognizeImageFile(filePath, true, ticket.get());
+    pageList = getStoredPages(filePath);
+  }
+  for (auto &page : pageList) {
+    if (result->pageList.size() <= page.first) {
+      result->pageList.resize(page.first + 1);
+    }
+    result->pageList[page.first] = getWordTable(filePath, page.first);
+  }
+  result->cancelled = ticket->isCancelled();
+  return result;
+}
+
+std::shared_ptr<HocrWordTable>
+RecognizeModelInternal::getWordTable(std::string filePath,
+                                     unsigned int pageNum) {
+  reloadEvictedFile(filePath);
+  std::lock_guard<std::mutex> lock(fileMapMutex);
+  auto fileIt = recognizeFileMap.find(filePath);
+  if (fileIt == recognizeFileMap.end()) {
+    return nullptr;
   }
-  std::shared_ptr<Ocr> ocrFile = ocrModule->newOcr();
-  ocrFile->setMode("");
-  ocrFile->setType("");
-  ocrFile->setLanguage({"eng"});
-  ocrFile->setDataPath("");
-  // call Init before attempting to set an image
-  ocrFile->openImageFile(fileRequested);
-  imageUpdateSignal(ocrFile->getPixmap());
-  ocrFile->onRecognizeDone(std::bind(&RecognizeModelInternal::recognizeDone,
-                                     this, std::placeholders::_1));
-  ocrFile->recognize();
+  auto pageIt = fileIt->second->hocrMap.find(pageNum);
+  if (pageIt == fileIt->second->hocrMap.end()) {
+    return nullptr;
+  }
+  touchFileLocked(filePath, *fileIt->second);
+  return pageIt->second;
+}
+
+std::shared_ptr<FileTypeBankStatement>
+RecognizeModelInternal::getBankStatement(std::string filePath,
+                                         unsigned int pageNum) {
+  reloadEvictedFile(filePath);
+  std::lock_guard<std::mutex> lock(fileMapMutex);
+  auto fileIt = recognizeFileMap.find(filePath);
+  if (fileIt == recognizeFileMap.end()) {
+    return nullptr;
+  }
+  auto pageIt = fileIt->second->statementMap.find(pageNum);
+  if (pageIt == fileIt->second->statementMap.end()) {
+    return nullptr;
+  }
+  touchFileLocked(filePath, *fileIt->second);
+  return pageIt->second;
+}
+
+std::shared_ptr<FileTypeInvoice>
+RecognizeModelInternal::getInvoice(std::string filePath, unsigned int pageNum) {
+  reloadEvictedFile(filePath);
+  std::lock_guard<std::mutex> lock(fileMapMutex);
+  auto fileIt = recognizeFileMap.find(filePath);
+  if (fileIt == recognizeFileMap.end()) {
+    return nullptr;
+  }
+  auto pageIt = fileIt->second->invoiceMap.find(pageNum);
+  if (pageIt == fileIt->second->invoiceMap.end()) {
+    return nullptr;
+  }
+  touchFileLocked(filePath, *fileIt->second);
+  return pageIt->second;
 }
 
 void RecognizeModelInternal::recognizeDone(std::shared_ptr<Ocr> ocrPtr) {
-  /* IMPORANT!
-   * wrapping ptree as a shared_ptr causes many bugs:
-   * std::shared_ptr<boost::property_tree::ptree>
-   * Don't do this in the future
-   */
-  boost::property_tree::ptree hocrTree;
-  std::string data(ocrPtr->getHocr());
-#if BOOKFILER_RECOGNIZE_MODEL_RECOGNIZE_DONE_DEBUG
-  std::cout << "bookfiler::RecognizeModelInternal::recognizeDone:\n"
-            << data << "\n";
-#endif
-  // stream prevents data being recopied
-  boost::iostreams::stream<boost::iostreams::array_source> stream(data.c_str(),
-                                                                  data.size());
-  boost::property_tree::read_xml(stream, hocrTree);
+  PipelinePage page;
+  page.ocr = ocrPtr;
+  toBankStatementTable(recognizeDone("", page, true), "", true);
+}
+
+std::shared_ptr<HocrWordTable>
+RecognizeModelInternal::recognizeDone(const std::string &filePath,
+                                      const PipelinePage &page,
+                                      bool streamSignal) {
+  unsigned int pageNum = page.pageNum;
+  unsigned int offsetX = page.offsetX, offsetY = page.offsetY;
+  std::string data;
+  {
+    MetricTimer timer(metrics, MetricStage::hocrText);
+    data = page.ocr->getHocr();
+  }
+  if (metrics.isEnabled()) {
+    metrics.hocrBytes.fetch_add(data.size(), std::memory_order_relaxed);
+  }
 #if BOOKFILER_RECOGNIZE_MODEL_RECOGNIZE_DONE_DEBUG
-  std::cout << "bookfiler::RecognizeModelInternal::recognizeDone:\n";
-  printPropertyTree(hocrTree);
+  if (getDebugLevel() >= 3) {
+    std::cout << "bookfiler::RecognizeModelInternal::recognizeDone:\n"
+              << data << "\n";
+  }
 #endif
-  toBankStatementTable(hocrTree);
+  std::chrono::steady_clock::duration pageTime =
+      page.pageStart.time_since_epoch().count() > 0
+          ? std::chrono::steady_clock::now() - page.pageStart
+          : std::chrono::steady_clock::duration::zero();
+  bool stream = streamSignal && !wordBatchUpdateSignal.empty();
+  std::vector<std::string_view> pageList = splitHocrPages(data);
+  if (pageList.size() == 1) {
+    std::chrono::steady_clock::duration parseTime;
+    std::shared_ptr<HocrWordTable> wordTable = parseHocrPage(
+        data, filePath, pageNum, offsetX, offsetY,
+        stream ? [this](std::shared_ptr<HocrWordBatch> batch) {
+          signalDispatcher->postWordBatch(batch);
+        } : std::function<void(std::shared_ptr<HocrWordBatch>)>(),
+        parseTime);
+    if (!filePath.empty()) {
+      storeWordTable(filePath, pageNum, page.pixmap, wordTable);
+    }
+    metrics.recordPage(pageTime, wordTable->size(), parseTime);
+    return wordTable;
+  }
+  // several pages, each is parsed and stored on its own
+  std::vector<std::shared_ptr<HocrWordTable>> tableList(pageList.size());
+  std::vector<std::vector<std::shared_ptr<HocrWordBatch>>> batchList(
+      stream ? pageList.size() : 0);
+  auto parsePage = [&](std::size_t i) {
+    unsigned int pageNumParsed = pageNum + static_cast<unsigned int>(i);
+    std::chrono::steady_clock::duration parseTime;
+    tableList[i] = parseHocrPage(
+        pageList[i], filePath, pageNumParsed, offsetX, offsetY,
+        stream ? [&batchList, i](std::shared_ptr<HocrWordBatch> batch) {
+          batchList[i].push_back(batch);
+        } : std::function<void(std::shared_ptr<HocrWordBatch>)>(),
+        parseTime);
+    if (!filePath.empty()) {
+      storeWordTable(filePath, pageNumParsed, i == 0 ? page.pixmap : nullptr,
+                     tableList[i]);
+    }
+    metrics.recordPage(pageTime, tableList[i]->size(), parseTime);
+  };
+  scheduler->forEach(*schedulerClient, pageList.size(), parsePage,
+                     WorkerPool::priorityCount - 1);
+  for (std::vector<std::shared_ptr<HocrWordBatch>> &pageBatchList :
+       batchList) {
+    for (std::shared_ptr<HocrWordBatch> &batch : pageBatchList) {
+      signalDispatcher->postWordBatch(batch);
+    }
+  }
+  std::shared_ptr<HocrWordTable> wordTable = std::make_shared<HocrWordTable>();
+  wordTable->pageNum = pageNum;
+  for (std::shared_ptr<HocrWordTable> &pageTable : tableList) {
+    wordTable->append(*pageTable, 0, pageTable->size());
+    wordTable->pageEnd.push_back(static_cast<unsigned int>(wordTable->size()));
+  }
+  return wordTable;
+}
+
+std::shared_ptr<HocrWordTable> RecognizeModelInternal::parseHocrPage(
+    std::string_view data, const std::string &filePath, unsigned int pageNum,
+    unsigned int offsetX, unsigned int offsetY,
+    const std::function<void(std::shared_ptr<HocrWordBatch>)> &onBatch,
+    std::chrono::steady_clock::duration &parseTime) {
+  std::shared_ptr<HocrWordTable> wordTable;
+  if (onBatch) {
+    unsigned long long sequence = 0;
+    MetricTimer parseTimer(metrics, MetricStage::hocrParse);
+    wordTable = hocrWordTableFromString(
+        data, getSettings()->streamLevel,
+        [&](const HocrWordTable &table, std::size_t beginIndex,
+            std::size_t endIndex, HocrEvent event) {
+          std::shared_ptr<HocrWordBatch> batch =
+              std::make_shared<HocrWordBatch>();
+          batch->filePath = filePath;
+          batch->pageNum = pageNum;
+          batch->sequence = sequence++;
+          batch->event = event;
+          batch->endOfDocument = event == HocrEvent::documentEnd;
+          batch->wordList =
+              table.toHocrWordList(table.view(beginIndex, endIndex));
+          if (offsetX || offsetY) {
+            for (std::shared_ptr<HocrWord> &word : *batch->wordList) {
+              word->x0 += offsetX;
+              word->y0 += offsetY;
+              word->x1 += offsetX;
+              word->y1 += offsetY;
+            }
+          }
+          onBatch(batch);
+        });
+    parseTime = parseTimer.stop();
+  } else {
+    MetricTimer parseTimer(metrics, MetricStage::hocrParse);
+    wordTable = hocrWordTableFromString(data);
+    parseTime = parseTimer.stop();
+  }
+  if (offsetX || offsetY) {
+    wordTable->translate(offsetX, offsetY);
+  }
+  wordTable->pageNum = pageNum;
+  return wordTable;
 }
 
 void RecognizeModelInternal::printPropertyTree(
@@ -116,15 +1714,10 @@ void RecognizeModelInternal::printPropertyTree(
   }
 }
 
-void RecognizeModelInternal::toBankStatementTable(
-    boost::property_tree::ptree hocrTree) {
-#if BOOKFILER_RECOGNIZE_MODEL_TO_STATEMENT_TABLE_DEBUG2
-  std::cout << "bookfiler::RecognizeModelInternal::toBankStatementTable:\n";
-  printPropertyTree(hocrTree);
-#endif
+std::shared_ptr<std::vector<std::shared_ptr<HocrWord>>>
+RecognizeModelInternal::toHocrWordListTree(
+    boost::property_tree::ptree &hocrTree) {
   std::vector<boost::property_tree::ptree> nodeList;
-  std::shared_ptr<FileTypeBankStatement> bankStatement =
-      std::make_shared<FileTypeBankStatement>();
   /* Depth First Traversal
    */
   std::stack<std::shared_ptr<HocrWordCandidate>> stack;
@@ -202,10 +1795,15 @@ void RecognizeModelInternal::toBankStatementTable(
              */
             try {
               if (propertyParts.size() == 5 && propertyParts.at(0) == "bbox") {
-                wordPtr->x0 = std::stoi(propertyParts.at(1));
-                wordPtr->y0 = std::stoi(propertyParts.at(2));
-                wordPtr->x1 = std::stoi(propertyParts.at(3));
-                wordPtr->y1 = std::stoi(propertyParts.at(4));
+                // all four or none, as the streaming parser reads it
+                unsigned int x0 = std::stoi(propertyParts.at(1));
+                unsigned int y0 = std::stoi(propertyParts.at(2));
+                unsigned int x1 = std::stoi(propertyParts.at(3));
+                unsigned int y1 = std::stoi(propertyParts.at(4));
+                wordPtr->x0 = x0;
+                wordPtr->y0 = y0;
+                wordPtr->x1 = x1;
+                wordPtr->y1 = y1;
                 wordPtr->w = wordPtr->x1 - wordPtr->x0;
                 wordPtr->h = wordPtr->y1 - wordPtr->y0;
               } else if (propertyParts.size() == 2 &&
@@ -223,13 +1821,19 @@ void RecognizeModelInternal::toBankStatementTable(
     wordList->push_back(wordPtr);
   }
 
+  return wordList;
+}
+
+void RecognizeModelInternal::toBankStatementTable(
+    std::shared_ptr<HocrWordTable> wordTable, const std::string &filePath,
+    bool streamed) {
 #if BOOKFILER_RECOGNIZE_MODEL_TO_STATEMENT_TABLE_DEBUG
-  for (auto wordPtr : *wordList) {
-    std::cout << "x0=" << wordPtr->x0 << " y0=" << wordPtr->y0
-              << " x1=" << wordPtr->x1 << " y1=" << wordPtr->y1 << "\n";
+  for (HocrWordRef word : wordTable->view()) {
+    std::cout << "x0=" << word.x0() << " y0=" << word.y0()
+              << " x1=" << word.x1() << " y1=" << word.y1() << "\n";
   }
 #endif
-  textUpdateSignal(wordList);
+  signalDispatcher->postWordTable(wordTable, filePath, streamed);
 }
 
 } // namespace bookfiler
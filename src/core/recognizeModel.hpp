@@ -13,13 +13,22 @@
 #include "config.hpp"
 
 // c++17
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
 #include <functional>
+#include <future>
 #include <iostream>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <queue>
 #include <stack>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -28,6 +37,7 @@
  */
 #include <boost/algorithm/string.hpp>
 #include <boost/config.hpp> // for BOOST_SYMBOL_EXPORT
+#include <boost/filesystem.hpp>
 #include <boost/iostreams/stream.hpp>
 #include <boost/optional.hpp>
 #include <boost/property_tree/ptree.hpp>
@@ -46,6 +56,26 @@
 
 // Local Project
 #include "../Interface.hpp"
+#include "bankStatement.hpp"
+#include "boundedQueue.hpp"
+#include "documentExtractor.hpp"
+#include "documentFile.hpp"
+#include "documentJson.hpp"
+#include "fileManifest.hpp"
+#include "hocrParser.hpp"
+#include "ocrEnginePool.hpp"
+#include "pageFingerprint.hpp"
+#include "pathCrawler.hpp"
+#include "payeeMatcher.hpp"
+#include "pixmapPool.hpp"
+#include "pixmapView.hpp"
+#include "recognizeCache.hpp"
+#include "recognizeMetrics.hpp"
+#include "recognizeScheduler.hpp"
+#include "recognizeSettings.hpp"
+#include "signalDispatcher.hpp"
+#include "wordIndex.hpp"
+#include "workerPool.hpp"
 
 /*
  * bookfiler = BookFiler™
@@ -79,43 +109,369 @@ public:
   boost::property_tree::ptree node, parent1, parent2;
 };
 
-class FileTypeBankStatementRow {
+/* Why a page was left out of the OCR, see PageSkipOptions
+ */
+enum class PageSkip : unsigned int { none = 0, blank, duplicate };
+
+/* A page travelling through the PDF pipeline
+ * render -> OCR -> parse
+ */
+class PipelinePage {
 public:
-  bool amountSign, balanceSign;
-  unsigned long long amount, balance;
-  std::string date, description;
+  unsigned int pageNum = 0;
+  // the whole page, stored with the word table for the image signal
+  std::shared_ptr<Pixmap> pixmap;
+  // checked out of the engine pool with the configuration ocrKey
+  std::shared_ptr<Ocr> ocr;
+  std::string ocrKey;
+  // set when the page came from the cache and skips OCR
+  std::shared_ptr<HocrWordTable> wordTable;
+  std::string cacheKey;
+  std::chrono::steady_clock::time_point pageStart;
+  // rendered size, and where the OCR region starts in it
+  long pageWidth = 0, pageHeight = 0;
+  unsigned int offsetX = 0, offsetY = 0;
+  // ink of the pixels sent to the engine, null if it was not counted
+  std::shared_ptr<const PageFingerprint> fingerprint;
+  /* a skipped page is stored without OCR, a duplicate with the words of
+   * duplicatePage of duplicateFile
+   */
+  PageSkip skip = PageSkip::none;
+  std::string duplicateFile;
+  unsigned int duplicatePage = 0;
 };
 
-class FileTypeBankStatement {
+/* A PDF going through the pipeline
+ * The render and parse stages run as jobs of the scheduler, a page per
+ * step and in page order. The thread of the OCR stage does a step itself
+ * when no worker got to it, so a file never waits on a job queued behind
+ * the one waiting for it. Shared with the jobs, which find nothing to do
+ * once the file is done.
+ */
+class PdfPipeline {
 public:
-  std::unordered_map<unsigned int, std::shared_ptr<HocrWord>> hocrWordMap;
-  std::unordered_map<unsigned int, FileTypeBankStatementRow> rowMap;
+  std::string filePath;
+  bool updateSignal = false;
+  const RecognizeTicket *ticket = nullptr;
+  std::shared_ptr<Pdf> pdfFile;
+  int pagesTotal = 0;
+  std::shared_ptr<const RecognizeRegion> region;
+  std::string cacheKeyBase;
+  BoundedQueue<PipelinePage> renderQueue{BOOKFILER_RECOGNIZE_PIPELINE_DEPTH};
+  BoundedQueue<PipelinePage> parseQueue{BOOKFILER_RECOGNIZE_PIPELINE_DEPTH};
+  // held for a step, one page of a stage at a time
+  std::mutex renderMutex, parseMutex;
+  // guarded by renderMutex
+  int nextPage = 0;
+  // every page was rendered, or the render stage stopped
+  std::atomic<bool> renderDone{false};
+  // a job of the stage is queued or running
+  std::atomic<bool> renderPosted{false}, parsePosted{false};
+  // guarded by parseMutex
+  unsigned int pagesDone = 0;
+  // not rendered or recognized, counted in the metrics too
+  std::atomic<unsigned int> pagesFailed{0};
 };
 
+/* Results of one file, keyed by page number
+ */
 class RecognizeFile {
 public:
-  std::unordered_map<unsigned int, std::shared_ptr<Ocr>> ocrMap;
-  std::unordered_map<unsigned int, std::shared_ptr<boost::property_tree::ptree>>
-      hocrMap;
+  std::unordered_map<unsigned int, std::shared_ptr<Pixmap>> pixmapMap;
+  std::unordered_map<unsigned int, std::shared_ptr<HocrWordTable>> hocrMap;
+  std::unordered_map<unsigned int, std::shared_ptr<FileTypeBankStatement>>
+      statementMap;
+  std::unordered_map<unsigned int, std::shared_ptr<FileTypeInvoice>>
+      invoiceMap;
+  // estimated bytes of pixmapMap, and of hocrMap with the extracted tables
+  std::size_t pixmapBytes = 0, wordBytes = 0;
+  // pages whose words were evicted, loaded back from the cache when asked
+  std::vector<unsigned int> evictedPageList;
+  // position in RecognizeModelInternal::fileLruList
+  std::list<std::string>::iterator lruIt;
+};
+
+/* Region of a document type
+ * declared is what setDocumentRegion was given and active is what the
+ * files use. A learn region has no active region until the row bounds of
+ * learnPages whole pages are collected.
+ */
+class DocumentRegion {
+public:
+  std::shared_ptr<const RecognizeRegion> declared, active;
+  unsigned int pagesLearned = 0;
+  // union of the statement rows, in fractions of the page
+  double x0 = 1, y0 = 1, x1 = 0, y1 = 0;
 };
 
 class RecognizeModelInternal : public RecognizeModel {
 private:
+  std::mutex fileMapMutex;
   std::unordered_map<std::string, std::shared_ptr<RecognizeFile>>
       recognizeFileMap;
+  /* files of recognizeFileMap still holding pages, most recently used
+   * first, and the bytes they hold, guarded by fileMapMutex
+   */
+  std::list<std::string> fileLruList;
+  std::size_t fileMapBytes = 0, fileMapPixmapBytes = 0;
+  unsigned long long pixmapsEvicted = 0, filesEvicted = 0, filesReloaded = 0;
+  // one file is loaded back from the cache at a time
+  std::mutex reloadMutex;
   std::shared_ptr<OcrInterface> ocrModule;
   std::shared_ptr<PdfInterface> pdfModule;
+  // swapped with std::atomic_store, read with getSettings()
+  std::shared_ptr<const RecognizeSettings> settings;
+  std::shared_ptr<RecognizeCache> recognizeCache;
+  std::shared_ptr<PixmapPool> pixmapPool;
+  std::shared_ptr<OcrEnginePool> ocrEnginePool;
+  // files recognized before, null or disabled to queue every file
+  std::shared_ptr<FileManifest> fileManifest;
+  // every page stored is indexed, shared by the models of the module
+  std::shared_ptr<WordIndex> wordIndex;
+  // null until a catalog is set, swapped with std::atomic_store
+  std::shared_ptr<const PayeeMatcher> payeeMatcher;
+  /* Batch recognition
+   * Paths from addPaths wait in pendingPaths and are moved to the worker
+   * pool as it frees up, so only a bounded number of jobs exist at once.
+   */
+  std::mutex batchMutex;
+  std::deque<CrawlFile> pendingPaths;
+  std::atomic<unsigned long long> batchPagesDone, batchPagesFailed;
+  // files left out of the batch, recorded as unchanged or not an image
+  std::atomic<unsigned long long> batchFilesUnchanged, batchFilesIgnored;
+  std::chrono::steady_clock::time_point batchStart;
+  std::atomic<unsigned long long> nextTicketId;
+  std::mutex regionMutex;
+  std::unordered_map<std::string, DocumentRegion> regionMap;
+  RecognizeMetrics metrics;
+  // pages recognized in the current batch, duplicates reuse their words
+  PageFingerprintIndex fingerprintIndex;
+  // walks the directories of addPaths, created on first use
+  std::unique_ptr<PathCrawler> pathCrawler;
+  // emits the signals, stopped after the workers posting to it
+  std::unique_ptr<SignalDispatcher> signalDispatcher;
+  /* runs the jobs of every model of the module, declared last so a
+   * scheduler of the model alone stops before the rest is destroyed
+   */
+  std::shared_ptr<RecognizeScheduler> scheduler;
+  std::shared_ptr<SchedulerClient> schedulerClient;
+
+  // create the crawler on first use, batchMutex must be held
+  void startCrawlerLocked();
+  void feedBatch();
+  // runs on the crawler threads for every file found
+  void addCrawledFile(CrawlFile &file);
+  // pages of a recorded file, loaded from the cache when asked for
+  void addUnchangedFile(const std::string &filePath, unsigned int pages);
+  // OCR configuration and region of the pages recorded in the manifest
+  unsigned long long getManifestConfigHash();
+  void recordManifest(const CrawlFile &file);
+  // pages stored or evicted
+  unsigned int getStoredPageCount(const std::string &filePath);
+  void recognizeBatchFile(const CrawlFile &file);
+  // stored pages of a file with their image, sorted by page number
+  std::vector<std::pair<unsigned int, std::shared_ptr<Pixmap>>>
+  getStoredPages(const std::string &filePath);
+  // runs on the worker pool for requestRecognizeAsync
+  std::shared_ptr<RecognizeResult>
+  recognizeTicket(std::string filePath,
+                  std::shared_ptr<RecognizeTicket> ticket);
+  /* @brief A configured engine from the pool, timed as ocrSetup
+   * @param ocrKey set to the configuration to check the engine back in with
+   */
+  std::shared_ptr<Ocr> checkOutOcr(std::string &ocrKey);
+  void checkInOcr(const std::string &ocrKey, std::shared_ptr<Ocr> ocr);
+  /* @brief Recognize the image open in the engine and wait for its callback
+   * The callback holds nothing of the page, an engine calling back late or
+   * once it is back in the pool does no harm.
+   * An engine recognizing inside recognize() is only left once it returns.
+   * @param ticket stop waiting once cancelled, may be null
+   * @return false if the engine did not call back within ocrTimeoutMs or
+   * the ticket was cancelled first, it may still be busy and must not go
+   * back to the pool
+   */
+  bool runOcr(Ocr &ocr, const RecognizeTicket *ticket);
+  /* @brief Cache key of every page of a file
+   * @param region part of the page recognized, null for the whole page
+   * @return empty if the cache is off or the file can not be read
+   */
+  std::string getCacheKeyBase(const std::string &filePath,
+                              const RecognizeRegion *region);
+  std::string getCacheKey(const std::string &keyBase, unsigned int pageNum);
+  // timed and counted cache access, an empty key is a miss
+  std::shared_ptr<HocrWordTable> loadCached(const std::string &cacheKey);
+  void storeCached(const std::string &cacheKey, const HocrWordTable &table);
+  // runtime trace level from the settings
+  unsigned int getDebugLevel();
+  // region used for the files starting now, null for the whole page
+  std::shared_ptr<const RecognizeRegion> getActiveRegion();
+  /* @brief Feed the table rows of a page recognized whole to the region
+   * of its document type if it is being learned
+   */
+  void learnRegion(const std::string &filePath, unsigned int pageNum,
+                   long pageWidth, long pageHeight);
+  void storeWordTable(const std::string &filePath, unsigned int pageNum,
+                      std::shared_ptr<Pixmap> pixmap,
+                      std::shared_ptr<HocrWordTable> wordTable);
+  /* @brief Mark the file as just used, fileMapMutex must be held
+   * A file not in the list yet is added.
+   */
+  void touchFileLocked(const std::string &filePath, RecognizeFile &file);
+  /* @brief Bring the model under modelMaxBytes, and under its memory limit
+   * of the scheduler, fileMapMutex must be held
+   * The images of the least recently used files go first, a page is
+   * rendered again for them, then their words. keep is never evicted.
+   */
+  void evictFilesLocked(const RecognizeFile *keep);
+  // evict when the scheduler asks, the module is over its maxBytes
+  void trimMemory();
+  /* @brief Load the evicted pages of the file back from the cache
+   * Pages missing from the cache stay unrecognized.
+   */
+  void reloadEvictedFile(const std::string &filePath);
+  /* @brief Store a table that may hold several pages, see pageEnd, one
+   * table per page from pageNum on
+   */
+  void storeWordTablePages(const std::string &filePath, unsigned int pageNum,
+                           std::shared_ptr<Pixmap> pixmap,
+                           std::shared_ptr<HocrWordTable> wordTable);
+  /* @brief Parse the hOCR of one page and move it to page coordinates
+   * @param onBatch gets each block as it closes, empty to parse in one go
+   * @param parseTime set to the parse time without the time in onBatch
+   */
+  std::shared_ptr<HocrWordTable> parseHocrPage(
+      std::string_view data, const std::string &filePath,
+      unsigned int pageNum, unsigned int offsetX, unsigned int offsetY,
+      const std::function<void(std::shared_ptr<HocrWordBatch>)> &onBatch,
+      std::chrono::steady_clock::duration &parseTime);
+  /* @brief Count the ink of the pixels going to the engine and set
+   * page.skip if the page is blank or a duplicate
+   * @param fileIndex pages of the same file sent to the engine so far,
+   * looked up before the batch, may be null
+   */
+  void checkPageSkip(const Pixmap &pixmap, PipelinePage &page,
+                     PageFingerprintIndex *fileIndex);
+  /* @brief Store a blank or duplicate page without OCR
+   * @return the stored word table, null if the page it duplicates is not
+   * stored
+   */
+  std::shared_ptr<HocrWordTable> storeSkippedPage(const std::string &filePath,
+                                                  const PipelinePage &page);
+  /* @brief Recognize a duplicate whose page is not stored after all, as
+   * recognizeImageFile does
+   * @return false if no engine took the page, page.ocr holds the result
+   * otherwise
+   */
+  bool recognizeSkippedPage(PipelinePage &page, const RecognizeRegion *region,
+                            const RecognizeTicket *ticket);
+  /* @brief Recognize an image file, from the cache if it is there
+   * Blocks until the OCR engine is done.
+   * @param updateSignal emit the image and word signals
+   * @param ticket stop and discard the result once cancelled, may be null
+   * @return false if the page failed or was cancelled
+   */
+  bool recognizeImageFile(const std::string &filePath, bool updateSignal,
+                          const RecognizeTicket *ticket);
+  /* @brief Render the next page of a PDF into its render queue
+   * @return false if the queue is full or the render stage is done
+   */
+  bool renderPdfPage(PdfPipeline &pipeline);
+  /* @brief Store the next page of the parse queue of a PDF
+   * @return false if the queue is empty
+   */
+  bool parsePdfPage(PdfPipeline &pipeline);
+  // queue a job running the stage while it has work, unless one is
+  void postPdfStage(std::shared_ptr<PdfPipeline> pipeline, bool render);
+  /* @brief Recognize every page of a PDF
+   * Rendering, OCR and hOCR parsing run as three pipelined stages so page
+   * k+1 renders while page k is recognized and page k-1 is parsed. OCR
+   * runs on the calling thread, the other two as jobs of the scheduler.
+   * @param updateSignal emit the image and word signals for each page
+   * @param ticket stop between pages once cancelled, may be null
+   * @param pagesFailed set to the pages that failed, may be null
+   * @return number of pages recognized
+   */
+  unsigned int recognizePdfFile(std::string filePath, bool updateSignal,
+                                const RecognizeTicket *ticket = nullptr,
+                                unsigned int *pagesFailed = nullptr);
 
 public:
   RecognizeModelInternal(std::shared_ptr<OcrInterface> ocrModule_,
-                         std::shared_ptr<PdfInterface> pdfModule_);
+                         std::shared_ptr<PdfInterface> pdfModule_,
+                         std::shared_ptr<const RecognizeSettings> settings_,
+                         std::shared_ptr<RecognizeCache> recognizeCache_,
+                         std::shared_ptr<PixmapPool> pixmapPool_ = nullptr,
+                         std::shared_ptr<OcrEnginePool> ocrEnginePool_ =
+                             nullptr,
+                         std::shared_ptr<FileManifest> fileManifest_ =
+                             nullptr,
+                         std::shared_ptr<WordIndex> wordIndex_ = nullptr,
+                         std::shared_ptr<RecognizeScheduler> scheduler_ =
+                             nullptr);
   ~RecognizeModelInternal();
+  void setSettings(std::shared_ptr<const RecognizeSettings> settings_);
+  std::shared_ptr<const RecognizeSettings> getSettings();
   void addPaths(std::shared_ptr<std::vector<std::string>> fileSelectedList);
   void requestRecognize(std::string fileRequested);
+  std::shared_ptr<RecognizeTicket>
+  requestRecognizeAsync(std::string fileRequested,
+                        RecognizePriority priority);
+  std::shared_ptr<rapidjson::Document> getBatchStatus();
+  std::shared_ptr<rapidjson::Document> getMetrics();
+  std::size_t getMemoryBytes();
+  void setDocumentRegion(std::string documentType,
+                         std::shared_ptr<const RecognizeRegion> region);
+  std::shared_ptr<const RecognizeRegion>
+  getDocumentRegion(std::string documentType);
   void recognizeDone(std::shared_ptr<Ocr>);
+  /* @brief Parse the hOCR of a finished page and store it in the file map
+   * hOCR of several pages, a multi-page TIFF, is cut at the ocr_page
+   * elements and the pages are parsed on the worker pool, stored from
+   * page.pageNum on.
+   * @param page the engine holding the hOCR, the page image, where the
+   * recognized region starts on the page, the words are moved by it, and
+   * when the page was opened, for the page latency
+   * @param streamSignal emit wordBatchUpdateSignal as the blocks are parsed,
+   * page by page in order once all are parsed for several pages
+   * @return the page word table, every page in order with pageEnd set for
+   * several pages
+   */
+  std::shared_ptr<HocrWordTable> recognizeDone(const std::string &filePath,
+                                               const PipelinePage &page,
+                                               bool streamSignal = false);
+  bool exportDocument(std::string filePath, std::string exportPath,
+                      std::string format);
+  std::shared_ptr<std::vector<WordHit>> findWords(std::string term,
+                                                  std::size_t maxHits);
+  std::shared_ptr<std::vector<WordHit>> findWordPrefix(std::string prefix,
+                                                       std::size_t maxHits);
+  std::shared_ptr<std::vector<WordHit>>
+  findAmounts(long long minimum, long long maximum, std::size_t maxHits);
+  void setPayeeCatalog(std::shared_ptr<const std::vector<std::string>> catalog);
+  void setSignalExecutor(std::function<void(std::function<void()>)> executor);
+  void flushSignals();
+  // @return stored word table, null if the page was not recognized yet
+  std::shared_ptr<HocrWordTable> getWordTable(std::string filePath,
+                                              unsigned int pageNum);
+  // @return transaction rows of a page, null if not recognized yet
+  std::shared_ptr<FileTypeBankStatement> getBankStatement(std::string filePath,
+                                                          unsigned int pageNum);
+  // @return items and totals of a page, null if not read as an invoice
+  std::shared_ptr<FileTypeInvoice> getInvoice(std::string filePath,
+                                              unsigned int pageNum);
   void printPropertyTree(boost::property_tree::ptree &tree);
-  // for the Bookfiler™ Accounting
-  void toBankStatementTable(boost::property_tree::ptree hocrTree);
+  /* Original read_xml based word extraction. recognizeDone uses the
+   * streaming HocrParser, this is kept to compare the two.
+   */
+  std::shared_ptr<std::vector<std::shared_ptr<HocrWord>>>
+  toHocrWordListTree(boost::property_tree::ptree &hocrTree);
+  /* @brief Queue the word signals of a finished page
+   * for the Bookfiler™ Accounting
+   * @param streamed the batches were already sent by recognizeDone
+   */
+  void toBankStatementTable(std::shared_ptr<HocrWordTable> wordTable,
+                            const std::string &filePath = "",
+                            bool streamed = false);
 };
 
 } // namespace bookfiler
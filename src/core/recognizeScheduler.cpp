@@ -0,0 +1,378 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <algorithm>
+
+// Local Project
+#include "recognizeScheduler.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+RecognizeScheduler::OcrPermit::OcrPermit(RecognizeScheduler &scheduler_,
+                                         SchedulerClient &client_)
+    : scheduler(&scheduler_), client(&client_) {
+  scheduler->acquireOcr(*client);
+}
+RecognizeScheduler::OcrPermit::~OcrPermit() { scheduler->releaseOcr(*client); }
+
+RecognizeScheduler::RecognizeScheduler()
+    : nextClientId(0), dispatchCount(0), maxJobs(0), maxOcrJobs(0),
+      maxBytes(0), running(0), ocrRunning(0), ocrPeak(0), memoryBytes(0),
+      busyTime(0), nextOcrTicket(0), stopFlag(false) {}
+RecognizeScheduler::~RecognizeScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopFlag = true;
+  }
+  // running jobs finish, nothing is handed out after them
+  workerPool.reset();
+}
+
+void RecognizeScheduler::configure(const RecognizeSettings &settings) {
+  std::lock_guard<std::mutex> lock(mutex);
+  maxJobs = settings.schedulerMaxJobs;
+  maxOcrJobs = settings.schedulerMaxOcrJobs;
+  maxBytes = static_cast<std::size_t>(settings.schedulerMaxBytes);
+  // more slots, or permits, may be free now
+  dispatchLocked();
+  ocrCondition.notify_all();
+  trimLocked(nullptr);
+}
+
+std::shared_ptr<SchedulerClient>
+RecognizeScheduler::addClient(std::size_t queueCapacity,
+                              std::function<void()> trim) {
+  std::shared_ptr<SchedulerClient> client =
+      std::make_shared<SchedulerClient>();
+  client->queueCapacity = queueCapacity;
+  client->trim = trim;
+  client->added = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock(mutex);
+  client->id = ++nextClientId;
+  clientList.push_back(client);
+  return client;
+}
+
+void RecognizeScheduler::removeClient(SchedulerClient &client) {
+  std::array<std::deque<std::function<void()>>, WorkerPool::priorityCount>
+      droppedList;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    client.closed = true;
+    droppedList.swap(client.queueList);
+    client.queued = 0;
+    idleCondition.wait(lock, [&client] { return client.running == 0; });
+    memoryBytes -= client.memoryBytes;
+    client.memoryBytes = 0;
+    clientList.erase(
+        std::remove_if(clientList.begin(), clientList.end(),
+                       [&client](const std::shared_ptr<SchedulerClient> &c) {
+                         return c.get() == &client;
+                       }),
+        clientList.end());
+    // an OCR waiter may have been behind it
+    ocrCondition.notify_all();
+  }
+  // the jobs hold promises, they are broken outside the lock
+}
+
+void RecognizeScheduler::startLocked() {
+  if (!workerPool) {
+    workerPool =
+        std::make_unique<WorkerPool>(BOOKFILER_RECOGNIZE_BATCH_THREADS);
+  }
+}
+
+unsigned int RecognizeScheduler::getMaxJobsLocked() {
+  if (maxJobs > 0) {
+    return maxJobs;
+  }
+  return workerPool ? workerPool->getThreadCount() : 1;
+}
+
+bool RecognizeScheduler::trySubmit(SchedulerClient &client,
+                                   std::function<void()> job,
+                                   unsigned int priority) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (client.closed || client.queued >= client.queueCapacity) {
+    return false;
+  }
+  pushLocked(client, std::move(job), priority);
+  return true;
+}
+
+void RecognizeScheduler::post(SchedulerClient &client,
+                              std::function<void()> job,
+                              unsigned int priority) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (client.closed) {
+    return;
+  }
+  pushLocked(client, std::move(job), priority);
+}
+
+void RecognizeScheduler::pushLocked(SchedulerClient &client,
+                                    std::function<void()> job,
+                                    unsigned int priority) {
+  startLocked();
+  priority = std::min(priority, WorkerPool::priorityCount - 1);
+  client.queueList[priority].push_back(std::move(job));
+  client.queued++;
+  dispatchLocked();
+}
+
+void RecognizeScheduler::dispatchLocked() {
+  if (stopFlag || !workerPool) {
+    return;
+  }
+  unsigned int slots = getMaxJobsLocked();
+  while (running < slots) {
+    std::shared_ptr<SchedulerClient> chosen;
+    unsigned int priority = WorkerPool::priorityCount;
+    while (!chosen && priority > 0) {
+      priority--;
+      for (const std::shared_ptr<SchedulerClient> &client : clientList) {
+        if (client->queueList[priority].empty()) {
+          continue;
+        }
+        if (!chosen || client->running < chosen->running ||
+            (client->running == chosen->running &&
+             client->lastDispatch < chosen->lastDispatch)) {
+          chosen = client;
+        }
+      }
+    }
+    if (!chosen) {
+      return;
+    }
+    std::function<void()> job = std::move(chosen->queueList[priority].front());
+    chosen->queueList[priority].pop_front();
+    chosen->queued--;
+    chosen->running++;
+    chosen->lastDispatch = ++dispatchCount;
+    running++;
+    // the pool only holds the jobs running, post never waits for room
+    workerPool->post(
+        [this, chosen, job = std::move(job)]() mutable { runJob(chosen, job); },
+        priority);
+  }
+}
+
+void RecognizeScheduler::runJob(std::shared_ptr<SchedulerClient> client,
+                                std::function<void()> &job) {
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  job();
+  std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+  // the captures of the job go before the client is seen idle
+  job = nullptr;
+  std::lock_guard<std::mutex> lock(mutex);
+  running--;
+  client->running--;
+  client->completed++;
+  client->busyTime += elapsed;
+  busyTime += elapsed;
+  if (client->closed && client->running == 0) {
+    idleCondition.notify_all();
+  }
+  dispatchLocked();
+}
+
+void RecognizeScheduler::forEach(SchedulerClient &client, std::size_t count,
+                                 const std::function<void(std::size_t)> &job,
+                                 unsigned int priority) {
+  forEachIndex(count, job, [&](const std::function<void()> &helper) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::size_t helperCount =
+        std::min<std::size_t>(count - 1, getMaxJobsLocked());
+    for (std::size_t i = 0; i < helperCount && !client.closed; i++) {
+      pushLocked(client, helper, priority);
+    }
+  });
+}
+
+void RecognizeScheduler::setMemoryBytes(SchedulerClient &client,
+                                        std::size_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (client.closed) {
+    return;
+  }
+  memoryBytes += bytes - client.memoryBytes;
+  client.memoryBytes = bytes;
+  // the client itself evicts as it stores
+  trimLocked(&client);
+}
+
+void RecognizeScheduler::trimLocked(const SchedulerClient *except) {
+  if (maxBytes == 0 || memoryBytes <= maxBytes || clientList.empty()) {
+    return;
+  }
+  std::size_t share = maxBytes / clientList.size();
+  for (const std::shared_ptr<SchedulerClient> &client : clientList) {
+    if (client.get() == except || !client->trim || client->trimPending ||
+        client->memoryBytes <= share) {
+      continue;
+    }
+    client->trimPending = true;
+    pushLocked(
+        *client,
+        [this, client]() {
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            client->trimPending = false;
+          }
+          client->trim();
+        },
+        WorkerPool::priorityCount - 1);
+  }
+}
+
+std::size_t RecognizeScheduler::getMemoryLimit(const SchedulerClient &client) {
+  std::lock_guard<std::mutex> lock(mutex);
+  return getMemoryLimitLocked(client);
+}
+
+std::size_t
+RecognizeScheduler::getMemoryLimitLocked(const SchedulerClient &client) {
+  if (maxBytes == 0 || clientList.empty()) {
+    return 0;
+  }
+  std::size_t others = memoryBytes - client.memoryBytes;
+  std::size_t share = maxBytes / clientList.size();
+  // at least one byte, 0 would be no limit
+  return std::max<std::size_t>(
+      {maxBytes > others ? maxBytes - others : 0, share, 1});
+}
+
+void RecognizeScheduler::acquireOcr(SchedulerClient &client) {
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> lock(mutex);
+  unsigned long long ticket = ++nextOcrTicket;
+  ocrWaitList.push_back({&client, ticket});
+  /* a free permit goes to the waiting client with the fewest pages in the
+   * engines, the first to arrive among them
+   */
+  ocrCondition.wait(lock, [&]() {
+    if (maxOcrJobs > 0 && ocrRunning >= maxOcrJobs) {
+      return false;
+    }
+    auto next = ocrWaitList.begin();
+    for (auto it = ocrWaitList.begin(); it != ocrWaitList.end(); ++it) {
+      if (it->first->ocrRunning < next->first->ocrRunning) {
+        next = it;
+      }
+    }
+    return next->second == ticket;
+  });
+  ocrWaitList.erase(std::find_if(
+      ocrWaitList.begin(), ocrWaitList.end(),
+      [ticket](const std::pair<SchedulerClient *, unsigned long long> &wait) {
+        return wait.second == ticket;
+      }));
+  ocrRunning++;
+  ocrPeak = std::max(ocrPeak, ocrRunning);
+  client.ocrRunning++;
+  client.ocrWaitTime += std::chrono::steady_clock::now() - start;
+  // the next waiter may fit too
+  ocrCondition.notify_all();
+}
+
+void RecognizeScheduler::releaseOcr(SchedulerClient &client) {
+  std::lock_guard<std::mutex> lock(mutex);
+  ocrRunning--;
+  client.ocrRunning--;
+  ocrCondition.notify_all();
+}
+
+unsigned int RecognizeScheduler::getThreadCount() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return workerPool ? workerPool->getThreadCount() : 0;
+}
+
+std::size_t RecognizeScheduler::getQueued(const SchedulerClient &client) {
+  std::lock_guard<std::mutex> lock(mutex);
+  return client.queued;
+}
+
+std::size_t RecognizeScheduler::getRunning(const SchedulerClient &client) {
+  std::lock_guard<std::mutex> lock(mutex);
+  return client.running;
+}
+
+void RecognizeScheduler::toJson(
+    rapidjson::Value &value, rapidjson::Document::AllocatorType &allocator) {
+  std::lock_guard<std::mutex> lock(mutex);
+  value.SetObject();
+  value.AddMember("threads", workerPool ? workerPool->getThreadCount() : 0,
+                  allocator);
+  value.AddMember("maxJobs", getMaxJobsLocked(), allocator);
+  value.AddMember("maxOcrJobs", maxOcrJobs, allocator);
+  value.AddMember("maxBytes", static_cast<uint64_t>(maxBytes), allocator);
+  value.AddMember("running", static_cast<uint64_t>(running), allocator);
+  value.AddMember("ocrRunning", static_cast<uint64_t>(ocrRunning), allocator);
+  value.AddMember("ocrPeak", static_cast<uint64_t>(ocrPeak), allocator);
+  value.AddMember("memoryBytes", static_cast<uint64_t>(memoryBytes),
+                  allocator);
+  rapidjson::Value modelList(rapidjson::kArrayType);
+  for (const std::shared_ptr<SchedulerClient> &client : clientList) {
+    rapidjson::Value model;
+    clientToJson(*client, model, allocator);
+    modelList.PushBack(model, allocator);
+  }
+  value.AddMember("models", modelList, allocator);
+}
+
+void RecognizeScheduler::getClientJson(
+    const SchedulerClient &client, rapidjson::Value &value,
+    rapidjson::Document::AllocatorType &allocator) {
+  std::lock_guard<std::mutex> lock(mutex);
+  clientToJson(client, value, allocator);
+}
+
+void RecognizeScheduler::clientToJson(
+    const SchedulerClient &client, rapidjson::Value &value,
+    rapidjson::Document::AllocatorType &allocator) {
+  double elapsed = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - client.added)
+                       .count();
+  double busy = std::chrono::duration<double>(client.busyTime).count();
+  double busyAll = std::chrono::duration<double>(busyTime).count();
+  value.SetObject();
+  value.AddMember("id", static_cast<uint64_t>(client.id), allocator);
+  value.AddMember("queued", static_cast<uint64_t>(client.queued), allocator);
+  value.AddMember("running", static_cast<uint64_t>(client.running),
+                  allocator);
+  value.AddMember("ocrRunning", static_cast<uint64_t>(client.ocrRunning),
+                  allocator);
+  value.AddMember("completed", static_cast<uint64_t>(client.completed),
+                  allocator);
+  value.AddMember("busySeconds", busy, allocator);
+  value.AddMember(
+      "ocrWaitSeconds",
+      std::chrono::duration<double>(client.ocrWaitTime).count(), allocator);
+  // of the job slots since the client was added, and of all the work done
+  value.AddMember("utilization",
+                  elapsed > 0 ? busy / (elapsed * getMaxJobsLocked()) : 0.0,
+                  allocator);
+  value.AddMember("share", busyAll > 0 ? busy / busyAll : 0.0, allocator);
+  value.AddMember("memoryBytes", static_cast<uint64_t>(client.memoryBytes),
+                  allocator);
+  value.AddMember("memoryLimit",
+                  static_cast<uint64_t>(getMemoryLimitLocked(client)),
+                  allocator);
+}
+
+} // namespace bookfiler
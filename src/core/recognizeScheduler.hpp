@@ -0,0 +1,173 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_SCHEDULER_H
+#define BOOKFILER_MODULE_RECOGNIZE_SCHEDULER_H
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/* rapidjson v1.1 (2016-8-25)
+ * Developed by Tencent
+ * License: MITs
+ */
+#include <rapidjson/document.h>
+
+// Local Project
+#include "recognizeSettings.hpp"
+#include "workerPool.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+/* A model as the scheduler sees it, every member is guarded by the mutex
+ * of the scheduler
+ */
+class SchedulerClient {
+public:
+  unsigned long long id = 0;
+  // jobs trySubmit lets wait, post is not bounded
+  std::size_t queueCapacity = 0;
+  // indexed by priority, the highest runs first
+  std::array<std::deque<std::function<void()>>, WorkerPool::priorityCount>
+      queueList;
+  std::size_t queued = 0, running = 0, ocrRunning = 0;
+  unsigned long long completed = 0;
+  std::chrono::nanoseconds busyTime{0}, ocrWaitTime{0};
+  std::chrono::steady_clock::time_point added;
+  // order of the last job handed out, the longest waiting client goes first
+  unsigned long long lastDispatch = 0;
+  // bytes of the pages the model keeps, see setMemoryBytes
+  std::size_t memoryBytes = 0;
+  // evicts down to getMemoryLimit, run as a job of the client
+  std::function<void()> trim;
+  bool trimPending = false;
+  // removed, its jobs are dropped
+  bool closed = false;
+};
+
+/* Runs the jobs of every model of the module on one worker pool
+ * Each model is a client with its own queue. Up to maxJobs jobs run at
+ * once, a free slot goes to the highest priority waiting and among the
+ * clients with a job of that priority to the one running the fewest, so
+ * models opened together share the workers evenly. Pages in the OCR
+ * engines are capped by maxOcrJobs over every model, and the bytes of the
+ * pages the models keep by maxBytes: a model over its share is asked to
+ * trim when the total goes over. Safe from any thread.
+ */
+class RecognizeScheduler {
+public:
+  /* Held while a page is in an OCR engine
+   */
+  class OcrPermit {
+  private:
+    RecognizeScheduler *scheduler;
+    SchedulerClient *client;
+
+  public:
+    OcrPermit(RecognizeScheduler &scheduler_, SchedulerClient &client_);
+    ~OcrPermit();
+    OcrPermit(const OcrPermit &) = delete;
+    OcrPermit &operator=(const OcrPermit &) = delete;
+  };
+
+private:
+  std::mutex mutex;
+  std::condition_variable idleCondition, ocrCondition;
+  std::vector<std::shared_ptr<SchedulerClient>> clientList;
+  unsigned long long nextClientId, dispatchCount;
+  unsigned int maxJobs, maxOcrJobs;
+  std::size_t maxBytes;
+  std::size_t running, ocrRunning, ocrPeak, memoryBytes;
+  std::chrono::nanoseconds busyTime;
+  // clients waiting for an OCR permit, in order of arrival
+  std::deque<std::pair<SchedulerClient *, unsigned long long>> ocrWaitList;
+  unsigned long long nextOcrTicket;
+  bool stopFlag;
+  // declared last so the workers stop before the rest is destroyed
+  std::unique_ptr<WorkerPool> workerPool;
+
+  // create the pool on first use
+  void startLocked();
+  unsigned int getMaxJobsLocked();
+  // hand the waiting jobs to the pool while slots are free
+  void dispatchLocked();
+  void runJob(std::shared_ptr<SchedulerClient> client,
+              std::function<void()> &job);
+  void pushLocked(SchedulerClient &client, std::function<void()> job,
+                  unsigned int priority);
+  // trim the clients over their share while the total is over maxBytes
+  void trimLocked(const SchedulerClient *except);
+  std::size_t getMemoryLimitLocked(const SchedulerClient &client);
+  void acquireOcr(SchedulerClient &client);
+  void releaseOcr(SchedulerClient &client);
+  void clientToJson(const SchedulerClient &client, rapidjson::Value &value,
+                    rapidjson::Document::AllocatorType &allocator);
+
+public:
+  RecognizeScheduler();
+  ~RecognizeScheduler();
+  void configure(const RecognizeSettings &settings);
+  /* @param queueCapacity jobs trySubmit lets wait
+   * @param trim evicts down to getMemoryLimit, null if nothing can be
+   */
+  std::shared_ptr<SchedulerClient> addClient(std::size_t queueCapacity,
+                                             std::function<void()> trim);
+  /* @brief Drop the queued jobs of the client and wait for the running
+   * ones, never from a job of the client
+   */
+  void removeClient(SchedulerClient &client);
+  /* @return false if the queue of the client is full or it was removed
+   * @param priority 0 to WorkerPool::priorityCount - 1, higher runs first
+   */
+  bool trySubmit(SchedulerClient &client, std::function<void()> job,
+                 unsigned int priority = 0);
+  // Queue the job even if the client queue is full
+  void post(SchedulerClient &client, std::function<void()> job,
+            unsigned int priority);
+  /* @brief Run job(i) for every i below count and return when all are done
+   * See forEachIndex, the helpers are jobs of the client so they count
+   * against maxJobs and its share. Safe to call from a job.
+   */
+  void forEach(SchedulerClient &client, std::size_t count,
+               const std::function<void(std::size_t)> &job,
+               unsigned int priority);
+  // @brief Record the bytes the client keeps, trims the others if over
+  void setMemoryBytes(SchedulerClient &client, std::size_t bytes);
+  /* @return the bytes the client may keep, its share of maxBytes or what
+   * the others leave if more, 0 for no limit
+   */
+  std::size_t getMemoryLimit(const SchedulerClient &client);
+  unsigned int getThreadCount();
+  // jobs of the client waiting and running
+  std::size_t getQueued(const SchedulerClient &client);
+  std::size_t getRunning(const SchedulerClient &client);
+  // caps, totals and every client
+  void toJson(rapidjson::Value &value,
+              rapidjson::Document::AllocatorType &allocator);
+  // queue, running jobs and utilization of one client
+  void getClientJson(const SchedulerClient &client, rapidjson::Value &value,
+                     rapidjson::Document::AllocatorType &allocator);
+};
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_SCHEDULER_H
@@ -0,0 +1,272 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+// c++17
+#include <cstdlib>
+
+/* boost 1.72.0
+ * License: Boost Software License (similar to BSD and MIT)
+ */
+#include <boost/filesystem.hpp>
+
+// Local Project
+#include "recognizeSettings.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+RecognizeSettings::RecognizeSettings() {
+  // the cache directory of the user, never one shared by every user
+#if defined(_WIN32)
+  const char *base = std::getenv("LOCALAPPDATA");
+  boost::filesystem::path userCache = base ? base : "";
+#else
+  const char *base = std::getenv("XDG_CACHE_HOME");
+  const char *home = std::getenv("HOME");
+  boost::filesystem::path userCache =
+      base && *base ? boost::filesystem::path(base)
+      : home && *home ? boost::filesystem::path(home) / ".cache"
+                      : boost::filesystem::path();
+#endif
+  if (!userCache.empty()) {
+    cachePath = (userCache / "bookfiler" / "recognize-cache").string();
+  }
+}
+
+void RecognizeSettings::load(const rapidjson::Value &data) {
+  if (!data.IsObject()) {
+    return;
+  }
+  auto ocrIt = data.FindMember("ocr");
+  if (ocrIt != data.MemberEnd() && ocrIt->value.IsObject()) {
+    const rapidjson::Value &ocr = ocrIt->value;
+    if (ocr.HasMember("mode") && ocr["mode"].IsString()) {
+      ocrMode = ocr["mode"].GetString();
+    }
+    if (ocr.HasMember("type") && ocr["type"].IsString()) {
+      ocrType = ocr["type"].GetString();
+      documentType = getDocumentType(ocrType);
+    }
+    if (ocr.HasMember("language") && ocr["language"].IsArray()) {
+      ocrLanguage.clear();
+      for (auto &language : ocr["language"].GetArray()) {
+        if (language.IsString()) {
+          ocrLanguage.push_back(language.GetString());
+        }
+      }
+    }
+    if (ocr.HasMember("dataPath") && ocr["dataPath"].IsString()) {
+      ocrDataPath = ocr["dataPath"].GetString();
+    }
+    if (ocr.HasMember("poolMaxIdle") && ocr["poolMaxIdle"].IsUint()) {
+      ocrPoolMaxIdle = ocr["poolMaxIdle"].GetUint();
+    }
+    if (ocr.HasMember("poolIdleSeconds") && ocr["poolIdleSeconds"].IsUint()) {
+      ocrPoolIdleSeconds = ocr["poolIdleSeconds"].GetUint();
+    }
+    if (ocr.HasMember("warmEngines") && ocr["warmEngines"].IsUint()) {
+      ocrWarmEngines = ocr["warmEngines"].GetUint();
+    }
+    if (ocr.HasMember("timeoutMs") && ocr["timeoutMs"].IsUint()) {
+      ocrTimeoutMs = ocr["timeoutMs"].GetUint();
+    }
+  }
+  auto cacheIt = data.FindMember("cache");
+  if (cacheIt != data.MemberEnd() && cacheIt->value.IsObject()) {
+    const rapidjson::Value &cache = cacheIt->value;
+    if (cache.HasMember("enabled") && cache["enabled"].IsBool()) {
+      cacheEnabled = cache["enabled"].GetBool();
+    }
+    if (cache.HasMember("path") && cache["path"].IsString()) {
+      cachePath = cache["path"].GetString();
+    }
+    if (cache.HasMember("maxBytes") && cache["maxBytes"].IsUint64()) {
+      cacheMaxBytes = cache["maxBytes"].GetUint64();
+    }
+  }
+  auto pixmapIt = data.FindMember("pixmap");
+  if (pixmapIt != data.MemberEnd() && pixmapIt->value.IsObject()) {
+    const rapidjson::Value &pixmap = pixmapIt->value;
+    if (pixmap.HasMember("cacheMaxBytes") &&
+        pixmap["cacheMaxBytes"].IsUint64()) {
+      pixmapCacheMaxBytes = pixmap["cacheMaxBytes"].GetUint64();
+    }
+    if (pixmap.HasMember("budgetBytes") && pixmap["budgetBytes"].IsUint64()) {
+      pixmapBudgetBytes = pixmap["budgetBytes"].GetUint64();
+    }
+    if (pixmap.HasMember("budgetWaitMs") && pixmap["budgetWaitMs"].IsUint()) {
+      pixmapBudgetWaitMs = pixmap["budgetWaitMs"].GetUint();
+    }
+  }
+  auto modelIt = data.FindMember("model");
+  if (modelIt != data.MemberEnd() && modelIt->value.IsObject()) {
+    const rapidjson::Value &model = modelIt->value;
+    if (model.HasMember("maxBytes") && model["maxBytes"].IsUint64()) {
+      modelMaxBytes = model["maxBytes"].GetUint64();
+    }
+  }
+  auto schedulerIt = data.FindMember("scheduler");
+  if (schedulerIt != data.MemberEnd() && schedulerIt->value.IsObject()) {
+    const rapidjson::Value &scheduler = schedulerIt->value;
+    if (scheduler.HasMember("maxJobs") && scheduler["maxJobs"].IsUint()) {
+      schedulerMaxJobs = scheduler["maxJobs"].GetUint();
+    }
+    if (scheduler.HasMember("maxOcrJobs") &&
+        scheduler["maxOcrJobs"].IsUint()) {
+      schedulerMaxOcrJobs = scheduler["maxOcrJobs"].GetUint();
+    }
+    if (scheduler.HasMember("maxBytes") && scheduler["maxBytes"].IsUint64()) {
+      schedulerMaxBytes = scheduler["maxBytes"].GetUint64();
+    }
+  }
+  auto crawlIt = data.FindMember("crawl");
+  if (crawlIt != data.MemberEnd() && crawlIt->value.IsObject()) {
+    const rapidjson::Value &crawl = crawlIt->value;
+    if (crawl.HasMember("threads") && crawl["threads"].IsUint()) {
+      crawlThreads = crawl["threads"].GetUint();
+    }
+    if (crawl.HasMember("manifest") && crawl["manifest"].IsBool()) {
+      crawlManifest = crawl["manifest"].GetBool();
+    }
+  }
+  auto indexIt = data.FindMember("index");
+  if (indexIt != data.MemberEnd() && indexIt->value.IsObject()) {
+    const rapidjson::Value &index = indexIt->value;
+    if (index.HasMember("enabled") && index["enabled"].IsBool()) {
+      indexEnabled = index["enabled"].GetBool();
+    }
+    if (index.HasMember("flushWords") && index["flushWords"].IsUint64()) {
+      indexFlushWords = index["flushWords"].GetUint64();
+    }
+  }
+  auto debugIt = data.FindMember("debug");
+  if (debugIt != data.MemberEnd() && debugIt->value.IsObject()) {
+    const rapidjson::Value &debug = debugIt->value;
+    if (debug.HasMember("level") && debug["level"].IsUint()) {
+      debugLevel = debug["level"].GetUint();
+    }
+    if (debug.HasMember("metrics") && debug["metrics"].IsBool()) {
+      metricsEnabled = debug["metrics"].GetBool();
+    }
+  }
+  auto streamIt = data.FindMember("stream");
+  if (streamIt != data.MemberEnd() && streamIt->value.IsObject()) {
+    const rapidjson::Value &stream = streamIt->value;
+    if (stream.HasMember("level") && stream["level"].IsString()) {
+      std::string level = stream["level"].GetString();
+      if (level == "line") {
+        streamLevel = HocrEvent::lineEnd;
+      } else if (level == "par") {
+        streamLevel = HocrEvent::parEnd;
+      } else if (level == "page") {
+        streamLevel = HocrEvent::pageEnd;
+      }
+    }
+  }
+  auto signalIt = data.FindMember("signal");
+  if (signalIt != data.MemberEnd() && signalIt->value.IsObject()) {
+    const rapidjson::Value &signal = signalIt->value;
+    if (signal.HasMember("dispatch") && signal["dispatch"].IsString()) {
+      std::string dispatch = signal["dispatch"].GetString();
+      if (dispatch == "thread") {
+        signalThread = true;
+      } else if (dispatch == "inline") {
+        signalThread = false;
+      }
+    }
+    if (signal.HasMember("mergeBatches") && signal["mergeBatches"].IsBool()) {
+      signalMergeBatches = signal["mergeBatches"].GetBool();
+    }
+  }
+  auto statementIt = data.FindMember("statement");
+  if (statementIt != data.MemberEnd() && statementIt->value.IsObject()) {
+    const rapidjson::Value &statement = statementIt->value;
+    if (statement.HasMember("year") && statement["year"].IsInt()) {
+      statementOptions.defaultYear = statement["year"].GetInt();
+    }
+    if (statement.HasMember("monthFirst") &&
+        statement["monthFirst"].IsBool()) {
+      statementOptions.monthFirst = statement["monthFirst"].GetBool();
+    }
+  }
+  auto skipIt = data.FindMember("skip");
+  if (skipIt != data.MemberEnd() && skipIt->value.IsObject()) {
+    const rapidjson::Value &skip = skipIt->value;
+    if (skip.HasMember("blank") && skip["blank"].IsBool()) {
+      pageSkip.skipBlank = skip["blank"].GetBool();
+    }
+    if (skip.HasMember("duplicate") && skip["duplicate"].IsBool()) {
+      pageSkip.skipDuplicate = skip["duplicate"].GetBool();
+    }
+    if (skip.HasMember("inkThreshold") && skip["inkThreshold"].IsUint()) {
+      pageSkip.inkThreshold = skip["inkThreshold"].GetUint();
+    }
+    if (skip.HasMember("blankInkRatio") && skip["blankInkRatio"].IsNumber()) {
+      pageSkip.blankInkRatio = skip["blankInkRatio"].GetDouble();
+    }
+    if (skip.HasMember("duplicateDistance") &&
+        skip["duplicateDistance"].IsNumber()) {
+      pageSkip.duplicateDistance = skip["duplicateDistance"].GetDouble();
+    }
+    if (skip.HasMember("duplicateBitDistance") &&
+        skip["duplicateBitDistance"].IsNumber()) {
+      pageSkip.duplicateBitDistance = skip["duplicateBitDistance"].GetDouble();
+    }
+    if (skip.HasMember("margin") && skip["margin"].IsNumber()) {
+      pageSkip.margin = skip["margin"].GetDouble();
+    }
+  }
+  auto payeeIt = data.FindMember("payee");
+  if (payeeIt != data.MemberEnd() && payeeIt->value.IsObject()) {
+    const rapidjson::Value &payee = payeeIt->value;
+    if (payee.HasMember("maxErrorRate") && payee["maxErrorRate"].IsNumber()) {
+      payeeMatch.maxErrorRate = payee["maxErrorRate"].GetDouble();
+    }
+    if (payee.HasMember("candidates") && payee["candidates"].IsUint()) {
+      payeeMatch.candidates = payee["candidates"].GetUint();
+    }
+    if (payee.HasMember("minSymbols") && payee["minSymbols"].IsUint()) {
+      payeeMatch.minSymbols = payee["minSymbols"].GetUint();
+    }
+    if (payee.HasMember("minConfidence") &&
+        payee["minConfidence"].IsNumber()) {
+      payeeMatch.minConfidence = payee["minConfidence"].GetDouble();
+    }
+    if (payee.HasMember("minMargin") && payee["minMargin"].IsUint()) {
+      payeeMatch.minMargin = payee["minMargin"].GetUint();
+    }
+  }
+}
+
+std::string RecognizeSettings::getOcrKey() const {
+  std::string key = ocrMode + '\n' + ocrType + '\n' + ocrDataPath;
+  for (const std::string &language : ocrLanguage) {
+    key += '\n' + language;
+  }
+  return key;
+}
+
+std::string RecognizeSettings::getPageSkipKey() const {
+  if (!pageSkip.skipBlank && !pageSkip.skipDuplicate) {
+    return "";
+  }
+  std::string key = "skip";
+  key += pageSkip.skipBlank ? " blank" : "";
+  key += pageSkip.skipDuplicate ? " duplicate" : "";
+  for (double value :
+       {static_cast<double>(pageSkip.inkThreshold), pageSkip.blankInkRatio,
+        pageSkip.duplicateDistance, pageSkip.duplicateBitDistance,
+        pageSkip.margin}) {
+    key += ' ' + std::to_string(value);
+  }
+  return key;
+}
+
+} // namespace bookfiler
@@ -0,0 +1,155 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_SETTINGS_H
+#define BOOKFILER_MODULE_RECOGNIZE_SETTINGS_H
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <string>
+#include <vector>
+
+/* rapidjson v1.1 (2016-8-25)
+ * Developed by Tencent
+ * License: MITs
+ */
+#include <rapidjson/document.h>
+
+// Local Project
+#include "../Interface.hpp"
+#include "documentExtractor.hpp"
+#include "pageFingerprint.hpp"
+#include "payeeMatcher.hpp"
+#include "statementFields.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+/* Settings shared by the module and every model.
+ * A settings object is never changed after it is handed out. setSettings
+ * makes a new copy and the models swap their pointer to it.
+ */
+class RecognizeSettings {
+public:
+  // OCR engine configuration, also part of the cache key
+  std::string ocrMode;
+  std::string ocrType;
+  std::vector<std::string> ocrLanguage = {"eng"};
+  std::string ocrDataPath;
+  // extractor of the recognized pages, read from ocrType
+  DocumentType documentType = DocumentType::bankStatement;
+  /* configured engines kept between pages, see OcrEnginePool
+   * idle engines per configuration, seconds before an idle engine is freed
+   * and engines created when the OCR module is set
+   */
+  unsigned int ocrPoolMaxIdle = 16;
+  unsigned int ocrPoolIdleSeconds = 300;
+  unsigned int ocrWarmEngines = 1;
+  /* wait for an engine to call back, the page fails and the engine is
+   * dropped past it, 0 waits forever
+   */
+  unsigned int ocrTimeoutMs = 120000;
+  /* persistent recognition cache, off unless asked for as the pages hold
+   * account numbers and amounts. cachePath is in the cache directory of
+   * the user.
+   */
+  bool cacheEnabled = false;
+  std::string cachePath;
+  unsigned long long cacheMaxBytes = 256ULL * 1024 * 1024;
+  /* pixel buffer pool, see PixmapPool
+   * released buffers kept for reuse, and the bytes handed out before
+   * newPixmap waits up to budgetWaitMs, 0 for no budget
+   */
+  unsigned long long pixmapCacheMaxBytes = 256ULL * 1024 * 1024;
+  unsigned long long pixmapBudgetBytes = 0;
+  unsigned int pixmapBudgetWaitMs = 1000;
+  /* directory walk of addPaths, threads listing directories, and the
+   * manifest of files recognized before kept with the cache
+   */
+  unsigned int crawlThreads = 4;
+  bool crawlManifest = false;
+  /* word index of every recognized page, see WordIndex
+   * kept with the cache, the words in memory are merged into it every
+   * flushWords words
+   */
+  bool indexEnabled = false;
+  unsigned long long indexFlushWords = 1ULL << 20;
+  /* recognized pages kept by each model, 0 for no limit
+   * Over it the images of the least recently used files are dropped, then
+   * their words, which come back from the cache when asked for.
+   */
+  unsigned long long modelMaxBytes = 512ULL * 1024 * 1024;
+  /* shared by the models of the module, see RecognizeScheduler
+   * jobs running at once, 0 for one per worker thread, pages in the OCR
+   * engines at once and bytes kept by every model together, 0 for no cap
+   */
+  unsigned int schedulerMaxJobs = 0;
+  unsigned int schedulerMaxOcrJobs = 0;
+  unsigned long long schedulerMaxBytes = 0;
+  /* Trace printed to std::cout by the blocks compiled in config.hpp
+   * 0 off, 1 errors, 2 files and pages, 3 hOCR text
+   */
+  unsigned int debugLevel = 0;
+  // per stage timers and histograms, see RecognizeModel::getMetrics
+  bool metricsEnabled = true;
+  // block closing each wordBatchUpdateSignal batch, "line", "par" or "page"
+  HocrEvent streamLevel = HocrEvent::lineEnd;
+  /* signals emitted on a dispatch thread of the model, "thread", or on the
+   * recognizing thread, "inline", and word batches of a page queued together
+   * merged into one, see SignalDispatcher
+   */
+  bool signalThread = true;
+  bool signalMergeBatches = true;
+  // how the statement dates are written, 0 takes the year of the page
+  StatementFieldOptions statementOptions;
+  // blank and duplicate pages left out of the OCR
+  PageSkipOptions pageSkip;
+  // statement descriptions matched to the payee catalog, see PayeeMatcher
+  PayeeMatchOptions payeeMatch;
+
+  RecognizeSettings();
+  /* @brief Read the members present in data, the rest keep their value
+   * {
+   *   "ocr": {"mode": "", "type": "", "language": ["eng"], "dataPath": "",
+   *           "poolMaxIdle": 16, "poolIdleSeconds": 300, "warmEngines": 1,
+   *           "timeoutMs": 120000},
+   *   "cache": {"enabled": false, "path": "", "maxBytes": 268435456},
+   *   "pixmap": {"cacheMaxBytes": 268435456, "budgetBytes": 0,
+   *              "budgetWaitMs": 1000},
+   *   "crawl": {"threads": 4, "manifest": false},
+   *   "index": {"enabled": false, "flushWords": 1048576},
+   *   "model": {"maxBytes": 536870912},
+   *   "scheduler": {"maxJobs": 0, "maxOcrJobs": 0, "maxBytes": 0},
+   *   "debug": {"level": 0, "metrics": true},
+   *   "stream": {"level": "line"},
+   *   "signal": {"dispatch": "thread", "mergeBatches": true},
+   *   "statement": {"year": 0, "monthFirst": true},
+   *   "skip": {"blank": true, "duplicate": false, "inkThreshold": 128,
+   *            "blankInkRatio": 0.001, "duplicateDistance": 0.1,
+   *            "duplicateBitDistance": 0.25, "margin": 0.03},
+   *   "payee": {"maxErrorRate": 0.25, "candidates": 32, "minSymbols": 4,
+   *             "minConfidence": 0.85, "minMargin": 2}
+   * }
+   */
+  void load(const rapidjson::Value &data);
+  // @return the OCR configuration as one string
+  std::string getOcrKey() const;
+  /* @return the page skip options as one string, empty if no page is
+   * skipped, part of the cache key as a skipped page is stored as such
+   */
+  std::string getPageSkipKey() const;
+};
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_SETTINGS_H
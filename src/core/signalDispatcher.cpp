@@ -0,0 +1,264 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <string>
+#include <unordered_set>
+
+// Local Project
+#include "signalDispatcher.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+SignalDispatcher::SignalDispatcher(RecognizeModel &model,
+                                   RecognizeMetrics &metrics)
+    : delivery(std::make_shared<Delivery>(&model, &metrics)), queued(0),
+      threaded(true), mergeBatches(true), waiting(false), stopFlag(false) {
+  thread = std::thread(&SignalDispatcher::run, this);
+}
+
+SignalDispatcher::~SignalDispatcher() {
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    stopFlag = true;
+    wakeCondition.notify_one();
+  }
+  thread.join();
+  // waits for a job of the executor delivering right now
+  std::lock_guard<std::mutex> lock(delivery->mutex);
+  delivery->model = nullptr;
+  delivery->metrics = nullptr;
+}
+
+void SignalDispatcher::configure(bool threaded_, bool mergeBatches_) {
+  threaded = threaded_;
+  mergeBatches = mergeBatches_;
+}
+
+void SignalDispatcher::setExecutor(Executor executor_) {
+  std::lock_guard<std::mutex> lock(executorMutex);
+  executor = executor_;
+}
+
+void SignalDispatcher::postImage(std::shared_ptr<Pixmap> pixmap,
+                                 const std::string &filePath,
+                                 unsigned int pageNum) {
+  SignalEvent event;
+  event.type = SignalType::image;
+  event.pixmap = pixmap;
+  event.filePath = filePath;
+  event.pageNum = pageNum;
+  post(std::move(event));
+}
+
+void SignalDispatcher::postWordTable(std::shared_ptr<HocrWordTable> wordTable,
+                                     const std::string &filePath,
+                                     bool streamed) {
+  SignalEvent event;
+  event.type = SignalType::wordTable;
+  event.wordTable = wordTable;
+  event.filePath = filePath;
+  event.streamed = streamed;
+  post(std::move(event));
+}
+
+void SignalDispatcher::postWordBatch(std::shared_ptr<HocrWordBatch> batch) {
+  SignalEvent event;
+  event.type = SignalType::wordBatch;
+  event.batch = batch;
+  post(std::move(event));
+}
+
+void SignalDispatcher::post(SignalEvent event) {
+  queued.fetch_add(1, std::memory_order_relaxed);
+  RecognizeMetrics &metrics = *delivery->metrics;
+  if (metrics.isEnabled()) {
+    metrics.signalsQueued.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (!threaded) {
+    std::vector<SignalEvent> eventList;
+    eventList.push_back(std::move(event));
+    deliver(*delivery, eventList, 1);
+    return;
+  }
+  if (metrics.isEnabled()) {
+    event.queuedAt = std::chrono::steady_clock::now();
+  }
+  queue.push(std::move(event));
+  // pairs with the fence in run, one of the two sees the other
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiting.load(std::memory_order_relaxed)) {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    wakeCondition.notify_one();
+  }
+}
+
+void SignalDispatcher::run() {
+  std::vector<SignalEvent> eventList;
+  while (true) {
+    SignalEvent event;
+    while (queue.pop(event)) {
+      eventList.push_back(std::move(event));
+    }
+    if (!eventList.empty()) {
+      std::size_t eventCount = eventList.size();
+      compact(eventList);
+      Executor executorCopy;
+      {
+        std::lock_guard<std::mutex> lock(executorMutex);
+        executorCopy = executor;
+      }
+      if (executorCopy) {
+        std::shared_ptr<Delivery> deliveryCopy = delivery;
+        std::shared_ptr<std::vector<SignalEvent>> job =
+            std::make_shared<std::vector<SignalEvent>>(std::move(eventList));
+        executorCopy([deliveryCopy, job, eventCount]() {
+          std::lock_guard<std::mutex> lock(deliveryCopy->mutex);
+          if (deliveryCopy->model) {
+            deliver(*deliveryCopy, *job, eventCount);
+          }
+        });
+      } else {
+        deliver(*delivery, eventList, eventCount);
+      }
+      eventList.clear();
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    waiting.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    wakeCondition.wait(lock, [this] { return stopFlag || !queue.empty(); });
+    waiting.store(false, std::memory_order_relaxed);
+    if (stopFlag && queue.empty()) {
+      break;
+    }
+  }
+}
+
+void SignalDispatcher::compact(std::vector<SignalEvent> &eventList) {
+  // images of a page posted again later in the run, walking back
+  std::vector<bool> superseded(eventList.size(), false);
+  std::unordered_set<std::string> imageSet;
+  std::string imageKey;
+  for (std::size_t i = eventList.size(); i-- > 0;) {
+    const SignalEvent &event = eventList[i];
+    if (event.type == SignalType::image) {
+      imageKey = event.filePath;
+      imageKey += '\n';
+      imageKey += std::to_string(event.pageNum);
+      superseded[i] = !imageSet.insert(imageKey).second;
+    }
+  }
+  bool merge = mergeBatches.load(std::memory_order_relaxed);
+  unsigned long long coalesced = 0, merged = 0;
+  std::size_t kept = 0;
+  for (std::size_t i = 0; i < eventList.size(); i++) {
+    SignalEvent &event = eventList[i];
+    if (superseded[i]) {
+      coalesced++;
+      continue;
+    }
+    if (merge && event.type == SignalType::wordBatch && kept > 0) {
+      SignalEvent &previous = eventList[kept - 1];
+      if (previous.type == SignalType::wordBatch &&
+          previous.batch->pageNum == event.batch->pageNum &&
+          previous.batch->filePath == event.batch->filePath) {
+        // a new batch, the slots may still hold the queued ones
+        if (!previous.batchCopied) {
+          std::shared_ptr<HocrWordBatch> batch =
+              std::make_shared<HocrWordBatch>(*previous.batch);
+          batch->wordList =
+              std::make_shared<std::vector<std::shared_ptr<HocrWord>>>(
+                  *previous.batch->wordList);
+          previous.batch = batch;
+          previous.batchCopied = true;
+        }
+        previous.batch->wordList->insert(previous.batch->wordList->end(),
+                                         event.batch->wordList->begin(),
+                                         event.batch->wordList->end());
+        previous.batch->event = event.batch->event;
+        previous.batch->endOfDocument = event.batch->endOfDocument;
+        merged++;
+        continue;
+      }
+    }
+    if (kept != i) {
+      eventList[kept] = std::move(event);
+    }
+    kept++;
+  }
+  eventList.resize(kept);
+  RecognizeMetrics &metrics = *delivery->metrics;
+  if (metrics.isEnabled()) {
+    metrics.signalsCoalesced.fetch_add(coalesced, std::memory_order_relaxed);
+    metrics.signalsMerged.fetch_add(merged, std::memory_order_relaxed);
+  }
+}
+
+void SignalDispatcher::deliver(Delivery &delivery,
+                               std::vector<SignalEvent> &eventList,
+                               std::size_t eventCount) {
+  RecognizeModel &model = *delivery.model;
+  RecognizeMetrics &metrics = *delivery.metrics;
+  for (SignalEvent &event : eventList) {
+    if (metrics.isEnabled() && event.queuedAt.time_since_epoch().count() > 0) {
+      metrics.signalQueueLatency.record(static_cast<std::uint64_t>(
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - event.queuedAt)
+              .count()));
+    }
+    MetricTimer timer(metrics, MetricStage::signalDispatch);
+    switch (event.type) {
+    case SignalType::image:
+      model.imageUpdateSignal(event.pixmap);
+      break;
+    case SignalType::wordTable:
+      model.wordTableUpdateSignal(event.wordTable);
+      if (!model.textUpdateSignal.empty()) {
+        model.textUpdateSignal(event.wordTable->toHocrWordList());
+      }
+      // the page was not parsed block by block, send it as its only batch
+      if (!event.streamed && !model.wordBatchUpdateSignal.empty()) {
+        std::shared_ptr<HocrWordBatch> batch =
+            std::make_shared<HocrWordBatch>();
+        batch->filePath = event.filePath;
+        batch->pageNum = event.wordTable->pageNum;
+        batch->endOfDocument = true;
+        batch->wordList = event.wordTable->toHocrWordList();
+        model.wordBatchUpdateSignal(batch);
+      }
+      break;
+    case SignalType::wordBatch:
+      model.wordBatchUpdateSignal(event.batch);
+      break;
+    }
+  }
+  if (metrics.isEnabled()) {
+    metrics.signalsDelivered.fetch_add(eventList.size(),
+                                       std::memory_order_relaxed);
+  }
+  delivery.delivered.fetch_add(eventCount, std::memory_order_release);
+  std::lock_guard<std::mutex> lock(delivery.flushMutex);
+  delivery.flushCondition.notify_all();
+}
+
+void SignalDispatcher::flush() {
+  unsigned long long target = queued.load(std::memory_order_relaxed);
+  std::unique_lock<std::mutex> lock(delivery->flushMutex);
+  delivery->flushCondition.wait(lock, [this, target] {
+    return delivery->delivered.load(std::memory_order_acquire) >= target;
+  });
+}
+
+} // namespace bookfiler
@@ -0,0 +1,129 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_SIGNAL_DISPATCHER_H
+#define BOOKFILER_MODULE_RECOGNIZE_SIGNAL_DISPATCHER_H
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Local Project
+#include "../Interface.hpp"
+#include "mpscQueue.hpp"
+#include "recognizeMetrics.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+enum class SignalType : unsigned int { image = 0, wordTable, wordBatch };
+
+/* One emit of a model signal waiting to be delivered
+ */
+class SignalEvent {
+public:
+  SignalType type = SignalType::image;
+  std::shared_ptr<Pixmap> pixmap;
+  std::shared_ptr<HocrWordTable> wordTable;
+  // file of pixmap or wordTable, and whether its batches were already sent
+  std::string filePath;
+  // page of pixmap
+  unsigned int pageNum = 0;
+  bool streamed = false;
+  std::shared_ptr<HocrWordBatch> batch;
+  // batch is a copy made by the dispatcher to merge the next ones into
+  bool batchCopied = false;
+  // zero when the metrics are off
+  std::chrono::steady_clock::time_point queuedAt;
+};
+
+/* Emits the signals of a model away from the threads recognizing
+ * The recognition threads push events on a lock-free queue and go on. One
+ * dispatch thread takes everything queued at once and delivers it in order,
+ * itself or through the executor the host set, so a slow slot only delays
+ * the signals behind it.
+ * From each run taken off the queue, an image update followed by a later
+ * one of the same page of the same file is dropped and consecutive word
+ * batches of the same page are merged into one. The word tables are always
+ * delivered.
+ */
+class SignalDispatcher {
+public:
+  // runs the job on a thread of the host, the UI thread for example
+  using Executor = std::function<void(std::function<void()>)>;
+
+private:
+  /* what the delivery needs, shared with the jobs handed to the executor
+   * so a job that runs after the model is gone does nothing
+   */
+  class Delivery {
+  public:
+    std::mutex mutex;
+    RecognizeModel *model;
+    RecognizeMetrics *metrics;
+    std::atomic<unsigned long long> delivered;
+    std::mutex flushMutex;
+    std::condition_variable flushCondition;
+    Delivery(RecognizeModel *model_, RecognizeMetrics *metrics_)
+        : model(model_), metrics(metrics_), delivered(0){};
+  };
+  std::shared_ptr<Delivery> delivery;
+  MpscQueue<SignalEvent> queue;
+  std::atomic<unsigned long long> queued;
+  std::atomic<bool> threaded, mergeBatches, waiting;
+  std::mutex sleepMutex;
+  std::condition_variable wakeCondition;
+  bool stopFlag;
+  std::mutex executorMutex;
+  Executor executor;
+  std::thread thread;
+
+  void run();
+  void post(SignalEvent event);
+  // drops the superseded images and merges the batches
+  void compact(std::vector<SignalEvent> &eventList);
+  static void deliver(Delivery &delivery, std::vector<SignalEvent> &eventList,
+                      std::size_t eventCount);
+
+public:
+  SignalDispatcher(RecognizeModel &model, RecognizeMetrics &metrics);
+  // delivers what is still queued, the executor jobs not run yet are dropped
+  ~SignalDispatcher();
+  /* @param threaded_ false emits on the calling thread as soon as posted
+   * @param mergeBatches_ merge the word batches of a page queued together
+   */
+  void configure(bool threaded_, bool mergeBatches_);
+  // null delivers on the dispatch thread
+  void setExecutor(Executor executor_);
+  void postImage(std::shared_ptr<Pixmap> pixmap, const std::string &filePath,
+                 unsigned int pageNum);
+  void postWordTable(std::shared_ptr<HocrWordTable> wordTable,
+                     const std::string &filePath, bool streamed);
+  void postWordBatch(std::shared_ptr<HocrWordBatch> batch);
+  /* @brief Wait until everything posted before the call is delivered
+   * Not from a slot or from the thread of the executor.
+   */
+  void flush();
+};
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_SIGNAL_DISPATCHER_H
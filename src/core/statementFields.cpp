@@ -0,0 +1,652 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+// c++17
+#include <algorithm>
+#include <array>
+
+// Local Project
+#include "statementFields.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+namespace {
+
+enum CharClass : unsigned char {
+  otherChar = 0,
+  digitChar,
+  // a letter the OCR confuses with a digit, O for 0 and l for 1
+  confusableChar,
+  // "." or ",", decimal or thousands
+  pointChar,
+  // "'" thousands only
+  groupChar,
+  spaceChar,
+  openChar,
+  closeChar,
+  minusChar,
+  plusChar,
+  currencyChar,
+  // "/" between the parts of a date
+  slashChar,
+  letterChar,
+  // first byte of a UTF-8 sequence, checked for a currency sign
+  highChar
+};
+
+// what may surround the number of an amount, bits of CharTable::affix
+enum AffixFlag : unsigned char {
+  // space, plus or "$"
+  skipAffix = 1,
+  openAffix = 2,
+  closeAffix = 4,
+  minusAffix = 8,
+  // a byte of a UTF-8 currency sign, or the R of CR and DR
+  checkAffix = 16
+};
+const unsigned char prefixAffix = skipAffix | openAffix | minusAffix |
+                                  checkAffix,
+                    suffixAffix = skipAffix | closeAffix | minusAffix |
+                                  checkAffix;
+
+/* Class, digit value and amount affix of every byte
+ */
+class CharTable {
+public:
+  std::array<unsigned char, 256> charClass{}, digit{}, lower{}, affix{};
+
+  CharTable() {
+    for (unsigned int c = 0; c < 256; c++) {
+      lower[c] = static_cast<unsigned char>(
+          (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c);
+      if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+        charClass[c] = letterChar;
+      } else if (c >= 0x80) {
+        charClass[c] = highChar;
+      }
+    }
+    for (unsigned int c = '0'; c <= '9'; c++) {
+      charClass[c] = digitChar;
+      digit[c] = static_cast<unsigned char>(c - '0');
+    }
+    const char *confusableList[10] = {"Oo", "lI|", "Z", "", "",
+                                      "",   "",    "",  "B", ""};
+    for (unsigned int d = 0; d < 10; d++) {
+      for (const char *c = confusableList[d]; *c; c++) {
+        charClass[static_cast<unsigned char>(*c)] = confusableChar;
+        digit[static_cast<unsigned char>(*c)] = static_cast<unsigned char>(d);
+      }
+    }
+    charClass['.'] = pointChar;
+    charClass[','] = pointChar;
+    charClass['\''] = groupChar;
+    charClass[' '] = spaceChar;
+    charClass['\t'] = spaceChar;
+    charClass['\n'] = spaceChar;
+    charClass['\r'] = spaceChar;
+    charClass['('] = openChar;
+    charClass[')'] = closeChar;
+    charClass['-'] = minusChar;
+    charClass['+'] = plusChar;
+    charClass['$'] = currencyChar;
+    charClass['/'] = slashChar;
+    for (unsigned int c = 0; c < 256; c++) {
+      switch (charClass[c]) {
+      case spaceChar:
+      case plusChar:
+      case currencyChar:
+        affix[c] = skipAffix;
+        break;
+      case openChar:
+        affix[c] = openAffix;
+        break;
+      case closeChar:
+        affix[c] = closeAffix;
+        break;
+      case minusChar:
+        affix[c] = minusAffix;
+        break;
+      case highChar:
+        affix[c] = checkAffix;
+        break;
+      }
+    }
+    affix['r'] = checkAffix;
+    affix['R'] = checkAffix;
+  }
+};
+
+const CharTable charTable;
+
+// each OCR correction and an unusual grouping lower the confidence
+const float substitutionFactor = 0.8f, groupingFactor = 0.7f,
+            minConfidence = 0.3f;
+
+// @return bytes of a UTF-8 currency sign starting at p: € £ ¥
+inline std::size_t currencyPrefix(const unsigned char *p,
+                                  const unsigned char *end) {
+  if (end - p >= 3 && p[0] == 0xE2 && p[1] == 0x82 && p[2] == 0xAC) {
+    return 3;
+  }
+  if (end - p >= 2 && p[0] == 0xC2 && (p[1] == 0xA3 || p[1] == 0xA5)) {
+    return 2;
+  }
+  return 0;
+}
+
+// @return bytes of a UTF-8 currency sign ending right before end
+inline std::size_t currencySuffix(const unsigned char *begin,
+                                  const unsigned char *end) {
+  if (end - begin >= 3 && currencyPrefix(end - 3, end) == 3) {
+    return 3;
+  }
+  if (end - begin >= 2 && currencyPrefix(end - 2, end) == 2) {
+    return 2;
+  }
+  return 0;
+}
+
+const unsigned long long powerList[3] = {1, 10, 100};
+
+/* Parts of a date token
+ */
+class DatePart {
+public:
+  unsigned int value = 0, digits = 0, substitutions = 0;
+  // 1 to 12 for a month name, 0 for a number
+  unsigned int month = 0;
+};
+
+const char *const monthNameList[12] = {
+    "january", "february", "march",     "april",   "may",      "june",
+    "july",    "august",   "september", "october", "november", "december"};
+
+/* Month of the first three letters of its name, packed in an integer
+ * (2 a + 9 b + c) % 32 puts the twelve abbreviations in different slots,
+ * so a lookup is one load and one compare.
+ */
+class MonthTable {
+public:
+  std::array<unsigned int, 32> key{};
+  std::array<unsigned char, 32> month{};
+
+  static unsigned int getSlot(unsigned int a, unsigned int b,
+                              unsigned int c) {
+    return (2 * a + 9 * b + c) & 31;
+  }
+
+  MonthTable() {
+    for (unsigned int m = 0; m < 12; m++) {
+      const char *name = monthNameList[m];
+      unsigned int slot = getSlot(name[0], name[1], name[2]);
+      key[slot] = (name[0] << 16) | (name[1] << 8) | name[2];
+      month[slot] = static_cast<unsigned char>(m + 1);
+    }
+  }
+};
+
+const MonthTable monthTable;
+
+/* @return month of a lower case name, "jan", "sept" or "january", 0 if the
+ * letters are no month
+ */
+unsigned int getMonth(const unsigned char *p, std::size_t size) {
+  if (size < 3) {
+    return 0;
+  }
+  unsigned int a = charTable.lower[p[0]], b = charTable.lower[p[1]],
+               c = charTable.lower[p[2]];
+  unsigned int slot = MonthTable::getSlot(a, b, c);
+  unsigned int month = monthTable.month[slot];
+  if (!month || monthTable.key[slot] != ((a << 16) | (b << 8) | c)) {
+    return 0;
+  }
+  if (size == 3 || (month == 9 && size == 4 && charTable.lower[p[3]] == 't')) {
+    return month;
+  }
+  const char *name = monthNameList[month - 1];
+  for (std::size_t i = 0; i < size; i++) {
+    if (!name[i] || charTable.lower[p[i]] != name[i]) {
+      return 0;
+    }
+  }
+  return name[size] ? 0 : month;
+}
+
+bool isLeapYear(int year) {
+  return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+unsigned int getMonthDays(int year, unsigned int month) {
+  static const unsigned int dayList[12] = {31, 28, 31, 30, 31, 30,
+                                           31, 31, 30, 31, 30, 31};
+  return month == 2 && isLeapYear(year) ? 29 : dayList[month - 1];
+}
+
+/* A date before the year of the column is known
+ * year 0 is a date written without one
+ */
+class DateFields {
+public:
+  int year = 0;
+  unsigned int month = 0, day = 0;
+  float confidence = 0;
+};
+
+DateFields parseDateToken(std::string_view token, bool monthFirst) {
+  DateFields fields;
+  const unsigned char *p =
+      reinterpret_cast<const unsigned char *>(token.data());
+  const unsigned char *end = p + token.size();
+  DatePart partList[3];
+  unsigned int partCount = 0;
+  // separator between the numbers, '/' '-' or '.'
+  unsigned char separator = 0;
+  while (p < end) {
+    unsigned char cls = charTable.charClass[*p];
+    bool numeric = cls == digitChar || cls == confusableChar;
+    // "Oct" starts with a letter read as a digit
+    if (cls == letterChar ||
+        (cls == confusableChar && p + 1 < end &&
+         charTable.charClass[p[1]] == letterChar)) {
+      if (partCount == 3) {
+        return fields;
+      }
+      const unsigned char *runBegin = p;
+      while (p < end && (charTable.charClass[*p] == letterChar ||
+                         charTable.charClass[*p] == confusableChar)) {
+        p++;
+      }
+      DatePart &part = partList[partCount++];
+      part.month = getMonth(runBegin, p - runBegin);
+      if (!part.month) {
+        return fields;
+      }
+    } else if (numeric) {
+      if (partCount == 3) {
+        return fields;
+      }
+      DatePart &part = partList[partCount++];
+      const unsigned char *runBegin = p;
+      unsigned int realDigits = 0;
+      do {
+        part.value = part.value * 10 + charTable.digit[*p];
+        realDigits += cls == digitChar;
+        if (++p == end) {
+          break;
+        }
+        cls = charTable.charClass[*p];
+      } while (cls == digitChar || cls == confusableChar);
+      part.digits = static_cast<unsigned int>(p - runBegin);
+      part.substitutions = part.digits - realDigits;
+      if (realDigits == 0 || part.digits > 4) {
+        return fields;
+      }
+      // ordinal suffix, "15th"
+      if (p < end && cls == letterChar) {
+        if (end - p < 2 || (end - p > 2 &&
+                            charTable.charClass[p[2]] == letterChar)) {
+          return fields;
+        }
+        unsigned int suffix =
+            (charTable.lower[p[0]] << 8) | charTable.lower[p[1]];
+        if (suffix != (('s' << 8) | 't') && suffix != (('n' << 8) | 'd') &&
+            suffix != (('r' << 8) | 'd') && suffix != (('t' << 8) | 'h')) {
+          return fields;
+        }
+        p += 2;
+      }
+    } else if (cls == slashChar || cls == minusChar || *p == '.') {
+      // "Jan. 15" abbreviates the month, the rest separate numbers
+      bool afterMonth = partCount > 0 && partList[partCount - 1].month;
+      if (partCount == 0 || (!afterMonth && separator && separator != *p)) {
+        return fields;
+      }
+      if (!afterMonth) {
+        separator = *p;
+      }
+      p++;
+    } else if (cls == spaceChar || *p == ',') {
+      p++;
+    } else {
+      return fields;
+    }
+  }
+  if (partCount < 2) {
+    return fields;
+  }
+  float confidence = 1.0f;
+  const DatePart *yearPart = nullptr;
+  unsigned int month = 0, day = 0;
+  int monthIndex = -1;
+  for (unsigned int i = 0; i < partCount; i++) {
+    if (partList[i].month) {
+      if (monthIndex >= 0) {
+        return fields;
+      }
+      monthIndex = static_cast<int>(i);
+    }
+    for (unsigned int s = 0; s < partList[i].substitutions; s++) {
+      confidence *= substitutionFactor;
+    }
+  }
+  if (monthIndex >= 0) {
+    // "Jan 15 2020", "15 Jan 2020", the day is the first number
+    month = partList[monthIndex].month;
+    const DatePart *dayPart = nullptr;
+    for (unsigned int i = 0; i < partCount; i++) {
+      if (static_cast<int>(i) == monthIndex) {
+        continue;
+      }
+      if (!dayPart && partList[i].digits <= 2) {
+        dayPart = &partList[i];
+      } else if (!yearPart) {
+        yearPart = &partList[i];
+      } else {
+        return fields;
+      }
+    }
+    if (!dayPart) {
+      return fields;
+    }
+    day = dayPart->value;
+  } else if (partList[0].digits == 4) {
+    // year first, 2020-01-15
+    if (partCount != 3 || partList[1].digits > 2 || partList[2].digits > 2) {
+      return fields;
+    }
+    yearPart = &partList[0];
+    month = partList[1].value;
+    day = partList[2].value;
+  } else {
+    if (partList[0].digits > 2 || partList[1].digits > 2) {
+      return fields;
+    }
+    unsigned int a = partList[0].value, b = partList[1].value;
+    bool dayFirst;
+    if (separator == '.') {
+      dayFirst = true;
+    } else if (a > 12) {
+      dayFirst = true;
+    } else if (b > 12) {
+      dayFirst = false;
+    } else {
+      dayFirst = !monthFirst;
+      if (a != b) {
+        confidence *= 0.9f;
+      }
+    }
+    month = dayFirst ? b : a;
+    day = dayFirst ? a : b;
+    if (partCount == 3) {
+      yearPart = &partList[2];
+    }
+  }
+  if (yearPart) {
+    if (yearPart->digits == 4) {
+      fields.year = static_cast<int>(yearPart->value);
+    } else if (yearPart->digits == 2) {
+      fields.year = static_cast<int>(yearPart->value) +
+                    (yearPart->value < 70 ? 2000 : 1900);
+    } else {
+      return fields;
+    }
+  } else {
+    confidence *= 0.9f;
+  }
+  // a date without a year is checked against a leap year
+  if (month < 1 || month > 12 || day < 1 ||
+      day > getMonthDays(fields.year ? fields.year : 2000, month)) {
+    return fields;
+  }
+  fields.month = month;
+  fields.day = day;
+  fields.confidence = confidence < minConfidence ? 0 : confidence;
+  return fields;
+}
+
+} // namespace
+
+float parseAmountToken(std::string_view token, unsigned long long &value,
+                       bool &negative) {
+  value = 0;
+  negative = false;
+  const unsigned char *begin =
+      reinterpret_cast<const unsigned char *>(token.data());
+  const unsigned char *end = begin + token.size();
+  /* One table pass from each end over the signs, parentheses, currency,
+   * spaces and a CR or DR around the number
+   */
+  unsigned char prefix = 0, suffix = 0, flag;
+  while (begin < end && (flag = charTable.affix[*begin] & prefixAffix)) {
+    if (flag == checkAffix) {
+      std::size_t bytes = currencyPrefix(begin, end);
+      if (bytes == 0) {
+        break;
+      }
+      begin += bytes;
+      continue;
+    }
+    prefix |= flag;
+    begin++;
+  }
+  while (end > begin && (flag = charTable.affix[end[-1]] & suffixAffix)) {
+    if (flag == checkAffix) {
+      std::size_t bytes = currencySuffix(begin, end);
+      if (bytes == 0 && end - begin > 2) {
+        // "CR" credit, "DR" debit
+        unsigned char c = charTable.lower[end[-2]];
+        if (c == 'c' || c == 'd') {
+          negative = negative || c == 'd';
+          bytes = 2;
+        }
+      }
+      if (bytes == 0) {
+        break;
+      }
+      end -= bytes;
+      continue;
+    }
+    suffix |= flag;
+    end--;
+  }
+  bool open = prefix & openAffix, close = suffix & closeAffix;
+  negative = negative || ((prefix | suffix) & minusAffix);
+  if (open != close) {
+    return 0;
+  }
+  negative = negative || open;
+  /* Digits and separators
+   * sepPos is the digit count when a separator was seen, so the digits of
+   * each group are the difference of two positions.
+   */
+  unsigned long long digits = 0, lastSepDigits = 0;
+  unsigned int digitCount = 0, realDigits = 0, substitutions = 0;
+  unsigned int sepCount = 0, firstSepPos = 0, lastSepPos = 0;
+  unsigned int pointCount[2] = {0, 0};
+  unsigned char lastSep = 0;
+  bool badGroup = false;
+  const unsigned char *p = begin;
+  while (p < end) {
+    unsigned char cls = charTable.charClass[*p];
+    if (cls == digitChar || cls == confusableChar) {
+      const unsigned char *runBegin = p;
+      do {
+        digits = digits * 10 + charTable.digit[*p];
+        realDigits += cls == digitChar;
+        if (++p == end) {
+          break;
+        }
+        cls = charTable.charClass[*p];
+      } while (cls == digitChar || cls == confusableChar);
+      digitCount += static_cast<unsigned int>(p - runBegin);
+      if (digitCount > 18) {
+        return 0;
+      }
+    } else if (cls == pointChar || cls == groupChar || cls == spaceChar) {
+      if (sepCount > 0) {
+        if (digitCount == lastSepPos) {
+          return 0;
+        }
+        badGroup = badGroup || digitCount - lastSepPos != 3;
+      } else {
+        firstSepPos = digitCount;
+      }
+      sepCount++;
+      lastSep = *p;
+      lastSepPos = digitCount;
+      lastSepDigits = digits;
+      if (cls == pointChar) {
+        pointCount[*p == ',']++;
+      }
+      p++;
+    } else {
+      return 0;
+    }
+  }
+  substitutions = digitCount - realDigits;
+  if (realDigits == 0) {
+    return 0;
+  }
+  unsigned int trailing = digitCount - lastSepPos;
+  unsigned long long whole = digits, cents = 0;
+  bool decimal = sepCount > 0 && charTable.charClass[lastSep] == pointChar &&
+                 trailing <= 2 && pointCount[lastSep == ','] == 1;
+  if (decimal) {
+    // the value at the separator, no division
+    whole = lastSepDigits;
+    cents = (digits - whole * powerList[trailing]) * powerList[2 - trailing];
+    // only the separators before the decimal one group thousands
+    if (sepCount > 1 && (firstSepPos == 0 || firstSepPos > 3)) {
+      badGroup = true;
+    }
+  } else if (sepCount > 0) {
+    badGroup =
+        badGroup || trailing != 3 || firstSepPos == 0 || firstSepPos > 3;
+  }
+  if (whole > 10000000000000000ULL) {
+    return 0;
+  }
+  float confidence = badGroup ? groupingFactor : 1.0f;
+  // "12.345" groups thousands or has a misread decimal
+  if (!decimal && sepCount == 1 && charTable.charClass[lastSep] == pointChar) {
+    confidence *= 0.9f;
+  }
+  for (unsigned int i = 0; i < substitutions; i++) {
+    confidence *= substitutionFactor;
+  }
+  if (confidence < minConfidence) {
+    return 0;
+  }
+  value = whole * 100 + cents;
+  return confidence;
+}
+
+void parseAmountColumn(const std::vector<std::string_view> &tokenList,
+                       StatementAmountColumn &column) {
+  std::size_t count = tokenList.size();
+  column.value.resize(count);
+  column.negative.resize(count);
+  column.confidence.resize(count);
+  for (std::size_t i = 0; i < count; i++) {
+    bool negative;
+    column.confidence[i] =
+        parseAmountToken(tokenList[i], column.value[i], negative);
+    column.negative[i] = negative;
+  }
+}
+
+void parseDateColumn(const std::vector<std::string_view> &tokenList,
+                     const StatementFieldOptions &options,
+                     StatementDateColumn &column) {
+  std::size_t count = tokenList.size();
+  column.day.resize(count);
+  column.confidence.resize(count);
+  /* most common year of the dates that have one
+   * a statement spans a year or two, a few slots are plenty and the
+   * dates past them only miss the count
+   */
+  const unsigned int yearSlots = 8;
+  int yearList[yearSlots] = {0};
+  unsigned int yearCount[yearSlots] = {0};
+  /* a date with a year is a day number at once, one without holds month
+   * and day packed and a negated confidence until the year is known
+   */
+  std::size_t yearMissing = 0;
+  for (std::size_t i = 0; i < count; i++) {
+    DateFields fields = parseDateToken(tokenList[i], options.monthFirst);
+    column.confidence[i] = fields.confidence;
+    if (fields.confidence == 0) {
+      column.day[i] = 0;
+    } else if (fields.year) {
+      column.day[i] = toDayNumber(fields.year, fields.month, fields.day);
+      for (unsigned int slot = 0; slot < yearSlots; slot++) {
+        if (yearList[slot] == fields.year || yearList[slot] == 0) {
+          yearList[slot] = fields.year;
+          yearCount[slot]++;
+          break;
+        }
+      }
+    } else {
+      column.day[i] = static_cast<int>(fields.month << 5 | fields.day);
+      column.confidence[i] = -fields.confidence;
+      yearMissing++;
+    }
+  }
+  if (yearMissing == 0) {
+    return;
+  }
+  int defaultYear = options.defaultYear;
+  if (defaultYear == 0) {
+    defaultYear = 1970;
+    unsigned int bestCount = 0;
+    for (unsigned int slot = 0; slot < yearSlots; slot++) {
+      if (yearCount[slot] > bestCount ||
+          (yearCount[slot] == bestCount && yearList[slot] > defaultYear)) {
+        defaultYear = yearList[slot];
+        bestCount = yearCount[slot];
+      }
+    }
+  }
+  for (std::size_t i = 0; i < count; i++) {
+    if (column.confidence[i] >= 0) {
+      continue;
+    }
+    unsigned int month = (column.day[i] >> 5) & 15, day = column.day[i] & 31;
+    // February 29 was only checked against a leap year
+    if (day <= getMonthDays(defaultYear, month)) {
+      column.day[i] = toDayNumber(defaultYear, month, day);
+      column.confidence[i] = -column.confidence[i];
+    } else {
+      column.day[i] = 0;
+      column.confidence[i] = 0;
+    }
+  }
+}
+
+unsigned int parseMonthName(std::string_view token) {
+  return getMonth(reinterpret_cast<const unsigned char *>(token.data()),
+                  token.size());
+}
+
+int toDayNumber(int year, unsigned int month, unsigned int day) {
+  // days_from_civil, http://howardhinnant.github.io/date_algorithms.html
+  year -= month <= 2;
+  int era = (year >= 0 ? year : year - 399) / 400;
+  unsigned int yearOfEra = static_cast<unsigned int>(year - era * 400);
+  unsigned int dayOfYear =
+      (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  unsigned int dayOfEra =
+      yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+  return era * 146097 + static_cast<int>(dayOfEra) - 719468;
+}
+
+} // namespace bookfiler
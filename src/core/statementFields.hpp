@@ -0,0 +1,94 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_STATEMENT_FIELDS_H
+#define BOOKFILER_MODULE_RECOGNIZE_STATEMENT_FIELDS_H
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <string_view>
+#include <vector>
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+/* How the dates of a statement are written
+ */
+class StatementFieldOptions {
+public:
+  /* year of the dates written without one, "01/15"
+   * 0 takes the year most dates of the column have, 1970 if none has one
+   */
+  int defaultYear = 0;
+  // 01/02/2020 is January 2 when true and February 1 otherwise
+  bool monthFirst = true;
+};
+
+/* Amounts of a column of tokens, one entry per token
+ * confidence is 0 when the token is not an amount, 1 when it was read as
+ * written, and lower for every OCR correction or unusual grouping.
+ */
+class StatementAmountColumn {
+public:
+  // in cents
+  std::vector<unsigned long long> value;
+  // 1 for parentheses, a minus sign or DR
+  std::vector<unsigned char> negative;
+  std::vector<float> confidence;
+};
+
+/* Dates of a column of tokens, one entry per token
+ * day counts from 1970-01-01, confidence is 0 when the token is not a
+ * date and lower when the year is missing or day and month could swap.
+ */
+class StatementDateColumn {
+public:
+  std::vector<int> day;
+  std::vector<float> confidence;
+};
+
+/* @brief Parse one amount like "$1,234.56", "(12.00)", "1.234,56 CR" or
+ * "1O.5O-", the letters O and l read as 0 and 1
+ * The decimal separator is the last "." or "," followed by one or two
+ * digits, every other "." "," "'" or space groups the thousands.
+ * @param value cents
+ * @param negative true for parentheses, a minus sign or DR
+ * @return confidence, 0 if the token is not an amount
+ */
+float parseAmountToken(std::string_view token, unsigned long long &value,
+                       bool &negative);
+/* @brief Parse a column of amount tokens
+ * Walks the tokens with a 256 entry character class table, no allocation
+ * past resizing the column.
+ */
+void parseAmountColumn(const std::vector<std::string_view> &tokenList,
+                       StatementAmountColumn &column);
+/* @brief Parse a column of date tokens
+ * "01/15", "1/15/2020", "2020-01-15", "15.01.20", "Jan 15, 2020" and
+ * "15 January 2020". A "." separated date is day first, a first number
+ * over 12 is a day and a second one over 12 is a day.
+ */
+void parseDateColumn(const std::vector<std::string_view> &tokenList,
+                     const StatementFieldOptions &options,
+                     StatementDateColumn &column);
+/* @brief Month of a name in any case, "Jan", "SEPT" or "january"
+ * One slot table lookup on the first three letters, no string compares.
+ * @return 1 to 12, 0 if the token is no month name
+ */
+unsigned int parseMonthName(std::string_view token);
+// @return days from 1970-01-01 of a proleptic Gregorian date
+int toDayNumber(int year, unsigned int month, unsigned int day);
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_STATEMENT_FIELDS_H
@@ -0,0 +1,906 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+/* boost 1.72.0
+ * License: Boost Software License (similar to BSD and MIT)
+ */
+#include <boost/endian/conversion.hpp>
+#include <boost/filesystem.hpp>
+
+// Local Project
+#include "recognizeCache.hpp"
+#include "statementFields.hpp"
+#include "wordIndex.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+namespace {
+
+const char wordIndexFileMagic[4] = {'B', 'F', 'W', 'I'};
+const unsigned int wordIndexColumnCount =
+    static_cast<unsigned int>(WordIndexColumn::count);
+const std::size_t headerBytes = 4 * sizeof(uint32_t);
+const std::size_t directoryBytes = wordIndexColumnCount * 2 * sizeof(uint64_t);
+const uint32_t deadPageId = UINT32_MAX;
+constexpr bool nativeLittleEndian =
+    boost::endian::order::native == boost::endian::order::little;
+
+std::size_t getEntryBytes(WordIndexColumn column) {
+  switch (column) {
+  case WordIndexColumn::pageHash:
+  case WordIndexColumn::termPostingEnd:
+  case WordIndexColumn::amountValue:
+    return sizeof(uint64_t);
+  case WordIndexColumn::stringArena:
+  case WordIndexColumn::postings:
+    return 1;
+  default:
+    return sizeof(uint32_t);
+  }
+}
+
+std::size_t alignUp(std::size_t offset) {
+  return (offset + 7) & ~std::size_t(7);
+}
+
+void appendVarint(std::string &bytes, uint32_t value) {
+  while (value >= 0x80) {
+    bytes.push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  bytes.push_back(static_cast<char>(value));
+}
+
+bool readVarint(const unsigned char *&cursor, const unsigned char *end,
+                uint32_t &value) {
+  value = 0;
+  for (unsigned int shift = 0; shift < 35; shift += 7) {
+    if (cursor == end) {
+      return false;
+    }
+    unsigned char byte = *cursor++;
+    value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// words of a page with the same words hash the same, wherever they came from
+unsigned long long hashPage(const HocrWordTable &table) {
+  unsigned long long hash = 0;
+  hash = hashBytes(table.x0.data(), table.x0.size() * sizeof(unsigned int),
+                   hash);
+  hash = hashBytes(table.y0.data(), table.y0.size() * sizeof(unsigned int),
+                   hash);
+  hash = hashBytes(table.x1.data(), table.x1.size() * sizeof(unsigned int),
+                   hash);
+  hash = hashBytes(table.y1.data(), table.y1.size() * sizeof(unsigned int),
+                   hash);
+  hash = hashBytes(table.valueIndex.data(),
+                   table.valueIndex.size() * sizeof(unsigned int), hash);
+  hash = hashBytes(table.stringOffset.data(),
+                   table.stringOffset.size() * sizeof(unsigned int), hash);
+  return hashBytes(table.stringArena.data(), table.stringArena.size(), hash);
+}
+
+/* Columns of a segment before they are written
+ */
+class SegmentColumns {
+public:
+  std::vector<uint32_t> docOffset, docLength, pageDoc, pageNum;
+  std::vector<uint64_t> pageHash;
+  std::vector<uint32_t> termOffset, termLength, termWords;
+  std::vector<uint64_t> termPostingEnd, amountValue;
+  std::vector<uint32_t> amountPage, amountX0, amountY0, amountX1, amountY1;
+  std::string stringArena, postings;
+
+  void addString(std::string_view value, std::vector<uint32_t> &offset,
+                 std::vector<uint32_t> &length) {
+    offset.push_back(static_cast<uint32_t>(stringArena.size()));
+    length.push_back(static_cast<uint32_t>(value.size()));
+    stringArena.append(value.data(), value.size());
+  }
+  void addAmount(const WordAmount &amount, uint32_t pageId) {
+    amountValue.push_back(static_cast<uint64_t>(amount.value));
+    amountPage.push_back(pageId);
+    amountX0.push_back(amount.x0);
+    amountY0.push_back(amount.y0);
+    amountX1.push_back(amount.x1);
+    amountY1.push_back(amount.y1);
+  }
+  // pointer and entry count of a column
+  std::pair<const char *, std::size_t> get(WordIndexColumn column) const;
+};
+
+template <typename T>
+std::pair<const char *, std::size_t> columnPair(const std::vector<T> &column) {
+  return {reinterpret_cast<const char *>(column.data()), column.size()};
+}
+
+std::pair<const char *, std::size_t>
+SegmentColumns::get(WordIndexColumn column) const {
+  switch (column) {
+  case WordIndexColumn::docOffset:
+    return columnPair(docOffset);
+  case WordIndexColumn::docLength:
+    return columnPair(docLength);
+  case WordIndexColumn::pageDoc:
+    return columnPair(pageDoc);
+  case WordIndexColumn::pageNum:
+    return columnPair(pageNum);
+  case WordIndexColumn::pageHash:
+    return columnPair(pageHash);
+  case WordIndexColumn::termOffset:
+    return columnPair(termOffset);
+  case WordIndexColumn::termLength:
+    return columnPair(termLength);
+  case WordIndexColumn::termPostingEnd:
+    return columnPair(termPostingEnd);
+  case WordIndexColumn::termWords:
+    return columnPair(termWords);
+  case WordIndexColumn::amountValue:
+    return columnPair(amountValue);
+  case WordIndexColumn::amountPage:
+    return columnPair(amountPage);
+  case WordIndexColumn::amountX0:
+    return columnPair(amountX0);
+  case WordIndexColumn::amountY0:
+    return columnPair(amountY0);
+  case WordIndexColumn::amountX1:
+    return columnPair(amountX1);
+  case WordIndexColumn::amountY1:
+    return columnPair(amountY1);
+  case WordIndexColumn::stringArena:
+    return {stringArena.data(), stringArena.size()};
+  case WordIndexColumn::postings:
+    return {postings.data(), postings.size()};
+  default:
+    return {nullptr, 0};
+  }
+}
+
+bool writeSegmentFile(const std::string &filePath,
+                      const SegmentColumns &columns) {
+  uint64_t directory[wordIndexColumnCount * 2];
+  std::size_t offset = headerBytes + directoryBytes;
+  for (unsigned int i = 0; i < wordIndexColumnCount; i++) {
+    WordIndexColumn column = static_cast<WordIndexColumn>(i);
+    offset = alignUp(offset);
+    directory[i * 2] = offset;
+    directory[i * 2 + 1] = columns.get(column).second;
+    offset += columns.get(column).second * getEntryBytes(column);
+  }
+  std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    return false;
+  }
+  uint32_t header[4] = {0, wordIndexFileVersion, wordIndexColumnCount, 0};
+  std::memcpy(&header[0], wordIndexFileMagic, 4);
+  file.write(reinterpret_cast<const char *>(header), sizeof(header));
+  file.write(reinterpret_cast<const char *>(directory), sizeof(directory));
+  const char padding[8] = {0};
+  std::size_t position = headerBytes + directoryBytes;
+  for (unsigned int i = 0; i < wordIndexColumnCount; i++) {
+    WordIndexColumn column = static_cast<WordIndexColumn>(i);
+    file.write(padding, directory[i * 2] - position);
+    std::pair<const char *, std::size_t> data = columns.get(column);
+    std::size_t bytes = data.second * getEntryBytes(column);
+    file.write(data.first, bytes);
+    position = directory[i * 2] + bytes;
+  }
+  file.close();
+  return !file.fail();
+}
+
+} // namespace
+
+std::string normalizeIndexTerm(std::string_view word) {
+  auto isWordChar = [](unsigned char c) {
+    return c >= 0x80 || (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+           (c >= 'A' && c <= 'Z');
+  };
+  std::size_t begin = 0, end = word.size();
+  while (begin < end && !isWordChar(word[begin])) {
+    begin++;
+  }
+  while (end > begin && !isWordChar(word[end - 1])) {
+    end--;
+  }
+  std::string term(word.substr(begin, end - begin));
+  for (char &c : term) {
+    if (c >= 'A' && c <= 'Z') {
+      c = static_cast<char>(c - 'A' + 'a');
+    }
+  }
+  return term;
+}
+
+void WordPostingList::append(const WordPosting &posting) {
+  uint32_t pageDelta = posting.pageId - lastPageId;
+  appendVarint(bytes, pageDelta);
+  if (pageDelta == 0 && count > 0) {
+    int32_t delta = static_cast<int32_t>(posting.y0 - lastY0);
+    appendVarint(bytes, (static_cast<uint32_t>(delta) << 1) ^
+                            static_cast<uint32_t>(delta >> 31));
+  } else {
+    appendVarint(bytes, posting.y0);
+  }
+  appendVarint(bytes, posting.x0);
+  appendVarint(bytes, posting.x1 - posting.x0);
+  appendVarint(bytes, posting.y1 - posting.y0);
+  lastPageId = posting.pageId;
+  lastY0 = posting.y0;
+  count++;
+}
+
+bool WordPostingReader::next(WordPosting &posting) {
+  uint32_t pageDelta, y, x0, width, height;
+  if (!readVarint(cursor, end, pageDelta) || !readVarint(cursor, end, y) ||
+      !readVarint(cursor, end, x0) || !readVarint(cursor, end, width) ||
+      !readVarint(cursor, end, height)) {
+    cursor = end;
+    return false;
+  }
+  if (pageDelta == 0 && started) {
+    y0 += (y >> 1) ^ (0u - (y & 1));
+  } else {
+    y0 = y;
+  }
+  pageId += pageDelta;
+  started = true;
+  posting.pageId = pageId;
+  posting.x0 = x0;
+  posting.y0 = y0;
+  posting.x1 = x0 + width;
+  posting.y1 = y0 + height;
+  return true;
+}
+
+bool WordIndexSegment::open(const std::string &filePath) {
+  close();
+  if (!nativeLittleEndian) {
+    return false;
+  }
+  try {
+    mapping = std::make_unique<boost::interprocess::file_mapping>(
+        filePath.c_str(), boost::interprocess::read_only);
+    region = std::make_unique<boost::interprocess::mapped_region>(
+        *mapping, boost::interprocess::read_only);
+  } catch (...) {
+    close();
+    return false;
+  }
+  const char *data = static_cast<const char *>(region->get_address());
+  std::size_t fileBytes = region->get_size();
+  uint32_t header[4];
+  if (fileBytes < headerBytes + directoryBytes ||
+      std::memcmp(data, wordIndexFileMagic, 4) != 0) {
+    close();
+    return false;
+  }
+  std::memcpy(header, data, headerBytes);
+  if (header[1] != wordIndexFileVersion || header[2] != wordIndexColumnCount) {
+    close();
+    return false;
+  }
+  uint64_t directory[wordIndexColumnCount * 2];
+  std::memcpy(directory, data + headerBytes, directoryBytes);
+  for (unsigned int i = 0; i < wordIndexColumnCount; i++) {
+    uint64_t offset = directory[i * 2], count = directory[i * 2 + 1];
+    std::size_t entryBytes = getEntryBytes(static_cast<WordIndexColumn>(i));
+    if (offset % 8 != 0 || offset > fileBytes ||
+        count > (fileBytes - offset) / entryBytes) {
+      close();
+      return false;
+    }
+    columnData[i] = data + offset;
+    columnCount[i] = static_cast<std::size_t>(count);
+  }
+  if (!check()) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+bool WordIndexSegment::check() {
+  std::size_t docCount = getDocCount(), pageCount = getPageCount(),
+              termCount = getTermCount(), amountCount = getAmountCount(),
+              arenaBytes = size(WordIndexColumn::stringArena);
+  if (size(WordIndexColumn::docLength) != docCount ||
+      size(WordIndexColumn::pageNum) != pageCount ||
+      size(WordIndexColumn::pageHash) != pageCount ||
+      size(WordIndexColumn::termLength) != termCount ||
+      size(WordIndexColumn::termPostingEnd) != termCount ||
+      size(WordIndexColumn::termWords) != termCount ||
+      size(WordIndexColumn::amountPage) != amountCount ||
+      size(WordIndexColumn::amountX0) != amountCount ||
+      size(WordIndexColumn::amountY0) != amountCount ||
+      size(WordIndexColumn::amountX1) != amountCount ||
+      size(WordIndexColumn::amountY1) != amountCount) {
+    return false;
+  }
+  auto checkStrings = [arenaBytes](const uint32_t *offset,
+                                   const uint32_t *length, std::size_t count) {
+    for (std::size_t i = 0; i < count; i++) {
+      if (static_cast<std::size_t>(offset[i]) + length[i] > arenaBytes) {
+        return false;
+      }
+    }
+    return true;
+  };
+  if (!checkStrings(column<uint32_t>(WordIndexColumn::docOffset),
+                    column<uint32_t>(WordIndexColumn::docLength), docCount) ||
+      !checkStrings(column<uint32_t>(WordIndexColumn::termOffset),
+                    column<uint32_t>(WordIndexColumn::termLength),
+                    termCount)) {
+    return false;
+  }
+  const uint32_t *pageDoc = column<uint32_t>(WordIndexColumn::pageDoc);
+  for (std::size_t i = 0; i < pageCount; i++) {
+    if (pageDoc[i] >= docCount) {
+      return false;
+    }
+  }
+  const uint64_t *postingEnd =
+      column<uint64_t>(WordIndexColumn::termPostingEnd);
+  uint64_t lastEnd = 0;
+  for (std::size_t i = 0; i < termCount; i++) {
+    if (postingEnd[i] < lastEnd ||
+        postingEnd[i] > size(WordIndexColumn::postings) ||
+        (i > 0 && !(getTerm(i - 1) < getTerm(i)))) {
+      return false;
+    }
+    lastEnd = postingEnd[i];
+  }
+  const uint32_t *amountPage = column<uint32_t>(WordIndexColumn::amountPage);
+  const uint64_t *amountValue =
+      column<uint64_t>(WordIndexColumn::amountValue);
+  for (std::size_t i = 0; i < amountCount; i++) {
+    if (amountPage[i] >= pageCount ||
+        (i > 0 && static_cast<long long>(amountValue[i - 1]) >
+                      static_cast<long long>(amountValue[i]))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void WordIndexSegment::close() {
+  region.reset();
+  mapping.reset();
+  columnData.fill(nullptr);
+  columnCount.fill(0);
+}
+
+std::string_view WordIndexSegment::getDoc(std::size_t index) const {
+  return std::string_view(
+      column<char>(WordIndexColumn::stringArena) +
+          column<uint32_t>(WordIndexColumn::docOffset)[index],
+      column<uint32_t>(WordIndexColumn::docLength)[index]);
+}
+
+std::string_view WordIndexSegment::getTerm(std::size_t index) const {
+  return std::string_view(
+      column<char>(WordIndexColumn::stringArena) +
+          column<uint32_t>(WordIndexColumn::termOffset)[index],
+      column<uint32_t>(WordIndexColumn::termLength)[index]);
+}
+
+std::string_view WordIndexSegment::getPostings(std::size_t index) const {
+  const uint64_t *postingEnd =
+      column<uint64_t>(WordIndexColumn::termPostingEnd);
+  uint64_t begin = index == 0 ? 0 : postingEnd[index - 1];
+  return std::string_view(column<char>(WordIndexColumn::postings) + begin,
+                          static_cast<std::size_t>(postingEnd[index] - begin));
+}
+
+WordAmount WordIndexSegment::getAmount(std::size_t index) const {
+  WordAmount amount;
+  amount.value = static_cast<long long>(
+      column<uint64_t>(WordIndexColumn::amountValue)[index]);
+  amount.pageId = column<uint32_t>(WordIndexColumn::amountPage)[index];
+  amount.x0 = column<uint32_t>(WordIndexColumn::amountX0)[index];
+  amount.y0 = column<uint32_t>(WordIndexColumn::amountY0)[index];
+  amount.x1 = column<uint32_t>(WordIndexColumn::amountX1)[index];
+  amount.y1 = column<uint32_t>(WordIndexColumn::amountY1)[index];
+  return amount;
+}
+
+std::size_t WordIndexSegment::lowerBound(std::string_view term) const {
+  std::size_t low = 0, high = getTermCount();
+  while (low < high) {
+    std::size_t middle = low + (high - low) / 2;
+    if (getTerm(middle) < term) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+std::size_t WordIndexSegment::lowerBoundAmount(long long value) const {
+  const uint64_t *amountValue =
+      column<uint64_t>(WordIndexColumn::amountValue);
+  std::size_t low = 0, high = getAmountCount();
+  while (low < high) {
+    std::size_t middle = low + (high - low) / 2;
+    if (static_cast<long long>(amountValue[middle]) < value) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+WordIndex::WordIndex()
+    : enabled(true), flushWords(1ULL << 20), loaded(true), amountSorted(0),
+      memoryWords(0), segmentWords(0), deadPages(0) {}
+
+WordIndex::~WordIndex() { flush(); }
+
+void WordIndex::configure(const RecognizeSettings &settings) {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::string path;
+  if (settings.indexEnabled && settings.cacheEnabled &&
+      !settings.cachePath.empty() && nativeLittleEndian) {
+    path = (boost::filesystem::path(settings.cachePath) / "wordIndex").string();
+  }
+  flushWords = std::max<unsigned long long>(settings.indexFlushWords, 1);
+  if (path == segmentPath && enabled == settings.indexEnabled) {
+    return;
+  }
+  // the words indexed so far stay with the old directory
+  if (loaded && !segmentPath.empty() && (memoryWords > 0 || deadPages > 0)) {
+    writeSegmentLocked();
+  }
+  resetLocked();
+  segmentPath = path;
+  enabled = settings.indexEnabled;
+  loaded = segmentPath.empty();
+}
+
+bool WordIndex::isEnabled() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return enabled;
+}
+
+void WordIndex::resetLocked() {
+  segment.close();
+  docList.clear();
+  docMap.clear();
+  pageList.clear();
+  livePageMap.clear();
+  termMap.clear();
+  amountList.clear();
+  amountSorted = 0;
+  memoryWords = 0;
+  segmentWords = 0;
+  deadPages = 0;
+}
+
+void WordIndex::loadLocked() {
+  loaded = true;
+  // a missing or damaged segment is written again at the next merge
+  if (segmentPath.empty() || !segment.open(segmentPath)) {
+    return;
+  }
+  readSegmentLocked();
+}
+
+void WordIndex::readSegmentLocked() {
+  docList.clear();
+  docMap.clear();
+  pageList.clear();
+  livePageMap.clear();
+  for (std::size_t i = 0; i < segment.getDocCount(); i++) {
+    docList.emplace_back(segment.getDoc(i));
+    docMap[docList.back()] = static_cast<unsigned int>(i);
+  }
+  const uint32_t *pageDoc = segment.column<uint32_t>(WordIndexColumn::pageDoc);
+  const uint32_t *pageNum = segment.column<uint32_t>(WordIndexColumn::pageNum);
+  const uint64_t *pageHash =
+      segment.column<uint64_t>(WordIndexColumn::pageHash);
+  pageList.resize(segment.getPageCount());
+  for (std::size_t i = 0; i < pageList.size(); i++) {
+    pageList[i].docId = pageDoc[i];
+    pageList[i].pageNum = pageNum[i];
+    pageList[i].hash = pageHash[i];
+    livePageMap[static_cast<unsigned long long>(pageDoc[i]) << 32 |
+                pageNum[i]] = static_cast<unsigned int>(i);
+  }
+  const uint32_t *termWords =
+      segment.column<uint32_t>(WordIndexColumn::termWords);
+  segmentWords = 0;
+  for (std::size_t i = 0; i < segment.getTermCount(); i++) {
+    segmentWords += termWords[i];
+  }
+}
+
+unsigned int WordIndex::getDocLocked(const std::string &filePath) {
+  auto docIt = docMap.find(filePath);
+  if (docIt != docMap.end()) {
+    return docIt->second;
+  }
+  unsigned int docId = static_cast<unsigned int>(docList.size());
+  docList.push_back(filePath);
+  docMap.emplace(filePath, docId);
+  return docId;
+}
+
+void WordIndex::addPage(const std::string &filePath, unsigned int pageNum,
+                        const HocrWordTable &table) {
+  unsigned long long hash = hashPage(table);
+  // each string of the page is normalized and parsed once, before locking
+  std::size_t stringCount = table.stringOffset.size();
+  std::vector<std::string> termList(stringCount);
+  std::vector<unsigned char> seenList(stringCount, 0), amountFlag(stringCount,
+                                                                  0);
+  std::vector<long long> amountValue(stringCount, 0);
+  for (unsigned int index : table.valueIndex) {
+    if (seenList[index]) {
+      continue;
+    }
+    seenList[index] = 1;
+    std::string_view value = table.getString(index);
+    termList[index] = normalizeIndexTerm(value);
+    unsigned long long cents;
+    bool negative;
+    if (parseAmountToken(value, cents, negative) > 0) {
+      amountFlag[index] = 1;
+      amountValue[index] = negative ? -static_cast<long long>(cents)
+                                    : static_cast<long long>(cents);
+    }
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!enabled) {
+    return;
+  }
+  if (!loaded) {
+    loadLocked();
+  }
+  unsigned int docId = getDocLocked(filePath);
+  unsigned long long pageKey =
+      static_cast<unsigned long long>(docId) << 32 | pageNum;
+  auto liveIt = livePageMap.find(pageKey);
+  if (liveIt != livePageMap.end()) {
+    // loaded back from the cache, or recognized again the same
+    if (pageList[liveIt->second].hash == hash) {
+      return;
+    }
+    pageList[liveIt->second].live = false;
+    deadPages++;
+  }
+  unsigned int pageId = static_cast<unsigned int>(pageList.size());
+  IndexPage page;
+  page.docId = docId;
+  page.pageNum = pageNum;
+  page.hash = hash;
+  pageList.push_back(page);
+  livePageMap[pageKey] = pageId;
+  std::vector<WordPostingList *> postingMap(stringCount, nullptr);
+  for (std::size_t i = 0; i < table.size(); i++) {
+    unsigned int index = table.valueIndex[i];
+    if (termList[index].empty()) {
+      continue;
+    }
+    if (!postingMap[index]) {
+      auto termIt = termMap.find(termList[index]);
+      if (termIt == termMap.end()) {
+        termIt = termMap.emplace(termList[index], WordPostingList()).first;
+      }
+      postingMap[index] = &termIt->second;
+    }
+    WordPosting posting;
+    posting.pageId = pageId;
+    posting.x0 = table.x0[i];
+    posting.y0 = table.y0[i];
+    posting.x1 = std::max(table.x1[i], table.x0[i]);
+    posting.y1 = std::max(table.y1[i], table.y0[i]);
+    postingMap[index]->append(posting);
+    memoryWords++;
+    if (amountFlag[index]) {
+      WordAmount amount;
+      amount.value = amountValue[index];
+      amount.pageId = pageId;
+      amount.x0 = posting.x0;
+      amount.y0 = posting.y0;
+      amount.x1 = posting.x1;
+      amount.y1 = posting.y1;
+      amountList.push_back(amount);
+    }
+  }
+  if (!segmentPath.empty() && memoryWords >= flushWords) {
+    writeSegmentLocked();
+  }
+}
+
+void WordIndex::sortAmountsLocked() {
+  if (amountSorted == amountList.size()) {
+    return;
+  }
+  auto byValue = [](const WordAmount &a, const WordAmount &b) {
+    return a.value < b.value;
+  };
+  std::sort(amountList.begin() + amountSorted, amountList.end(), byValue);
+  std::inplace_merge(amountList.begin(), amountList.begin() + amountSorted,
+                     amountList.end(), byValue);
+  amountSorted = amountList.size();
+}
+
+bool WordIndex::writeSegmentLocked() {
+  if (segmentPath.empty()) {
+    return false;
+  }
+  sortAmountsLocked();
+  SegmentColumns columns;
+  for (const std::string &doc : docList) {
+    columns.addString(doc, columns.docOffset, columns.docLength);
+  }
+  // the live pages keep their order, so the posting lists stay sorted
+  std::vector<uint32_t> newPageId(pageList.size(), deadPageId);
+  for (std::size_t i = 0; i < pageList.size(); i++) {
+    if (pageList[i].live) {
+      newPageId[i] = static_cast<uint32_t>(columns.pageDoc.size());
+      columns.pageDoc.push_back(pageList[i].docId);
+      columns.pageNum.push_back(pageList[i].pageNum);
+      columns.pageHash.push_back(pageList[i].hash);
+    }
+  }
+  auto copyPostings = [&newPageId](std::string_view bytes,
+                                   WordPostingList &list) {
+    WordPostingReader reader(bytes);
+    WordPosting posting;
+    while (reader.next(posting)) {
+      if (posting.pageId < newPageId.size() &&
+          newPageId[posting.pageId] != deadPageId) {
+        posting.pageId = newPageId[posting.pageId];
+        list.append(posting);
+      }
+    }
+  };
+  // both term lists are sorted, merged like two runs
+  std::size_t termIndex = 0, termCount = segment.getTermCount();
+  auto termIt = termMap.begin();
+  while (termIndex < termCount || termIt != termMap.end()) {
+    std::string term;
+    WordPostingList list;
+    bool fromSegment = termIndex < termCount &&
+                       (termIt == termMap.end() ||
+                        segment.getTerm(termIndex) <= termIt->first);
+    if (fromSegment) {
+      term = segment.getTerm(termIndex);
+      copyPostings(segment.getPostings(termIndex), list);
+      termIndex++;
+    }
+    if (termIt != termMap.end() && (!fromSegment || termIt->first == term)) {
+      term = termIt->first;
+      copyPostings(termIt->second.bytes, list);
+      ++termIt;
+    }
+    if (list.count == 0) {
+      continue;
+    }
+    columns.addString(term, columns.termOffset, columns.termLength);
+    columns.postings += list.bytes;
+    columns.termPostingEnd.push_back(columns.postings.size());
+    columns.termWords.push_back(list.count);
+  }
+  std::size_t amountIndex = 0, amountCount = segment.getAmountCount(),
+              memoryIndex = 0;
+  while (amountIndex < amountCount || memoryIndex < amountList.size()) {
+    WordAmount amount;
+    if (memoryIndex == amountList.size() ||
+        (amountIndex < amountCount &&
+         segment.getAmount(amountIndex).value <=
+             amountList[memoryIndex].value)) {
+      amount = segment.getAmount(amountIndex++);
+    } else {
+      amount = amountList[memoryIndex++];
+    }
+    if (amount.pageId < newPageId.size() &&
+        newPageId[amount.pageId] != deadPageId) {
+      columns.addAmount(amount, newPageId[amount.pageId]);
+    }
+  }
+  std::string tempPath = segmentPath + ".tmp";
+  if (!writeSegmentFile(tempPath, columns)) {
+    return false;
+  }
+  // unmapped first, a mapped file can not be replaced everywhere
+  segment.close();
+  boost::system::error_code ec;
+  boost::filesystem::rename(tempPath, segmentPath, ec);
+  if (ec) {
+    if (segment.open(segmentPath)) {
+      readSegmentLocked();
+    }
+    return false;
+  }
+  termMap.clear();
+  amountList.clear();
+  amountSorted = 0;
+  memoryWords = 0;
+  deadPages = 0;
+  if (!segment.open(segmentPath)) {
+    // the words are gone with the segment, start over
+    resetLocked();
+    return false;
+  }
+  readSegmentLocked();
+  return true;
+}
+
+bool WordIndex::addHitLocked(unsigned int pageId, unsigned int x0,
+                             unsigned int y0, unsigned int x1,
+                             unsigned int y1, std::string_view term,
+                             long long amount, std::size_t maxHits,
+                             std::vector<WordHit> &hitList) {
+  if (pageId < pageList.size() && pageList[pageId].live) {
+    const IndexPage &page = pageList[pageId];
+    hitList.emplace_back();
+    WordHit &hit = hitList.back();
+    hit.filePath = docList[page.docId];
+    hit.pageNum = page.pageNum;
+    hit.x0 = x0;
+    hit.y0 = y0;
+    hit.x1 = x1;
+    hit.y1 = y1;
+    hit.term = term;
+    hit.amount = amount;
+  }
+  return maxHits == 0 || hitList.size() < maxHits;
+}
+
+void WordIndex::findLocked(std::string_view term, bool prefix,
+                           std::size_t maxHits,
+                           std::vector<WordHit> &hitList) {
+  if (!enabled) {
+    return;
+  }
+  if (!loaded) {
+    loadLocked();
+  }
+  auto matches = [term, prefix](std::string_view indexed) {
+    return prefix ? indexed.substr(0, term.size()) == term : indexed == term;
+  };
+  auto addPostings = [&](std::string_view indexed, std::string_view bytes) {
+    WordPostingReader reader(bytes);
+    WordPosting posting;
+    while (reader.next(posting)) {
+      if (!addHitLocked(posting.pageId, posting.x0, posting.y0, posting.x1,
+                        posting.y1, indexed, 0, maxHits, hitList)) {
+        return false;
+      }
+    }
+    return true;
+  };
+  if (segment.isOpen()) {
+    for (std::size_t i = segment.lowerBound(term);
+         i < segment.getTermCount() && matches(segment.getTerm(i)); i++) {
+      if (!addPostings(segment.getTerm(i), segment.getPostings(i))) {
+        return;
+      }
+    }
+  }
+  for (auto termIt = termMap.lower_bound(term);
+       termIt != termMap.end() && matches(termIt->first); ++termIt) {
+    if (!addPostings(termIt->first, termIt->second.bytes)) {
+      return;
+    }
+  }
+}
+
+void WordIndex::findTerm(std::string_view term, std::size_t maxHits,
+                         std::vector<WordHit> &hitList) {
+  std::string normalized = normalizeIndexTerm(term);
+  if (normalized.empty()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  findLocked(normalized, false, maxHits, hitList);
+}
+
+void WordIndex::findPrefix(std::string_view prefix, std::size_t maxHits,
+                           std::vector<WordHit> &hitList) {
+  std::string normalized = normalizeIndexTerm(prefix);
+  if (normalized.empty()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  findLocked(normalized, true, maxHits, hitList);
+}
+
+void WordIndex::findAmounts(long long minimum, long long maximum,
+                            std::size_t maxHits,
+                            std::vector<WordHit> &hitList) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!enabled || minimum > maximum) {
+    return;
+  }
+  if (!loaded) {
+    loadLocked();
+  }
+  sortAmountsLocked();
+  std::size_t amountIndex = 0, amountCount = 0;
+  if (segment.isOpen()) {
+    amountIndex = segment.lowerBoundAmount(minimum);
+    amountCount = segment.getAmountCount();
+  }
+  auto memoryIt = std::lower_bound(
+      amountList.begin(), amountList.end(), minimum,
+      [](const WordAmount &amount, long long value) {
+        return amount.value < value;
+      });
+  // the segment and the memory merged in order of value
+  while (true) {
+    bool segmentLeft = amountIndex < amountCount &&
+                       segment.getAmount(amountIndex).value <= maximum;
+    bool memoryLeft =
+        memoryIt != amountList.end() && memoryIt->value <= maximum;
+    if (!segmentLeft && !memoryLeft) {
+      return;
+    }
+    WordAmount amount;
+    if (segmentLeft &&
+        (!memoryLeft ||
+         segment.getAmount(amountIndex).value <= memoryIt->value)) {
+      amount = segment.getAmount(amountIndex++);
+    } else {
+      amount = *memoryIt++;
+    }
+    if (!addHitLocked(amount.pageId, amount.x0, amount.y0, amount.x1,
+                      amount.y1, std::string_view(), amount.value, maxHits,
+                      hitList)) {
+      return;
+    }
+  }
+}
+
+bool WordIndex::flush() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!enabled || !loaded || segmentPath.empty() ||
+      (memoryWords == 0 && deadPages == 0)) {
+    return true;
+  }
+  return writeSegmentLocked();
+}
+
+unsigned long long WordIndex::getWordCount() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (enabled && !loaded) {
+    loadLocked();
+  }
+  return segmentWords + memoryWords;
+}
+
+std::size_t WordIndex::getTermCount() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (enabled && !loaded) {
+    loadLocked();
+  }
+  return segment.getTermCount() + termMap.size();
+}
+
+} // namespace bookfiler
@@ -0,0 +1,264 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_WORD_INDEX_H
+#define BOOKFILER_MODULE_RECOGNIZE_WORD_INDEX_H
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/* boost 1.72.0
+ * License: Boost Software License (similar to BSD and MIT)
+ */
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+// Local Project
+#include "../Interface.hpp"
+#include "recognizeSettings.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+/* @brief Lower case the ASCII letters of a word and drop the punctuation
+ * around it, "Payee," is "payee" and "$1,234.56" is "1,234.56"
+ * @return empty if nothing is left
+ */
+std::string normalizeIndexTerm(std::string_view word);
+
+/* One indexed word, pageId numbers the pages in the order they were
+ * indexed
+ */
+class WordPosting {
+public:
+  unsigned int pageId = 0;
+  unsigned int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+};
+
+/* Posting list of a term, appended one word at a time
+ * A word is varints of the page id delta, y0, x0, width and height. y0 is
+ * a zigzag delta from the word before on the same page, so the words of a
+ * line take a few bytes each.
+ */
+class WordPostingList {
+public:
+  std::string bytes;
+  unsigned int count = 0, lastPageId = 0, lastY0 = 0;
+
+  // page ids never go down
+  void append(const WordPosting &posting);
+};
+
+/* Reads the words of a posting list in order
+ */
+class WordPostingReader {
+private:
+  const unsigned char *cursor, *end;
+  unsigned int pageId = 0, y0 = 0;
+  bool started = false;
+
+public:
+  explicit WordPostingReader(std::string_view bytes)
+      : cursor(reinterpret_cast<const unsigned char *>(bytes.data())),
+        end(cursor + bytes.size()){};
+  // @return false at the end, or where the bytes stop inside a word
+  bool next(WordPosting &posting);
+};
+
+/* An amount of the index, cents negative for debits
+ */
+class WordAmount {
+public:
+  long long value = 0;
+  unsigned int pageId = 0;
+  unsigned int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+};
+
+/* Columns of a word index segment, in file order
+ * docs are the file paths, pages say which doc and page number each page
+ * id is. Terms are sorted by their bytes, the posting list of term i is
+ * [termPostingEnd[i-1], termPostingEnd[i]) of postings. Amounts are sorted
+ * by value.
+ */
+enum class WordIndexColumn : unsigned int {
+  docOffset = 0,
+  docLength,
+  pageDoc,
+  pageNum,
+  pageHash,
+  termOffset,
+  termLength,
+  termPostingEnd,
+  termWords,
+  amountValue,
+  amountPage,
+  amountX0,
+  amountY0,
+  amountX1,
+  amountY1,
+  stringArena,
+  postings,
+  count
+};
+
+/* Word index segment file, little endian
+ * header: "BFWI", version, columnCount, 0 (four 32 bit words)
+ * directory: offset, entry count (two 64 bit words) per column
+ * columns: each starts on an 8 byte boundary, u64 for the page hashes,
+ *          posting ends and amounts, bytes for the arena and the postings,
+ *          u32 otherwise
+ * Same layout as the document file, a reader maps it and binary searches
+ * the terms in place.
+ */
+const unsigned int wordIndexFileVersion = 1;
+
+/* Read only view of a word index segment
+ * open() checks that the columns lie inside the file, the strings inside
+ * the arena, the terms are sorted and the page and doc indexes are in
+ * range. Posting lists are checked as they are decoded.
+ */
+class WordIndexSegment {
+private:
+  std::unique_ptr<boost::interprocess::file_mapping> mapping;
+  std::unique_ptr<boost::interprocess::mapped_region> region;
+  std::array<const char *, static_cast<unsigned int>(WordIndexColumn::count)>
+      columnData{};
+  std::array<std::size_t, static_cast<unsigned int>(WordIndexColumn::count)>
+      columnCount{};
+
+  bool check();
+
+public:
+  /* @brief Map the file, closing the one open before
+   * @return false if the file is missing, damaged or another version
+   */
+  bool open(const std::string &filePath);
+  void close();
+  bool isOpen() const { return region != nullptr; }
+  std::size_t size(WordIndexColumn column) const {
+    return columnCount[static_cast<unsigned int>(column)];
+  }
+  template <typename T> const T *column(WordIndexColumn column) const {
+    return reinterpret_cast<const T *>(
+        columnData[static_cast<unsigned int>(column)]);
+  }
+  std::size_t getDocCount() const { return size(WordIndexColumn::docOffset); }
+  std::size_t getPageCount() const { return size(WordIndexColumn::pageDoc); }
+  std::size_t getTermCount() const {
+    return size(WordIndexColumn::termOffset);
+  }
+  std::size_t getAmountCount() const {
+    return size(WordIndexColumn::amountValue);
+  }
+  std::string_view getDoc(std::size_t index) const;
+  std::string_view getTerm(std::size_t index) const;
+  std::string_view getPostings(std::size_t index) const;
+  WordAmount getAmount(std::size_t index) const;
+  // @return the first term not less than term, getTermCount() if none
+  std::size_t lowerBound(std::string_view term) const;
+  // @return the first amount not less than value
+  std::size_t lowerBoundAmount(long long value) const;
+};
+
+/* Inverted index of the words of every recognized page
+ * Maps the normalized words to posting lists of page and bounding box, and
+ * the amounts among them to a sorted list for range lookups. Pages are
+ * added as they are stored, a page added again replaces its words unless
+ * they are the same. With the cache on the index is kept in "wordIndex" in
+ * the cache directory: the pages of earlier sessions are in the mapped
+ * segment, the new ones in memory until flushWords words are merged into a
+ * new segment. Safe from any thread.
+ */
+class WordIndex {
+private:
+  class IndexPage {
+  public:
+    unsigned int docId = 0, pageNum = 0;
+    unsigned long long hash = 0;
+    bool live = true;
+  };
+
+  std::mutex mutex;
+  bool enabled;
+  // empty to keep the index in memory only
+  std::string segmentPath;
+  unsigned long long flushWords;
+  bool loaded;
+  WordIndexSegment segment;
+  std::vector<std::string> docList;
+  std::unordered_map<std::string, unsigned int> docMap;
+  // indexed by page id, the segment pages first
+  std::vector<IndexPage> pageList;
+  // live page id of doc << 32 | page number
+  std::unordered_map<unsigned long long, unsigned int> livePageMap;
+  std::map<std::string, WordPostingList, std::less<>> termMap;
+  // amounts not in the segment, sorted up to amountSorted
+  std::vector<WordAmount> amountList;
+  std::size_t amountSorted;
+  unsigned long long memoryWords, segmentWords, deadPages;
+
+  void loadLocked();
+  // docs and pages of the segment just opened
+  void readSegmentLocked();
+  void resetLocked();
+  unsigned int getDocLocked(const std::string &filePath);
+  // merge the segment and the memory into a new segment
+  bool writeSegmentLocked();
+  void sortAmountsLocked();
+  // @return false once maxHits hits are in hitList
+  bool addHitLocked(unsigned int pageId, unsigned int x0, unsigned int y0,
+                    unsigned int x1, unsigned int y1, std::string_view term,
+                    long long amount, std::size_t maxHits,
+                    std::vector<WordHit> &hitList);
+  void findLocked(std::string_view term, bool prefix, std::size_t maxHits,
+                  std::vector<WordHit> &hitList);
+
+public:
+  // in memory and on until configured
+  WordIndex();
+  // merges the words in memory into the segment
+  ~WordIndex();
+  void configure(const RecognizeSettings &settings);
+  bool isEnabled();
+  void addPage(const std::string &filePath, unsigned int pageNum,
+               const HocrWordTable &table);
+  /* @brief Words equal to term once both are normalized
+   * @param maxHits 0 for all
+   */
+  void findTerm(std::string_view term, std::size_t maxHits,
+                std::vector<WordHit> &hitList);
+  // words starting with the normalized prefix, term by term
+  void findPrefix(std::string_view prefix, std::size_t maxHits,
+                  std::vector<WordHit> &hitList);
+  // amounts from minimum to maximum cents, in order of value
+  void findAmounts(long long minimum, long long maximum, std::size_t maxHits,
+                   std::vector<WordHit> &hitList);
+  // @return false if the segment could not be written
+  bool flush();
+  // words of the live pages and of the pages replaced since the last merge
+  unsigned long long getWordCount();
+  // terms of the segment and of the memory, one in both counts twice
+  std::size_t getTermCount();
+};
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_WORD_INDEX_H
@@ -0,0 +1,176 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+// c++17
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+/* boost 1.72.0
+ * License: Boost Software License (similar to BSD and MIT)
+ */
+#include <boost/endian/conversion.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+// Local Project
+#include "wordTableFile.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+namespace {
+
+const char wordTableFileMagic[4] = {'B', 'F', 'W', 'T'};
+const std::size_t headerBytes = 8 * sizeof(uint32_t);
+constexpr bool nativeLittleEndian =
+    boost::endian::order::native == boost::endian::order::little;
+
+template <typename T>
+void writeColumn(std::ofstream &file, const std::vector<T> &column) {
+  file.write(reinterpret_cast<const char *>(column.data()),
+             column.size() * sizeof(T));
+}
+
+template <typename T>
+const char *readColumn(const char *cursor, std::size_t count,
+                       std::vector<T> &column) {
+  column.resize(count);
+  std::memcpy(column.data(), cursor, count * sizeof(T));
+  return cursor + count * sizeof(T);
+}
+
+} // namespace
+
+bool writeWordTableFile(const std::string &filePath,
+                        const HocrWordTable &table) {
+  if (!nativeLittleEndian) {
+    return false;
+  }
+  std::string tempPath = filePath + ".tmp";
+  {
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      return false;
+    }
+    uint32_t header[8] = {0,
+                          wordTableFileVersion,
+                          table.pageNum,
+                          static_cast<uint32_t>(table.size()),
+                          static_cast<uint32_t>(table.stringOffset.size()),
+                          static_cast<uint32_t>(table.stringArena.size()),
+                          static_cast<uint32_t>(table.lineEnd.size()),
+                          static_cast<uint32_t>(table.pageEnd.size())};
+    std::memcpy(&header[0], wordTableFileMagic, 4);
+    file.write(reinterpret_cast<const char *>(header), sizeof(header));
+    writeColumn(file, table.x0);
+    writeColumn(file, table.y0);
+    writeColumn(file, table.x1);
+    writeColumn(file, table.y1);
+    writeColumn(file, table.confidence);
+    writeColumn(file, table.baselineSlope);
+    writeColumn(file, table.baselineOffset);
+    writeColumn(file, table.xSize);
+    writeColumn(file, table.xFsize);
+    writeColumn(file, table.textAngle);
+    writeColumn(file, table.valueIndex);
+    writeColumn(file, table.idIndex);
+    writeColumn(file, table.lineEnd);
+    writeColumn(file, table.pageEnd);
+    writeColumn(file, table.stringOffset);
+    writeColumn(file, table.stringLength);
+    file.write(table.stringArena.data(), table.stringArena.size());
+    if (!file) {
+      return false;
+    }
+  }
+  boost::system::error_code ec;
+  boost::filesystem::rename(tempPath, filePath, ec);
+  return !ec;
+}
+
+std::shared_ptr<HocrWordTable> readWordTableFile(const std::string &filePath) {
+  if (!nativeLittleEndian) {
+    return nullptr;
+  }
+  try {
+    boost::interprocess::file_mapping mapping(filePath.c_str(),
+                                              boost::interprocess::read_only);
+    boost::interprocess::mapped_region region(mapping,
+                                              boost::interprocess::read_only);
+    const char *data = static_cast<const char *>(region.get_address());
+    std::size_t size = region.get_size();
+    if (size < headerBytes || std::memcmp(data, wordTableFileMagic, 4) != 0) {
+      return nullptr;
+    }
+    uint32_t header[8];
+    std::memcpy(header, data, headerBytes);
+    std::size_t wordCount = header[3], stringCount = header[4],
+                arenaBytes = header[5], lineCount = header[6],
+                pageCount = header[7];
+    if (header[1] != wordTableFileVersion ||
+        size != headerBytes + wordCount * 12 * 4 + lineCount * 4 +
+                    pageCount * 4 + stringCount * 2 * 4 + arenaBytes) {
+      return nullptr;
+    }
+    std::shared_ptr<HocrWordTable> table = std::make_shared<HocrWordTable>();
+    table->pageNum = header[2];
+    const char *cursor = data + headerBytes;
+    cursor = readColumn(cursor, wordCount, table->x0);
+    cursor = readColumn(cursor, wordCount, table->y0);
+    cursor = readColumn(cursor, wordCount, table->x1);
+    cursor = readColumn(cursor, wordCount, table->y1);
+    cursor = readColumn(cursor, wordCount, table->confidence);
+    cursor = readColumn(cursor, wordCount, table->baselineSlope);
+    cursor = readColumn(cursor, wordCount, table->baselineOffset);
+    cursor = readColumn(cursor, wordCount, table->xSize);
+    cursor = readColumn(cursor, wordCount, table->xFsize);
+    cursor = readColumn(cursor, wordCount, table->textAngle);
+    cursor = readColumn(cursor, wordCount, table->valueIndex);
+    cursor = readColumn(cursor, wordCount, table->idIndex);
+    cursor = readColumn(cursor, lineCount, table->lineEnd);
+    cursor = readColumn(cursor, pageCount, table->pageEnd);
+    cursor = readColumn(cursor, stringCount, table->stringOffset);
+    cursor = readColumn(cursor, stringCount, table->stringLength);
+    table->stringArena.assign(cursor, arenaBytes);
+    // reject string indexes pointing outside the arena
+    for (std::size_t i = 0; i < stringCount; i++) {
+      if (static_cast<std::size_t>(table->stringOffset[i]) +
+              table->stringLength[i] >
+          arenaBytes) {
+        return nullptr;
+      }
+    }
+    for (std::size_t i = 0; i < lineCount; i++) {
+      if (table->lineEnd[i] > wordCount ||
+          (i > 0 && table->lineEnd[i] < table->lineEnd[i - 1])) {
+        return nullptr;
+      }
+    }
+    for (std::size_t i = 0; i < pageCount; i++) {
+      if (table->pageEnd[i] > wordCount ||
+          (i > 0 && table->pageEnd[i] < table->pageEnd[i - 1])) {
+        return nullptr;
+      }
+    }
+    for (std::size_t i = 0; i < wordCount; i++) {
+      if (table->valueIndex[i] >= stringCount ||
+          table->idIndex[i] >= stringCount) {
+        return nullptr;
+      }
+    }
+    return table;
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+} // namespace bookfiler
@@ -0,0 +1,56 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_WORD_TABLE_FILE_H
+#define BOOKFILER_MODULE_RECOGNIZE_WORD_TABLE_FILE_H
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <memory>
+#include <string>
+
+// Local Project
+#include "../Interface.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+/* Binary word table file, little endian
+ * header: "BFWT", version, pageNum, wordCount, stringCount, arenaBytes,
+ *         lineCount, pageCount (eight 32 bit words)
+ * columns: x0 y0 x1 y1 (u32), confidence baselineSlope baselineOffset
+ *          xSize xFsize textAngle (f32), valueIndex idIndex (u32)
+ *          one entry per word
+ * lines: lineEnd (u32) one entry per line
+ * pages: pageEnd (u32) one entry per page of a multi-page table
+ * strings: stringOffset stringLength (u32) one entry per string, then the
+ *          arena bytes
+ * The columns are the HocrWordTable vectors as they are in memory, so
+ * writing and reading is one copy per column.
+ */
+const unsigned int wordTableFileVersion = 3;
+
+/* @brief Write the table to filePath through a temporary file so readers
+ * never see a partial file
+ * @return false on error
+ */
+bool writeWordTableFile(const std::string &filePath,
+                        const HocrWordTable &table);
+/* @brief Map the file and copy the columns into a new table
+ * @return null if the file is missing, truncated or another version
+ */
+std::shared_ptr<HocrWordTable> readWordTableFile(const std::string &filePath);
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_WORD_TABLE_FILE_H
@@ -0,0 +1,163 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+// Local Project
+#include "workerPool.hpp"
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+WorkerPool::WorkerPool(unsigned int threadCount_)
+    : queued(0), running(0), completed(0), nextWorker(0), stopFlag(false) {
+  unsigned int threadCount = threadCount_;
+  if (threadCount == 0) {
+    threadCount = std::thread::hardware_concurrency();
+  }
+  if (threadCount == 0) {
+    threadCount = 1;
+  }
+  for (unsigned int i = 0; i < threadCount; i++) {
+    workerList.push_back(std::make_unique<Worker>());
+  }
+  for (unsigned int i = 0; i < threadCount; i++) {
+    threadList.emplace_back(&WorkerPool::run, this, i);
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    stopFlag = true;
+  }
+  workCondition.notify_all();
+  for (std::thread &thread : threadList) {
+    thread.join();
+  }
+}
+
+void WorkerPool::pushJob(std::function<void()> job, unsigned int priority) {
+  if (priority >= priorityCount) {
+    priority = priorityCount - 1;
+  }
+  unsigned int index = nextWorker++ % workerList.size();
+  {
+    std::lock_guard<std::mutex> lock(workerList[index]->mutex);
+    workerList[index]->queueList[priority].push_back(std::move(job));
+  }
+  workCondition.notify_one();
+}
+
+void WorkerPool::post(std::function<void()> job, unsigned int priority) {
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    if (stopFlag) {
+      return;
+    }
+    queued++;
+  }
+  pushJob(std::move(job), priority);
+}
+
+bool WorkerPool::popJob(unsigned int index, std::function<void()> &job) {
+  for (unsigned int priority = priorityCount; priority-- > 0;) {
+    {
+      Worker &worker = *workerList[index];
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      std::deque<std::function<void()>> &queue = worker.queueList[priority];
+      if (!queue.empty()) {
+        job = std::move(queue.front());
+        queue.pop_front();
+        return true;
+      }
+    }
+    // steal from the back of the other queues
+    for (std::size_t i = 1; i < workerList.size(); i++) {
+      Worker &victim = *workerList[(index + i) % workerList.size()];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      std::deque<std::function<void()>> &queue = victim.queueList[priority];
+      if (!queue.empty()) {
+        job = std::move(queue.back());
+        queue.pop_back();
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void WorkerPool::run(unsigned int index) {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(sleepMutex);
+      workCondition.wait(lock, [this] { return stopFlag || queued > 0; });
+      if (stopFlag) {
+        return;
+      }
+    }
+    std::function<void()> job;
+    if (!popJob(index, job)) {
+      /* another worker took it between the wake up and the pop, or the
+       * post reserved the slot and is still pushing the job
+       */
+      std::this_thread::yield();
+      continue;
+    }
+    {
+      std::lock_guard<std::mutex> lock(sleepMutex);
+      queued--;
+      running++;
+    }
+    job();
+    running--;
+    completed++;
+  }
+}
+
+unsigned int WorkerPool::getThreadCount() {
+  return static_cast<unsigned int>(threadList.size());
+}
+std::size_t WorkerPool::getRunning() { return running; }
+unsigned long long WorkerPool::getCompleted() { return completed; }
+
+void forEachIndex(
+    std::size_t count, const std::function<void(std::size_t)> &job,
+    const std::function<void(const std::function<void()> &)> &postHelpers) {
+  class ForEachState {
+  public:
+    std::atomic<std::size_t> next{0};
+    std::size_t count = 0, done = 0;
+    // only called for a taken index, while forEachIndex is still waiting
+    const std::function<void(std::size_t)> *job = nullptr;
+    std::mutex mutex;
+    std::condition_variable doneCondition;
+  };
+  std::shared_ptr<ForEachState> state = std::make_shared<ForEachState>();
+  state->count = count;
+  state->job = &job;
+  std::function<void()> drain = [state]() {
+    std::size_t i;
+    while ((i = state->next.fetch_add(1)) < state->count) {
+      (*state->job)(i);
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (++state->done == state->count) {
+        state->doneCondition.notify_all();
+      }
+    }
+  };
+  if (count > 1) {
+    postHelpers(drain);
+  }
+  drain();
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->doneCondition.wait(lock,
+                            [&state] { return state->done == state->count; });
+}
+
+} // namespace bookfiler
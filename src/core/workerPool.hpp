@@ -0,0 +1,87 @@
+/*
+ * @name Bookfiler™ Recognize Module
+ * @author Branden Lee
+ * @version 1.00
+ * @license GNU LGPL v3
+ * @brief text recognition.
+ */
+
+#ifndef BOOKFILER_MODULE_RECOGNIZE_WORKER_POOL_H
+#define BOOKFILER_MODULE_RECOGNIZE_WORKER_POOL_H
+
+// config
+#include "config.hpp"
+
+// c++17
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * bookfiler = BookFiler™
+ */
+namespace bookfiler {
+
+/* Fixed size thread pool with one job queue per worker and priority.
+ * Jobs are handed out round robin. A worker takes jobs from the front of
+ * its own queue and steals from the back of the others once it runs dry,
+ * always looking at the higher priorities first. The queues are not
+ * bounded, RecognizeScheduler only posts the jobs it lets run.
+ */
+class WorkerPool {
+public:
+  static const unsigned int priorityCount = 3;
+
+private:
+  class Worker {
+  public:
+    std::mutex mutex;
+    // indexed by priority, the highest runs first
+    std::array<std::deque<std::function<void()>>, priorityCount> queueList;
+  };
+  std::vector<std::unique_ptr<Worker>> workerList;
+  std::vector<std::thread> threadList;
+  std::mutex sleepMutex;
+  std::condition_variable workCondition;
+  std::atomic<std::size_t> queued, running;
+  std::atomic<unsigned long long> completed;
+  std::atomic<unsigned int> nextWorker;
+  bool stopFlag;
+
+  void run(unsigned int index);
+  bool popJob(unsigned int index, std::function<void()> &job);
+  void pushJob(std::function<void()> job, unsigned int priority);
+
+public:
+  // @param threadCount_ 0 uses the number of hardware threads
+  WorkerPool(unsigned int threadCount_);
+  ~WorkerPool();
+  /* Queue the job, never blocks
+   * @param priority 0 to priorityCount - 1, higher runs first
+   */
+  void post(std::function<void()> job, unsigned int priority);
+  unsigned int getThreadCount();
+  std::size_t getRunning();
+  unsigned long long getCompleted();
+};
+
+/* @brief Run job(i) for every i below count and return when all are done
+ * The caller runs them too. postHelpers is called once with a helper job
+ * and queues as many copies as it wants run, never more than count - 1 are
+ * of use. A helper that starts after every index was taken returns at once,
+ * so this never waits for a queued job and is safe to call from a worker.
+ */
+void forEachIndex(
+    std::size_t count, const std::function<void(std::size_t)> &job,
+    const std::function<void(const std::function<void()> &)> &postHelpers);
+
+} // namespace bookfiler
+
+#endif
+// end BOOKFILER_MODULE_RECOGNIZE_WORKER_POOL_H